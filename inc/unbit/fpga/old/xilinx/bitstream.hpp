@@ -7,6 +7,10 @@
 
 #include "common.hpp"
 
+#include "unbit/runtime/mem_stats.hpp"
+
+#include <span>
+
 namespace unbit
 {
 	namespace old
@@ -145,6 +149,12 @@ namespace unbit
 				*/
 				bool is_readback_;
 
+				/** @brief Memory accounting for the in-memory data (input buffer) */
+				runtime::mem_account data_account_;
+
+				/** @brief Memory accounting for the SLR slices (packet index) */
+				runtime::mem_account index_account_;
+
 			public:
 				/**
 				* @brief Loads an uncompressed (and unencrypted) bitstream from a given file.
@@ -403,6 +413,22 @@ namespace unbit
 					return frame_data_begin(slr_index) + frame_data_size(slr_index);
 				}
 
+				/**
+				* @brief Gets the raw data of the bitstream (file format). (non-const)
+				*/
+				inline std::span<uint8_t> raw_data()
+				{
+					return data_;
+				}
+
+				/**
+				* @brief Gets the raw data of the bitstream (file format). (const)
+				*/
+				inline std::span<const uint8_t> raw_data() const
+				{
+					return data_;
+				}
+
 				/**
 				* @brief In-place rewrite of the bitstream.
 				*
@@ -446,6 +472,93 @@ namespace unbit
 				*/
 				void write_frame_data_bit(size_t bit_offset, bool value, unsigned slr_index);
 
+				/**
+				* @brief Gets the number of 32-bit words in the frame data area (cf. @ref frame_source).
+				*
+				* @param[in] slr_index specifies the index of the (sub-)bitstream (aka. SLR in configuration
+				*   order) to be accessed.
+				*/
+				inline size_t frame_data_words(unsigned slr_index) const
+				{
+					return frame_data_size(slr_index) / 4u;
+				}
+
+				/**
+				* @brief Reads the frame data word containing a bit (cf. @ref frame_source).
+				*
+				* @param[in] slr_index specifies the index of the (sub-)bitstream (aka. SLR in configuration
+				*   order) to be accessed.
+				*
+				* @param[in] bit_offset specifies the offset (in bits) relative to the start of the
+				*   frame data area.
+				*
+				* @return The 32-bit word (in native byte order) containing the bit. Bit (bit_offset % 32)
+				*   of the word is the addressed bit.
+				*/
+				inline uint32_t read_frame_word(unsigned slr_index, size_t bit_offset) const
+				{
+					const slr_info& info = slr(slr_index);
+					const size_t byte_offset = (bit_offset / 32u) * 4u;
+
+					if (byte_offset >= info.frame_data_size || (info.frame_data_size - byte_offset) < 4u)
+						throw std::out_of_range("frame data slice is out of bounds");
+
+					const uint8_t* word = data_.data() + info.frame_data_offset + byte_offset;
+
+					return (static_cast<uint32_t>(word[0u]) << 24u) | (static_cast<uint32_t>(word[1u]) << 16u) |
+						(static_cast<uint32_t>(word[2u]) << 8u) | static_cast<uint32_t>(word[3u]);
+				}
+
+				/**
+				* @brief Reads a range of frame data words (cf. @ref frame_source).
+				*
+				* @param[in] slr_index specifies the index of the (sub-)bitstream (aka. SLR in configuration
+				*   order) to be accessed.
+				*
+				* @param[in] first_word specifies the index of the first word to be read.
+				*
+				* @param[out] words receives the frame data words (in native byte order).
+				*/
+				void read_frame_words(unsigned slr_index, size_t first_word, std::span<uint32_t> words) const;
+
+				/**
+				* @brief Writes a bit in the frame data area (cf. @ref frame_sink).
+				*
+				* @param[in] slr_index specifies the index of the (sub-)bitstream (aka. SLR in configuration
+				*   order) to be accessed.
+				*
+				* @param[in] bit_offset specifies the offset (in bits) relative to the start of the
+				*   frame data area.
+				*
+				* @param[in] value the value to write at the given location.
+				*/
+				inline void write_frame_bit(unsigned slr_index, size_t bit_offset, bool value)
+				{
+					const slr_info& info = slr(slr_index);
+					const size_t byte_offset = (bit_offset / 32u) * 4u;
+
+					if (byte_offset >= info.frame_data_size || (info.frame_data_size - byte_offset) < 4u)
+						throw std::out_of_range("frame data slice is out of bounds");
+
+					// Bit (bit_offset % 32) of the (big-endian) word
+					uint8_t& byte = data_[info.frame_data_offset + byte_offset + (3u - (bit_offset / 8u) % 4u)];
+					const uint8_t mask = static_cast<uint8_t>(1u << (bit_offset % 8u));
+
+					byte = value ? static_cast<uint8_t>(byte | mask) : static_cast<uint8_t>(byte & ~mask);
+				}
+
+				/**
+				* @brief Overwrites a range of frame data words (cf. @ref frame_sink).
+				*
+				* @param[in] slr_index specifies the index of the (sub-)bitstream (aka. SLR in configuration
+				*   order) to be accessed.
+				*
+				* @param[in] first_word specifies the index of the first word to be written.
+				*
+				* @param[in] words specifies the frame data words (in native byte order).
+				*/
+				void write_frame_words(unsigned slr_index, size_t first_word, std::span<const uint32_t> words);
+
 				/**
 				* @brief Gets the device IDCODE that was parsed from the bitstream's configuration
 				*  packets.
@@ -6,6 +6,11 @@
 #define UNBIT_OLD_XILINX_BRAM_HPP_ 1
 
 #include "common.hpp"
+#include "frame_source.hpp"
+
+#include <array>
+#include <span>
+#include <utility>
 
 namespace unbit
 {
@@ -97,13 +102,18 @@ namespace unbit
 				*
 				* @param[in] slr specifies the zero-based index of the SLR bitstream of this RAM.
 				*/
-				bram(unsigned x, unsigned y, size_t num_words, size_t data_bits, size_t parity_bits,
-					bram_category category, size_t bitstream_offset, unsigned slr);
+				constexpr bram(unsigned x, unsigned y, size_t num_words, size_t data_bits,
+							size_t parity_bits, bram_category category, size_t bitstream_offset,
+							unsigned slr)
+					: slr_(slr), x_(x), y_(y), num_words_(num_words), data_bits_(data_bits),
+					parity_bits_(parity_bits), category_(category), bitstream_offset_(bitstream_offset)
+				{
+				}
 
 				/**
 				* @brief Diposes a block RAM descriptor
 				*/
-				virtual ~bram() = 0;
+				constexpr virtual ~bram() = 0;
 
 			public:
 				/**
@@ -129,21 +139,60 @@ namespace unbit
 				virtual size_t map_to_bitstream(size_t bit_addr, bool is_parity) const = 0;
 
 				/**
-				* @brief Extracts data or parity bits of this block RAM from a bitstream.
+				* @brief Maps a range of consecutive RAM data (or parity) bit locations to the bitstream.
+				*
+				* @param[in] first_bit is the address of the first (data or parity) bit to be mapped.
+				*
+				* @param[in] is_parity indicates whether data bits (false) or parity bits (true) are to be
+				*  mapped.
+				*
+				* @param[out] offsets receives the bitstream offsets of the bits first_bit,
+				*  first_bit + 1, ... (one per element, cf. @ref map_to_bitstream).
+				*
+				* @note The default implementation calls @ref map_to_bitstream for each bit. The RAM
+				*  primitives override this method to map a whole range with a single virtual call.
+				*/
+				virtual void map_range_to_bitstream(size_t first_bit, bool is_parity,
+												std::span<size_t> offsets) const;
+
+				/**
+				* @brief Number of bits mapped per call to @ref map_range_to_bitstream by the extraction
+				*  and injection algorithms.
+				*/
+				static constexpr size_t map_chunk_bits = 256u;
+
+				/**
+				* @brief Gets the range of frame data words holding the data (or parity) bits of this RAM.
 				*
-				* @param[in]  bits specifies the source bitstream.
+				* The extraction and injection algorithms access this range with a single bulk read
+				* (and write) instead of one access per bit (e.g. one cache lookup per bit on compressed
+				* frame sources).
+				*
+				* @param[in] is_parity indicates whether the data bits (false) or the parity bits (true)
+				*  are considered.
+				*
+				* @return The index of the first word (relative to the SLR's frame data) and the number
+				*  of words of the range.
+				*/
+				std::pair<size_t, size_t> map_word_range(bool is_parity) const;
+
+				/**
+				* @brief Extracts data or parity bits of this block RAM from a frame source.
+				*
+				* @param[in] src specifies the source frame data (e.g. a bitstream).
 				*
 				* @param[in] extract_parity indicates whether data (false) or parity (true) data shall
 				*  be extracted.
 				*
 				* @return A fresh byte vector containing the extracted data bits.
 				*/
-				std::vector<uint8_t> extract(const bitstream& bits, bool extract_parity) const;
+				template<frame_source Source>
+				std::vector<uint8_t> extract(const Source& src, bool extract_parity) const;
 
 				/**
-				* @brief Extracts a single data or parity of this block RAM from a bitstream.
+				* @brief Extracts a single data or parity of this block RAM from a frame source.
 				*
-				* @param[in] bits specifies the source bitstream.
+				* @param[in] src specifies the source frame data (e.g. a bitstream).
 				*
 				* @param[in] offset is the bit offset into the data (or parity) space of the RAM.
 				*
@@ -152,24 +201,26 @@ namespace unbit
 				*
 				* @return The bit value of the extracted bit.
 				*/
-				bool extract_bit(const bitstream& bits, size_t offset, bool extract_parity) const;
+				template<frame_source Source>
+				bool extract_bit(const Source& src, size_t offset, bool extract_parity) const;
 
 				/**
-				* @brief Injects data or parity bits for this block RAM into a bitstream.
+				* @brief Injects data or parity bits for this block RAM into a frame sink.
 				*
-				* @param[in,out] bits specifies the target bitstream.
+				* @param[in,out] dst specifies the target frame data (e.g. a bitstream).
 				*
 				* @param[in] inject_parity indicates whether data (false) or parity (true) data shall
 				*  be injected.
 				*
 				* @param[in] data specifies the byte vector to be injected.
 				*/
-				void inject(bitstream& bits, bool inject_parity, const std::vector<uint8_t>& data) const;
+				template<frame_sink Sink>
+				void inject(Sink& dst, bool inject_parity, const std::vector<uint8_t>& data) const;
 
 				/**
-				* @brief Injects a single data or parity bits of this block RAM into a bitstream.
+				* @brief Injects a single data or parity bits of this block RAM into a frame sink.
 				*
-				* @param[in,out] bits specifies the target bitstream.
+				* @param[in,out] dst specifies the target frame data (e.g. a bitstream).
 				*
 				* @param[in] offset is the bit offset into the data (or parity) space of the RAM.
 				*
@@ -178,12 +229,13 @@ namespace unbit
 				*
 				* @param[in] value specifies the bit valueto be injected.
 				*/
-				void inject_bit(bitstream& bits, size_t offset, bool inject_parity, bool value) const;
+				template<frame_sink Sink>
+				void inject_bit(Sink& dst, size_t offset, bool inject_parity, bool value) const;
 
 				/**
 				* @brief Gets the SLR index of this RAM tile.
 				*/
-				inline unsigned slr() const
+				constexpr unsigned slr() const
 				{
 					return slr_;
 				}
@@ -191,7 +243,7 @@ namespace unbit
 				/**
 				* @brief Gets the X location of this RAM tile.
 				*/
-				inline unsigned x() const
+				constexpr unsigned x() const
 				{
 					return x_;
 				}
@@ -199,7 +251,7 @@ namespace unbit
 				/**
 				* @brief Gets the Y location of this RAM tile.
 				*/
-				inline unsigned y() const
+				constexpr unsigned y() const
 				{
 					return y_;
 				}
@@ -207,7 +259,7 @@ namespace unbit
 				/**
 				* @brief Gets the number of words of this RAM tile.
 				*/
-				inline size_t num_words() const
+				constexpr size_t num_words() const
 				{
 					return num_words_;
 				}
@@ -215,7 +267,7 @@ namespace unbit
 				/**
 				* @brief Gets the number of data bits per RAM word.
 				*/
-				inline size_t data_bits() const
+				constexpr size_t data_bits() const
 				{
 					return data_bits_;
 				}
@@ -223,7 +275,7 @@ namespace unbit
 				/**
 				* @brief Gets the number of parity bits per RAM word.
 				*/
-				inline size_t parity_bits() const
+				constexpr size_t parity_bits() const
 				{
 					return parity_bits_;
 				}
@@ -231,7 +283,7 @@ namespace unbit
 				/**
 				* @brief Gets the category of this RAM.
 				*/
-				inline bram_category category() const
+				constexpr bram_category category() const
 				{
 					return category_;
 				}
@@ -242,7 +294,7 @@ namespace unbit
 				*
 				* @note The returned value is given relative to the SLR's data frame.
 				*/
-				inline size_t bitstream_offset() const
+				constexpr size_t bitstream_offset() const
 				{
 					return bitstream_offset_;
 				}
@@ -265,6 +317,107 @@ namespace unbit
 				bram& operator=(const bram&) = delete;
 			};
 
+			//------------------------------------------------------------------------------------------
+			constexpr bram::~bram()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			template<frame_source Source>
+			std::vector<uint8_t> bram::extract(const Source& src, bool extract_parity) const
+			{
+				// Determine the length (in bits)
+				const size_t bit_length = (extract_parity ? parity_bits_ : data_bits_) * num_words_;
+				const size_t byte_length = (bit_length + 7u) / 8u;
+
+				// Prepare the result array
+				std::vector<uint8_t> extracted(byte_length);
+
+				// Read the frame data words of this RAM at once
+				const auto [first_word, num_words] = map_word_range(extract_parity);
+				std::vector<uint32_t> words(num_words);
+				src.read_frame_words(slr_, first_word, std::span<uint32_t>(words));
+
+				// Extract data (bit-wise, the bitstream locations are mapped chunk by chunk)
+				const size_t base_bit = first_word * 32u;
+				std::array<size_t, map_chunk_bits> src_bits;
+
+				for (size_t first = 0u; first < bit_length; first += map_chunk_bits)
+				{
+					const size_t count = std::min(map_chunk_bits, bit_length - first);
+					map_range_to_bitstream(first, extract_parity, std::span<size_t>(src_bits.data(), count));
+
+					for (size_t k = 0u; k < count; ++k)
+					{
+						const size_t i = first + k;
+						const size_t bit = src_bits[k] - base_bit;
+
+						// Extract the source value and update the extracted byte array
+						if ((words[bit / 32u] >> (bit % 32u)) & 1u)
+							extracted[i / 8u] |= static_cast<uint8_t>(1u << (i % 8u));
+					}
+				}
+
+				// Done
+				return extracted;
+			}
+
+			//------------------------------------------------------------------------------------------
+			template<frame_source Source>
+			bool bram::extract_bit(const Source& src, size_t offset, bool extract_parity) const
+			{
+				return read_frame_bit(src, slr_, map_to_bitstream(offset, extract_parity));
+			}
+
+			//------------------------------------------------------------------------------------------
+			template<frame_sink Sink>
+			void bram::inject(Sink& dst, bool inject_parity, const std::vector<uint8_t>& data) const
+			{
+				// Determine the length (in bits)
+				const size_t bit_length = (inject_parity ? parity_bits_ : data_bits_) * num_words_;
+				const size_t byte_length = (bit_length + 7u) / 8u;
+
+				if (data.size() != byte_length)
+					throw std::invalid_argument("size of data to be injected does not match"
+												" block ram size");
+
+				// Read-modify-write of the frame data words of this RAM
+				const auto [first_word, num_words] = map_word_range(inject_parity);
+				std::vector<uint32_t> words(num_words);
+				dst.read_frame_words(slr_, first_word, std::span<uint32_t>(words));
+
+				// Inject data (bit-wise, the bitstream locations are mapped chunk by chunk)
+				const size_t base_bit = first_word * 32u;
+				std::array<size_t, map_chunk_bits> dst_bits;
+
+				for (size_t first = 0u; first < bit_length; first += map_chunk_bits)
+				{
+					const size_t count = std::min(map_chunk_bits, bit_length - first);
+					map_range_to_bitstream(first, inject_parity, std::span<size_t>(dst_bits.data(), count));
+
+					for (size_t k = 0u; k < count; ++k)
+					{
+						const size_t i = first + k;
+						const size_t bit = dst_bits[k] - base_bit;
+						const uint32_t mask = static_cast<uint32_t>(1u) << (bit % 32u);
+
+						if ((data[i / 8u] >> (i % 8u)) & 1u)
+							words[bit / 32u] |= mask;
+						else
+							words[bit / 32u] &= ~mask;
+					}
+				}
+
+				dst.write_frame_words(slr_, first_word, std::span<const uint32_t>(words));
+			}
+
+			//------------------------------------------------------------------------------------------
+			template<frame_sink Sink>
+			void bram::inject_bit(Sink& dst, size_t offset, bool inject_parity, bool value) const
+			{
+				dst.write_frame_bit(slr_, map_to_bitstream(offset, inject_parity), value);
+			}
+
 			//------------------------------------------------------------------------------------------
 			/**
 			* @brief Prints the type and location of a RAM.
@@ -296,6 +449,9 @@ namespace unbit
 				const std::string& primitive() const override;
 
 				size_t map_to_bitstream(size_t bit_addr, bool is_parity) const override;
+
+				void map_range_to_bitstream(size_t first_bit, bool is_parity,
+										std::span<size_t> offsets) const override;
 			};
 
 			//------------------------------------------------------------------------------------------
@@ -308,17 +464,25 @@ namespace unbit
 				/**
 				* @brief Construct a RAMB36E2 block RAM tile.
 				*/
-				ramb36e2(unsigned x, unsigned y, size_t bitstream_offset, unsigned slr = 0u);
+				constexpr ramb36e2(unsigned x, unsigned y, size_t bitstream_offset, unsigned slr = 0u)
+					: bram(x, y, 1024u, 32u, 4u, bram_category::ramb36, bitstream_offset, slr)
+				{
+				}
 
 				/**
-				* @brief Disposes a RAMB36E1 block RAM tile.
+				* @brief Disposes a RAMB36E2 block RAM tile.
 				*/
-				~ramb36e2();
+				constexpr ~ramb36e2() override
+				{
+				}
 
 			public:
 				const std::string& primitive() const override;
 
 				size_t map_to_bitstream(size_t bit_addr, bool is_parity) const override;
+
+				void map_range_to_bitstream(size_t first_bit, bool is_parity,
+										std::span<size_t> offsets) const override;
 			};
 
 
@@ -354,6 +518,52 @@ namespace unbit
 				const std::string& primitive() const override;
 
 				size_t map_to_bitstream(size_t bit_addr, bool is_parity) const override;
+
+				void map_range_to_bitstream(size_t first_bit, bool is_parity,
+										std::span<size_t> offsets) const override;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			* @brief Description of a RAMB18E2 block RAM tile (found on Virtex UltraScale+)
+			*
+			* RAMB18E2 tiles are the bottom (even Y) and top (odd Y) halves of a RAMB36E2 tile. Both
+			* halves share the configuration bits of the enclosing tile; the constructor is
+			* constexpr so that device tables of the halves can be derived at compile time.
+			*/
+			class ramb18e2 final : public bram
+			{
+			private:
+				/**
+				* @brief Indicates if this is the top (true) or bottom (false) half.
+				*/
+				bool is_top_;
+
+			public:
+				/**
+				* @brief Construct a RAMB18E2 block RAM tile (a half of a RAMB36E2 tile).
+				*/
+				constexpr ramb18e2(const ramb36e2& ramb36, bool is_top)
+					: bram(ramb36.x(), 2u * ramb36.y() + (is_top ? 1u : 0u), 1024u, 16u, 2u,
+						bram_category::ramb18, ramb36.bitstream_offset(), ramb36.slr()),
+					is_top_(is_top)
+				{
+				}
+
+				/**
+				* @brief Disposes a RAMB18E2 block RAM tile.
+				*/
+				constexpr ~ramb18e2() override
+				{
+				}
+
+			public:
+				const std::string& primitive() const override;
+
+				size_t map_to_bitstream(size_t bit_addr, bool is_parity) const override;
+
+				void map_range_to_bitstream(size_t first_bit, bool is_parity,
+										std::span<size_t> offsets) const override;
 			};
 		}
 	}
@@ -0,0 +1,211 @@
+/**
+ * @file
+ * @brief Frame sources (configuration frame data access for block RAM and memory map algorithms)
+ */
+#ifndef UNBIT_OLD_XILINX_FRAME_SOURCE_HPP_
+#define UNBIT_OLD_XILINX_FRAME_SOURCE_HPP_ 1
+
+#include "common.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <span>
+#include <type_traits>
+
+namespace unbit
+{
+	namespace old
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			* @brief Source of configuration frame data.
+			*
+			* A frame source provides the frame data of each SLR as a sequence of 32-bit words (in
+			* native byte order). Bit offsets are linear bit offsets relative to the start of an
+			* SLR's frame data; bit (offset % 32) of the word containing the offset is the addressed
+			* bit (this matches the byte-swapped view of @ref bitstream::read_frame_data_bit).
+			*
+			* - @c frame_data_words(slr) gets the number of frame data words of an SLR.
+			* - @c read_frame_word(slr, bit_offset) gets the word containing a bit.
+			* - @c read_frame_words(slr, first_word, words) copies a range of words (bulk access).
+			*
+			* Accesses outside the frame data throw a @c std::out_of_range exception.
+			*
+			* The block RAM and memory map algorithms (@ref bram::extract, @ref mmi::memory_map::read_region,
+			* ...) are templates over frame sources; each source type gets its own (inlined)
+			* instantiation. Sources include @ref bitstream (configuration and readback data),
+			* @ref basic_word_frames (frame stores, memory-mapped images, readback buffers) and
+			* @c unbit::fpga::xilinx::compressed_frame_store (compressed resident images).
+			*/
+			template<typename Source>
+			concept frame_source = requires(const Source& src, unsigned slr, size_t offset, std::span<uint32_t> words)
+			{
+				{ src.frame_data_words(slr) } -> std::convertible_to<size_t>;
+				{ src.read_frame_word(slr, offset) } -> std::convertible_to<uint32_t>;
+				src.read_frame_words(slr, offset, words);
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			* @brief Writable source of configuration frame data.
+			*
+			* - @c write_frame_bit(slr, bit_offset, value) writes a bit.
+			* - @c write_frame_words(slr, first_word, words) overwrites a range of words (bulk access).
+			*/
+			template<typename Sink>
+			concept frame_sink = frame_source<Sink> &&
+				requires(Sink& snk, unsigned slr, size_t offset, bool value, std::span<const uint32_t> words)
+			{
+				snk.write_frame_bit(slr, offset, value);
+				snk.write_frame_words(slr, offset, words);
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			* @brief Reads a bit from a frame source.
+			*
+			* @param[in] src is the frame source.
+			* @param[in] slr is the zero-based index of the SLR (in configuration order).
+			* @param[in] bit_offset is the bit offset relative to the start of the SLR's frame data.
+			*/
+			template<frame_source Source>
+			inline bool read_frame_bit(const Source& src, unsigned slr, size_t bit_offset)
+			{
+				return static_cast<bool>((src.read_frame_word(slr, bit_offset) >> (bit_offset % 32u)) & 1u);
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			* @brief Frame source over per-SLR spans of frame data words (in native byte order).
+			*
+			* The spans are referenced, not copied (e.g. the frames of a frame store, a memory-mapped
+			* frame image or a readback buffer). Spans of non-const words make the source writable
+			* (@ref frame_sink).
+			*/
+			template<typename Word>
+			class basic_word_frames
+			{
+				static_assert(std::is_same_v<std::remove_const_t<Word>, uint32_t>,
+							"frame data words must be 32-bit words");
+
+			private:
+				/**
+				* @brief Frame data words of the SLRs (in configuration order).
+				*/
+				std::vector<std::span<Word>> slrs_;
+
+			public:
+				/**
+				* @brief Constructs a frame source over the given frame data spans.
+				*/
+				explicit basic_word_frames(std::vector<std::span<Word>> slrs)
+					: slrs_(std::move(slrs))
+				{
+				}
+
+				/**
+				* @brief Constructs a frame source over the SLRs of a frame container.
+				*
+				* @param[in] store is the frame container (e.g. a frame store); it must provide
+				*   @c num_slrs() and @c words(slr) (returning the frame data words of an SLR).
+				*/
+				template<typename Store>
+				static basic_word_frames of(Store& store)
+				{
+					std::vector<std::span<Word>> slrs;
+					slrs.reserve(store.num_slrs());
+
+					for (size_t k = 0u; k < store.num_slrs(); ++k)
+						slrs.push_back(store.words(k));
+
+					return basic_word_frames(std::move(slrs));
+				}
+
+				/**
+				* @brief Gets the number of SLRs.
+				*/
+				inline size_t num_slrs() const
+				{
+					return slrs_.size();
+				}
+
+				/**
+				* @brief Gets the number of frame data words of an SLR.
+				*/
+				inline size_t frame_data_words(unsigned slr) const
+				{
+					return slrs_.at(slr).size();
+				}
+
+				/**
+				* @brief Gets the frame data word containing a bit.
+				*/
+				inline uint32_t read_frame_word(unsigned slr, size_t bit_offset) const
+				{
+					const auto& words = slrs_.at(slr);
+
+					if ((bit_offset / 32u) >= words.size())
+						throw std::out_of_range("frame data slice is out of bounds");
+
+					return words[bit_offset / 32u];
+				}
+
+				/**
+				* @brief Copies a range of frame data words.
+				*/
+				inline void read_frame_words(unsigned slr, size_t first_word, std::span<uint32_t> words) const
+				{
+					const auto& src = slrs_.at(slr);
+
+					if (first_word > src.size() || (src.size() - first_word) < words.size())
+						throw std::out_of_range("frame data slice is out of bounds");
+
+					std::copy_n(src.begin() + first_word, words.size(), words.begin());
+				}
+
+				/**
+				* @brief Writes a bit (writable sources only).
+				*/
+				inline void write_frame_bit(unsigned slr, size_t bit_offset, bool value)
+					requires (!std::is_const_v<Word>)
+				{
+					auto& words = slrs_.at(slr);
+
+					if ((bit_offset / 32u) >= words.size())
+						throw std::out_of_range("frame data slice is out of bounds");
+
+					const uint32_t mask = static_cast<uint32_t>(1u) << (bit_offset % 32u);
+					words[bit_offset / 32u] = value ? (words[bit_offset / 32u] | mask) : (words[bit_offset / 32u] & ~mask);
+				}
+
+				/**
+				* @brief Overwrites a range of frame data words (writable sources only).
+				*/
+				inline void write_frame_words(unsigned slr, size_t first_word, std::span<const uint32_t> words)
+					requires (!std::is_const_v<Word>)
+				{
+					auto& dst = slrs_.at(slr);
+
+					if (first_word > dst.size() || (dst.size() - first_word) < words.size())
+						throw std::out_of_range("frame data slice is out of bounds");
+
+					std::copy(words.begin(), words.end(), dst.begin() + first_word);
+				}
+			};
+
+			/**
+			* @brief Read-only frame source over frame data words.
+			*/
+			typedef basic_word_frames<const uint32_t> const_word_frames;
+
+			/**
+			* @brief Writable frame source over frame data words.
+			*/
+			typedef basic_word_frames<uint32_t> word_frames;
+		}
+	}
+}
+
+#endif // UNBIT_OLD_XILINX_FRAME_SOURCE_HPP_
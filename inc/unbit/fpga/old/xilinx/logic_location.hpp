@@ -0,0 +1,313 @@
+/**
+ * @file
+ * @brief Support for Xilinx logic location files (LUT INIT extraction and injection).
+ */
+#ifndef UNBIT_OLD_XILINX_LOGIC_LOCATION_HPP_
+#define UNBIT_OLD_XILINX_LOGIC_LOCATION_HPP_ 1
+
+#include "common.hpp"
+#include "fpga.hpp"
+#include "frame_source.hpp"
+
+#include <array>
+#include <istream>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace unbit
+{
+	namespace old
+	{
+		namespace xilinx
+		{
+			/**
+			* @brief Bit index of a logic location file (as written by write_bitstream -logic_location_file).
+			*
+			* Logic location files list the bitstream location of memory cells, one "Bit" line per cell:
+			*
+			*  > Bit <offset> <frame address> <frame offset> Block=<site> [Ram=<id>:<bit> | Rom=<id>:<bit>] ...
+			*
+			* The bit offset is relative to the start of the frame data (the same offsets that are used
+			* for block RAMs). This index keeps the LUT cells of the file, i.e. the Ram/Rom bits of
+			* SLICE sites, named "<site>/<id>" (e.g. "SLICE_X12Y34/A"). Bit @c n of a cell is bit @c n
+			* of the LUT's INIT value.
+			*/
+			class logic_location
+			{
+			public:
+				/**
+				* @brief Number of INIT bits of a LUT.
+				*/
+				static constexpr size_t lut_bits = 64u;
+
+				/**
+				* @brief LUT cell (INIT bit locations of a LUT).
+				*/
+				struct lut_cell
+				{
+					/** @brief Name of the LUT ("<site>/<id>") */
+					std::string name;
+
+					/** @brief Bit offsets (relative to the start of the frame data) of the INIT bits */
+					std::array<size_t, lut_bits> bits;
+
+					/** @brief Mask of the INIT bits that are listed in the file */
+					uint64_t mask = 0u;
+				};
+
+			private:
+				/**
+				* @brief LUT cells (in order of appearance).
+				*/
+				std::vector<lut_cell> luts_;
+
+				/**
+				* @brief Index of the LUT cells by name.
+				*/
+				std::unordered_map<std::string, size_t> index_;
+
+				/**
+				* @brief SLR of the frame data that is described by the file.
+				*/
+				unsigned slr_;
+
+			public:
+				/**
+				* @brief Constructs an empty index.
+				*/
+				explicit logic_location(unsigned slr = 0u);
+
+				/**
+				* @brief Gets the SLR of the frame data that is described by this index.
+				*/
+				inline unsigned slr() const
+				{
+					return slr_;
+				}
+
+				/**
+				* @brief Gets the number of LUT cells.
+				*/
+				inline size_t num_luts() const
+				{
+					return luts_.size();
+				}
+
+				/**
+				* @brief Gets a LUT cell.
+				*
+				* @param[in] index is the zero based index of the LUT cell.
+				*/
+				inline const lut_cell& lut(size_t index) const
+				{
+					return luts_.at(index);
+				}
+
+				/**
+				* @brief Finds a LUT cell by name.
+				*
+				* @param[in] name is the name of the LUT cell ("<site>/<id>").
+				*
+				* @return The zero based index of the LUT cell.
+				*
+				* @throws std::invalid_argument if the LUT cell is not listed in the file.
+				*/
+				size_t find_lut(const std::string& name) const;
+
+				/**
+				* @brief Adds the INIT bit location of a LUT cell.
+				*
+				* @param[in] name is the name of the LUT cell ("<site>/<id>").
+				* @param[in] init_bit is the index of the INIT bit.
+				* @param[in] bit_offset is the bit offset (relative to the start of the frame data).
+				*/
+				void add_lut_bit(const std::string& name, size_t init_bit, size_t bit_offset);
+
+				/**
+				* @brief Loads the LUT cells of a logic location file.
+				*
+				* @param[in] filename specifies the file name (path) of the logic location file.
+				* @param[in] slr specifies the SLR of the frame data that is described by the file.
+				*
+				* @throws std::runtime_error if the file cannot be read or contains malformed Bit lines.
+				*/
+				static logic_location load(const std::string& filename, unsigned slr = 0u);
+
+				/**
+				* @brief Parses the LUT cells of a logic location file (given as stream).
+				*/
+				static logic_location parse(std::istream& stm, unsigned slr = 0u);
+			};
+
+			/**
+			* @brief Frame-grouped plan for reading and writing the INIT values of a set of LUTs.
+			*
+			* The INIT bits of all LUTs are grouped by configuration frame: @ref read and @ref write
+			* visit each affected frame once, transferring it as a whole (one read, and one write for
+			* patches).
+			*/
+			class lut_init_plan
+			{
+			private:
+				/**
+				* @brief INIT bit in a frame.
+				*/
+				struct bit_request
+				{
+					/** @brief Bit offset relative to the start of the frame */
+					uint32_t frame_bit;
+
+					/** @brief Index of the LUT (in plan order) */
+					uint32_t lut;
+
+					/** @brief Index of the INIT bit */
+					uint32_t init_bit;
+				};
+
+				/**
+				* @brief INIT bits of a frame.
+				*/
+				struct frame_group
+				{
+					/** @brief Index of the frame (relative to the start of the SLR's frame data) */
+					size_t frame;
+
+					/** @brief INIT bits in this frame */
+					std::vector<bit_request> bits;
+				};
+
+				/**
+				* @brief SLR of the frames.
+				*/
+				unsigned slr_;
+
+				/**
+				* @brief Size of a frame (in 32-bit words).
+				*/
+				size_t frame_words_;
+
+				/**
+				* @brief Masks of the planned INIT bits (one per LUT).
+				*/
+				std::vector<uint64_t> masks_;
+
+				/**
+				* @brief Affected frames (in increasing frame order).
+				*/
+				std::vector<frame_group> frames_;
+
+			public:
+				/**
+				* @brief Plans the access to the INIT values of a set of LUTs.
+				*
+				* @param[in] fpga is the FPGA type (for the frame geometry).
+				* @param[in] ll is the logic location index.
+				* @param[in] luts are the indices of the LUT cells (cf. @ref logic_location::find_lut).
+				*/
+				lut_init_plan(const fpga& fpga, const logic_location& ll, std::span<const size_t> luts);
+
+				/**
+				* @brief Gets the number of LUTs in this plan.
+				*/
+				inline size_t num_luts() const
+				{
+					return masks_.size();
+				}
+
+				/**
+				* @brief Gets the mask of the INIT bits of a LUT that are covered by this plan.
+				*
+				* @param[in] index is the index of the LUT (in plan order).
+				*/
+				inline uint64_t mask(size_t index) const
+				{
+					return masks_.at(index);
+				}
+
+				/**
+				* @brief Gets the number of frames that are affected by this plan.
+				*/
+				inline size_t num_frames() const
+				{
+					return frames_.size();
+				}
+
+				/**
+				* @brief Reads the INIT values of the planned LUTs.
+				*
+				* @param[in] src is the source frame data (e.g. a bitstream or readback).
+				*
+				* @return The INIT values (in plan order). INIT bits that are not listed in the logic
+				*   location file read as zero.
+				*/
+				template<frame_source Source>
+				std::vector<uint64_t> read(const Source& src) const;
+
+				/**
+				* @brief Writes the INIT values of the planned LUTs.
+				*
+				* @param[in,out] dst is the source/destination frame data (e.g. a bitstream).
+				* @param[in] values are the INIT values (in plan order). INIT bits that are not listed in
+				*   the logic location file are ignored.
+				*
+				* @throws std::invalid_argument if the number of values does not match the plan.
+				*/
+				template<frame_sink Sink>
+				void write(Sink& dst, std::span<const uint64_t> values) const;
+			};
+
+			//------------------------------------------------------------------------------------------
+			template<frame_source Source>
+			std::vector<uint64_t> lut_init_plan::read(const Source& src) const
+			{
+				std::vector<uint64_t> values(masks_.size(), 0u);
+				std::vector<uint32_t> words(frame_words_);
+
+				for (const auto& group : frames_)
+				{
+					src.read_frame_words(slr_, group.frame * frame_words_, std::span<uint32_t>(words));
+
+					for (const auto& req : group.bits)
+					{
+						if ((words[req.frame_bit / 32u] >> (req.frame_bit % 32u)) & 1u)
+							values[req.lut] |= static_cast<uint64_t>(1u) << req.init_bit;
+					}
+				}
+
+				return values;
+			}
+
+			//------------------------------------------------------------------------------------------
+			template<frame_sink Sink>
+			void lut_init_plan::write(Sink& dst, std::span<const uint64_t> values) const
+			{
+				if (values.size() != masks_.size())
+					throw std::invalid_argument("number of INIT values does not match the number of planned LUTs");
+
+				std::vector<uint32_t> words(frame_words_);
+
+				for (const auto& group : frames_)
+				{
+					// Read-modify-write of the complete frame
+					dst.read_frame_words(slr_, group.frame * frame_words_, std::span<uint32_t>(words));
+
+					for (const auto& req : group.bits)
+					{
+						const uint32_t mask = static_cast<uint32_t>(1u) << (req.frame_bit % 32u);
+
+						if ((values[req.lut] >> req.init_bit) & 1u)
+							words[req.frame_bit / 32u] |= mask;
+						else
+							words[req.frame_bit / 32u] &= ~mask;
+					}
+
+					dst.write_frame_words(slr_, group.frame * frame_words_, std::span<const uint32_t>(words));
+				}
+			}
+		}
+	}
+}
+
+#endif // UNBIT_OLD_XILINX_LOGIC_LOCATION_HPP_
@@ -8,9 +8,17 @@
 #include "fpga.hpp"
 #include "bram.hpp"
 #include "bitstream.hpp"
+#include "frame_source.hpp"
 
+#include "unbit/runtime/executor.hpp"
+
+#include <algorithm>
+#include <array>
 #include <memory>
+#include <span>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace unbit
 {
@@ -82,6 +90,11 @@ namespace unbit
 					*/
 					virtual ~memory_map();
 
+					/**
+					* @brief Gets the instance name of the memory map (e.g. the processor's InstPath).
+					*/
+					virtual const std::string& name() const = 0;
+
 					/**
 					* @brief Gets the byte endianness of the memory map.
 					*
@@ -102,63 +115,201 @@ namespace unbit
 					*/
 					virtual const memory_region& region(size_t index) const = 0;
 
+					/**
+					* @brief Location of a bit (in CPU address space) in the underlying block RAMs.
+					*/
+					struct bit_location
+					{
+						/** @brief Block RAM holding the bit */
+						const bram* ram;
+
+						/** @brief Bit offset into the data (or parity) space of the RAM */
+						size_t offset;
+
+						/** @brief Parity (true) or data (false) space of the RAM */
+						bool is_parity;
+					};
+
+					/**
+					* @brief Block RAM (data) lane of a region, as used by @ref read_region.
+					*/
+					struct region_lane
+					{
+						/** @brief Block RAM of this lane */
+						const bram* ram;
+
+						/** @brief LSB bit position of this lane in a word of the region */
+						unsigned lsb;
+
+						/** @brief MSB bit position of this lane in a word of the region */
+						unsigned msb;
+					};
+
+					/**
+					* @brief Extraction plan of a region (address space), as used by @ref read_region.
+					*/
+					struct region_plan
+					{
+						/** @brief Size of the region (in bytes) */
+						size_t num_bytes = 0u;
+
+						/** @brief Word size of the region (in bits) */
+						size_t word_size = 0u;
+
+						/** @brief Number of words in the region */
+						size_t num_words = 0u;
+
+						/** @brief Lanes of the region (lanes that do not own any bit are omitted) */
+						std::vector<region_lane> lanes;
+
+						/** @brief Owning lane (index into @ref lanes) of each bit position of a word */
+						std::vector<size_t> owners;
+					};
+
+					/**
+					* @brief Range of bytes (in CPU address space), as used by @ref read_ranges.
+					*/
+					struct byte_range
+					{
+						/** @brief Start byte address of the range */
+						uint64_t address;
+
+						/** @brief Size of the range (in bytes) */
+						size_t size;
+					};
+
+					/**
+					* @brief Locates a single bit in the underlying block RAMs.
+					*
+					* @param[in] fpga is the FPGA type for block RAM translation.
+					*
+					* @param[in] bit_addr is the address of the bit in CPU address space.
+					*/
+					virtual bit_location locate_bit(const fpga& fpga, uint64_t bit_addr) const = 0;
+
+					/**
+					* @brief Plans the extraction of a complete region (address space).
+					*
+					* @param[in] fpga is the FPGA type for block RAM translation.
+					*
+					* @param[in] index is the zero based index of the region.
+					*/
+					virtual region_plan plan_region(const fpga& fpga, size_t index) const = 0;
+
 					/**
 					* @brief Reads a single bit.
 					*
 					* @param[in] fpga is the FPGA type for block RAM translation.
 					*
-					* @param[in] bs is the source bit stream.
+					* @param[in] src is the source frame data (e.g. a bitstream).
 					*
 					* @param[in] bit_addr is the address of the bit in CPU address space.
 					*/
-					virtual bool read_bit(const fpga& fpga, const bitstream& bs,
-										uint64_t bit_addr) const = 0;
+					template<frame_source Source>
+					bool read_bit(const fpga& fpga, const Source& src, uint64_t bit_addr) const
+					{
+						const bit_location loc = locate_bit(fpga, bit_addr);
+						return loc.ram->extract_bit(src, loc.offset, loc.is_parity);
+					}
 
 					/**
 					* @brief Reads an 8-bit byte.
 					*
 					* @param[in] fpga is the FPGA type for block RAM translation.
 					*
-					* @param[in] bs is the source bit stream.
+					* @param[in] src is the source frame data (e.g. a bitstream).
 					*
 					* @param[in] byte_addr is the byte address in CPU address space.
-					*
-					* @note The default implementation of this method delegates to @ref read_bit
-					*   for bit-level access.
 					*/
-					virtual uint8_t read_byte(const fpga& fpga, const bitstream& bs,
-											uint64_t byte_addr) const;
+					template<frame_source Source>
+					uint8_t read_byte(const fpga& fpga, const Source& src, uint64_t byte_addr) const
+					{
+						uint8_t value = 0u;
+						for (size_t i = 0u; i < 8u; ++i)
+						{
+							value |= static_cast<uint8_t>(read_bit(fpga, src, byte_addr * 8u + i)) << i;
+						}
+
+						return value;
+					}
 
 					/**
 					* @brief Writes a single bit.
 					*
-					* @param[in] fpga is the FPGA type for block RAM translation.
+					* @param[in,out] dst is the source/destination frame data (e.g. a bitstream).
 					*
-					* @param[in,out] bs is the source/destination bit stream.
+					* @param[in] fpga is the FPGA type for block RAM translation.
 					*
 					* @param[in] bit_addr is the address of the bit in CPU address space.
 					*
 					* @param[in] value is the bit value to be written.
 					*/
-					virtual void write_bit(bitstream& bs, const fpga& fpga,
-										uint64_t bit_addr, bool value) const = 0;
+					template<frame_sink Sink>
+					void write_bit(Sink& dst, const fpga& fpga, uint64_t bit_addr, bool value) const
+					{
+						const bit_location loc = locate_bit(fpga, bit_addr);
+						loc.ram->inject_bit(dst, loc.offset, loc.is_parity, value);
+					}
 
 					/**
 					* @brief Writes an 8-bit byte.
 					*
-					* @param[in,out] bs is the source/destination bit stream.
+					* @param[in,out] dst is the source/destination frame data (e.g. a bitstream).
 					*
 					* @param[in] fpga is the FPGA type for block RAM translation.
 					*
 					* @param[in] byte_addr is the byte address in CPU address space.
 					*
 					* @param[in] value is the byte value to be written
+					*/
+					template<frame_sink Sink>
+					void write_byte(Sink& dst, const fpga& fpga, uint64_t byte_addr, uint8_t value) const
+					{
+						for (size_t i = 0u; i < 8u; ++i)
+						{
+							const bool bit_value = !!((value >> i) & 1u);
+							write_bit(dst, fpga, byte_addr * 8u + i, bit_value);
+						}
+					}
+
+					/**
+					* @brief Reads a complete region (address space).
+					*
+					* @param[in] fpga is the FPGA type for block RAM translation.
+					*
+					* @param[in] src is the source frame data (e.g. a bitstream).
+					*
+					* @param[in] index is the zero based index of the region.
+					*
+					* @return The bytes of the region (in increasing address order).
+					*
+					* @note Each block RAM of the region is extracted once (cf. @ref plan_region), its bits
+					*   are then scattered into the region.
+					*/
+					template<frame_source Source>
+					std::vector<uint8_t> read_region(const fpga& fpga, const Source& src, size_t index) const;
+
+					/**
+					* @brief Reads a batch of byte ranges (e.g. the variables named by a symbol table).
+					*
+					* @param[in] fpga is the FPGA type for block RAM translation.
+					*
+					* @param[in] src is the source frame data (e.g. a bitstream).
+					*
+					* @param[in] ranges are the byte ranges to be read (ranges may overlap and may span
+					*   multiple regions).
+					*
+					* @return The bytes of each range (in the order of @p ranges).
 					*
-					* @note The default implementation of this method delegates to @ref write_bit
-					*   for bit-level access.
+					* @throws std::out_of_range if a range is not covered by the regions of the map.
+					*
+					* @note The ranges are mapped through the region plans (cf. @ref plan_region) and the
+					*   requested bits are grouped by block RAM. Each block RAM is visited once (densely
+					*   used block RAMs are extracted as a whole), block RAMs are read in parallel.
 					*/
-					virtual void write_byte(bitstream& bs, const fpga& fpga,
-											uint64_t byte_addr, uint8_t value) const;
+					template<frame_source Source>
+					std::vector<std::vector<uint8_t>> read_ranges(const fpga& fpga, const Source& src,
+																	std::span<const byte_range> ranges) const;
 
 				public:
 					/**
@@ -176,11 +327,364 @@ namespace unbit
 					*/
 					static std::unique_ptr<memory_map> load(const std::string& filename, const std::string& instance);
 
+					/**
+					* @brief Loads the memory maps of all processor instances of a given file.
+					*
+					* @param[in] filename specifies the file name (path) of the MMI file to be loaded.
+					*
+					* @return The memory maps (in file order). The file is parsed once for all instances.
+					*
+					* @throws std::runtime_error if parsing of the XML document fails (e.g. file not found)
+					*/
+					static std::vector<std::unique_ptr<memory_map>> load_all(const std::string& filename);
+
 				protected:
 					// Non-copyable
 					memory_map(const memory_map& other) =delete;
 					memory_map& operator= (const memory_map& other) =delete;
 				};
+
+				/**
+				* @brief Merged write plan for the block RAMs of one or more memory maps.
+				*
+				* Images are added for any number of memory maps (e.g. all processors of a multi-core
+				* design). Their bits are mapped through the region plans of the maps (cf. @ref
+				* memory_map::plan_region) and merged per block RAM, later writes to the same bit replace
+				* earlier ones. @ref apply then visits each affected block RAM once, mapping the written
+				* bits chunk by chunk (cf. @ref bram::map_range_to_bitstream).
+				*
+				* @note Block RAMs of different lanes are assumed not to alias each other (e.g. a RAMB18
+				*   half and its enclosing RAMB36 tile), as is the case for implemented designs.
+				*/
+				class bram_write_plan
+				{
+				private:
+					/**
+					* @brief Planned writes to a block RAM.
+					*/
+					struct ram_writes
+					{
+						/** @brief Block RAM to be written */
+						const bram* ram;
+
+						/** @brief Values of the written data bits (one bit per RAM data bit) */
+						std::vector<uint8_t> data;
+
+						/** @brief Mask of the written data bits (one bit per RAM data bit) */
+						std::vector<uint8_t> mask;
+					};
+
+					/**
+					* @brief FPGA type for block RAM translation.
+					*/
+					const fpga& fpga_;
+
+					/**
+					* @brief Region plans of the memory maps (planned on first use).
+					*/
+					std::unordered_map<const memory_map*, std::vector<memory_map::region_plan>> plans_;
+
+					/**
+					* @brief Index of the planned block RAMs (into @ref rams_).
+					*/
+					std::unordered_map<const bram*, size_t> ram_index_;
+
+					/**
+					* @brief Planned block RAMs (in order of first use).
+					*/
+					std::vector<ram_writes> rams_;
+
+					/**
+					* @brief Number of distinct bits to be written.
+					*/
+					size_t num_bits_ = 0u;
+
+				public:
+					/**
+					* @brief Constructs an empty write plan.
+					*
+					* @param[in] fpga is the FPGA type for block RAM translation.
+					*/
+					explicit bram_write_plan(const fpga& fpga);
+
+					/**
+					* @brief Adds a range of bytes to be written through a memory map.
+					*
+					* @param[in] map is the memory map (must outlive the plan).
+					*
+					* @param[in] address is the start byte address (in CPU address space).
+					*
+					* @param[in] data are the bytes to be written.
+					*
+					* @throws std::out_of_range if a byte is not covered by the regions of the map.
+					*/
+					void add(const memory_map& map, uint64_t address, std::span<const uint8_t> data);
+
+					/**
+					* @brief Gets the number of block RAMs affected by this plan.
+					*/
+					inline size_t num_brams() const
+					{
+						return rams_.size();
+					}
+
+					/**
+					* @brief Gets the number of distinct bits written by this plan.
+					*/
+					inline size_t num_bits() const
+					{
+						return num_bits_;
+					}
+
+					/**
+					* @brief Applies the plan.
+					*
+					* @param[in,out] dst is the destination frame data (e.g. a bitstream).
+					*/
+					template<frame_sink Sink>
+					void apply(Sink& dst) const;
+
+				private:
+					/**
+					* @brief Gets the (lazily planned) region plans of a memory map.
+					*/
+					const std::vector<memory_map::region_plan>& plans_of(const memory_map& map);
+				};
+
+				//-------------------------------------------------------------------------------------
+				template<frame_source Source>
+				std::vector<uint8_t> memory_map::read_region(const fpga& fpga, const Source& src,
+															size_t index) const
+				{
+					const region_plan plan = plan_region(fpga, index);
+
+					std::vector<uint8_t> data(plan.num_bytes);
+
+					// Extract each block RAM once, then scatter its bits into the region
+					for (size_t l = 0u; l < plan.lanes.size(); ++l)
+					{
+						const auto& lane = plan.lanes[l];
+
+						const auto bram_data = lane.ram->extract(src, false);
+						const size_t bram_bits = bram_data.size() * 8u;
+
+						const unsigned lane_word_size = lane.msb - lane.lsb + 1u;
+
+						for (size_t w = 0u; w < plan.num_words; ++w)
+						{
+							for (unsigned b = lane.lsb; b <= lane.msb; ++b)
+							{
+								if (plan.owners[b] != l)
+									continue;
+
+								const size_t bram_bit_offset = w * lane_word_size + (b - lane.lsb);
+								if (bram_bit_offset >= bram_bits)
+								{
+									throw std::out_of_range("bit address to be mapped is out of bounds");
+								}
+
+								if ((bram_data[bram_bit_offset / 8u] >> (bram_bit_offset % 8u)) & 1u)
+								{
+									const size_t region_bit = w * plan.word_size + b;
+									data[region_bit / 8u] |= static_cast<uint8_t>(1u << (region_bit % 8u));
+								}
+							}
+						}
+					}
+
+					return data;
+				}
+
+				//-------------------------------------------------------------------------------------
+				template<frame_source Source>
+				std::vector<std::vector<uint8_t>> memory_map::read_ranges(const fpga& fpga, const Source& src,
+																		std::span<const byte_range> ranges) const
+				{
+					/**
+					* @brief Bit to be read from a block RAM.
+					*/
+					struct bit_request
+					{
+						/** @brief Bit offset into the data space of the RAM */
+						size_t bram_bit;
+
+						/** @brief Index of the destination range */
+						size_t range;
+
+						/** @brief Bit offset into the destination range */
+						size_t bit;
+					};
+
+					std::vector<std::vector<uint8_t>> result(ranges.size());
+
+					// Region plans (planned on first use)
+					std::vector<region_plan> plans(num_regions());
+					std::vector<bool> planned(num_regions(), false);
+
+					// Requested bits, grouped by block RAM
+					std::unordered_map<const bram*, size_t> ram_index;
+					std::vector<const bram*> rams;
+					std::vector<std::vector<bit_request>> requests;
+
+					size_t index = 0u;
+
+					for (size_t r = 0u; r < ranges.size(); ++r)
+					{
+						const auto& range = ranges[r];
+						result[r].resize(range.size);
+
+						for (size_t i = 0u; i < range.size; ++i)
+						{
+							const uint64_t byte_addr = range.address + i;
+
+							// Find the region of the byte (ranges rarely leave the region of their first byte)
+							if (index >= num_regions() || byte_addr < region(index).start_bit_addr() / 8u ||
+								byte_addr > region(index).end_bit_addr() / 8u)
+							{
+								index = 0u;
+								while (index < num_regions() && (byte_addr < region(index).start_bit_addr() / 8u ||
+																 byte_addr > region(index).end_bit_addr() / 8u))
+								{
+									++index;
+								}
+
+								if (index == num_regions())
+								{
+									throw std::out_of_range("byte range is not covered by the memory map");
+								}
+							}
+
+							if (!planned[index])
+							{
+								plans[index] = plan_region(fpga, index);
+								planned[index] = true;
+							}
+
+							const auto& plan = plans[index];
+							const uint64_t region_bit = (byte_addr - region(index).start_bit_addr() / 8u) * 8u;
+
+							for (size_t k = 0u; k < 8u; ++k)
+							{
+								const size_t w = static_cast<size_t>((region_bit + k) / plan.word_size);
+								const size_t b = static_cast<size_t>((region_bit + k) % plan.word_size);
+
+								const size_t l = plan.owners[b];
+								const auto& lane = plan.lanes[l];
+
+								const auto [it, inserted] = ram_index.try_emplace(lane.ram, rams.size());
+								if (inserted)
+								{
+									rams.push_back(lane.ram);
+									requests.emplace_back();
+								}
+
+								const size_t bram_bit = w * (lane.msb - lane.lsb + 1u) + (b - lane.lsb);
+								requests[it->second].push_back(bit_request { bram_bit, r, i * 8u + k });
+							}
+						}
+					}
+
+					// Read the requested bits of each block RAM (in parallel)
+					std::vector<std::vector<uint8_t>> values(rams.size());
+
+					runtime::parallel_for(0u, rams.size(), [&](size_t j)
+					{
+						const bram& ram = *rams[j];
+						const auto& reqs = requests[j];
+						const size_t bram_bits = ram.data_bits() * ram.num_words();
+
+						auto& bits = values[j];
+						bits.resize((reqs.size() + 7u) / 8u);
+
+						// Extract densely used block RAMs as a whole, read sparse bits one by one
+						const bool dense = reqs.size() * 16u >= bram_bits;
+						const auto bram_data = dense ? ram.extract(src, false) : std::vector<uint8_t>();
+
+						for (size_t q = 0u; q < reqs.size(); ++q)
+						{
+							const size_t offset = reqs[q].bram_bit;
+							if (offset >= bram_bits)
+							{
+								throw std::out_of_range("bit address to be mapped is out of bounds");
+							}
+
+							const bool value = dense ? !!((bram_data[offset / 8u] >> (offset % 8u)) & 1u)
+													: ram.extract_bit(src, offset, false);
+
+							if (value)
+								bits[q / 8u] |= static_cast<uint8_t>(1u << (q % 8u));
+						}
+					});
+
+					// Scatter the bits into the ranges
+					for (size_t j = 0u; j < rams.size(); ++j)
+					{
+						const auto& reqs = requests[j];
+
+						for (size_t q = 0u; q < reqs.size(); ++q)
+						{
+							if ((values[j][q / 8u] >> (q % 8u)) & 1u)
+							{
+								result[reqs[q].range][reqs[q].bit / 8u] |= static_cast<uint8_t>(1u << (reqs[q].bit % 8u));
+							}
+						}
+					}
+
+					return result;
+				}
+
+				//-------------------------------------------------------------------------------------
+				template<frame_sink Sink>
+				void bram_write_plan::apply(Sink& dst) const
+				{
+					std::array<size_t, bram::map_chunk_bits> dst_bits;
+					std::vector<uint32_t> words;
+
+					for (const auto& writes : rams_)
+					{
+						const bram& ram = *writes.ram;
+						const size_t bram_bits = ram.data_bits() * ram.num_words();
+
+						// Read-modify-write of the frame data words of the block RAM
+						const auto [first_word, num_words] = ram.map_word_range(false);
+						const size_t base_bit = first_word * 32u;
+
+						words.resize(num_words);
+						dst.read_frame_words(ram.slr(), first_word, std::span<uint32_t>(words));
+
+						for (size_t first = 0u; first < bram_bits; first += bram::map_chunk_bits)
+						{
+							const size_t count = std::min(bram::map_chunk_bits, bram_bits - first);
+
+							// Skip chunks without any written bit (the chunks are byte aligned)
+							const auto mask_begin = writes.mask.begin() + first / 8u;
+							const auto mask_end = mask_begin + (count + 7u) / 8u;
+
+							if (std::all_of(mask_begin, mask_end, [](uint8_t m) { return m == 0u; }))
+								continue;
+
+							ram.map_range_to_bitstream(first, false, std::span<size_t>(dst_bits.data(), count));
+
+							for (size_t k = 0u; k < count; ++k)
+							{
+								const size_t i = first + k;
+
+								if (!((writes.mask[i / 8u] >> (i % 8u)) & 1u))
+									continue;
+
+								const size_t bit = dst_bits[k] - base_bit;
+								const uint32_t mask = static_cast<uint32_t>(1u) << (bit % 32u);
+
+								if ((writes.data[i / 8u] >> (i % 8u)) & 1u)
+									words[bit / 32u] |= mask;
+								else
+									words[bit / 32u] &= ~mask;
+							}
+						}
+
+						dst.write_frame_words(ram.slr(), first_word, std::span<const uint32_t>(words));
+					}
+				}
 			}
 		}
 	}
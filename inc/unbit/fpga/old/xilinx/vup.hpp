@@ -7,6 +7,9 @@
 
 #include "fpga.hpp"
 
+#include <array>
+#include <utility>
+
 namespace unbit
 {
 	namespace old
@@ -38,11 +41,13 @@ namespace unbit
 					*/
 					inline size_t num_brams(bram_category category) const override final
 					{
-						return (category == bram_category::ramb36) ? num_brams_ : 0u;
+						return (category == bram_category::ramb36) ? num_brams_ :
+							(category == bram_category::ramb18) ? (2u * num_brams_) :
+							0u;
 					}
 
 					/**
-					* @brief Gets a block RAM (RAMB36E2) by its index.
+					* @brief Gets a block RAM (RAMB36E2 or RAMB18E2) by its index.
 					*/
 					virtual const bram& bram_at(bram_category category, size_t index) const override = 0;
 
@@ -66,13 +71,46 @@ namespace unbit
 					*/
 					const std::array<ramb36e2, NumBrams>& brams_;
 
+					/**
+					* @brief Block RAM halves of this device. (RAMB18E2)
+					*/
+					const std::array<ramb18e2, 2u * NumBrams>& brams_18_;
+
+				private:
+					/**
+					* @brief Helper method to create the RAMB18E2 halves table.
+					*/
+					template<std::size_t... I>
+					static constexpr std::array<ramb18e2, sizeof...(I)>
+					make_ramb18e2_halves(const std::array<ramb36e2, sizeof...(I) / 2u>& brams,
+										std::index_sequence<I...>)
+					{
+						return std::array<ramb18e2, sizeof...(I)> {
+							ramb18e2 { brams[I / 2u], (I % 2u != 0u) }...
+						};
+					}
+
 				public:
 					/**
-					* @brief Constructs a Zynq-7 variant
+					* @brief Creates the RAMB18E2 halves of a (constexpr) RAMB36E2 table.
+					*
+					* Block RAM tables of UltraScale+ devices are constant expressions; the halves are
+					* derived at compile time (instead of building alias arrays for each instance).
+					* Entry 2*i (2*i + 1) is the bottom (top) half of RAMB36E2 entry i.
+					*/
+					static constexpr std::array<ramb18e2, 2u * NumBrams>
+					make_ramb18e2_halves(const std::array<ramb36e2, NumBrams>& brams)
+					{
+						return make_ramb18e2_halves(brams, std::make_index_sequence<2u * NumBrams> {});
+					}
+
+					/**
+					* @brief Constructs a Virtex UltraScale+ variant
 					*/
 					virtex_up_variant(const std::string& name,
-									const std::array<ramb36e2, NumBrams>& brams)
-						: virtex_up(name, IdCode, NumBrams), brams_(brams)
+									const std::array<ramb36e2, NumBrams>& brams,
+									const std::array<ramb18e2, 2u * NumBrams>& brams_18)
+						: virtex_up(name, IdCode, NumBrams), brams_(brams), brams_18_(brams_18)
 					{
 					}
 
@@ -94,6 +132,9 @@ namespace unbit
 						case bram_category::ramb36:
 							return brams_.at(index);
 
+						case bram_category::ramb18:
+							return brams_18_.at(index);
+
 						default:
 							throw std::invalid_argument("unsupported block ram category");
 						}
@@ -184,6 +184,14 @@ namespace unbit
 				 *   bitstream processing should stop at this packet.
 				 */
 				virtual bool on_config_nop(config_reg reg, word_span_type data);
+
+				/**
+				 * @brief SYNC word seen in the packet stream (e.g. re-synchronization after a DESYNC).
+				 *
+				 * @return True if processing should continue, or false if the bitstream processing
+				 *   should stop at this word.
+				 */
+				virtual bool on_config_sync();
 			};
 		}
 	}
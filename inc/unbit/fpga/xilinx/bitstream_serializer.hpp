@@ -0,0 +1,289 @@
+/**
+ * @file
+ * @brief Parallel serializer for configuration bitstreams (per-SLR segments, vectored writes).
+ */
+#ifndef UNBIT_XILINX_BITSTREAM_SERIALIZER_HPP_
+#define UNBIT_XILINX_BITSTREAM_SERIALIZER_HPP_ 1
+
+#include "unbit/fpga/xilinx/config_reg.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Options of the @ref bitstream_serializer.
+			 */
+			struct serializer_options
+			{
+				/**
+				 * @brief Emit a CRC check at the end of each SLR.
+				 */
+				bool with_crc = true;
+
+				/**
+				 * @brief Write frames with identical contents via MFWR (requires frame addresses).
+				 */
+				bool compress = false;
+
+				/**
+				 * @brief Number of (zero) words written to the MFWR register per duplicated frame.
+				 */
+				std::size_t mfwr_words = 4u;
+
+				/**
+				 * @brief Encode the SLRs in parallel.
+				 */
+				bool parallel = true;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Serializer for (uncompressed or MFWR-compressed) configuration bitstreams.
+			 *
+			 * The serializer encodes the configuration frames of a @ref frame_store into a loadable
+			 * configuration bitstream. The packet stream of each SLR (header, FAR/FDRI and MFWR
+			 * sequences, byte-swapping to the big-endian file format, and the configuration CRC) is
+			 * encoded independently, in parallel, into separate segment buffers.
+			 *
+			 * SLRs following the first one are nested into the stream of their predecessor via a
+			 * write to the (reserved) register 30, i.e. the file layout is:
+			 *
+			 *     head(0) link(0) head(1) link(1) ... head(n-1) tail(n-1) ... tail(1) tail(0)
+			 *
+			 * where @c link(k) is the packet header of the nested write (which depends on the size of
+			 * all following SLRs), and @c tail(k) holds the trailer register writes, the CRC check
+			 * and the DESYNC command of SLR @c k. The nested payload contributes to the CRC of the
+			 * enclosing SLR; this contribution is derived from the per-segment CRCs via
+			 * @ref config_crc::combine, so that no segment needs to be scanned twice.
+			 *
+			 * After encoding, the final file offsets of all segments are known and the bitstream can
+			 * be written with a single vectored write (@c pwritev) without assembling it in memory.
+			 */
+			class bitstream_serializer
+			{
+			public:
+				/**
+				 * @brief Marker for frames without a frame address (e.g. row padding frames).
+				 */
+				static constexpr uint32_t NO_FRAME_ADDRESS = 0xFFFFFFFFu;
+
+				/**
+				 * @brief A register write (emitted verbatim as type 1 or type 2 packet).
+				 */
+				struct register_write
+				{
+					/**
+					 * @brief Target register of the write.
+					 */
+					config_reg reg;
+
+					/**
+					 * @brief Data words (native byte order).
+					 */
+					std::vector<uint32_t> data;
+				};
+
+				/**
+				 * @brief Per-SLR serialization settings.
+				 */
+				struct slr_config
+				{
+					/**
+					 * @brief Frame address (FAR) of each frame of the SLR (linear frame order).
+					 *
+					 * Row padding frames are marked with @ref NO_FRAME_ADDRESS. The frame address
+					 * map is optional for uncompressed output (the FDRI write then starts at the
+					 * frame address zero) and mandatory for MFWR compression.
+					 */
+					std::vector<uint32_t> frame_addresses;
+
+					/**
+					 * @brief Register writes emitted after the IDCODE write (before any frame data).
+					 */
+					std::vector<register_write> header;
+
+					/**
+					 * @brief Register writes emitted after the frame data (and any nested SLRs), but
+					 *   before the CRC check and the DESYNC command.
+					 */
+					std::vector<register_write> trailer;
+				};
+
+			private:
+				/**
+				 * @brief Encoded segments of an SLR.
+				 */
+				struct slr_image
+				{
+					/** @brief Sync, header and frame data packets (big-endian). */
+					std::vector<uint32_t> head;
+
+					/** @brief Packet header of the nested write of the next SLR (big-endian). */
+					std::vector<uint32_t> link;
+
+					/** @brief Trailer, CRC check and DESYNC packets (big-endian). */
+					std::vector<uint32_t> tail;
+
+					/** @brief Configuration CRC at the end of the head segment. */
+					uint32_t head_crc = 0u;
+
+					/** @brief CRC of the head segment as nested payload (register 30, from zero). */
+					uint32_t head_nested_crc = 0u;
+
+					/** @brief CRC of the complete stream of this SLR as nested payload. */
+					uint32_t nested_crc = 0u;
+
+					/** @brief Number of words of the complete stream of this SLR (incl. nested SLRs). */
+					uint64_t stream_words = 0u;
+
+					/** @brief Number of frames written via FDRI. */
+					std::size_t num_fdri_frames = 0u;
+
+					/** @brief Number of frames written via MFWR. */
+					std::size_t num_mfwr_frames = 0u;
+				};
+
+				/**
+				 * @brief The frames to be serialized.
+				 */
+				const frame_store& frames_;
+
+				/**
+				 * @brief Serializer options.
+				 */
+				serializer_options options_;
+
+				/**
+				 * @brief Per-SLR serialization settings.
+				 */
+				std::vector<slr_config> configs_;
+
+				/**
+				 * @brief Encoded per-SLR segments (valid after @ref encode).
+				 */
+				std::vector<slr_image> images_;
+
+				/**
+				 * @brief Segment buffers in file order (valid after @ref encode).
+				 */
+				std::vector<std::span<const uint8_t>> buffers_;
+
+			public:
+				/**
+				 * @brief Constructs a serializer for a frame store.
+				 *
+				 * @param frames specifies the frames to be serialized. The frame store must outlive
+				 *   the serializer, and must not be modified between @ref encode and the last write.
+				 * @param opts specifies the serializer options.
+				 */
+				explicit bitstream_serializer(const frame_store& frames,
+					const serializer_options& opts = serializer_options());
+
+				/**
+				 * @brief Destroys the serializer.
+				 */
+				~bitstream_serializer();
+
+				/**
+				 * @brief Gets the serialization settings of an SLR (for modification before encoding).
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				slr_config& config(std::size_t slr);
+
+				/**
+				 * @brief Encodes the bitstream (all SLRs, in parallel if enabled).
+				 */
+				void encode();
+
+				/**
+				 * @brief Tests if the bitstream has been encoded.
+				 */
+				inline bool encoded() const noexcept
+				{
+					return !buffers_.empty();
+				}
+
+				/**
+				 * @brief Gets the segment buffers of the encoded bitstream (in file order).
+				 */
+				inline std::span<const std::span<const uint8_t>> buffers() const noexcept
+				{
+					return buffers_;
+				}
+
+				/**
+				 * @brief Gets the total size of the encoded bitstream in bytes.
+				 */
+				std::size_t size() const noexcept;
+
+				/**
+				 * @brief Gets the number of frames written via FDRI (all SLRs).
+				 */
+				std::size_t num_fdri_frames() const noexcept;
+
+				/**
+				 * @brief Gets the number of frames written via MFWR (all SLRs).
+				 */
+				std::size_t num_mfwr_frames() const noexcept;
+
+				/**
+				 * @brief Writes the encoded bitstream to a file descriptor (vectored positional write).
+				 *
+				 * @param fd is the (writable) file descriptor.
+				 * @param offset is the file offset of the first byte of the bitstream.
+				 */
+				void write(int fd, uint64_t offset = 0u) const;
+
+				/**
+				 * @brief Writes the encoded bitstream to a file (created or truncated).
+				 *
+				 * @param filename specifies the name (and path) of the output file.
+				 */
+				void write(const std::string& filename) const;
+
+				/**
+				 * @brief Writes the encoded bitstream to an output stream.
+				 *
+				 * @param os is the output stream (opened in binary mode).
+				 */
+				void write(std::ostream& os) const;
+
+				/**
+				 * @brief Gets a copy of the encoded bitstream.
+				 */
+				std::vector<uint8_t> to_bytes() const;
+
+			private:
+				/**
+				 * @brief Encodes the head segment of an SLR.
+				 */
+				void encode_head(std::size_t slr);
+
+				/**
+				 * @brief Links the SLRs (nested write headers, CRCs and tail segments).
+				 */
+				void link();
+
+				// Non-copyable
+				bitstream_serializer(const bitstream_serializer&) =delete;
+				bitstream_serializer& operator=(const bitstream_serializer&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_BITSTREAM_SERIALIZER_HPP_
@@ -0,0 +1,313 @@
+/**
+ * @file
+ * @brief Compressed configuration frames of a (multi-SLR) Xilinx FPGA.
+ */
+#ifndef UNBIT_XILINX_COMPRESSED_FRAME_STORE_HPP_
+#define UNBIT_XILINX_COMPRESSED_FRAME_STORE_HPP_ 1
+
+#include "unbit/fpga/xilinx/frame_store.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Options of compressed frame stores.
+			 */
+			struct compressed_store_options
+			{
+				/**
+				 * @brief Capacity of the frame cache (number of decompressed frames, at least one).
+				 *
+				 * The block RAM content bits of a RAMB36 are spread over the 128 frames of its block
+				 * RAM column; the default keeps two such columns decompressed.
+				 */
+				std::size_t cache_frames = 256u;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Compressed configuration frames of a (multi-SLR) Xilinx FPGA.
+			 *
+			 * The @c compressed_frame_store class holds the same frames as a @ref frame_store, with
+			 * each frame encoded as a sequence of zero runs, repeated words and literal words.
+			 * Trailing zero words are not stored, i.e. empty frames (the majority of the frames of
+			 * most designs) take no space besides their 4-byte index entry. Resident images typically
+			 * shrink by an order of magnitude or more.
+			 *
+			 * Frames are decompressed on demand into a small LRU cache. The store provides the frame
+			 * source and frame sink interface of the block RAM and memory map algorithms
+			 * (cf. @c unbit::old::xilinx::frame_source); these decompress only the frames they touch.
+			 * Reads of empty frames and reads of whole frames bypass the cache.
+			 *
+			 * Writes go to the cache (whole-frame writes are encoded directly); modified frames are
+			 * encoded again when they are evicted from the cache or on @ref flush.
+			 *
+			 * Concurrent reads (e.g. the parallel block RAM reads of a memory map) are safe; writes
+			 * must not run concurrently with any other access.
+			 */
+			class compressed_frame_store
+			{
+			private:
+				/**
+				 * @brief Per-SLR compressed frames.
+				 */
+				struct slr_frames
+				{
+					/**
+					 * @brief Encoded frames (length word and tokens; frames re-encoded after a write are
+					 *   appended).
+					 */
+					std::vector<uint32_t> codes;
+
+					/**
+					 * @brief Offset of the encoding of each frame in @ref codes (@c EMPTY_FRAME for empty
+					 *   frames).
+					 */
+					std::vector<uint32_t> offsets;
+
+					/**
+					 * @brief Number of words in @ref codes that are no longer referenced.
+					 */
+					std::size_t stale_words = 0u;
+
+					/**
+					 * @brief IDCODE of this SLR (if known).
+					 */
+					std::optional<uint32_t> idcode;
+				};
+
+				/**
+				 * @brief Frame cache (decompressed frames, LRU replacement).
+				 */
+				struct frame_cache;
+
+				/**
+				 * @brief Number of 32-bit words per frame.
+				 */
+				std::size_t frame_words_;
+
+				/**
+				 * @brief Compressed frames of the SLRs (in configuration order).
+				 *
+				 * Evictions of modified frames (which may happen during reads) re-encode them under the
+				 * lock of the frame cache.
+				 */
+				mutable std::vector<slr_frames> slrs_;
+
+				/**
+				 * @brief Frame cache.
+				 */
+				std::unique_ptr<frame_cache> cache_;
+
+			public:
+				/**
+				 * @brief Constructs an empty compressed frame store.
+				 */
+				compressed_frame_store() noexcept;
+
+				/**
+				 * @brief Compresses the frames of a frame store.
+				 *
+				 * @param frames is the (materialized) frame store.
+				 * @param opts specifies the options of the compressed store.
+				 */
+				explicit compressed_frame_store(const frame_store& frames,
+					const compressed_store_options& opts = compressed_store_options());
+
+				/**
+				 * @brief Move constructor for compressed frame stores.
+				 */
+				compressed_frame_store(compressed_frame_store&& other) noexcept;
+
+				/**
+				 * @brief Move assignment for compressed frame stores.
+				 */
+				compressed_frame_store& operator=(compressed_frame_store&& other) noexcept;
+
+				/**
+				 * @brief Destroys the compressed frame store.
+				 */
+				~compressed_frame_store();
+
+				/**
+				 * @brief Loads and compresses the frames of an (uncompressed) configuration bitstream.
+				 *
+				 * The frames are materialized in a temporary @ref frame_store (see @ref frame_store::load)
+				 * before they are compressed.
+				 *
+				 * @param cfg_data specifies the configuration bitstream data (native byte order).
+				 * @param frame_words is the number of 32-bit words per frame.
+				 * @param opts specifies the options of the compressed store.
+				 *
+				 * @return The loaded frame store.
+				 */
+				static compressed_frame_store load(std::span<const uint32_t> cfg_data, std::size_t frame_words,
+					const compressed_store_options& opts = compressed_store_options());
+
+				/**
+				 * @brief Decompresses all frames into a (materialized) frame store.
+				 *
+				 * @param policy specifies the allocation policy of the frame buffers.
+				 */
+				frame_store decompress(const frame_alloc_policy& policy = frame_alloc_policy()) const;
+
+				/**
+				 * @brief Gets the number of 32-bit words per frame.
+				 */
+				std::size_t frame_words() const noexcept;
+
+				/**
+				 * @brief Gets the number of SLRs in this frame store.
+				 */
+				std::size_t num_slrs() const noexcept;
+
+				/**
+				 * @brief Gets the number of frames of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				std::size_t num_frames(std::size_t slr) const;
+
+				/**
+				 * @brief Gets the IDCODE of an SLR (if known).
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				const std::optional<uint32_t>& idcode(std::size_t slr) const;
+
+				/**
+				 * @brief Sets the IDCODE of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param new_idcode is the new IDCODE value.
+				 */
+				void set_idcode(std::size_t slr, uint32_t new_idcode);
+
+				/**
+				 * @brief Reads the data words of a single frame.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param frame is the linear index of the frame within the SLR.
+				 * @param words receives the frame data (exactly one frame).
+				 */
+				void read_frame(std::size_t slr, std::size_t frame, std::span<uint32_t> words) const;
+
+				/**
+				 * @brief Overwrites the data words of a single frame.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param frame is the linear index of the frame within the SLR.
+				 * @param words specifies the new frame data (exactly one frame).
+				 */
+				void write_frame(std::size_t slr, std::size_t frame, std::span<const uint32_t> words);
+
+				/**
+				 * @brief Encodes all modified frames held in the frame cache.
+				 */
+				void flush();
+
+				/**
+				 * @brief Gets the number of bytes held by the compressed frames, their index and the
+				 *   frame cache (all SLRs).
+				 */
+				std::size_t compressed_bytes() const;
+
+				/**
+				 * @brief Gets the number of bytes of the uncompressed frame data (all SLRs).
+				 */
+				std::size_t uncompressed_bytes() const noexcept;
+
+				/**
+				 * @brief Gets the number of frames decompressed so far (cache misses and whole-frame reads).
+				 */
+				std::size_t num_decoded_frames() const;
+
+				// Frame source interface (cf. unbit::old::xilinx::frame_source)
+
+				/**
+				 * @brief Gets the number of frame data words of an SLR.
+				 */
+				std::size_t frame_data_words(unsigned slr) const;
+
+				/**
+				 * @brief Gets the frame data word containing a bit.
+				 */
+				uint32_t read_frame_word(unsigned slr, std::size_t bit_offset) const;
+
+				/**
+				 * @brief Copies a range of frame data words.
+				 */
+				void read_frame_words(unsigned slr, std::size_t first_word, std::span<uint32_t> words) const;
+
+				/**
+				 * @brief Writes a bit.
+				 */
+				void write_frame_bit(unsigned slr, std::size_t bit_offset, bool value);
+
+				/**
+				 * @brief Overwrites a range of frame data words.
+				 */
+				void write_frame_words(unsigned slr, std::size_t first_word, std::span<const uint32_t> words);
+
+			private:
+				/**
+				 * @brief Gets the compressed frames of an SLR (with range checking).
+				 */
+				slr_frames& get_slr(std::size_t slr) const;
+
+				/**
+				 * @brief Gets the frame data of a cache slot.
+				 */
+				uint32_t* slot_words(uint32_t slot) const noexcept;
+
+				/**
+				 * @brief Gets the cache slot of a frame, decompressing the frame on a miss. (locked)
+				 */
+				uint32_t fetch_slot(unsigned slr, std::size_t frame) const;
+
+				/**
+				 * @brief Marks a cached frame as modified. (locked)
+				 */
+				void mark_dirty(uint32_t slot) const noexcept;
+
+				/**
+				 * @brief Encodes a modified cached frame. (locked)
+				 */
+				void clean_slot(uint32_t slot) const;
+
+				/**
+				 * @brief Encodes and stores the data of a frame. (locked)
+				 */
+				void store_frame(unsigned slr, std::size_t frame, std::span<const uint32_t> words) const;
+
+				/**
+				 * @brief Gets the number of bytes held by the compressed frames and the frame cache.
+				 */
+				std::size_t held_bytes() const noexcept;
+
+				/**
+				 * @brief Reports changes of the held bytes to the memory statistics.
+				 */
+				void update_tracking() const noexcept;
+
+				// Non-copyable
+				compressed_frame_store(const compressed_frame_store&) =delete;
+				compressed_frame_store& operator=(const compressed_frame_store&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_COMPRESSED_FRAME_STORE_HPP_
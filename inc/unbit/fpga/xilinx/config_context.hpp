@@ -5,6 +5,9 @@
 #ifndef UNBIT_XILINX_CONFIG_CONTEXT_HPP_
 #define UNBIT_XILINX_CONFIG_CONTEXT_HPP_ 1
 
+#include "unbit/fpga/xilinx/config_reg.hpp"
+
+#include <array>
 #include <cstdint>
 #include <cstddef>
 #include <optional>
@@ -92,6 +95,16 @@ namespace unbit
 			*      via the FDRI and MFWR register. Writes are alway forwarded to the backend
 			*      configuration array, and the tracking bitmap is updated to record any (over-)written
 			*      frames as configured.
+			*
+			* 4. A shadow copy of the configuration registers (the last value written to each
+			*    register). Writes to the CTL0 and CTL1 registers are qualified by the MASK register,
+			*    i.e. only bits set in MASK are updated.
+			*
+			* 5. The state of the configuration sequence: A context starts synchronized, a START
+			*    command arms the start-up sequence, and a DESYNC command ends the configuration
+			*    sequence (until the next SYNC word is seen). Configuration engines can use the
+			*    state to stop processing at the DESYNC command, instead of scanning trailing
+			*    padding (or unrelated data following the bitstream in a flash image).
 			*/
 			class config_context
 			{
@@ -130,6 +143,42 @@ namespace unbit
 					overwrite = 2u
 				};
 
+				/**
+				 * @brief States of the configuration sequence.
+				 */
+				enum class cstate : uint32_t
+				{
+					/**
+					 * @brief Synchronized (packets are processed).
+					 */
+					synchronized = 0u,
+
+					/**
+					 * @brief Start-up sequence armed (START command seen, awaiting DESYNC).
+					 */
+					startup = 1u,
+
+					/**
+					 * @brief Desynchronized (DESYNC command seen, awaiting the next SYNC word).
+					 */
+					desynchronized = 2u
+				};
+
+				/**
+				 * @brief Number of (addressable) configuration registers.
+				 */
+				static constexpr std::size_t NUM_REGS = 32u;
+
+				/**
+				 * @brief Security level bits (SBITS) of the CTL0 register (readback and ICAP access).
+				 */
+				static constexpr uint32_t CTL0_SBITS = 0x00000030u;
+
+				/**
+				 * @brief Decryption enable bit (DEC) of the CTL0 register.
+				 */
+				static constexpr uint32_t CTL0_DEC = 0x00000040u;
+
 			private:
 				/**
 				 * @brief The parent engine of this configuration context.
@@ -166,6 +215,26 @@ namespace unbit
 				 */
 				std::unordered_set<uint32_t> write_bitmap_;
 
+				/**
+				 * @brief Shadow copy of the configuration registers (indexed by register address).
+				 */
+				std::array<uint32_t, NUM_REGS> regs_;
+
+				/**
+				 * @brief Bitmap of the configuration registers that have been written.
+				 */
+				uint32_t regs_written_;
+
+				/**
+				 * @brief State of the configuration sequence.
+				 */
+				cstate state_;
+
+				/**
+				 * @brief Indicates if the start-up sequence was triggered (START followed by DESYNC).
+				 */
+				bool started_;
+
 			public:
 				/**
 				 * @brief Construct a new context object.
@@ -272,6 +341,103 @@ namespace unbit
 				 */
 				void mark_frame_write(uint32_t frame_addr);
 
+				/**
+				 * @brief Gets the shadow value of a configuration register.
+				 *
+				 * @param reg is the configuration register.
+				 *
+				 * @return The last value written to the register (or std::nullopt if the register
+				 *   has not been written on this context).
+				 */
+				inline std::optional<uint32_t> reg(config_reg reg) const
+				{
+					const uint32_t index = static_cast<uint32_t>(reg) % NUM_REGS;
+
+					if ((regs_written_ & (1u << index)) == 0u)
+						return std::nullopt;
+
+					return regs_[index];
+				}
+
+				/**
+				 * @brief Updates the shadow value of a configuration register.
+				 *
+				 * Writes to the CTL0 and CTL1 registers only update the bits that are set in the MASK
+				 * register (all bits are updated if MASK has not been written on this context).
+				 *
+				 * @param reg is the configuration register.
+				 * @param value is the value written to the register.
+				 */
+				void write_reg(config_reg reg, uint32_t value);
+
+				/**
+				 * @brief Gets the state of the configuration sequence.
+				 *
+				 * @return The state of the configuration sequence.
+				 */
+				inline cstate state() const
+				{
+					return state_;
+				}
+
+				/**
+				 * @brief Sets the state of the configuration sequence.
+				 *
+				 * Entering the desynchronized state from the start-up state marks the context
+				 * as started.
+				 *
+				 * @param new_state is the new state.
+				 */
+				void set_state(cstate new_state);
+
+				/**
+				 * @brief Tests if the start-up sequence was triggered (START command followed by DESYNC).
+				 */
+				inline bool is_started() const
+				{
+					return started_;
+				}
+
+				/**
+				 * @brief Tests if readback is disabled by the security level bits (SBITS) of CTL0.
+				 */
+				inline bool is_readback_disabled() const
+				{
+					return (reg(config_reg::CTL0).value_or(0u) & CTL0_SBITS) != 0u;
+				}
+
+				/**
+				 * @brief Tests if bitstream decryption is enabled (DEC bit of CTL0).
+				 */
+				inline bool is_encrypted() const
+				{
+					return (reg(config_reg::CTL0).value_or(0u) & CTL0_DEC) != 0u;
+				}
+
+				/**
+				 * @brief Tests if the configuration data is compressed (i.e. uses multi-frame writes).
+				 */
+				inline bool is_compressed() const
+				{
+					return reg(config_reg::MFWR).has_value();
+				}
+
+				/**
+				 * @brief Gets the warm boot start address (WBSTAR) register (if written).
+				 */
+				inline std::optional<uint32_t> wbstar() const
+				{
+					return reg(config_reg::WBSTAR);
+				}
+
+				/**
+				 * @brief Gets the watchdog timer (TIMER) register (if written).
+				 */
+				inline std::optional<uint32_t> timer() const
+				{
+					return reg(config_reg::TIMER);
+				}
+
 			private:
 				config_context(const config_context&) =delete;
 				config_context& operator=(const config_context&) =delete;
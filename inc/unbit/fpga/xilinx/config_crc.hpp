@@ -0,0 +1,177 @@
+/**
+ * @file
+ * @brief Configuration CRC of Xilinx Series-7 and UltraScale FPGAs.
+ */
+#ifndef UNBIT_XILINX_CONFIG_CRC_HPP_
+#define UNBIT_XILINX_CONFIG_CRC_HPP_ 1
+
+#include "unbit/fpga/xilinx/config_reg.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <span>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Configuration CRC of Xilinx Series-7 and UltraScale FPGAs.
+			 *
+			 * The configuration engine accumulates a CRC over all data words written to configuration
+			 * registers. Each data word is extended by the 5-bit address of the target register, and
+			 * the resulting 37-bit value (data bits first, starting with the LSB) is fed into a
+			 * reflected CRC-32C (Castagnoli, polynomial 0x82F63B78) without pre- or post-inversion.
+			 *
+			 * Writes to the CRC register are compared against the accumulated value and do not
+			 * contribute to the CRC. The RCRC command resets the CRC to zero.
+			 *
+			 * The data part is computed via the SSE4.2 @c crc32 instruction if the library is built
+			 * for a target that supports it, and via slicing-by-4 tables otherwise.
+			 */
+			class config_crc
+			{
+			private:
+				/**
+				 * @brief Current CRC value.
+				 */
+				uint32_t value_;
+
+			public:
+				/**
+				 * @brief Constructs a new (reset) configuration CRC.
+				 */
+				config_crc() noexcept;
+
+				/**
+				 * @brief Constructs a configuration CRC with a given initial value.
+				 *
+				 * @param initial is the initial CRC value.
+				 */
+				explicit config_crc(uint32_t initial) noexcept;
+
+				/**
+				 * @brief Gets the current CRC value.
+				 */
+				inline uint32_t value() const noexcept
+				{
+					return value_;
+				}
+
+				/**
+				 * @brief Resets the CRC (as done by the RCRC command).
+				 */
+				inline void reset() noexcept
+				{
+					value_ = 0u;
+				}
+
+				/**
+				 * @brief Updates the CRC for a single data word written to a register.
+				 *
+				 * @param reg is the target register of the write.
+				 * @param data is the data word being written.
+				 */
+				inline void update(config_reg reg, uint32_t data) noexcept
+				{
+					value_ = step(value_, static_cast<uint32_t>(reg), data);
+				}
+
+				/**
+				 * @brief Updates the CRC for a sequence of data words written to a register.
+				 *
+				 * @param reg is the target register of the write.
+				 * @param data specifies the data words being written.
+				 */
+				void update(config_reg reg, std::span<const uint32_t> data) noexcept;
+
+				/**
+				 * @brief Tracks a register write (applying the CRC and RCRC rules of the device).
+				 *
+				 * Writes to the CRC register are ignored, an RCRC command resets the CRC, all other
+				 * writes update the CRC.
+				 *
+				 * @param reg is the target register of the write.
+				 * @param data specifies the data words being written.
+				 */
+				void process_write(config_reg reg, std::span<const uint32_t> data) noexcept;
+
+				/**
+				 * @brief Computes a single CRC step (one data word with its register address).
+				 *
+				 * @param crc is the current CRC value.
+				 * @param reg_addr is the 5-bit address of the target register.
+				 * @param data is the data word being written.
+				 *
+				 * @return The updated CRC value.
+				 */
+				static uint32_t step(uint32_t crc, uint32_t reg_addr, uint32_t data) noexcept;
+
+				/**
+				 * @brief Computes a single CRC step (bit-serial reference implementation).
+				 *
+				 * @param crc is the current CRC value.
+				 * @param reg_addr is the 5-bit address of the target register.
+				 * @param data is the data word being written.
+				 *
+				 * @return The updated CRC value.
+				 */
+				static uint32_t step_bitwise(uint32_t crc, uint32_t reg_addr, uint32_t data) noexcept;
+
+				/**
+				 * @brief Combines the CRCs of two consecutive write sequences.
+				 *
+				 * The CRC is linear: Processing a sequence B (of @p num_words_b words) starting from
+				 * a CRC value @p crc_a yields the CRC of B (computed from zero) combined with
+				 * @p crc_a advanced over @p num_words_b zero-valued 37-bit inputs. This allows the
+				 * CRCs of independent parts of a bitstream to be computed in parallel.
+				 *
+				 * @param crc_a is the CRC value before the second sequence.
+				 * @param crc_b is the CRC of the second sequence (computed from zero).
+				 * @param num_words_b is the number of data words in the second sequence.
+				 *
+				 * @return The CRC value after both sequences.
+				 */
+				static uint32_t combine(uint32_t crc_a, uint32_t crc_b, uint64_t num_words_b) noexcept;
+
+				/**
+				 * @brief Compares the CRC checks of a configuration bitstream with the accumulated CRC.
+				 *
+				 * The bitstream is scanned as by @ref update_checks, without modifying it. Tools that
+				 * rewrite CRC checks use this to confirm that the CRC model matches the (unmodified)
+				 * input bitstream first.
+				 *
+				 * @param data specifies the bitstream data (file format, i.e. big-endian words).
+				 *
+				 * @return The number of CRC checks that differ from the accumulated CRC.
+				 *
+				 * @throws bitstream_error if the bitstream has no sync word or is malformed.
+				 */
+				static std::size_t verify_checks(std::span<const uint8_t> data);
+
+				/**
+				 * @brief Recomputes the CRC checks of a configuration bitstream in place.
+				 *
+				 * The bitstream is scanned from its first sync word; any leading data (e.g. the .bit
+				 * file header) is left untouched. The CRC of each (sub-)stream is tracked as by the
+				 * device, and each write to the CRC register is replaced by the CRC accumulated up to
+				 * that point. Streams nested via register 30 writes (SLRs of SSI devices) are processed
+				 * inline, i.e. their updated words contribute to the CRC of the enclosing stream.
+				 *
+				 * @param data specifies the bitstream data (file format, i.e. big-endian words).
+				 *
+				 * @return The number of CRC checks whose value was changed.
+				 *
+				 * @throws bitstream_error if the bitstream has no sync word or is malformed.
+				 */
+				static std::size_t update_checks(std::span<uint8_t> data);
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_CONFIG_CRC_HPP_
@@ -0,0 +1,217 @@
+/**
+ * @file
+ * @brief Single-pass fan-out of configuration events to multiple (lightweight) visitors.
+ */
+#ifndef UNBIT_XILINX_CONFIG_DISPATCHER_HPP_
+#define UNBIT_XILINX_CONFIG_DISPATCHER_HPP_ 1
+
+#include "unbit/fpga/xilinx/config_engine.hpp"
+#include "unbit/fpga/xilinx/config_context.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+#include <initializer_list>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Computes a register mask (bit i corresponds to the register with address i).
+			 *
+			 * @param regs specifies the registers to be included in the mask.
+			 */
+			constexpr uint32_t config_reg_mask(std::initializer_list<config_reg> regs) noexcept
+			{
+				uint32_t mask = 0u;
+
+				for (const config_reg reg : regs)
+					mask |= (1u << (static_cast<uint32_t>(reg) & 0x1Fu));
+
+				return mask;
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Selects the events delivered to a visitor by a @ref config_dispatcher.
+			 */
+			struct visitor_filter
+			{
+				/**
+				 * @brief Registers whose write and read packets are delivered (cf. @ref config_reg_mask).
+				 */
+				uint32_t regs = 0xFFFFFFFFu;
+
+				/**
+				 * @brief Indicates if the frames of FDRI writes are delivered.
+				 */
+				bool frames = false;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Visitor of the configuration events seen by a @ref config_dispatcher.
+			 *
+			 * All callbacks have empty default implementations; visitors override the events they are
+			 * interested in (and select the packet and frame events via their @ref visitor_filter).
+			 * The SLR begin and end events are delivered to all visitors.
+			 *
+			 * The context passed to the callbacks is the active context of the dispatcher; its shadow
+			 * registers reflect the packets processed before the current one.
+			 */
+			class config_visitor
+			{
+			public:
+				/**
+				 * @brief Span of configuration words (with dynamic extent).
+				 */
+				using word_span_type = bitstream_engine::word_span_type;
+
+			public:
+				/**
+				 * @brief Destroys the visitor.
+				 */
+				virtual ~config_visitor();
+
+				/**
+				 * @brief Processing of a (root or nested) SLR begins.
+				 *
+				 * @param ctx is the (new) context of the SLR.
+				 */
+				virtual void on_slr_begin(const config_context& ctx);
+
+				/**
+				 * @brief Processing of a (root or nested) SLR ends.
+				 *
+				 * @param ctx is the context of the SLR.
+				 */
+				virtual void on_slr_end(const config_context& ctx);
+
+				/**
+				 * @brief A configuration register is written.
+				 *
+				 * @param ctx is the active context.
+				 * @param reg is the register being written.
+				 * @param data specifies the data words of the write.
+				 */
+				virtual void on_write(const config_context& ctx, config_reg reg, word_span_type data);
+
+				/**
+				 * @brief A configuration register is read (e.g. in readback streams).
+				 *
+				 * @param ctx is the active context.
+				 * @param reg is the register being read.
+				 * @param data specifies the data words of the read packet.
+				 */
+				virtual void on_read(const config_context& ctx, config_reg reg, word_span_type data);
+
+				/**
+				 * @brief A frame is written via the FDRI register.
+				 *
+				 * @param ctx is the active context.
+				 * @param frame_index is the index of the frame in the FDRI data of the SLR (counting
+				 *   over all FDRI writes of the SLR).
+				 * @param frame specifies the data words of the frame.
+				 */
+				virtual void on_frame(const config_context& ctx, std::size_t frame_index, word_span_type frame);
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Configuration engine dispatching each event to multiple visitors.
+			 *
+			 * The dispatcher parses a bitstream once, and fans out each packet (and frame) event to the
+			 * registered visitors. The per-register visitor lists are built when the visitors are added,
+			 * so visitors that are not interested in a register do not see (or pay for) its packets.
+			 *
+			 * Visitors are called in the order in which they were added. Write events are delivered
+			 * before the configuration engine processes the write (in particular, the write to the
+			 * RSVD30 register announcing a nested SLR is delivered before the events of the nested SLR).
+			 */
+			class config_dispatcher : public config_engine
+			{
+			private:
+				/**
+				 * @brief Number of 32-bit words per frame (zero if frame events are disabled).
+				 */
+				std::size_t frame_words_;
+
+				/**
+				 * @brief All registered visitors.
+				 */
+				std::vector<config_visitor*> visitors_;
+
+				/**
+				 * @brief Visitors of the read and write packets of each register.
+				 */
+				std::array<std::vector<config_visitor*>, config_context::NUM_REGS> reg_visitors_;
+
+				/**
+				 * @brief Visitors of the frame events.
+				 */
+				std::vector<config_visitor*> frame_visitors_;
+
+				/**
+				 * @brief Number of frames seen so far (by SLR index).
+				 */
+				std::vector<std::size_t> frame_counts_;
+
+			public:
+				/**
+				 * @brief Constructs a new dispatcher.
+				 *
+				 * @param frame_words specifies the number of 32-bit words per frame (zero disables the
+				 *   frame events).
+				 */
+				explicit config_dispatcher(std::size_t frame_words = 0u);
+
+				/**
+				 * @brief Destroys the dispatcher.
+				 */
+				~config_dispatcher();
+
+				/**
+				 * @brief Registers a visitor (the visitor must outlive the dispatcher's processing).
+				 *
+				 * @param visitor is the visitor to be added.
+				 * @param filter selects the events delivered to the visitor.
+				 */
+				void add(config_visitor& visitor, const visitor_filter& filter = visitor_filter());
+
+				/**
+				 * @brief Gets the number of words per frame (zero if frame events are disabled).
+				 */
+				inline std::size_t frame_words() const noexcept
+				{
+					return frame_words_;
+				}
+
+			protected:
+				parser_status_type process_packets(word_span_type cfg_data, bool is_synchronized) override;
+
+				bool on_config_write(config_reg reg, word_span_type data) override;
+
+				bool on_config_read(config_reg reg, word_span_type data) override;
+
+				void on_config_fdri(word_span_type data) override;
+
+				void on_slr_begin() override;
+
+				void on_slr_end() override;
+
+			private:
+				// Non-copyable
+				config_dispatcher(const config_dispatcher&) =delete;
+				config_dispatcher& operator=(const config_dispatcher&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_CONFIG_DISPATCHER_HPP_
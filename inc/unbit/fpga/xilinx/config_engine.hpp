@@ -40,6 +40,36 @@ namespace unbit
 				 */
 				std::unique_ptr<config_context> ctx_;
 
+			private:
+				/**
+				 * @brief Indicates if packet processing stops at a DESYNC command.
+				 */
+				bool stop_at_desync_;
+
+			public:
+				/**
+				 * @brief Tests if packet processing stops at a DESYNC command.
+				 */
+				inline bool stop_at_desync() const noexcept
+				{
+					return stop_at_desync_;
+				}
+
+				/**
+				 * @brief Enables (or disables) stopping at a DESYNC command.
+				 *
+				 * If enabled, the processing of each (nested) configuration stream ends at the
+				 * first DESYNC command, i.e. trailing padding and any data following the bitstream
+				 * (e.g. in a flash image) are not scanned. Stopping at a DESYNC command is reported
+				 * as successful processing. The option is disabled by default.
+				 *
+				 * @param enable specifies if processing stops at a DESYNC command.
+				 */
+				inline void set_stop_at_desync(bool enable) noexcept
+				{
+					stop_at_desync_ = enable;
+				}
+
 			protected:
 				/**
 				 * @brief Construct a new FGPA configuration engine object
@@ -83,6 +113,10 @@ namespace unbit
 				/**
 				 * @brief Processes a configuration write packet.
 				 *
+				 * The (last) data word of each write is recorded in the shadow register file of
+				 * the active context, except for the FDRI and RSVD30 (SLR) writes, which carry
+				 * payload data.
+				 *
 				 * @param reg is the configuration register to write.
 				 *
 				 * @param data points to the start of paramater data of this write.
@@ -92,6 +126,14 @@ namespace unbit
 				 */
 				bool on_config_write(config_reg reg, word_span_type data) override;
 
+				/**
+				 * @brief Processes a SYNC word (re-synchronizes the active context).
+				 *
+				 * @return True if processing should continue, or false if the bitstream processing
+				 *   should stop at this word.
+				 */
+				bool on_config_sync() override;
+
 				/**
 				 * @brief Processes configuration of a (nested) SLR.
 				 *
@@ -104,6 +146,21 @@ namespace unbit
 				 */
 				virtual void on_config_slr(word_span_type data, uint32_t next_slr_index);
 
+				/**
+				 * @brief Called after the context of a (root or nested) SLR has been activated.
+				 *
+				 * The new context is available via @ref get_context.
+				 */
+				virtual void on_slr_begin();
+
+				/**
+				 * @brief Called after the packets of a (root or nested) SLR have been processed.
+				 *
+				 * The context of the SLR is still active (and is restored to the parent context after
+				 * this call returns). This method is not called if processing is aborted by an exception.
+				 */
+				virtual void on_slr_end();
+
 				/**
 				 * @brief Handles a write to the command (CMD) register.
 				 *
@@ -140,6 +197,16 @@ namespace unbit
 				 */
 				virtual void on_config_mfwr(word_span_type data);
 
+				/**
+				 * @brief Handles a START command.
+				 */
+				virtual void on_cmd_start();
+
+				/**
+				 * @brief Handles a DESYNC command.
+				 */
+				virtual void on_cmd_desync();
+
 				/**
 				 * @brief Handles a NUL command.
 				 */
@@ -0,0 +1,288 @@
+/**
+ * @file
+ * @brief Content-addressable archive of configuration frames (deduplicated across builds).
+ */
+#ifndef UNBIT_XILINX_FRAME_ARCHIVE_HPP_
+#define UNBIT_XILINX_FRAME_ARCHIVE_HPP_ 1
+
+#include "unbit/fpga/xilinx/bitstream_serializer.hpp"
+#include "unbit/fpga/xilinx/frame_merkle.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+#include "unbit/runtime/sha256.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Manifest of a build stored in a @ref frame_archive.
+			 */
+			struct archive_manifest
+			{
+				/**
+				 * @brief Per-SLR part of the manifest.
+				 */
+				struct slr
+				{
+					/** @brief IDCODE of the SLR (if known). */
+					std::optional<uint32_t> idcode;
+
+					/** @brief Frame addresses (FAR) of the frames (empty if unknown). */
+					std::vector<uint32_t> frame_addresses;
+
+					/** @brief Content hashes of the frames (linear frame order). */
+					std::vector<runtime::sha256::digest> frames;
+				};
+
+				/**
+				 * @brief Number of 32-bit words per frame.
+				 */
+				std::size_t frame_words = 0u;
+
+				/**
+				 * @brief SLRs of the build (in configuration order).
+				 */
+				std::vector<slr> slrs;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Storage statistics of a @ref frame_archive.
+			 */
+			struct archive_stats
+			{
+				/** @brief Number of builds in the archive. */
+				std::size_t num_builds = 0u;
+
+				/** @brief Number of unique frames stored in the archive. */
+				std::size_t num_unique_frames = 0u;
+
+				/** @brief Number of frames referenced by all builds. */
+				uint64_t num_frame_refs = 0u;
+
+				/** @brief Size of the frame pack file in bytes. */
+				uint64_t pack_bytes = 0u;
+
+				/** @brief Total size of the manifests, the Merkle trees and the frame index in bytes. */
+				uint64_t metadata_bytes = 0u;
+
+				/** @brief Total size of the frame data of all builds in bytes (without deduplication). */
+				uint64_t logical_bytes = 0u;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Content-addressable archive of configuration frames.
+			 *
+			 * The archive splits the frame data of each build into frames keyed by their SHA-256
+			 * digest. Each unique frame is stored once, in an append-only pack file; a build is
+			 * described by its manifest (IDCODEs, frame addresses and the frame digests of each SLR).
+			 * Consecutive builds of a design typically share most of their frames, so the archive
+			 * grows by the changed frames (plus the manifest) per build.
+			 *
+			 * The archive is a directory with the following contents:
+			 *
+			 *     frames.pack             unique frames (big-endian words, in insertion order)
+			 *     frames.idx              digest, pack offset and size of each unique frame
+			 *     builds/<name>.manifest  manifest of a build
+			 *
+			 * New frames are appended to the pack before the index, and the manifest is written
+			 * last (and atomically renamed into place), so an interrupted @ref add leaves at most
+			 * unreferenced frames behind.
+			 *
+			 * Builds are retrieved by reading the referenced frames in pack order (a sequential read
+			 * for builds that were added in one piece) into a @ref frame_store, which is then streamed
+			 * through the @ref bitstream_serializer.
+			 */
+			class frame_archive
+			{
+			public:
+				/**
+				 * @brief Digest type of the frames.
+				 */
+				using frame_hash = runtime::sha256::digest;
+
+			private:
+				/**
+				 * @brief Location of a unique frame in the pack file.
+				 */
+				struct frame_location
+				{
+					/** @brief Byte offset in the pack file. */
+					uint64_t offset;
+
+					/** @brief Number of 32-bit words of the frame. */
+					uint32_t num_words;
+				};
+
+				/**
+				 * @brief Root directory of the archive.
+				 */
+				std::filesystem::path root_;
+
+				/**
+				 * @brief Index of the unique frames.
+				 */
+				std::unordered_map<frame_hash, frame_location, runtime::sha256_digest_hash> index_;
+
+				/**
+				 * @brief Size of the pack file (in bytes).
+				 */
+				uint64_t pack_size_;
+
+			public:
+				/**
+				 * @brief Opens an archive (the archive is created if the directory does not exist).
+				 *
+				 * @param directory specifies the root directory of the archive.
+				 */
+				explicit frame_archive(const std::string& directory);
+
+				/**
+				 * @brief Closes the archive.
+				 */
+				~frame_archive();
+
+				/**
+				 * @brief Adds a build to the archive.
+				 *
+				 * @param build is the name of the build (letters, digits, '.', '_', '+' and '-'; not
+				 *   starting with a '.'). The name must not exist in the archive.
+				 * @param frames specifies the frame data of the build.
+				 * @param frame_addresses optionally specifies the frame address map of each SLR (cf.
+				 *   @ref bitstream_serializer::slr_config::frame_addresses).
+				 *
+				 * @return The number of frames that were new to the archive.
+				 */
+				std::size_t add(const std::string& build, const frame_store& frames,
+					std::span<const std::vector<uint32_t>> frame_addresses = {});
+
+				/**
+				 * @brief Tests if the archive contains a build.
+				 *
+				 * @param build is the name of the build.
+				 */
+				bool contains(const std::string& build) const;
+
+				/**
+				 * @brief Gets the names of all builds in the archive (sorted).
+				 */
+				std::vector<std::string> builds() const;
+
+				/**
+				 * @brief Reads the manifest of a build.
+				 *
+				 * @param build is the name of the build.
+				 */
+				archive_manifest manifest(const std::string& build) const;
+
+				/**
+				 * @brief Gets the Merkle trees of a build.
+				 *
+				 * The trees are built from the frame digests of the manifest (one hash per node, no
+				 * frame data is read).
+				 *
+				 * @param build is the name of the build.
+				 */
+				frame_merkle merkle(const std::string& build) const;
+
+				/**
+				 * @brief Tests if the archive contains a frame.
+				 *
+				 * @param hash is the digest of the frame.
+				 */
+				inline bool contains_frame(const frame_hash& hash) const
+				{
+					return index_.count(hash) != 0u;
+				}
+
+				/**
+				 * @brief Reads frames by their digests.
+				 *
+				 * @param hashes specifies the digests of the frames.
+				 * @param frame_words is the number of 32-bit words per frame.
+				 *
+				 * @return The frame data (native byte order, frames in the order of the digests).
+				 */
+				std::vector<uint32_t> read_frames(std::span<const frame_hash> hashes, std::size_t frame_words) const;
+
+				/**
+				 * @brief Materializes the frames of a build.
+				 *
+				 * @param build is the name of the build.
+				 * @param policy specifies the allocation policy of the frame buffers.
+				 */
+				frame_store load(const std::string& build, const frame_alloc_policy& policy = frame_alloc_policy()) const;
+
+				/**
+				 * @brief Reconstructs the configuration bitstream of a build.
+				 *
+				 * @param build is the name of the build.
+				 * @param os is the output stream (opened in binary mode).
+				 * @param opts specifies the serializer options.
+				 */
+				void reconstruct(const std::string& build, std::ostream& os,
+					const serializer_options& opts = serializer_options()) const;
+
+				/**
+				 * @brief Reconstructs the configuration bitstream of a build into a file.
+				 *
+				 * @param build is the name of the build.
+				 * @param filename specifies the name (and path) of the output file.
+				 * @param opts specifies the serializer options.
+				 */
+				void reconstruct(const std::string& build, const std::string& filename,
+					const serializer_options& opts = serializer_options()) const;
+
+				/**
+				 * @brief Gets the number of unique frames in the archive.
+				 */
+				inline std::size_t num_unique_frames() const noexcept
+				{
+					return index_.size();
+				}
+
+				/**
+				 * @brief Gets the storage statistics of the archive (reads all manifests).
+				 */
+				archive_stats stats() const;
+
+			private:
+				/**
+				 * @brief Gets the path of the manifest of a build (validating the build name).
+				 */
+				std::filesystem::path manifest_path(const std::string& build) const;
+
+				/**
+				 * @brief Loads the frame index (dropping entries beyond the end of the pack file).
+				 */
+				void load_index();
+
+				/**
+				 * @brief Configures a serializer with the frame addresses of a manifest.
+				 */
+				static void configure(bitstream_serializer& serializer, const archive_manifest& manifest);
+
+				// Non-copyable
+				frame_archive(const frame_archive&) =delete;
+				frame_archive& operator=(const frame_archive&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_FRAME_ARCHIVE_HPP_
@@ -0,0 +1,195 @@
+/**
+ * @file
+ * @brief Page-aligned backing storage for materialized configuration frames.
+ */
+#ifndef UNBIT_XILINX_FRAME_BUFFER_HPP_
+#define UNBIT_XILINX_FRAME_BUFFER_HPP_ 1
+
+#include <cstdint>
+#include <cstddef>
+
+#include <span>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Page-aligned backing storage for materialized configuration frames.
+			 *
+			 * A materialized frame image of a large device (e.g. a 3-SLR XCVU9P) easily exceeds
+			 * 100 MB. Random access into such an image (as done by block RAM extraction and MMI
+			 * address translation) touches many distinct pages; with 4 KiB pages the TLB thrashes.
+			 * The @c frame_buffer class therefore allocates its storage directly from the operating
+			 * system (anonymous memory mappings on Linux), optionally backed by huge pages.
+			 *
+			 * Storage is never touched by the allocating thread. The first thread writing to a page
+			 * determines its NUMA placement ("first-touch" policy of the Linux kernel), which allows
+			 * callers to populate per-SLR buffers on the thread that later processes the SLR.
+			 *
+			 * Freshly allocated buffers read as zero.
+			 */
+			class frame_buffer
+			{
+			public:
+				/**
+				 * @brief Page backing modes for frame buffers.
+				 */
+				enum class page_mode : uint32_t
+				{
+					/**
+					 * @brief Regular (small) pages.
+					 */
+					standard = 0u,
+
+					/**
+					 * @brief Transparent huge pages (requested via @c madvise(MADV_HUGEPAGE)).
+					 *
+					 * The storage is aligned to the huge page size, and the kernel is advised to
+					 * back the mapping with huge pages. The kernel may silently fall back to
+					 * regular pages.
+					 */
+					transparent_huge = 1u,
+
+					/**
+					 * @brief Explicit huge pages (requested via @c MAP_HUGETLB).
+					 *
+					 * Explicit huge pages must be reserved by the system administrator (e.g. via
+					 * @c /proc/sys/vm/nr_hugepages). If the reservation is exhausted the allocation
+					 * falls back to @ref transparent_huge.
+					 */
+					explicit_huge = 2u
+				};
+
+				/**
+				 * @brief Size of a (default) huge page in bytes.
+				 */
+				static constexpr std::size_t HUGE_PAGE_SIZE = 2u * 1024u * 1024u;
+
+			private:
+				/**
+				 * @brief Start of the storage area (or nullptr for an empty buffer).
+				 */
+				uint32_t* data_;
+
+				/**
+				 * @brief Number of 32-bit words in the buffer.
+				 */
+				std::size_t num_words_;
+
+				/**
+				 * @brief Number of bytes reserved for the buffer (rounded up to the page size).
+				 */
+				std::size_t reserved_bytes_;
+
+				/**
+				 * @brief Effective page backing mode (after any fallbacks).
+				 */
+				page_mode mode_;
+
+			public:
+				/**
+				 * @brief Constructs an empty frame buffer.
+				 */
+				frame_buffer() noexcept;
+
+				/**
+				 * @brief Allocates a new (zero-initialized) frame buffer.
+				 *
+				 * @param num_words is the number of 32-bit words to allocate.
+				 * @param mode is the requested page backing mode.
+				 */
+				frame_buffer(std::size_t num_words, page_mode mode);
+
+				/**
+				 * @brief Move constructor for frame buffers.
+				 */
+				frame_buffer(frame_buffer&& other) noexcept;
+
+				/**
+				 * @brief Move assignment for frame buffers.
+				 */
+				frame_buffer& operator=(frame_buffer&& other) noexcept;
+
+				/**
+				 * @brief Releases the storage of this frame buffer.
+				 */
+				~frame_buffer();
+
+				/**
+				 * @brief Gets a pointer to the first word of the buffer.
+				 */
+				inline uint32_t* data() noexcept
+				{
+					return data_;
+				}
+
+				/**
+				 * @brief Gets a pointer to the first word of the buffer. (const)
+				 */
+				inline const uint32_t* data() const noexcept
+				{
+					return data_;
+				}
+
+				/**
+				 * @brief Gets the number of 32-bit words in the buffer.
+				 */
+				inline std::size_t size() const noexcept
+				{
+					return num_words_;
+				}
+
+				/**
+				 * @brief Gets the number of bytes reserved for the buffer (including page rounding).
+				 */
+				inline std::size_t reserved_bytes() const noexcept
+				{
+					return reserved_bytes_;
+				}
+
+				/**
+				 * @brief Gets the effective page backing mode of the buffer.
+				 *
+				 * @note The effective mode can differ from the requested mode if the system did not
+				 *   support (or had no reservation for) the requested huge pages.
+				 */
+				inline page_mode mode() const noexcept
+				{
+					return mode_;
+				}
+
+				/**
+				 * @brief Gets a span covering the words of the buffer.
+				 */
+				inline std::span<uint32_t> words() noexcept
+				{
+					return std::span<uint32_t>(data_, num_words_);
+				}
+
+				/**
+				 * @brief Gets a span covering the words of the buffer. (const)
+				 */
+				inline std::span<const uint32_t> words() const noexcept
+				{
+					return std::span<const uint32_t>(data_, num_words_);
+				}
+
+			private:
+				/**
+				 * @brief Releases the storage (if any).
+				 */
+				void release() noexcept;
+
+				// Non-copyable
+				frame_buffer(const frame_buffer&) =delete;
+				frame_buffer& operator=(const frame_buffer&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_FRAME_BUFFER_HPP_
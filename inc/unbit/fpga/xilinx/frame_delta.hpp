@@ -0,0 +1,350 @@
+/**
+ * @file
+ * @brief Frame-level delta patches between configuration bitstreams (OTA updates).
+ */
+#ifndef UNBIT_XILINX_FRAME_DELTA_HPP_
+#define UNBIT_XILINX_FRAME_DELTA_HPP_ 1
+
+#include "unbit/fpga/xilinx/bitstream_serializer.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+#include "unbit/runtime/sha256.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <istream>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Options of the @ref frame_delta_encoder.
+			 */
+			struct delta_options
+			{
+				/**
+				 * @brief Encode changed frames as run-length encoded XOR against the base frames
+				 *   (if smaller than the raw frame data).
+				 */
+				bool xor_rle = true;
+
+				/**
+				 * @brief Encode the SLRs in parallel.
+				 */
+				bool parallel = true;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Frame-level delta patch format.
+			 *
+			 * A delta patch transforms the frames of a base image into the frames of a target image
+			 * with identical geometry (frame size and number of frames per SLR). All fields are
+			 * little-endian 32-bit words:
+			 *
+			 *     magic ("UNBFDL01", 2 words), frame_words, num_slrs,
+			 *     per SLR: num_frames, num_records, section_words,
+			 *     base image digest (8 words), target image digest (8 words),
+			 *     per SLR: section (records of the SLR in ascending frame order),
+			 *     CRC
+			 *
+			 * Each record replaces a run of consecutive frames:
+			 *
+			 *     first_frame, num_frames, frame_address, (encoding << 28) | payload_words, payload
+			 *
+			 * The frame address is the FAR of the first frame of the run (or
+			 * @ref bitstream_serializer::NO_FRAME_ADDRESS if unknown); records are applied by their
+			 * linear frame index. The payload either holds the target frame data (@ref ENCODING_RAW),
+			 * or the XOR of target and base frame data as a sequence of tokens
+			 * <tt>(zero_words << 16) | literal_words</tt>, each followed by its literal words
+			 * (@ref ENCODING_XOR_RLE).
+			 *
+			 * The image digests are the SHA-256 digests of the per-SLR frame data digests (cf.
+			 * @ref image_digest), the final CRC is the configuration CRC (@ref config_crc) of all
+			 * preceding words (taken as FDRI writes).
+			 */
+			class frame_delta
+			{
+			public:
+				/**
+				 * @brief Payload holds the target frame data.
+				 */
+				static constexpr uint32_t ENCODING_RAW = 0u;
+
+				/**
+				 * @brief Payload holds the run-length encoded XOR of target and base frame data.
+				 */
+				static constexpr uint32_t ENCODING_XOR_RLE = 1u;
+
+				/**
+				 * @brief Computes the image digest of a frame store.
+				 *
+				 * @param frames specifies the frame data.
+				 */
+				static runtime::sha256::digest image_digest(const frame_store& frames);
+
+				/**
+				 * @brief Computes the image digest from the per-SLR frame data digests.
+				 *
+				 * @param slr_digests specifies the SHA-256 digests of the frame data of each SLR (words
+				 *   in big-endian byte order).
+				 */
+				static runtime::sha256::digest image_digest(std::span<const runtime::sha256::digest> slr_digests);
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Encoder for frame-level delta patches (cf. @ref frame_delta).
+			 *
+			 * Frames are compared word by word; runs of consecutive changed frames become one record.
+			 * The sections of the SLRs (and the digests of their frame data) are computed
+			 * independently, in parallel if enabled.
+			 */
+			class frame_delta_encoder
+			{
+			private:
+				/**
+				 * @brief The base frames.
+				 */
+				const frame_store& base_;
+
+				/**
+				 * @brief The target frames.
+				 */
+				const frame_store& target_;
+
+				/**
+				 * @brief Encoder options.
+				 */
+				delta_options options_;
+
+				/**
+				 * @brief Frame address maps of the SLRs (empty if unknown).
+				 */
+				std::vector<std::vector<uint32_t>> frame_addresses_;
+
+				/**
+				 * @brief Number of records written by the last encoding.
+				 */
+				std::size_t num_records_;
+
+				/**
+				 * @brief Number of changed frames found by the last encoding.
+				 */
+				std::size_t num_changed_frames_;
+
+				/**
+				 * @brief Size (in bytes) of the delta written by the last encoding.
+				 */
+				uint64_t size_;
+
+			public:
+				/**
+				 * @brief Constructs an encoder for a pair of frame stores.
+				 *
+				 * @param base specifies the base frames.
+				 * @param target specifies the target frames (same geometry as the base frames).
+				 * @param opts specifies the encoder options.
+				 */
+				frame_delta_encoder(const frame_store& base, const frame_store& target,
+					const delta_options& opts = delta_options());
+
+				/**
+				 * @brief Destroys the encoder.
+				 */
+				~frame_delta_encoder();
+
+				/**
+				 * @brief Sets the frame address map of an SLR (recorded in the delta records).
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param addresses specifies the frame address (FAR) of each frame of the SLR (cf.
+				 *   @ref bitstream_serializer::slr_config::frame_addresses).
+				 */
+				void set_frame_addresses(std::size_t slr, std::vector<uint32_t> addresses);
+
+				/**
+				 * @brief Encodes the delta.
+				 *
+				 * @param os is the output stream (opened in binary mode).
+				 */
+				void encode(std::ostream& os);
+
+				/**
+				 * @brief Gets the number of records written by the last encoding.
+				 */
+				inline std::size_t num_records() const noexcept
+				{
+					return num_records_;
+				}
+
+				/**
+				 * @brief Gets the number of changed frames found by the last encoding.
+				 */
+				inline std::size_t num_changed_frames() const noexcept
+				{
+					return num_changed_frames_;
+				}
+
+				/**
+				 * @brief Gets the size (in bytes) of the delta written by the last encoding.
+				 */
+				inline uint64_t size() const noexcept
+				{
+					return size_;
+				}
+
+			private:
+				// Non-copyable
+				frame_delta_encoder(const frame_delta_encoder&) =delete;
+				frame_delta_encoder& operator=(const frame_delta_encoder&) =delete;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Decoder for frame-level delta patches (cf. @ref frame_delta).
+			 *
+			 * Opening a delta reads its header and checks the CRC of the complete delta (in a
+			 * streaming pass), so that a corrupted delta is rejected before any output is produced.
+			 *
+			 * The streaming @ref apply method copies a base bitstream to the output, replacing the
+			 * frame data of the FDRI writes and the values of the CRC checks (the base bitstream's CRC
+			 * checks are verified on the way). Apart from fixed-size I/O buffers, one frame and the
+			 * digest states, no memory is allocated, regardless of the size of the bitstream. The
+			 * base bitstream is read sequentially (it may be a pipe), the delta stream must be
+			 * seekable.
+			 */
+			class frame_delta_decoder
+			{
+			public:
+				/**
+				 * @brief Per-SLR section of the delta.
+				 */
+				struct slr_section
+				{
+					/** @brief Number of frames of the SLR. */
+					std::size_t num_frames = 0u;
+
+					/** @brief Number of records of the SLR. */
+					std::size_t num_records = 0u;
+
+					/** @brief Offset (in bytes) of the section in the delta. */
+					uint64_t offset = 0u;
+
+					/** @brief Size (in words) of the section. */
+					uint64_t words = 0u;
+				};
+
+			private:
+				/**
+				 * @brief Input stream with the delta.
+				 */
+				std::istream& delta_;
+
+				/**
+				 * @brief Stream position of the start of the delta.
+				 */
+				uint64_t origin_;
+
+				/**
+				 * @brief Number of 32-bit words per frame.
+				 */
+				std::size_t frame_words_;
+
+				/**
+				 * @brief Sections of the SLRs (in configuration order).
+				 */
+				std::vector<slr_section> slrs_;
+
+				/**
+				 * @brief Digest of the base image.
+				 */
+				runtime::sha256::digest base_digest_;
+
+				/**
+				 * @brief Digest of the target image.
+				 */
+				runtime::sha256::digest target_digest_;
+
+			public:
+				/**
+				 * @brief Opens a delta (and checks its CRC).
+				 *
+				 * @param delta is the (seekable) input stream, opened in binary mode.
+				 */
+				explicit frame_delta_decoder(std::istream& delta);
+
+				/**
+				 * @brief Destroys the decoder.
+				 */
+				~frame_delta_decoder();
+
+				/**
+				 * @brief Gets the number of 32-bit words per frame.
+				 */
+				inline std::size_t frame_words() const noexcept
+				{
+					return frame_words_;
+				}
+
+				/**
+				 * @brief Gets the sections of the SLRs (in configuration order).
+				 */
+				inline const std::vector<slr_section>& slrs() const noexcept
+				{
+					return slrs_;
+				}
+
+				/**
+				 * @brief Gets the digest of the base image.
+				 */
+				inline const runtime::sha256::digest& base_digest() const noexcept
+				{
+					return base_digest_;
+				}
+
+				/**
+				 * @brief Gets the digest of the target image.
+				 */
+				inline const runtime::sha256::digest& target_digest() const noexcept
+				{
+					return target_digest_;
+				}
+
+				/**
+				 * @brief Applies the delta to a frame store (in place).
+				 *
+				 * @param frames specifies the base frames (replaced by the target frames).
+				 */
+				void apply(frame_store& frames);
+
+				/**
+				 * @brief Applies the delta to a base bitstream (streaming).
+				 *
+				 * The base bitstream must be uncompressed (one FDRI write per SLR, no MFWR writes).
+				 * The image digests are checked at the end of the base bitstream; a mismatch throws a
+				 * @ref bitstream_error after the output has been written (callers should write the
+				 * output to a temporary file).
+				 *
+				 * @param base is the input stream with the base bitstream (opened in binary mode).
+				 * @param output is the output stream (opened in binary mode).
+				 */
+				void apply(std::istream& base, std::ostream& output);
+
+			private:
+				// Non-copyable
+				frame_delta_decoder(const frame_delta_decoder&) =delete;
+				frame_delta_decoder& operator=(const frame_delta_decoder&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_FRAME_DELTA_HPP_
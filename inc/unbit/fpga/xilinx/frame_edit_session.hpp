@@ -0,0 +1,244 @@
+/**
+ * @file
+ * @brief Transactional edit sessions on materialized configuration frames.
+ */
+#ifndef UNBIT_XILINX_FRAME_EDIT_SESSION_HPP_
+#define UNBIT_XILINX_FRAME_EDIT_SESSION_HPP_ 1
+
+#include "unbit/fpga/xilinx/frame_store.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <span>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Transactional edit session on a frame store.
+			 *
+			 * Edit sessions apply modifications directly to the frames of a @ref frame_store, and record
+			 * the original content of each modified word range in an undo journal. Committing a session
+			 * discards the journal, rolling back a session restores the journaled words (in reverse
+			 * order). Both operations cost O(edited words), independent of the size of the frame store.
+			 *
+			 * Savepoints mark positions in the journal and can be nested. Rolling back to a savepoint
+			 * undoes all modifications made after the savepoint was set, releasing a savepoint keeps
+			 * the modifications (as part of the enclosing savepoint or session).
+			 *
+			 * Modifications that bypass the session (e.g. direct writes via @ref frame_store::words)
+			 * are not journaled. A session that is destroyed without being committed is rolled back.
+			 */
+			class frame_edit_session
+			{
+			public:
+				/**
+				 * @brief Identifies a savepoint of an edit session.
+				 */
+				typedef std::size_t savepoint_id;
+
+			private:
+				/**
+				 * @brief Journal entry (original content of a contiguous word range).
+				 */
+				struct journal_entry
+				{
+					/**
+					 * @brief SLR index of the modified range.
+					 */
+					std::size_t slr;
+
+					/**
+					 * @brief Word offset (relative to the start of the SLR's frame data).
+					 */
+					std::size_t offset;
+
+					/**
+					 * @brief Number of words in the range.
+					 */
+					std::size_t count;
+
+					/**
+					 * @brief Position of the original words in the undo buffer.
+					 */
+					std::size_t undo_pos;
+				};
+
+				/**
+				 * @brief Frame store being edited.
+				 */
+				frame_store& store_;
+
+				/**
+				 * @brief Undo journal (in modification order).
+				 */
+				std::vector<journal_entry> journal_;
+
+				/**
+				 * @brief Original words of the journaled ranges.
+				 */
+				std::vector<uint32_t> undo_;
+
+				/**
+				 * @brief Journal positions of the active savepoints (innermost savepoint last).
+				 */
+				std::vector<std::size_t> savepoints_;
+
+			public:
+				/**
+				 * @brief Starts a new edit session on a frame store.
+				 *
+				 * @param store is the frame store to be edited.
+				 */
+				explicit frame_edit_session(frame_store& store);
+
+				/**
+				 * @brief Destroys the edit session (pending modifications are rolled back).
+				 */
+				~frame_edit_session();
+
+				/**
+				 * @brief Gets the frame store being edited.
+				 */
+				inline const frame_store& store() const noexcept
+				{
+					return store_;
+				}
+
+				/**
+				 * @brief Gets the number of original words held by the undo journal.
+				 */
+				inline std::size_t journal_words() const noexcept
+				{
+					return undo_.size();
+				}
+
+				/**
+				 * @brief Gets the number of active savepoints.
+				 */
+				inline std::size_t num_savepoints() const noexcept
+				{
+					return savepoints_.size();
+				}
+
+				/**
+				 * @brief Prepares a word range for modification.
+				 *
+				 * The original content of the range is recorded in the journal before the range is
+				 * returned to the caller.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param word_offset is the word offset relative to the start of the SLR's frame data.
+				 * @param num_words is the number of words to be modified.
+				 *
+				 * @return A span covering the (writable) word range.
+				 */
+				std::span<uint32_t> modify(std::size_t slr, std::size_t word_offset, std::size_t num_words);
+
+				/**
+				 * @brief Prepares a frame for modification.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param frame is the linear index of the frame within the SLR.
+				 *
+				 * @return A span covering the (writable) frame data.
+				 */
+				std::span<uint32_t> modify_frame(std::size_t slr, std::size_t frame);
+
+				/**
+				 * @brief Writes a word range.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param word_offset is the word offset relative to the start of the SLR's frame data.
+				 * @param data specifies the new content of the word range.
+				 */
+				void write_words(std::size_t slr, std::size_t word_offset, std::span<const uint32_t> data);
+
+				/**
+				 * @brief Writes a single word.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param word_offset is the word offset relative to the start of the SLR's frame data.
+				 * @param value is the new value of the word.
+				 */
+				void write_word(std::size_t slr, std::size_t word_offset, uint32_t value);
+
+				/**
+				 * @brief Writes a single bit (the journal is not touched if the bit is unchanged).
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param bit_offset is the bit offset relative to the start of the SLR's frame data.
+				 * @param value is the new value of the bit.
+				 */
+				void write_bit(std::size_t slr, std::size_t bit_offset, bool value);
+
+				/**
+				 * @brief Sets a new (nested) savepoint.
+				 *
+				 * @return The identifier of the new savepoint.
+				 */
+				savepoint_id set_savepoint();
+
+				/**
+				 * @brief Undoes all modifications made after a savepoint.
+				 *
+				 * The savepoint itself remains active; any savepoints nested inside are discarded.
+				 *
+				 * @param sp is the savepoint to roll back to.
+				 */
+				void rollback_to(savepoint_id sp);
+
+				/**
+				 * @brief Releases a savepoint (and any nested savepoints) keeping all modifications.
+				 *
+				 * @param sp is the savepoint to be released.
+				 */
+				void release(savepoint_id sp);
+
+				/**
+				 * @brief Commits all modifications of this session.
+				 *
+				 * The journal and all savepoints are discarded. The session remains usable for
+				 * further modifications.
+				 */
+				void commit() noexcept;
+
+				/**
+				 * @brief Rolls back all modifications of this session.
+				 *
+				 * The journal and all savepoints are discarded. The session remains usable for
+				 * further modifications.
+				 */
+				void rollback() noexcept;
+
+			private:
+				/**
+				 * @brief Records the original content of a word range in the journal.
+				 */
+				void journal(std::size_t slr, std::size_t word_offset, std::size_t num_words);
+
+				/**
+				 * @brief Restores journal entries (in reverse order) down to the given journal size.
+				 */
+				void undo_to(std::size_t journal_size) noexcept;
+
+				/**
+				 * @brief Validates a savepoint identifier.
+				 */
+				void check_savepoint(savepoint_id sp) const;
+
+				// Non-copyable
+				frame_edit_session(const frame_edit_session&) =delete;
+				frame_edit_session& operator=(const frame_edit_session&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_FRAME_EDIT_SESSION_HPP_
@@ -0,0 +1,255 @@
+/**
+ * @file
+ * @brief Merkle trees over the frame digests of a build (equality checks and difference search).
+ */
+#ifndef UNBIT_XILINX_FRAME_MERKLE_HPP_
+#define UNBIT_XILINX_FRAME_MERKLE_HPP_ 1
+
+#include "unbit/fpga/xilinx/frame_store.hpp"
+#include "unbit/runtime/sha256.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			struct archive_manifest;
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Binary Merkle tree over the frame digests of an SLR.
+			 *
+			 * Level 0 holds the leaves (the SHA-256 digests of the frames, as in an
+			 * @ref archive_manifest), each following level combines pairs of nodes
+			 * (@ref combine); the last node of a level with an odd number of nodes is promoted
+			 * unchanged. The top level holds the root. A tree without leaves has the digest of the
+			 * empty message as root.
+			 *
+			 * Two trees with the same number of leaves have the same shape, so differing frames are
+			 * found by descending from differing roots into differing children only.
+			 */
+			class merkle_tree
+			{
+			public:
+				/**
+				 * @brief Digest type of the nodes.
+				 */
+				using node_hash = runtime::sha256::digest;
+
+			private:
+				/**
+				 * @brief Nodes of all levels (leaves first, root last).
+				 */
+				std::vector<node_hash> nodes_;
+
+				/**
+				 * @brief Offset of the first node of each level (plus the end).
+				 */
+				std::vector<std::size_t> levels_;
+
+			public:
+				/**
+				 * @brief Constructs a tree without leaves.
+				 */
+				merkle_tree();
+
+				/**
+				 * @brief Constructs a tree over the given leaves.
+				 *
+				 * @param leaves specifies the frame digests (linear frame order).
+				 */
+				explicit merkle_tree(std::span<const node_hash> leaves);
+
+				/**
+				 * @brief Destroys the tree.
+				 */
+				~merkle_tree();
+
+				/**
+				 * @brief Gets the number of leaves.
+				 */
+				inline std::size_t num_leaves() const noexcept
+				{
+					return levels_[1u] - levels_[0u];
+				}
+
+				/**
+				 * @brief Gets the number of levels (including the leaves and the root).
+				 */
+				inline std::size_t num_levels() const noexcept
+				{
+					return levels_.size() - 1u;
+				}
+
+				/**
+				 * @brief Gets the number of nodes of a level.
+				 *
+				 * @param level is the level (0 for the leaves).
+				 */
+				std::size_t level_size(std::size_t level) const;
+
+				/**
+				 * @brief Gets a node.
+				 *
+				 * @param level is the level (0 for the leaves).
+				 * @param index is the index of the node within its level.
+				 */
+				const node_hash& node(std::size_t level, std::size_t index) const;
+
+				/**
+				 * @brief Gets the leaves.
+				 */
+				inline std::span<const node_hash> leaves() const noexcept
+				{
+					return std::span<const node_hash>(nodes_.data(), num_leaves());
+				}
+
+				/**
+				 * @brief Gets the root.
+				 */
+				inline const node_hash& root() const noexcept
+				{
+					return nodes_.back();
+				}
+
+				/**
+				 * @brief Gets the nodes of all levels (leaves first, root last).
+				 */
+				inline const std::vector<node_hash>& nodes() const noexcept
+				{
+					return nodes_;
+				}
+
+				/**
+				 * @brief Combines two child nodes into their parent node.
+				 *
+				 * @param left is the left child.
+				 * @param right is the right child.
+				 *
+				 * @return The SHA-256 digest of a 0x01 byte followed by both children.
+				 */
+				static node_hash combine(const node_hash& left, const node_hash& right) noexcept;
+
+				/**
+				 * @brief Finds the leaves that differ between two trees of the same shape.
+				 *
+				 * @param a is the first tree.
+				 * @param b is the second tree (same number of leaves).
+				 *
+				 * @return The indices of the differing leaves (ascending).
+				 */
+				static std::vector<std::size_t> diff(const merkle_tree& a, const merkle_tree& b);
+
+			private:
+				friend class frame_merkle;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Merkle trees of all SLRs of a build.
+			 *
+			 * The on-disk format is a little-endian file with the magic number "UNBMKL01", the frame
+			 * size and the number of SLRs, followed by the number of leaves and the nodes of each
+			 * tree (leaves first). The build root (@ref root) is derived from the SLR roots.
+			 */
+			class frame_merkle
+			{
+			private:
+				/**
+				 * @brief Number of 32-bit words per frame.
+				 */
+				std::size_t frame_words_;
+
+				/**
+				 * @brief Trees of the SLRs (in configuration order).
+				 */
+				std::vector<merkle_tree> slrs_;
+
+			public:
+				/**
+				 * @brief Constructs the trees of an empty build.
+				 */
+				frame_merkle();
+
+				/**
+				 * @brief Constructs the trees from per-SLR trees.
+				 *
+				 * @param frame_words is the number of 32-bit words per frame.
+				 * @param slrs specifies the trees of the SLRs (in configuration order).
+				 */
+				frame_merkle(std::size_t frame_words, std::vector<merkle_tree> slrs);
+
+				/**
+				 * @brief Constructs the trees of a build from its frame data.
+				 *
+				 * @param frames specifies the frame data.
+				 */
+				explicit frame_merkle(const frame_store& frames);
+
+				/**
+				 * @brief Constructs the trees of an archived build (no frame data is read).
+				 *
+				 * @param manifest is the manifest of the build.
+				 */
+				explicit frame_merkle(const archive_manifest& manifest);
+
+				/**
+				 * @brief Destroys the trees.
+				 */
+				~frame_merkle();
+
+				/**
+				 * @brief Gets the number of 32-bit words per frame.
+				 */
+				inline std::size_t frame_words() const noexcept
+				{
+					return frame_words_;
+				}
+
+				/**
+				 * @brief Gets the number of SLRs.
+				 */
+				inline std::size_t num_slrs() const noexcept
+				{
+					return slrs_.size();
+				}
+
+				/**
+				 * @brief Gets the tree of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				const merkle_tree& slr(std::size_t slr) const;
+
+				/**
+				 * @brief Gets the root of the build (digest of the frame size and the SLR roots).
+				 */
+				merkle_tree::node_hash root() const;
+
+				/**
+				 * @brief Saves the trees to a file (atomically replacing an existing file).
+				 *
+				 * @param filename specifies the name (and path) of the file.
+				 */
+				void save(const std::string& filename) const;
+
+				/**
+				 * @brief Loads the trees from a file.
+				 *
+				 * @param filename specifies the name (and path) of the file.
+				 */
+				static frame_merkle load(const std::string& filename);
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_FRAME_MERKLE_HPP_
@@ -0,0 +1,261 @@
+/**
+ * @file
+ * @brief Similarity sketches of configuration frame data (nearest-build search).
+ */
+#ifndef UNBIT_XILINX_FRAME_SKETCH_HPP_
+#define UNBIT_XILINX_FRAME_SKETCH_HPP_ 1
+
+#include "unbit/fpga/xilinx/frame_archive.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Bottom-k (MinHash) sketch of the frames of a build.
+			 *
+			 * Each frame contributes one element, derived from its position (SLR and linear frame index)
+			 * and the SHA-256 digest of its content (cf. @ref archive_manifest). The sketch keeps the
+			 * @c k smallest element hashes, which estimates both the Jaccard similarity of two builds
+			 * (the fraction of frames with identical content at identical positions, relative to all
+			 * distinct frames of the pair) and the number of distinct elements.
+			 *
+			 * Sketches are independent of the source of the frame data: Bitstreams, readback data
+			 * (converted to frames) and archived manifests yield comparable sketches, as long as the
+			 * sketch sizes match.
+			 */
+			class frame_sketch
+			{
+			public:
+				/**
+				 * @brief Default number of element hashes kept by a sketch.
+				 */
+				static constexpr std::size_t DEFAULT_SIZE = 256u;
+
+			private:
+				/**
+				 * @brief Number of element hashes kept by the sketch.
+				 */
+				std::size_t size_;
+
+				/**
+				 * @brief Smallest element hashes seen so far (max-heap).
+				 */
+				std::vector<uint64_t> heap_;
+
+			public:
+				/**
+				 * @brief Constructs an empty sketch.
+				 *
+				 * @param size specifies the number of element hashes kept by the sketch.
+				 */
+				explicit frame_sketch(std::size_t size = DEFAULT_SIZE);
+
+				/**
+				 * @brief Destroys the sketch.
+				 */
+				~frame_sketch();
+
+				/**
+				 * @brief Gets the number of element hashes kept by the sketch.
+				 */
+				inline std::size_t size() const noexcept
+				{
+					return size_;
+				}
+
+				/**
+				 * @brief Adds a frame to the sketch.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param frame_index is the linear index of the frame within the SLR.
+				 * @param content_hash is the (64-bit) content hash of the frame (cf. @ref content_hash).
+				 */
+				void add(uint32_t slr, std::size_t frame_index, uint64_t content_hash);
+
+				/**
+				 * @brief Adds all frames of a frame store.
+				 *
+				 * @param frames specifies the frame data.
+				 */
+				void add(const frame_store& frames);
+
+				/**
+				 * @brief Adds all frames of an archived build (no frame data is read).
+				 *
+				 * @param manifest is the manifest of the build.
+				 */
+				void add(const archive_manifest& manifest);
+
+				/**
+				 * @brief Gets the signature of the sketch (the element hashes in ascending order).
+				 */
+				std::vector<uint64_t> signature() const;
+
+				/**
+				 * @brief Computes the 64-bit content hash of a frame (prefix of its SHA-256 digest).
+				 *
+				 * @param frame specifies the data words of the frame.
+				 */
+				static uint64_t content_hash(std::span<const uint32_t> frame) noexcept;
+
+				/**
+				 * @brief Computes the 64-bit content hash of a frame from its SHA-256 digest.
+				 *
+				 * @param digest is the SHA-256 digest of the frame (big-endian words).
+				 */
+				static uint64_t content_hash(const runtime::sha256::digest& digest) noexcept;
+
+				/**
+				 * @brief Estimates the Jaccard similarity of two signatures.
+				 *
+				 * @param a is the first signature (ascending order).
+				 * @param b is the second signature (ascending order).
+				 * @param size is the sketch size of the signatures.
+				 *
+				 * @return The estimated similarity (0.0 to 1.0).
+				 */
+				static double similarity(std::span<const uint64_t> a, std::span<const uint64_t> b, std::size_t size) noexcept;
+
+				/**
+				 * @brief Estimates the number of distinct elements of a signature.
+				 *
+				 * @param sig is the signature (ascending order).
+				 * @param size is the sketch size of the signature.
+				 */
+				static double cardinality(std::span<const uint64_t> sig, std::size_t size) noexcept;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Match of a nearest-build query.
+			 */
+			struct sketch_match
+			{
+				/** @brief Name of the build. */
+				std::string name;
+
+				/** @brief Estimated Jaccard similarity to the query (0.0 to 1.0). */
+				double similarity;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Index of build signatures for nearest-build queries.
+			 *
+			 * The signatures are stored as one contiguous array (fixed stride), so a query is a linear
+			 * merge over all entries; with the default sketch size this takes about a microsecond per
+			 * indexed build.
+			 *
+			 * The on-disk format is a little-endian file with the magic number "UNBSKX01", the sketch
+			 * size and the number of entries, followed by the entries (name length, name, signature
+			 * length and signature values).
+			 */
+			class sketch_index
+			{
+			private:
+				/**
+				 * @brief Sketch size of all signatures.
+				 */
+				std::size_t size_;
+
+				/**
+				 * @brief Names of the indexed builds.
+				 */
+				std::vector<std::string> names_;
+
+				/**
+				 * @brief Signatures (fixed stride of @c size_ values, unused values are all-ones).
+				 */
+				std::vector<uint64_t> values_;
+
+				/**
+				 * @brief Signature lengths.
+				 */
+				std::vector<uint32_t> lengths_;
+
+			public:
+				/**
+				 * @brief Constructs an empty index.
+				 *
+				 * @param size specifies the sketch size of the signatures.
+				 */
+				explicit sketch_index(std::size_t size = frame_sketch::DEFAULT_SIZE);
+
+				/**
+				 * @brief Destroys the index.
+				 */
+				~sketch_index();
+
+				/**
+				 * @brief Gets the sketch size of the signatures.
+				 */
+				inline std::size_t size() const noexcept
+				{
+					return size_;
+				}
+
+				/**
+				 * @brief Gets the number of indexed builds.
+				 */
+				inline std::size_t num_entries() const noexcept
+				{
+					return names_.size();
+				}
+
+				/**
+				 * @brief Gets the names of the indexed builds (in insertion order).
+				 */
+				inline const std::vector<std::string>& names() const noexcept
+				{
+					return names_;
+				}
+
+				/**
+				 * @brief Adds (or replaces) the signature of a build.
+				 *
+				 * @param name is the name of the build.
+				 * @param sketch is the sketch of the build (its size must match the index).
+				 */
+				void add(const std::string& name, const frame_sketch& sketch);
+
+				/**
+				 * @brief Finds the builds most similar to a sketch.
+				 *
+				 * @param sketch is the query sketch (its size must match the index).
+				 * @param k specifies the maximum number of matches.
+				 *
+				 * @return The best matches (in descending order of similarity).
+				 */
+				std::vector<sketch_match> nearest(const frame_sketch& sketch, std::size_t k) const;
+
+				/**
+				 * @brief Saves the index to a file (atomically replacing an existing file).
+				 *
+				 * @param filename specifies the name (and path) of the index file.
+				 */
+				void save(const std::string& filename) const;
+
+				/**
+				 * @brief Loads an index from a file.
+				 *
+				 * @param filename specifies the name (and path) of the index file.
+				 */
+				static sketch_index load(const std::string& filename);
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_FRAME_SKETCH_HPP_
@@ -0,0 +1,259 @@
+/**
+ * @file
+ * @brief Materialized configuration frames of a (multi-SLR) Xilinx FPGA.
+ */
+#ifndef UNBIT_XILINX_FRAME_STORE_HPP_
+#define UNBIT_XILINX_FRAME_STORE_HPP_ 1
+
+#include "unbit/fpga/xilinx/frame_buffer.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Allocation policy for frame stores.
+			 */
+			struct frame_alloc_policy
+			{
+				/**
+				 * @brief Page backing mode for the per-SLR frame buffers.
+				 */
+				frame_buffer::page_mode pages = frame_buffer::page_mode::standard;
+
+				/**
+				 * @brief Populate the frame buffer of each SLR on a dedicated thread.
+				 *
+				 * The Linux kernel places anonymous memory on the NUMA node of the thread that first
+				 * touches a page. Populating each SLR on its own thread spreads the frame data of
+				 * multi-SLR devices over the nodes the populating threads run on (instead of placing
+				 * all frames on the node of the loading thread).
+				 */
+				bool first_touch = false;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Materialized configuration frames of a (multi-SLR) Xilinx FPGA.
+			 *
+			 * The @c frame_store class holds the configuration frames of each SLR of a device in a
+			 * contiguous, page-aligned @ref frame_buffer. Frames are addressed by their linear index
+			 * within the SLR (in the order in which they appear in the FDRI payload of an uncompressed
+			 * bitstream). Frame data words are stored in native byte order, i.e. bit @c b of the frame
+			 * data of an SLR refers to bit @c (b%32) of word @c (b/32).
+			 */
+			class frame_store
+			{
+			public:
+				/**
+				 * @brief Per-SLR frame data.
+				 */
+				struct slr_frames
+				{
+					/**
+					 * @brief Backing storage for the frames of this SLR.
+					 */
+					frame_buffer data;
+
+					/**
+					 * @brief Number of frames in this SLR.
+					 */
+					std::size_t num_frames = 0u;
+
+					/**
+					 * @brief IDCODE of this SLR (if known).
+					 */
+					std::optional<uint32_t> idcode;
+				};
+
+			private:
+				/**
+				 * @brief Number of 32-bit words per frame.
+				 */
+				std::size_t frame_words_;
+
+				/**
+				 * @brief Allocation policy used for the frame buffers.
+				 */
+				frame_alloc_policy policy_;
+
+				/**
+				 * @brief Frame data of the SLRs (in configuration order).
+				 */
+				std::vector<slr_frames> slrs_;
+
+			public:
+				/**
+				 * @brief Constructs an empty frame store.
+				 */
+				frame_store() noexcept;
+
+				/**
+				 * @brief Constructs a new (zero-initialized) frame store.
+				 *
+				 * @param frame_words is the number of 32-bit words per frame.
+				 * @param frames_per_slr specifies the number of frames of each SLR (in configuration order).
+				 * @param policy specifies the allocation policy of the frame buffers.
+				 */
+				frame_store(std::size_t frame_words, std::span<const std::size_t> frames_per_slr,
+					const frame_alloc_policy& policy = frame_alloc_policy());
+
+				/**
+				 * @brief Move constructor for frame stores.
+				 */
+				frame_store(frame_store&& other) noexcept;
+
+				/**
+				 * @brief Move assignment for frame stores.
+				 */
+				frame_store& operator=(frame_store&& other) noexcept;
+
+				/**
+				 * @brief Destroys the frame store.
+				 */
+				~frame_store();
+
+				/**
+				 * @brief Loads the frames of an (uncompressed) configuration bitstream.
+				 *
+				 * The FDRI payload of each SLR is copied into a frame buffer allocated according to the
+				 * given policy. The bitstream data must be given in native byte order (as processed by
+				 * the @ref bitstream_engine).
+				 *
+				 * @param cfg_data specifies the configuration bitstream data.
+				 * @param frame_words is the number of 32-bit words per frame.
+				 * @param policy specifies the allocation policy of the frame buffers.
+				 *
+				 * @return The loaded frame store.
+				 */
+				static frame_store load(std::span<const uint32_t> cfg_data, std::size_t frame_words,
+					const frame_alloc_policy& policy = frame_alloc_policy());
+
+				/**
+				 * @brief Gets the number of 32-bit words per frame.
+				 */
+				inline std::size_t frame_words() const noexcept
+				{
+					return frame_words_;
+				}
+
+				/**
+				 * @brief Gets the allocation policy of this frame store.
+				 */
+				inline const frame_alloc_policy& policy() const noexcept
+				{
+					return policy_;
+				}
+
+				/**
+				 * @brief Gets the number of SLRs in this frame store.
+				 */
+				inline std::size_t num_slrs() const noexcept
+				{
+					return slrs_.size();
+				}
+
+				/**
+				 * @brief Gets the number of frames of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				std::size_t num_frames(std::size_t slr) const;
+
+				/**
+				 * @brief Gets the IDCODE of an SLR (if known).
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				const std::optional<uint32_t>& idcode(std::size_t slr) const;
+
+				/**
+				 * @brief Sets the IDCODE of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param new_idcode is the new IDCODE value.
+				 */
+				void set_idcode(std::size_t slr, uint32_t new_idcode);
+
+				/**
+				 * @brief Gets the frame data words of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				std::span<uint32_t> words(std::size_t slr);
+
+				/**
+				 * @brief Gets the frame data words of an SLR. (const)
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				std::span<const uint32_t> words(std::size_t slr) const;
+
+				/**
+				 * @brief Gets the data words of a single frame.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param frame is the linear index of the frame within the SLR.
+				 */
+				std::span<uint32_t> frame(std::size_t slr, std::size_t frame);
+
+				/**
+				 * @brief Gets the data words of a single frame. (const)
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param frame is the linear index of the frame within the SLR.
+				 */
+				std::span<const uint32_t> frame(std::size_t slr, std::size_t frame) const;
+
+				/**
+				 * @brief Reads a bit from the frame data of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param bit_offset is the bit offset relative to the start of the SLR's frame data.
+				 */
+				bool read_bit(std::size_t slr, std::size_t bit_offset) const;
+
+				/**
+				 * @brief Writes a bit in the frame data of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param bit_offset is the bit offset relative to the start of the SLR's frame data.
+				 * @param value is the new value of the bit.
+				 */
+				void write_bit(std::size_t slr, std::size_t bit_offset, bool value);
+
+				/**
+				 * @brief Gets the total number of bytes reserved for frame data (all SLRs).
+				 */
+				std::size_t reserved_bytes() const noexcept;
+
+			private:
+				/**
+				 * @brief Gets the frame data of an SLR (with range checking).
+				 */
+				const slr_frames& get_slr(std::size_t slr) const;
+
+				/**
+				 * @brief Gets the frame data of an SLR (with range checking).
+				 */
+				slr_frames& get_slr(std::size_t slr);
+
+				// Non-copyable
+				frame_store(const frame_store&) =delete;
+				frame_store& operator=(const frame_store&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_FRAME_STORE_HPP_
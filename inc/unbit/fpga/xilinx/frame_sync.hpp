@@ -0,0 +1,378 @@
+/**
+ * @file
+ * @brief Synchronization of archived builds between hosts (Merkle tree walk over a byte stream).
+ */
+#ifndef UNBIT_XILINX_FRAME_SYNC_HPP_
+#define UNBIT_XILINX_FRAME_SYNC_HPP_ 1
+
+#include "unbit/fpga/xilinx/frame_archive.hpp"
+#include "unbit/fpga/xilinx/frame_merkle.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Message channel over a pair of file descriptors (pipes or a socket).
+			 *
+			 * Each message is framed by its type and payload size (little-endian 32-bit words),
+			 * followed by the payload. File descriptors are only available on POSIX platforms;
+			 * elsewhere, sending and receiving throws a @c std::runtime_error.
+			 */
+			class sync_channel
+			{
+			public:
+				/**
+				 * @brief Maximum payload size of a message (in bytes).
+				 */
+				static constexpr uint32_t MAX_PAYLOAD_SIZE = 64u * 1024u * 1024u;
+
+			private:
+				/**
+				 * @brief File descriptor to read from.
+				 */
+				int in_fd_;
+
+				/**
+				 * @brief File descriptor to write to.
+				 */
+				int out_fd_;
+
+				/**
+				 * @brief Number of bytes sent.
+				 */
+				uint64_t bytes_sent_;
+
+				/**
+				 * @brief Number of bytes received.
+				 */
+				uint64_t bytes_received_;
+
+			public:
+				/**
+				 * @brief Constructs a channel (the file descriptors remain owned by the caller).
+				 *
+				 * @param in_fd is the file descriptor to read from.
+				 * @param out_fd is the file descriptor to write to (may be the same as @p in_fd).
+				 */
+				sync_channel(int in_fd, int out_fd) noexcept;
+
+				/**
+				 * @brief Destroys the channel.
+				 */
+				~sync_channel();
+
+				/**
+				 * @brief Sends a message.
+				 *
+				 * @param type is the message type.
+				 * @param payload specifies the payload.
+				 */
+				void send(uint32_t type, std::span<const uint8_t> payload);
+
+				/**
+				 * @brief Receives a message.
+				 *
+				 * @param type receives the message type.
+				 * @param payload receives the payload.
+				 *
+				 * @return @c false if the peer closed the channel (before the start of a message).
+				 */
+				bool receive(uint32_t& type, std::vector<uint8_t>& payload);
+
+				/**
+				 * @brief Gets the number of bytes sent.
+				 */
+				inline uint64_t bytes_sent() const noexcept
+				{
+					return bytes_sent_;
+				}
+
+				/**
+				 * @brief Gets the number of bytes received.
+				 */
+				inline uint64_t bytes_received() const noexcept
+				{
+					return bytes_received_;
+				}
+
+			private:
+				// Non-copyable
+				sync_channel(const sync_channel&) =delete;
+				sync_channel& operator=(const sync_channel&) =delete;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Build synchronization protocol.
+			 *
+			 * The client sends requests, the server (which holds the archive with the build) answers
+			 * each request with one message. All fields are little-endian:
+			 *
+			 *     HELLO        version                      -> HELLO version
+			 *     INFO         build name                   -> INFO (build info, cf. below)
+			 *     NODES        slr, level, count, indices   -> HASHES (count digests)
+			 *     FRAMES       slr, count, indices          -> FRAME_DATA (count frames, big-endian words)
+			 *     ADDRESSES    slr                          -> ADDRESS_MAP (frame addresses)
+			 *     BYE                                       (no answer, the server returns)
+			 *
+			 * SLR and level numbers and counts are 32-bit, indices 64-bit words. The INFO answer
+			 * selects the build for the following requests; it holds a flag (zero if the build does
+			 * not exist), followed by the frame size, the number of SLRs, and for each SLR a flag word
+			 * (@ref SLR_HAS_IDCODE, @ref SLR_HAS_ADDRESSES), the IDCODE, the number of frames, the
+			 * root of its Merkle tree and the digest of its frame addresses (@ref address_digest).
+			 * Failed requests are answered with an ERROR message (holding the reason).
+			 */
+			class frame_sync
+			{
+			public:
+				/** @brief Protocol version. */
+				static constexpr uint32_t VERSION = 1u;
+
+				/** @brief Handshake. */
+				static constexpr uint32_t MSG_HELLO = 1u;
+
+				/** @brief Build information (request and answer). */
+				static constexpr uint32_t MSG_INFO = 2u;
+
+				/** @brief Merkle tree nodes request. */
+				static constexpr uint32_t MSG_NODES = 3u;
+
+				/** @brief Merkle tree nodes answer. */
+				static constexpr uint32_t MSG_HASHES = 4u;
+
+				/** @brief Frame data request. */
+				static constexpr uint32_t MSG_FRAMES = 5u;
+
+				/** @brief Frame data answer. */
+				static constexpr uint32_t MSG_FRAME_DATA = 6u;
+
+				/** @brief Frame address map request. */
+				static constexpr uint32_t MSG_ADDRESSES = 7u;
+
+				/** @brief Frame address map answer. */
+				static constexpr uint32_t MSG_ADDRESS_MAP = 8u;
+
+				/** @brief End of the session. */
+				static constexpr uint32_t MSG_BYE = 9u;
+
+				/** @brief Failed request. */
+				static constexpr uint32_t MSG_ERROR = 15u;
+
+				/** @brief SLR flag: the IDCODE is known. */
+				static constexpr uint32_t SLR_HAS_IDCODE = 1u << 0u;
+
+				/** @brief SLR flag: the frame addresses are known. */
+				static constexpr uint32_t SLR_HAS_ADDRESSES = 1u << 1u;
+
+				/**
+				 * @brief Computes the digest of a frame address map.
+				 *
+				 * @param addresses specifies the frame addresses (empty if unknown).
+				 */
+				static runtime::sha256::digest address_digest(std::span<const uint32_t> addresses) noexcept;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Build information of a @ref frame_sync server.
+			 */
+			struct sync_build_info
+			{
+				/**
+				 * @brief Per-SLR part of the build information.
+				 */
+				struct slr
+				{
+					/** @brief IDCODE of the SLR (if known). */
+					std::optional<uint32_t> idcode;
+
+					/** @brief Number of frames. */
+					std::size_t num_frames = 0u;
+
+					/** @brief Root of the Merkle tree. */
+					merkle_tree::node_hash root {};
+
+					/** @brief The frame addresses are known. */
+					bool has_addresses = false;
+
+					/** @brief Digest of the frame addresses (cf. @ref frame_sync::address_digest). */
+					runtime::sha256::digest address_digest {};
+				};
+
+				/**
+				 * @brief Number of 32-bit words per frame.
+				 */
+				std::size_t frame_words = 0u;
+
+				/**
+				 * @brief SLRs of the build (in configuration order).
+				 */
+				std::vector<slr> slrs;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Statistics of a @ref frame_sync_client::sync operation.
+			 */
+			struct sync_stats
+			{
+				/** @brief The local archive already contained the build. */
+				bool up_to_date = false;
+
+				/** @brief Number of requests sent (each is one round trip). */
+				std::size_t round_trips = 0u;
+
+				/** @brief Number of Merkle tree nodes received. */
+				std::size_t nodes_received = 0u;
+
+				/** @brief Number of frames received. */
+				std::size_t frames_received = 0u;
+
+				/** @brief Number of frames taken from the local archive. */
+				std::size_t frames_reused = 0u;
+
+				/** @brief Number of bytes sent. */
+				uint64_t bytes_sent = 0u;
+
+				/** @brief Number of bytes received. */
+				uint64_t bytes_received = 0u;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Server side of the @ref frame_sync protocol.
+			 *
+			 * The server answers requests for the builds of an archive. Manifests and Merkle trees
+			 * are read when a build is selected, frame data is read on demand.
+			 */
+			class frame_sync_server
+			{
+			private:
+				/**
+				 * @brief The archive.
+				 */
+				const frame_archive& archive_;
+
+				/**
+				 * @brief The channel.
+				 */
+				sync_channel channel_;
+
+			public:
+				/**
+				 * @brief Constructs a server.
+				 *
+				 * @param archive specifies the archive.
+				 * @param in_fd is the file descriptor to read requests from.
+				 * @param out_fd is the file descriptor to write answers to.
+				 */
+				frame_sync_server(const frame_archive& archive, int in_fd, int out_fd);
+
+				/**
+				 * @brief Destroys the server.
+				 */
+				~frame_sync_server();
+
+				/**
+				 * @brief Serves requests until the client ends the session (or closes the channel).
+				 */
+				void serve();
+
+			private:
+				// Non-copyable
+				frame_sync_server(const frame_sync_server&) =delete;
+				frame_sync_server& operator=(const frame_sync_server&) =delete;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Client side of the @ref frame_sync protocol.
+			 *
+			 * The client fetches builds into a local archive. The Merkle tree of each SLR is walked
+			 * top-down against the tree of a local base build (one round trip per level), so only
+			 * the digests along the paths to changed frames are transferred. Frames that exist in
+			 * the local archive (of any build) are read locally; only the remaining frames are
+			 * transferred. The received frames are verified against the tree roots before the build
+			 * is added to the local archive.
+			 */
+			class frame_sync_client
+			{
+			private:
+				/**
+				 * @brief The channel.
+				 */
+				sync_channel channel_;
+
+				/**
+				 * @brief Number of requests sent.
+				 */
+				std::size_t round_trips_;
+
+			public:
+				/**
+				 * @brief Constructs a client (and performs the handshake).
+				 *
+				 * @param in_fd is the file descriptor to read answers from.
+				 * @param out_fd is the file descriptor to write requests to.
+				 */
+				frame_sync_client(int in_fd, int out_fd);
+
+				/**
+				 * @brief Destroys the client (ending the session).
+				 */
+				~frame_sync_client();
+
+				/**
+				 * @brief Gets the information of a build of the server.
+				 *
+				 * @param build is the name of the build.
+				 *
+				 * @return The build information (empty if the server has no such build).
+				 */
+				std::optional<sync_build_info> info(const std::string& build);
+
+				/**
+				 * @brief Fetches a build into a local archive.
+				 *
+				 * @param local specifies the local archive.
+				 * @param build is the name of the build.
+				 * @param base_build optionally specifies a build of the local archive to compare the
+				 *   Merkle trees against (all frame digests are transferred without a base build).
+				 *
+				 * @return The statistics of the operation.
+				 */
+				sync_stats sync(frame_archive& local, const std::string& build, const std::string& base_build = std::string());
+
+			private:
+				/**
+				 * @brief Sends a request and receives the answer (of the expected type).
+				 */
+				std::vector<uint8_t> request(uint32_t type, std::span<const uint8_t> payload, uint32_t answer);
+
+				/**
+				 * @brief Fetches Merkle tree nodes of the selected build.
+				 */
+				std::vector<merkle_tree::node_hash> fetch_nodes(std::size_t slr, std::size_t level,
+					std::span<const std::size_t> indices);
+
+				// Non-copyable
+				frame_sync_client(const frame_sync_client&) =delete;
+				frame_sync_client& operator=(const frame_sync_client&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_FRAME_SYNC_HPP_
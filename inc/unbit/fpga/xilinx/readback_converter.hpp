@@ -0,0 +1,234 @@
+/**
+ * @file
+ * @brief Streaming conversion of readback data into configuration bitstreams.
+ */
+#ifndef UNBIT_XILINX_READBACK_CONVERTER_HPP_
+#define UNBIT_XILINX_READBACK_CONVERTER_HPP_ 1
+
+#include "unbit/fpga/xilinx/bitstream_serializer.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Layout of a raw readback data file (e.g. from @c readback_hw_device -bin_file).
+			 *
+			 * Raw readback files contain the frame data of each SLR (in configuration order), each
+			 * surrounded by device family dependent padding.
+			 */
+			struct readback_layout
+			{
+				/**
+				 * @brief Geometry of a single SLR.
+				 */
+				struct slr
+				{
+					/** @brief IDCODE of the SLR. */
+					uint32_t idcode = 0u;
+
+					/** @brief Number of frames of the SLR. */
+					std::size_t num_frames = 0u;
+				};
+
+				/**
+				 * @brief Padding (in words) in front of the frame data of each SLR.
+				 */
+				std::size_t front_padding_words = 0u;
+
+				/**
+				 * @brief Padding (in words) after the frame data of each SLR.
+				 */
+				std::size_t back_padding_words = 0u;
+
+				/**
+				 * @brief SLRs (in configuration order).
+				 */
+				std::vector<slr> slrs;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Streaming converter from readback data to configuration bitstreams.
+			 *
+			 * The converter accepts either a readback bitstream (with FDRO read packets carrying the
+			 * readback data, see @ref scan_fdro), or a raw readback data file with a known layout (see
+			 * @ref set_layout). In both cases the input is first indexed (packet headers only, the
+			 * payload is skipped), yielding the position and size of the frame data of each SLR. The
+			 * pipeline words and the padding frame in front of the readback data are dropped.
+			 *
+			 * The configuration bitstream is then written sequentially, in the same layout as produced
+			 * by the @ref bitstream_serializer (IDCODE, FAR/WCFG/FDRI, optional MFWR compression of
+			 * all-zero frames, nested SLRs, CRC checks). Sizes of nested SLR streams are determined
+			 * by a dry run that does not touch the frame data, and the frame data is streamed from
+			 * the input in fixed-size chunks. Memory usage is thus independent of the size of the
+			 * device (apart from one bit per frame for MFWR compression).
+			 *
+			 * The input stream must be seekable; the output stream need not be.
+			 */
+			class readback_converter
+			{
+			public:
+				/**
+				 * @brief Frame data extent of an SLR in the input.
+				 */
+				struct slr_extent
+				{
+					/** @brief IDCODE of the SLR (if known). */
+					std::optional<uint32_t> idcode;
+
+					/** @brief Byte offset of the first frame (after pipeline words and padding frame). */
+					uint64_t data_offset = 0u;
+
+					/** @brief Number of frames of the SLR. */
+					std::size_t num_frames = 0u;
+				};
+
+			private:
+				/**
+				 * @brief Input stream with the readback data.
+				 */
+				std::istream& input_;
+
+				/**
+				 * @brief Stream position of the start of the readback data.
+				 */
+				uint64_t origin_;
+
+				/**
+				 * @brief Number of 32-bit words per frame.
+				 */
+				std::size_t frame_words_;
+
+				/**
+				 * @brief Serializer options (CRC checks, MFWR compression).
+				 */
+				serializer_options options_;
+
+				/**
+				 * @brief Frame data extents of the SLRs (in configuration order).
+				 */
+				std::vector<slr_extent> slrs_;
+
+				/**
+				 * @brief Per-SLR serialization settings.
+				 */
+				std::vector<bitstream_serializer::slr_config> configs_;
+
+				/**
+				 * @brief Number of frames written via FDRI by the last conversion.
+				 */
+				std::size_t num_fdri_frames_;
+
+				/**
+				 * @brief Number of frames written via MFWR by the last conversion.
+				 */
+				std::size_t num_mfwr_frames_;
+
+				/**
+				 * @brief Size (in bytes) of the bitstream written by the last conversion.
+				 */
+				uint64_t output_size_;
+
+			public:
+				/**
+				 * @brief Constructs a converter for a readback input stream.
+				 *
+				 * @param input is the (seekable) input stream, opened in binary mode.
+				 * @param frame_words is the number of 32-bit words per frame.
+				 * @param opts specifies the serializer options (@c parallel is ignored).
+				 */
+				readback_converter(std::istream& input, std::size_t frame_words,
+					const serializer_options& opts = serializer_options());
+
+				/**
+				 * @brief Destroys the converter.
+				 */
+				~readback_converter();
+
+				/**
+				 * @brief Indexes a readback bitstream (FDRO read packets).
+				 *
+				 * Each synchronized (sub-)stream, including streams nested via writes to register 30,
+				 * is a candidate SLR; streams without FDRO data are dropped. The FDRO payload of each
+				 * SLR starts with @p pipeline_words pipeline words and one padding frame, which are
+				 * skipped.
+				 *
+				 * @param pipeline_words is the number of pipeline words in front of the padding frame.
+				 */
+				void scan_fdro(std::size_t pipeline_words = 0u);
+
+				/**
+				 * @brief Indexes a raw readback data file with a known layout.
+				 *
+				 * @param layout specifies the layout of the input file.
+				 */
+				void set_layout(const readback_layout& layout);
+
+				/**
+				 * @brief Gets the frame data extents of the SLRs (after indexing).
+				 */
+				inline const std::vector<slr_extent>& slrs() const noexcept
+				{
+					return slrs_;
+				}
+
+				/**
+				 * @brief Gets the serialization settings of an SLR (after indexing).
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 */
+				bitstream_serializer::slr_config& config(std::size_t slr);
+
+				/**
+				 * @brief Converts the readback data into a configuration bitstream.
+				 *
+				 * @param output is the output stream (opened in binary mode).
+				 */
+				void convert(std::ostream& output);
+
+				/**
+				 * @brief Gets the number of frames written via FDRI by the last conversion.
+				 */
+				inline std::size_t num_fdri_frames() const noexcept
+				{
+					return num_fdri_frames_;
+				}
+
+				/**
+				 * @brief Gets the number of frames written via MFWR by the last conversion.
+				 */
+				inline std::size_t num_mfwr_frames() const noexcept
+				{
+					return num_mfwr_frames_;
+				}
+
+				/**
+				 * @brief Gets the size (in bytes) of the bitstream written by the last conversion.
+				 */
+				inline uint64_t output_size() const noexcept
+				{
+					return output_size_;
+				}
+
+			private:
+				// Non-copyable
+				readback_converter(const readback_converter&) =delete;
+				readback_converter& operator=(const readback_converter&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_READBACK_CONVERTER_HPP_
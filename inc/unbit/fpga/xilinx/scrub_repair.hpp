@@ -0,0 +1,233 @@
+/**
+ * @file
+ * @brief Scrub-repair partial bitstreams from readback data (masked comparison against a golden image).
+ */
+#ifndef UNBIT_XILINX_SCRUB_REPAIR_HPP_
+#define UNBIT_XILINX_SCRUB_REPAIR_HPP_ 1
+
+#include "unbit/fpga/xilinx/frame_store.hpp"
+#include "unbit/fpga/xilinx/readback_converter.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <istream>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Options of the @ref scrub_repair generator.
+			 */
+			struct scrub_options
+			{
+				/**
+				 * @brief Emit a CRC check at the end of each SLR stream of the repair bitstream.
+				 */
+				bool with_crc = true;
+
+				/**
+				 * @brief Maximum number of upset frames to record (0 for no limit); comparing stops
+				 *   at the limit (e.g. to fall back to a full reconfiguration).
+				 */
+				std::size_t max_upsets = 0u;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief An upset frame found by the @ref scrub_repair generator.
+			 */
+			struct scrub_upset
+			{
+				/** @brief Index of the SLR (in configuration order). */
+				std::size_t slr = 0u;
+
+				/** @brief Linear index of the frame. */
+				std::size_t frame = 0u;
+
+				/** @brief Frame address (FAR) of the frame. */
+				uint32_t frame_address = 0u;
+
+				/** @brief Number of upset (unmasked, differing) bits. */
+				std::size_t num_bits = 0u;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Generator for scrub-repair partial bitstreams.
+			 *
+			 * Readback frames are compared against the frames of the golden image, ignoring the bits
+			 * that are set in the mask image (e.g. a Vivado @c .msk file, covering LUT RAMs, SRLs and
+			 * block RAM contents). Frames with differing unmasked bits are recorded as upsets,
+			 * together with their repaired contents (golden bits, except for the masked bits, which
+			 * keep their readback value).
+			 *
+			 * The repair bitstream rewrites the upset frames only: each run of upset frames that are
+			 * consecutive in frame address auto-increment order becomes one FAR/FDRI write (followed
+			 * by a pipeline flush frame). The SLR streams are nested as in the full bitstream (SLRs
+			 * after the last SLR with upsets are omitted), and each SLR stream ends with a CRC check
+			 * and a DESYNC command; no start-up sequence is issued.
+			 *
+			 * The readback data is compared in fixed-size chunks as it is read (see @ref scan), and
+			 * only the upset frames are kept, so memory use and run time are independent of the
+			 * number of intact frames (apart from the golden and mask images, which are referenced,
+			 * not copied). Frame addresses are taken from the frame address maps of the SLRs (cf.
+			 * @ref bitstream_serializer::slr_config::frame_addresses); upsets in row padding frames
+			 * (@ref bitstream_serializer::NO_FRAME_ADDRESS) are not repairable and are ignored.
+			 */
+			class scrub_repair
+			{
+			private:
+				/**
+				 * @brief The golden frames.
+				 */
+				const frame_store& golden_;
+
+				/**
+				 * @brief The mask frames (null if no bits are masked).
+				 */
+				const frame_store* mask_;
+
+				/**
+				 * @brief Generator options.
+				 */
+				scrub_options options_;
+
+				/**
+				 * @brief Frame address maps of the SLRs.
+				 */
+				std::vector<std::vector<uint32_t>> frame_addresses_;
+
+				/**
+				 * @brief Upset frames (in the order they were found).
+				 */
+				std::vector<scrub_upset> upsets_;
+
+				/**
+				 * @brief Repaired contents of the upset frames (in the order of the upsets).
+				 */
+				std::vector<uint32_t> repaired_;
+
+				/**
+				 * @brief Number of frames written by the last repair bitstream.
+				 */
+				std::size_t num_fdri_frames_;
+
+				/**
+				 * @brief Size (in bytes) of the last repair bitstream.
+				 */
+				uint64_t output_size_;
+
+			public:
+				/**
+				 * @brief Constructs a generator for a golden image.
+				 *
+				 * @param golden specifies the golden frames (must outlive the generator).
+				 * @param opts specifies the generator options.
+				 */
+				explicit scrub_repair(const frame_store& golden, const scrub_options& opts = scrub_options());
+
+				/**
+				 * @brief Destroys the generator.
+				 */
+				~scrub_repair();
+
+				/**
+				 * @brief Sets the mask image (bits set in the mask are not compared).
+				 *
+				 * @param mask specifies the mask frames (same geometry as the golden frames, must
+				 *   outlive the generator).
+				 */
+				void set_mask(const frame_store& mask);
+
+				/**
+				 * @brief Sets the frame address map of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param addresses specifies the frame address (FAR) of each frame of the SLR.
+				 */
+				void set_frame_addresses(std::size_t slr, std::vector<uint32_t> addresses);
+
+				/**
+				 * @brief Compares consecutive readback frames of an SLR.
+				 *
+				 * @param slr is the index of the SLR (in configuration order).
+				 * @param first_frame is the linear index of the first frame.
+				 * @param readback specifies the readback data of the frames (native byte order).
+				 *
+				 * @return The number of upset frames found.
+				 */
+				std::size_t compare(std::size_t slr, std::size_t first_frame, std::span<const uint32_t> readback);
+
+				/**
+				 * @brief Compares the readback data of all SLRs (streaming).
+				 *
+				 * @param readback is the (seekable) input stream with the readback data.
+				 * @param extents specifies the frame data extents of the SLRs (cf.
+				 *   @ref readback_converter::slrs), matching the geometry of the golden image.
+				 *
+				 * @return The number of upset frames found.
+				 */
+				std::size_t scan(std::istream& readback, std::span<const readback_converter::slr_extent> extents);
+
+				/**
+				 * @brief Gets the upset frames found so far.
+				 */
+				inline const std::vector<scrub_upset>& upsets() const noexcept
+				{
+					return upsets_;
+				}
+
+				/**
+				 * @brief Tests if the upset limit (@ref scrub_options::max_upsets) has been reached.
+				 */
+				inline bool limit_reached() const noexcept
+				{
+					return options_.max_upsets > 0u && upsets_.size() >= options_.max_upsets;
+				}
+
+				/**
+				 * @brief Discards the upset frames found so far.
+				 */
+				void clear() noexcept;
+
+				/**
+				 * @brief Writes the repair bitstream for the upset frames found so far.
+				 *
+				 * @param output is the output stream (opened in binary mode).
+				 */
+				void write(std::ostream& output);
+
+				/**
+				 * @brief Gets the number of frames written by the last repair bitstream.
+				 */
+				inline std::size_t num_fdri_frames() const noexcept
+				{
+					return num_fdri_frames_;
+				}
+
+				/**
+				 * @brief Gets the size (in bytes) of the last repair bitstream.
+				 */
+				inline uint64_t output_size() const noexcept
+				{
+					return output_size_;
+				}
+
+			private:
+				// Non-copyable
+				scrub_repair(const scrub_repair&) =delete;
+				scrub_repair& operator=(const scrub_repair&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_SCRUB_REPAIR_HPP_
@@ -0,0 +1,303 @@
+/**
+ * @file
+ * @brief Streaming packet walker for Xilinx Series-7 and UltraScale FPGAs.
+ */
+#ifndef UNBIT_XILINX_STREAM_ENGINE_HPP_
+#define UNBIT_XILINX_STREAM_ENGINE_HPP_ 1
+
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/config_reg.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <span>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Streaming packet walker for Xilinx Series-7 and UltraScale FPGAs.
+			 *
+			 * The @c stream_engine class is the streaming counterpart of the @ref bitstream_engine:
+			 * It pulls the bitstream from a byte source (see @ref read_bytes) instead of requiring the
+			 * complete bitstream in memory, and passes payload data to the derived class in chunks.
+			 *
+			 * Packets are decoded as by the device: A type 1 packet with a zero word count is followed
+			 * by a type 2 packet carrying the word count of the payload (if the next word is not a
+			 * type 2 packet, the type 1 packet has no payload). Freestanding type 2 packets address
+			 * the register of the last type 1 packet. Streams nested via register 30 writes (SLRs of
+			 * SSI devices) are processed inline; each (nested) stream is a level with its own CRC.
+			 *
+			 * The top-level stream starts at the first (byte-aligned) sync word; leading data, and
+			 * a trailing partial word, are passed to @ref on_raw_bytes. A DESYNC command ends the
+			 * synchronized part of a stream; words up to the next (word-aligned) sync word are passed
+			 * on as raw words.
+			 */
+			class stream_engine
+			{
+			public:
+				/**
+				 * @brief Packet opcodes.
+				 */
+				enum class packet_op : uint32_t
+				{
+					nop      = 0b00u, //!< No operation
+					read     = 0b01u, //!< Register read
+					write    = 0b10u, //!< Register write
+					reserved = 0b11u  //!< Reserved
+				};
+
+				/**
+				 * @brief A (normalized) configuration packet.
+				 */
+				struct packet
+				{
+					/** @brief Opcode of the packet. */
+					packet_op op;
+
+					/** @brief Target register of the packet. */
+					config_reg reg;
+
+					/** @brief Number of data words (written or read). */
+					uint64_t word_count;
+				};
+
+				/**
+				 * @brief A (nested) configuration stream.
+				 */
+				struct level
+				{
+					/** @brief Index of the SLR of the stream (in configuration order). */
+					std::size_t slr;
+
+					/** @brief Configuration CRC of the stream (over the output words). */
+					config_crc crc;
+
+					/** @brief Configuration CRC of the stream over the input words (if tracked). */
+					config_crc input_crc;
+
+					/** @brief Number of words left in the nested stream (unbounded for the top level). */
+					uint64_t remaining;
+
+					/** @brief Register of the last type 1 packet. */
+					config_reg last_reg;
+
+					/** @brief Indicates if the stream is synchronized. */
+					bool synced;
+				};
+
+			private:
+				/**
+				 * @brief Maximum number of payload words per chunk.
+				 */
+				std::size_t chunk_words_;
+
+				/**
+				 * @brief Indicates if the CRCs over the input words are tracked.
+				 */
+				bool track_input_crc_;
+
+				/**
+				 * @brief Indicates if words with unknown packet types are skipped.
+				 */
+				bool skip_unknown_packets_;
+
+				/**
+				 * @brief Indicates if the data of read packets follows inline (readback data).
+				 */
+				bool read_payloads_;
+
+				/**
+				 * @brief Indicates if the end of the top-level stream has been reached.
+				 */
+				bool at_end_;
+
+				/**
+				 * @brief Active streams (top-level stream first).
+				 */
+				std::vector<level> levels_;
+
+				/**
+				 * @brief Payload chunk (input words).
+				 */
+				std::vector<uint32_t> input_;
+
+				/**
+				 * @brief Payload chunk (output words).
+				 */
+				std::vector<uint32_t> output_;
+
+			protected:
+				/**
+				 * @brief Constructs a new streaming packet walker.
+				 *
+				 * @param chunk_words is the maximum number of payload words passed per chunk.
+				 */
+				explicit stream_engine(std::size_t chunk_words = 1024u);
+
+				/**
+				 * @brief Destroys the streaming packet walker.
+				 */
+				virtual ~stream_engine();
+
+			public:
+				/**
+				 * @brief Enables (or disables) tracking of the CRCs over the input words.
+				 *
+				 * The input CRCs differ from the (output) CRCs if payload words are modified by
+				 * @ref on_payload. Tracking is disabled by default.
+				 */
+				inline void set_track_input_crc(bool enable) noexcept
+				{
+					track_input_crc_ = enable;
+				}
+
+				/**
+				 * @brief Enables (or disables) skipping of words with unknown packet types.
+				 *
+				 * If disabled (the default), unknown packet types in synchronized streams are reported
+				 * as @ref bitstream_error.
+				 */
+				inline void set_skip_unknown_packets(bool enable) noexcept
+				{
+					skip_unknown_packets_ = enable;
+				}
+
+				/**
+				 * @brief Enables (or disables) inline payloads of read packets.
+				 *
+				 * Readback data contains the data of each read packet following its header; in
+				 * configuration bitstreams, only write packets carry payload words. Disabled by default.
+				 */
+				inline void set_read_payloads(bool enable) noexcept
+				{
+					read_payloads_ = enable;
+				}
+
+				/**
+				 * @brief Processes the bitstream provided by the byte source.
+				 *
+				 * @throws bitstream_error if the bitstream has no sync word or is malformed.
+				 */
+				void process();
+
+			protected:
+				/**
+				 * @brief Gets the innermost active stream.
+				 */
+				const level& current_level() const;
+
+				/**
+				 * @brief Reads bytes from the source.
+				 *
+				 * @return The number of bytes read (less than @p size only at the end of the data).
+				 */
+				virtual std::size_t read_bytes(uint8_t* dst, std::size_t size) = 0;
+
+				/**
+				 * @brief Skips bytes of the source (the payload of a skipped packet).
+				 *
+				 * The default implementation reads and discards the bytes.
+				 */
+				virtual void skip_bytes(uint64_t size);
+
+				/**
+				 * @brief Handles bytes outside of the packet stream (leading data up to, and including,
+				 *   the first sync word, and a trailing partial word).
+				 */
+				virtual void on_raw_bytes(std::span<const uint8_t> bytes);
+
+				/**
+				 * @brief Called after a (nested) stream has been synchronized.
+				 */
+				virtual void on_sync();
+
+				/**
+				 * @brief Called after a nested stream (the stream of the next SLR) has been entered.
+				 */
+				virtual void on_slr_begin();
+
+				/**
+				 * @brief Called before a nested stream is left.
+				 */
+				virtual void on_slr_end();
+
+				/**
+				 * @brief Called for each packet (except register 30 writes) before its payload.
+				 *
+				 * Only write packets (and read packets, see @ref set_read_payloads) have a payload.
+				 *
+				 * @return True if the payload is to be processed (see @ref on_payload), or false if
+				 *   it is to be skipped. Skipped payloads are neither tracked in the CRCs nor passed
+				 *   to @ref on_words.
+				 */
+				virtual bool on_packet(const packet& pkt);
+
+				/**
+				 * @brief Handles a chunk of payload words.
+				 *
+				 * @param pkt is the packet.
+				 * @param offset is the offset of the chunk in the payload (in words).
+				 * @param input are the payload words as read.
+				 * @param output are the payload words to be emitted (initially a copy of the input,
+				 *   may be modified).
+				 */
+				virtual void on_payload(const packet& pkt, uint64_t offset, std::span<const uint32_t> input,
+					std::span<uint32_t> output);
+
+				/**
+				 * @brief Called after the payload of a packet has been processed (or skipped).
+				 */
+				virtual void on_packet_end(const packet& pkt);
+
+				/**
+				 * @brief Handles words of the packet stream (headers, payloads and raw words).
+				 *
+				 * @param input are the words as read.
+				 * @param output are the words to be emitted.
+				 */
+				virtual void on_words(std::span<const uint32_t> input, std::span<const uint32_t> output);
+
+			private:
+				/**
+				 * @brief Searches the first (byte-aligned) sync word.
+				 */
+				void synchronize();
+
+				/**
+				 * @brief Reads a packet header (or raw word).
+				 *
+				 * @return False at the end of the top-level stream.
+				 */
+				bool read_header(uint32_t& hdr);
+
+				/**
+				 * @brief Reads words of the innermost stream.
+				 */
+				void read_words(std::span<uint32_t> words);
+
+				/**
+				 * @brief Accounts words as (nested) payload of the enclosing streams.
+				 */
+				void emit(std::span<const uint32_t> input, std::span<const uint32_t> output);
+
+				/**
+				 * @brief Processes the payload of a packet.
+				 */
+				void process_payload(const packet& pkt);
+
+				// Non-copyable
+				stream_engine(const stream_engine&) =delete;
+				stream_engine& operator=(const stream_engine&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_STREAM_ENGINE_HPP_
@@ -0,0 +1,248 @@
+/**
+ * @file
+ * @brief Streaming SVF (serial vector format) writer for JTAG configuration of Xilinx FPGAs.
+ */
+#ifndef UNBIT_XILINX_SVF_WRITER_HPP_
+#define UNBIT_XILINX_SVF_WRITER_HPP_ 1
+
+#include <cstdint>
+#include <cstddef>
+
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief JTAG instructions of the configuration logic (7-series and UltraScale(+) devices).
+			 *
+			 * The instruction register has 6 bits per SLR. The instruction codes used for JTAG
+			 * configuration are identical for the 7-series and UltraScale(+) families.
+			 */
+			enum class jtag_instruction : uint8_t
+			{
+				CFG_IN    = 0x05u, //!< Shift configuration data into the configuration logic
+				IDCODE    = 0x09u, //!< Select the IDCODE register
+				JPROGRAM  = 0x0Bu, //!< Clear the configuration memory (equivalent to PROGRAM_B)
+				JSTART    = 0x0Cu, //!< Clock the startup sequence with TCK
+				ISC_NOOP  = 0x14u, //!< No operation (IR capture reflects the configuration status)
+				BYPASS    = 0x3Fu  //!< Select the bypass register
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Options of the @ref svf_writer.
+			 */
+			struct svf_options
+			{
+				/**
+				 * @brief Number of SLRs of the device (the instruction is replicated for each SLR).
+				 */
+				std::size_t num_slrs = 1u;
+
+				/**
+				 * @brief Expected IDCODE of the device (verified before programming, if set).
+				 */
+				std::optional<uint32_t> idcode;
+
+				/**
+				 * @brief Mask of the verified IDCODE bits (default: ignore the revision field).
+				 */
+				uint32_t idcode_mask = 0x0FFFFFFFu;
+
+				/**
+				 * @brief Maximum number of bytes per SDR shift (multiple of 4; zero for a single shift).
+				 *
+				 * Chunked shifts end in the DRPAUSE state, i.e. the configuration data register stays
+				 * selected and the configuration logic sees one continuous stream.
+				 */
+				std::size_t chunk_bytes = 0u;
+
+				/**
+				 * @brief Number of TCK cycles to wait for the configuration memory to be cleared.
+				 */
+				std::size_t clear_wait_tck = 10000u;
+
+				/**
+				 * @brief Number of TCK cycles to clock the startup sequence.
+				 */
+				std::size_t startup_wait_tck = 2000u;
+
+				/**
+				 * @brief Verify the INIT_COMPLETE and DONE status bits (via the IR capture value).
+				 */
+				bool check_status = true;
+
+				/**
+				 * @brief Number of IR bits of the devices before (TDI side) and after the target device.
+				 *
+				 * The other devices of the chain are placed in BYPASS.
+				 */
+				std::size_t header_ir_bits = 0u;
+				std::size_t trailer_ir_bits = 0u;
+
+				/**
+				 * @brief Number of DR bits (bypass registers) before and after the target device.
+				 */
+				std::size_t header_dr_bits = 0u;
+				std::size_t trailer_dr_bits = 0u;
+
+				/**
+				 * @brief Size of the output buffer (in bytes).
+				 */
+				std::size_t buffer_bytes = 1u << 20u;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Streaming writer for SVF programming sequences.
+			 *
+			 * The writer converts a configuration bitstream (in file format, i.e. big-endian words,
+			 * uncompressed or compressed) into the JTAG programming sequence of the device:
+			 *
+			 *     [IDCODE check] JPROGRAM ISC_NOOP [INIT check] CFG_IN <SDR shifts> JSTART [DONE check]
+			 *
+			 * SVF shifts the least significant bit of a hex string first, while the configuration
+			 * logic expects the most significant bit of each bitstream byte first. The TDI data of
+			 * a shift is thus the bitstream data in reverse byte order, with the bits of each byte
+			 * reversed. The writer formats this data with a 256-entry table (one bit-reversed hex
+			 * pair per byte) directly into a large output buffer, which is written to the output
+			 * stream whenever it is full. The SVF text is never held in memory as a whole.
+			 *
+			 * The bitstream is given as a sequence of byte buffers (e.g. the segment buffers of a
+			 * @ref bitstream_serializer), so that re-encoded bitstreams can be converted without
+			 * assembling them first.
+			 */
+			class svf_writer
+			{
+			private:
+				/**
+				 * @brief Output stream.
+				 */
+				std::ostream& os_;
+
+				/**
+				 * @brief Writer options.
+				 */
+				svf_options options_;
+
+				/**
+				 * @brief Output buffer.
+				 */
+				std::vector<char> buffer_;
+
+				/**
+				 * @brief Number of used bytes in the output buffer.
+				 */
+				std::size_t used_ = 0u;
+
+				/**
+				 * @brief Number of bytes written to the output stream so far.
+				 */
+				uint64_t text_size_ = 0u;
+
+				/**
+				 * @brief Number of SDR shifts of configuration data written so far.
+				 */
+				std::size_t num_shifts_ = 0u;
+
+			public:
+				/**
+				 * @brief Constructs an SVF writer.
+				 *
+				 * @param os is the output stream.
+				 * @param opts specifies the writer options.
+				 *
+				 * @throws std::invalid_argument if the options are invalid (e.g. the chunk size is not
+				 *   a multiple of 4, or the instruction register of the device exceeds 60 bits).
+				 */
+				explicit svf_writer(std::ostream& os, const svf_options& opts = svf_options());
+
+				/**
+				 * @brief Destroys the writer (after flushing the output buffer, errors are ignored).
+				 */
+				~svf_writer();
+
+				/**
+				 * @brief Writes the programming sequence of a configuration bitstream.
+				 *
+				 * @param stream is the configuration bitstream (file format), given as a sequence of
+				 *   buffers in stream order.
+				 */
+				void write_program(std::span<const std::span<const uint8_t>> stream);
+
+				/**
+				 * @brief Writes the programming sequence of a configuration bitstream.
+				 *
+				 * @param stream is the configuration bitstream (file format).
+				 */
+				void write_program(std::span<const uint8_t> stream);
+
+				/**
+				 * @brief Flushes the output buffer to the output stream.
+				 */
+				void flush();
+
+				/**
+				 * @brief Gets the number of bytes of SVF text written so far (including buffered data).
+				 */
+				inline uint64_t text_size() const noexcept
+				{
+					return text_size_ + used_;
+				}
+
+				/**
+				 * @brief Gets the number of SDR shifts of configuration data written so far.
+				 */
+				inline std::size_t num_shifts() const noexcept
+				{
+					return num_shifts_;
+				}
+
+			private:
+				/**
+				 * @brief Appends text to the output buffer.
+				 */
+				void put(std::string_view text);
+
+				/**
+				 * @brief Appends a hex number (with the given number of bits) to the output buffer.
+				 */
+				void put_hex(uint64_t value, std::size_t bits);
+
+				/**
+				 * @brief Writes an SIR command (with optional expected capture value and mask).
+				 */
+				void write_sir(jtag_instruction instr, std::optional<uint8_t> tdo = std::nullopt, uint8_t mask = 0u);
+
+				/**
+				 * @brief Writes the SDR shift of a byte range of the bitstream.
+				 *
+				 * @param stream are the buffers of the bitstream.
+				 * @param first is the offset of the first byte of the shift.
+				 * @param count is the number of bytes of the shift.
+				 */
+				void write_sdr(std::span<const std::span<const uint8_t>> stream, uint64_t first, uint64_t count);
+
+				/**
+				 * @brief Gets the IR value for an instruction (replicated for each SLR).
+				 */
+				uint64_t ir_value(uint8_t instr) const noexcept;
+
+				// Non-copyable
+				svf_writer(const svf_writer&) =delete;
+				svf_writer& operator=(const svf_writer&) =delete;
+			};
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_SVF_WRITER_HPP_
@@ -0,0 +1,110 @@
+/**
+ * @file
+ * @brief ELF symbol table support
+ */
+#ifndef UNBIT_ELF_HPP_
+#define UNBIT_ELF_HPP_ 1
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	/**
+	 * @brief An ELF symbol table reader (utility class)
+	 *
+	 * Supports 32-bit and 64-bit ELF files of either byte order.
+	 */
+	struct elf
+	{
+	private:
+		// Utility class (no constructor/destructor)
+		elf() =delete;
+		~elf() =delete;
+
+	public:
+		/**
+		 * @brief Type of a symbol (cf. STT_xxx)
+		 */
+		enum class symbol_type : uint8_t
+		{
+			notype   = 0u,
+			object   = 1u,
+			function = 2u,
+			section  = 3u,
+			file     = 4u,
+			common   = 5u,
+			tls      = 6u,
+			other    = 0xFFu
+		};
+
+		/**
+		 * @brief Binding of a symbol (cf. STB_xxx)
+		 */
+		enum class symbol_binding : uint8_t
+		{
+			local  = 0u,
+			global = 1u,
+			weak   = 2u,
+			other  = 0xFFu
+		};
+
+		/**
+		 * @brief Symbol table entry
+		 */
+		struct symbol
+		{
+		public:
+			/** @brief Name of the symbol */
+			std::string name;
+
+			/** @brief Address (value) of the symbol */
+			uint64_t address;
+
+			/** @brief Size of the symbol (in bytes) */
+			uint64_t size;
+
+			/** @brief Type of the symbol */
+			symbol_type type;
+
+			/** @brief Binding of the symbol */
+			symbol_binding binding;
+
+		public:
+			/**
+			 * @brief Constructs an empty symbol
+			 */
+			inline symbol()
+				: address(0u), size(0u), type(symbol_type::notype), binding(symbol_binding::local)
+			{
+			}
+		};
+
+	public:
+		/**
+		 * @brief Loads the symbol table of an ELF file
+		 *
+		 * @param[in] filename specifies the path to the ELF file to be read.
+		 *
+		 * @return The defined symbols of the static symbol table (or of the dynamic symbol table,
+		 *   if the file has no static symbol table), in symbol table order. Undefined, section and
+		 *   file symbols are omitted.
+		 *
+		 * @throws std::runtime_error if the file cannot be read or is not a well-formed ELF file.
+		 */
+		static std::vector<symbol> load_symbols(const std::string& filename);
+
+		/**
+		 * @brief Parses the symbol table of an ELF file (given as bytes)
+		 *
+		 * @param[in] data is the content of an ELF file.
+		 *
+		 * @return The defined symbols (cf. @ref load_symbols).
+		 */
+		static std::vector<symbol> parse_symbols(std::span<const uint8_t> data);
+	};
+}
+
+#endif // UNBIT_ELF_HPP_
@@ -5,10 +5,13 @@
 #ifndef UNBIT_IHEX_HPP_
 #define UNBIT_IHEX_HPP_ 1
 
+#include "unbit/ihex/image.hpp"
+
 #include <cstdint>
 #include <functional>
 #include <istream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace unbit
@@ -52,6 +55,16 @@ namespace unbit
 			}
 		};
 
+		/**
+		 * @brief Contiguous block of data in a (sparse) memory image
+		 */
+		typedef image_segment segment;
+
+		/**
+		 * @brief Sparse memory image (as loaded from an Intel-Hex file)
+		 */
+		typedef memory_image image;
+
 	public:
 		/**
 		 * @brief Simulates loading of records from an Intel-Hex file
@@ -89,6 +102,48 @@ namespace unbit
 		 * @param[in] callback specifies the callback to be invoked for loading data records.
 		 */
 		static void parse(std::istream& stm, const std::function<bool(const record&)>& callback);
+
+		/**
+		 * @brief Streams the data records of Intel-Hex text
+		 *
+		 * Records are decoded into a fixed buffer (no allocation per record); data records are
+		 * passed to the callback with their absolute load address.
+		 *
+		 * @param[in] text is the content of an Intel-Hex file.
+		 * @param[in] callback specifies the callback to be invoked for loading data records.
+		 *
+		 * @return The entrypoint indicated in the hex file (if any).
+		 */
+		static uint32_t parse_records(std::string_view text, const record_callback& callback);
+
+		/**
+		 * @brief Loads an Intel-Hex file into a sparse memory image (in parallel)
+		 *
+		 * The file is mapped into memory and loaded in two phases: The text is split into chunks
+		 * at line boundaries, and each chunk is scanned for extended segment/linear address
+		 * records (type 2/4) and for the end of file record. The base address in effect at the
+		 * start of each chunk follows from the scan results of the preceding chunks. The chunks
+		 * are then parsed in parallel (on the shared executor) and merged into the image.
+		 *
+		 * @param[in] filename specifies the path to the Intel-Hex file to be read.
+		 *
+		 * @return The loaded image. Overlapping data records are resolved in file order (i.e.
+		 *   the last record wins), as with @ref load.
+		 *
+		 * @throws std::runtime_error if the file has no end of file record (type 1).
+		 */
+		static image load_image(const std::string& filename);
+
+		/**
+		 * @brief Parses Intel-Hex text into a sparse memory image (in parallel)
+		 *
+		 * @param[in] text is the content of an Intel-Hex file.
+		 *
+		 * @return The loaded image (cf. @ref load_image).
+		 *
+		 * @throws std::runtime_error if the text has no end of file record (type 1).
+		 */
+		static image parse_image(std::string_view text);
 	};
 }
 
@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @brief Sparse memory images (as loaded from Intel-Hex, S-record and raw binary files)
+ */
+#ifndef UNBIT_IMAGE_HPP_
+#define UNBIT_IMAGE_HPP_ 1
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace unbit
+{
+	/**
+	 * @brief Callback receiving the data records of an image file (in file order)
+	 *
+	 * The callback is invoked with the load address and the payload of each data record. The
+	 * payload span is only valid for the duration of the call.
+	 */
+	typedef std::function<void(uint32_t, std::span<const uint8_t>)> record_callback;
+
+	/**
+	 * @brief Contiguous block of data in a (sparse) memory image
+	 */
+	struct image_segment
+	{
+	public:
+		/** @brief Start address of the block */
+		uint32_t address;
+
+		/** @brief Data bytes of the block */
+		std::vector<uint8_t> data;
+
+	public:
+		/**
+		 * @brief Constructs an empty segment
+		 */
+		inline image_segment()
+			: address(0u)
+		{
+		}
+	};
+
+	/**
+	 * @brief Sparse memory image
+	 */
+	struct memory_image
+	{
+	public:
+		/** @brief Data segments (in increasing address order; neither overlapping nor adjacent) */
+		std::vector<image_segment> segments;
+
+		/** @brief Entrypoint indicated in the image file (if any) */
+		uint32_t entrypoint;
+
+	public:
+		/**
+		 * @brief Constructs an empty image
+		 */
+		inline memory_image()
+			: entrypoint(0u)
+		{
+		}
+
+		/**
+		 * @brief Gets the total number of data bytes in the image
+		 */
+		size_t size() const;
+	};
+}
+
+#endif // UNBIT_IMAGE_HPP_
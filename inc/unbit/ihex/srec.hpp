@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief Motorola S-record and raw binary image support
+ */
+#ifndef UNBIT_SREC_HPP_
+#define UNBIT_SREC_HPP_ 1
+
+#include "unbit/ihex/image.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace unbit
+{
+	/**
+	 * @brief A Motorola S-record (S19/S28/S37) file reader (utility class)
+	 *
+	 * Data records (S1/S2/S3) carry 16, 24 or 32-bit absolute load addresses; the termination
+	 * records (S9/S8/S7) indicate the entrypoint and end the file. Header (S0) and record count
+	 * (S5/S6) records are skipped. The checksum of each record is verified.
+	 */
+	struct srec
+	{
+	private:
+		// Utility class (no constructor/destructor)
+		srec() =delete;
+		~srec() =delete;
+
+	public:
+		/**
+		 * @brief Streams the data records of S-record text
+		 *
+		 * Records are decoded into a fixed buffer (no allocation per record).
+		 *
+		 * @param[in] text is the content of an S-record file.
+		 * @param[in] callback specifies the callback to be invoked for loading data records.
+		 *
+		 * @return The entrypoint indicated in the termination record (if any).
+		 */
+		static uint32_t parse_records(std::string_view text, const record_callback& callback);
+
+		/**
+		 * @brief Loads an S-record file into a sparse memory image (in parallel)
+		 *
+		 * The file is mapped into memory and split into chunks at line boundaries. Since every
+		 * data record carries its absolute address, the chunks are parsed independently (on the
+		 * shared executor) and merged into the image.
+		 *
+		 * @param[in] filename specifies the path to the S-record file to be read.
+		 *
+		 * @return The loaded image. Overlapping data records are resolved in file order (i.e.
+		 *   the last record wins).
+		 */
+		static memory_image load_image(const std::string& filename);
+
+		/**
+		 * @brief Parses S-record text into a sparse memory image (in parallel)
+		 *
+		 * @param[in] text is the content of an S-record file.
+		 *
+		 * @return The loaded image (cf. @ref load_image).
+		 */
+		static memory_image parse_image(std::string_view text);
+	};
+
+	/**
+	 * @brief A raw binary file reader (utility class)
+	 */
+	struct raw_binary
+	{
+	private:
+		// Utility class (no constructor/destructor)
+		raw_binary() =delete;
+		~raw_binary() =delete;
+
+	public:
+		/**
+		 * @brief Loads a raw binary file into a memory image
+		 *
+		 * @param[in] filename specifies the path to the binary file to be read.
+		 * @param[in] base_address specifies the load address of the first byte of the file.
+		 *
+		 * @return The loaded image (a single segment at the base address; the entrypoint is
+		 *   the base address).
+		 *
+		 * @throws std::out_of_range if the file does not fit into the 32-bit address space.
+		 */
+		static memory_image load_image(const std::string& filename, uint32_t base_address);
+	};
+}
+
+#endif // UNBIT_SREC_HPP_
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Little-endian byte encoding and atomic file replacement (shared by the on-disk formats).
+ */
+#ifndef UNBIT_RUNTIME_BYTE_IO_HPP_
+#define UNBIT_RUNTIME_BYTE_IO_HPP_ 1
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace runtime
+	{
+		namespace detail
+		{
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Appends a little-endian integer to a byte buffer.
+			 */
+			template<typename T>
+			inline void put_le(std::vector<uint8_t>& out, T value)
+			{
+				for (std::size_t i = 0u; i < sizeof(T); ++i)
+					out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8u * i)));
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Decodes a little-endian integer (without bounds checking).
+			 */
+			template<typename T>
+			inline T load_le(const uint8_t* p)
+			{
+				uint64_t value = 0u;
+				for (std::size_t i = sizeof(T); i-- > 0u; )
+					value = (value << 8u) | p[i];
+
+				return static_cast<T>(value);
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Bounds-checked reader for little-endian integers in a byte buffer.
+			 *
+			 * @tparam Error is the exception type thrown (with the given message) on truncated data.
+			 */
+			template<typename Error>
+			class le_reader
+			{
+			private:
+				std::span<const uint8_t> data_;
+				std::size_t pos_;
+				const char* truncated_;
+
+			public:
+				/**
+				 * @brief Constructs a reader for a byte buffer.
+				 *
+				 * @param data is the byte buffer.
+				 * @param truncated is the message of the exception thrown on truncated data.
+				 */
+				le_reader(std::span<const uint8_t> data, const char* truncated) noexcept
+					: data_(data), pos_(0u), truncated_(truncated)
+				{
+				}
+
+				/**
+				 * @brief Reads a range of raw bytes.
+				 */
+				std::span<const uint8_t> bytes(std::size_t n)
+				{
+					if (n > data_.size() - pos_)
+						throw Error(truncated_);
+
+					const auto result = data_.subspan(pos_, n);
+					pos_ += n;
+					return result;
+				}
+
+				/**
+				 * @brief Reads a little-endian integer.
+				 */
+				template<typename T>
+				T get()
+				{
+					return load_le<T>(bytes(sizeof(T)).data());
+				}
+
+				/**
+				 * @brief Gets the number of bytes left to read.
+				 */
+				std::size_t remaining() const noexcept
+				{
+					return data_.size() - pos_;
+				}
+
+				/**
+				 * @brief Tests if all bytes have been read.
+				 */
+				bool at_end() const noexcept
+				{
+					return pos_ == data_.size();
+				}
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Replaces a file atomically (writes a temporary file, then renames it into place).
+			 *
+			 * @param path is the path of the file to replace.
+			 * @param write is invoked with the output stream of the temporary file.
+			 * @param what describes the file in error messages.
+			 */
+			template<typename Writer>
+				requires std::invocable<Writer&, std::ofstream&>
+			void replace_file(const std::filesystem::path& path, Writer&& write, const std::string& what)
+			{
+				const auto tmp_path = std::filesystem::path(path).concat(".tmp");
+				{
+					std::ofstream stm(tmp_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+					write(stm);
+					stm.flush();
+
+					if (stm.fail())
+						throw std::ios_base::failure("i/o error while writing " + what + " '" + tmp_path.string() + "'");
+				}
+
+				std::filesystem::rename(tmp_path, path);
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Replaces a file atomically with the content of a byte buffer.
+			 */
+			inline void replace_file(const std::filesystem::path& path, std::span<const uint8_t> data,
+				const std::string& what)
+			{
+				replace_file(path, [&](std::ofstream& stm)
+				{
+					stm.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+				}, what);
+			}
+		}
+	}
+}
+
+#endif // UNBIT_RUNTIME_BYTE_IO_HPP_
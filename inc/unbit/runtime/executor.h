@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief C interface of the shared work-stealing executor.
+ */
+#ifndef UNBIT_RUNTIME_EXECUTOR_H_
+#define UNBIT_RUNTIME_EXECUTOR_H_ 1
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	/**
+	 * @brief Loop body of @ref unbit_parallel_for.
+	 *
+	 * @param[in] context is the context pointer passed to @ref unbit_parallel_for.
+	 * @param[in] index is the index to be processed.
+	 *
+	 * @return 0 on success, any other value aborts the loop (and is returned by
+	 *   @ref unbit_parallel_for).
+	 */
+	typedef int (*unbit_loop_body)(void* context, size_t index);
+
+	/**
+	 * @brief Gets the number of threads of the process-wide executor.
+	 */
+	size_t unbit_executor_concurrency(void);
+
+	/**
+	 * @brief Changes the number of threads of the process-wide executor.
+	 *
+	 * @param[in] concurrency is the new number of threads (0 selects the default, i.e. the
+	 *   @c UNBIT_THREADS environment variable or the number of hardware threads).
+	 *
+	 * @return 0 on success, -1 if tasks are pending on the executor.
+	 */
+	int unbit_executor_set_concurrency(size_t concurrency);
+
+	/**
+	 * @brief Calls a function for each index in [first, last) on the process-wide executor.
+	 *
+	 * @param[in] first is the first index of the range.
+	 * @param[in] last is the end of the range (exclusive).
+	 * @param[in] grain is the minimum number of indices per chunk (0 is treated as 1).
+	 * @param[in] body is the loop body (may be called concurrently).
+	 * @param[in] context is passed to the loop body.
+	 *
+	 * @return 0 on success, the first non-zero result of the loop body, or -1 on internal errors.
+	 */
+	int unbit_parallel_for(size_t first, size_t last, size_t grain, unbit_loop_body body, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UNBIT_RUNTIME_EXECUTOR_H_ */
@@ -0,0 +1,316 @@
+/**
+ * @file
+ * @brief Shared work-stealing executor (task groups and parallel loops).
+ */
+#ifndef UNBIT_RUNTIME_EXECUTOR_HPP_
+#define UNBIT_RUNTIME_EXECUTOR_HPP_ 1
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace unbit
+{
+	namespace runtime
+	{
+		class task_group;
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Work-stealing executor.
+		 *
+		 * The executor owns a fixed set of worker threads, each with its own task deque. Tasks
+		 * submitted from a worker go to the back of the worker's deque and are run in LIFO order
+		 * by their owner; idle workers steal from the front of the other deques. Tasks submitted
+		 * from other threads go to a shared injection queue.
+		 *
+		 * Threads waiting for a @ref task_group run pending tasks while they wait, so nested
+		 * parallelism (e.g. a parallel loop inside a task) neither deadlocks nor oversubscribes
+		 * the cores. The concurrency of an executor counts the waiting thread, i.e. an executor
+		 * with a concurrency of N runs N - 1 worker threads.
+		 *
+		 * All parallel paths of unbit share the @ref global executor. Its concurrency defaults
+		 * to the @c UNBIT_THREADS environment variable (if set to a positive number) or to the
+		 * number of hardware threads, and can be changed with @ref set_concurrency.
+		 */
+		class executor
+		{
+			friend class task_group;
+
+		public:
+			/**
+			 * @brief Task type.
+			 */
+			typedef std::function<void()> task_type;
+
+		private:
+			/**
+			 * @brief Task deque of a worker thread.
+			 */
+			struct worker_queue;
+
+			/**
+			 * @brief Number of threads executing tasks (including a waiting thread).
+			 */
+			std::size_t concurrency_;
+
+			/**
+			 * @brief Task deques of the worker threads.
+			 */
+			std::vector<std::unique_ptr<worker_queue>> queues_;
+
+			/**
+			 * @brief Injection queue (tasks submitted from non-worker threads).
+			 */
+			std::unique_ptr<worker_queue> injected_;
+
+			/**
+			 * @brief Worker threads.
+			 */
+			std::vector<std::thread> threads_;
+
+			/**
+			 * @brief Number of queued (not yet started) tasks.
+			 */
+			std::atomic<std::size_t> num_queued_;
+
+			/**
+			 * @brief Protects the sleep state of the workers.
+			 */
+			std::mutex sleep_lock_;
+
+			/**
+			 * @brief Wakes up sleeping workers.
+			 */
+			std::condition_variable wake_;
+
+			/**
+			 * @brief Indicates that the workers shall terminate.
+			 */
+			bool stopping_;
+
+		public:
+			/**
+			 * @brief Constructs a new executor.
+			 *
+			 * @param[in] concurrency is the number of threads executing tasks (0 selects
+			 *   @ref default_concurrency).
+			 */
+			explicit executor(std::size_t concurrency = 0u);
+
+			/**
+			 * @brief Runs the remaining tasks and stops the worker threads.
+			 */
+			~executor();
+
+			/**
+			 * @brief Gets the number of threads executing tasks (including a waiting thread).
+			 */
+			inline std::size_t concurrency() const noexcept
+			{
+				return concurrency_;
+			}
+
+			/**
+			 * @brief Changes the number of threads executing tasks.
+			 *
+			 * @param[in] concurrency is the new number of threads (0 selects @ref default_concurrency).
+			 *
+			 * @throws std::logic_error if tasks are pending or if called from a worker thread.
+			 */
+			void set_concurrency(std::size_t concurrency);
+
+			/**
+			 * @brief Submits a task for execution.
+			 *
+			 * @note Exceptions must not escape from the task (use a @ref task_group to collect
+			 *   the exceptions of a set of tasks).
+			 */
+			void submit(task_type task);
+
+			/**
+			 * @brief Gets the default concurrency.
+			 *
+			 * @return The value of the @c UNBIT_THREADS environment variable (if set to a positive
+			 *   number), the number of hardware threads otherwise (at least 1).
+			 */
+			static std::size_t default_concurrency();
+
+			/**
+			 * @brief Gets the process-wide executor (created on first use).
+			 */
+			static executor& global();
+
+		private:
+			/**
+			 * @brief Starts the worker threads.
+			 */
+			void start(std::size_t concurrency);
+
+			/**
+			 * @brief Stops the worker threads (after running the remaining tasks).
+			 */
+			void stop();
+
+			/**
+			 * @brief Main loop of a worker thread.
+			 */
+			void worker_main(std::size_t index);
+
+			/**
+			 * @brief Runs a single queued task (if any).
+			 *
+			 * @return @c true if a task was run.
+			 */
+			bool try_run_one();
+
+			// Non-copyable
+			executor(const executor&) =delete;
+			executor& operator=(const executor&) =delete;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Group of tasks (with exception propagation).
+		 *
+		 * Tasks are run on an executor; @ref wait blocks until all tasks of the group completed
+		 * and rethrows the first exception thrown by a task. Tasks that did not start yet when a
+		 * task failed are skipped.
+		 */
+		class task_group
+		{
+		private:
+			/**
+			 * @brief Executor running the tasks.
+			 */
+			executor& exec_;
+
+			/**
+			 * @brief Number of submitted but not completed tasks.
+			 */
+			std::atomic<std::size_t> pending_;
+
+			/**
+			 * @brief Indicates that a task failed (remaining tasks are skipped).
+			 */
+			std::atomic<bool> failed_;
+
+			/**
+			 * @brief Protects the captured exception.
+			 */
+			std::mutex lock_;
+
+			/**
+			 * @brief First exception thrown by a task.
+			 */
+			std::exception_ptr error_;
+
+		public:
+			/**
+			 * @brief Constructs a new task group.
+			 *
+			 * @param[in] exec is the executor running the tasks.
+			 */
+			explicit task_group(executor& exec = executor::global());
+
+			/**
+			 * @brief Waits for the remaining tasks (exceptions are discarded).
+			 */
+			~task_group();
+
+			/**
+			 * @brief Runs a task as part of this group.
+			 */
+			void run(executor::task_type task);
+
+			/**
+			 * @brief Waits for all tasks of this group (the calling thread helps running tasks).
+			 *
+			 * @throws The first exception thrown by a task of this group.
+			 */
+			void wait();
+
+		private:
+			/**
+			 * @brief Waits for all tasks of this group (without rethrowing).
+			 */
+			void join() noexcept;
+
+			// Non-copyable
+			task_group(const task_group&) =delete;
+			task_group& operator=(const task_group&) =delete;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Runs a function for each index of a range (in parallel).
+		 *
+		 * The range is split into chunks of at least @p grain indices (and at most four chunks per
+		 * thread of the executor, leaving room for load balancing by stealing). The calling thread
+		 * takes part in the loop. Ranges that fit into a single chunk, and executors with a
+		 * concurrency of 1, run serially on the calling thread.
+		 *
+		 * @param[in] exec is the executor running the loop.
+		 * @param[in] first is the first index of the range.
+		 * @param[in] last is the end of the range (exclusive).
+		 * @param[in] fn is the function to be called for each index (may be called concurrently).
+		 * @param[in] grain is the minimum number of indices per chunk.
+		 *
+		 * @throws The first exception thrown by @p fn.
+		 */
+		template<typename Fn>
+		void parallel_for(executor& exec, std::size_t first, std::size_t last, Fn&& fn, std::size_t grain = 1u)
+		{
+			if (first >= last)
+				return;
+
+			const std::size_t count = last - first;
+			grain = std::max<std::size_t>(grain, 1u);
+
+			if (exec.concurrency() <= 1u || count <= grain)
+			{
+				for (std::size_t i = first; i < last; ++i)
+					fn(i);
+
+				return;
+			}
+
+			const std::size_t num_chunks = std::min((count + grain - 1u) / grain, 4u * exec.concurrency());
+			const std::size_t chunk = (count + num_chunks - 1u) / num_chunks;
+
+			task_group group(exec);
+
+			for (std::size_t begin = first; begin < last; begin += chunk)
+			{
+				const std::size_t end = std::min(last, begin + chunk);
+
+				group.run([&fn, begin, end]()
+				{
+					for (std::size_t i = begin; i < end; ++i)
+						fn(i);
+				});
+			}
+
+			group.wait();
+		}
+
+		/**
+		 * @brief Runs a function for each index of a range (in parallel, on the global executor).
+		 */
+		template<typename Fn>
+		void parallel_for(std::size_t first, std::size_t last, Fn&& fn, std::size_t grain = 1u)
+		{
+			parallel_for(executor::global(), first, last, std::forward<Fn>(fn), grain);
+		}
+	}
+}
+
+#endif // UNBIT_RUNTIME_EXECUTOR_HPP_
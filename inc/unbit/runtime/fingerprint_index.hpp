@@ -0,0 +1,279 @@
+/**
+ * @file
+ * @brief On-disk inverted index of rolling window hashes (firmware fingerprint search).
+ */
+#ifndef UNBIT_RUNTIME_FINGERPRINT_INDEX_HPP_
+#define UNBIT_RUNTIME_FINGERPRINT_INDEX_HPP_ 1
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace runtime
+	{
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Parameters of a fingerprint index.
+		 */
+		struct fingerprint_options
+		{
+			/**
+			 * @brief Size of the hashed windows (in bytes).
+			 */
+			std::size_t window = 64u;
+
+			/**
+			 * @brief Distance of the indexed windows (in bytes).
+			 *
+			 * Windows of the indexed images start at multiples of the stride; a query matches if it
+			 * covers at least one complete indexed window (i.e. queries should be at least
+			 * @c window + @c stride bytes long).
+			 */
+			std::size_t stride = 32u;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Description of an indexed memory image.
+		 */
+		struct fingerprint_image
+		{
+			/** @brief Source of the image (e.g. the path of the bitstream). */
+			std::string source;
+
+			/** @brief Memory instance (e.g. the processor instance in the MMI file). */
+			std::string instance;
+
+			/** @brief Region (address space) of the instance. */
+			std::string region;
+
+			/** @brief Start address of the image. */
+			uint64_t base_address = 0u;
+
+			/** @brief Size of the image (in bytes). */
+			uint64_t size = 0u;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Match of a fingerprint query.
+		 */
+		struct fingerprint_match
+		{
+			/** @brief Index of the matching image. */
+			uint32_t image;
+
+			/** @brief Address of the query's first byte in the image (may lie before the image). */
+			int64_t address;
+
+			/** @brief Number of indexed windows of the image that match the query. */
+			std::size_t matched_windows;
+
+			/** @brief Number of indexed windows expected to match for an identical copy of the query. */
+			std::size_t expected_windows;
+
+			/**
+			 * @brief Gets the fraction of the expected windows that match.
+			 */
+			inline double coverage() const noexcept
+			{
+				return (expected_windows > 0u) ? static_cast<double>(matched_windows) / static_cast<double>(expected_windows) : 0.0;
+			}
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Builds a fingerprint index.
+		 *
+		 * Each image is split into windows starting at multiples of the stride. Windows with a
+		 * single repeated byte value (erased or zero-initialized memory) are skipped, all other
+		 * windows are recorded by their (Rabin-Karp) rolling hash. Images can be added concurrently
+		 * from multiple threads; the hashes are computed outside of the builder's lock.
+		 *
+		 * The index file (little-endian, magic number "UNBFPI01") contains the parameters, the image
+		 * table, a directory of 65536 buckets (by the upper 16 bits of the hash) and the postings
+		 * (hash, image and offset) sorted by hash.
+		 */
+		class fingerprint_index_builder
+		{
+		public:
+			/**
+			 * @brief Posting of an indexed window.
+			 */
+			struct posting
+			{
+				/** @brief Hash of the window. */
+				uint64_t hash;
+
+				/** @brief Index of the image. */
+				uint32_t image;
+
+				/** @brief Offset of the window in the image. */
+				uint32_t offset;
+			};
+
+		private:
+			/**
+			 * @brief Parameters of the index.
+			 */
+			fingerprint_options options_;
+
+			/**
+			 * @brief Images added so far.
+			 */
+			std::vector<fingerprint_image> images_;
+
+			/**
+			 * @brief Postings of all images.
+			 */
+			std::vector<posting> postings_;
+
+			/**
+			 * @brief Lock protecting the images and postings.
+			 */
+			std::mutex lock_;
+
+		public:
+			/**
+			 * @brief Constructs an empty index builder.
+			 *
+			 * @param options specifies the parameters of the index.
+			 */
+			explicit fingerprint_index_builder(const fingerprint_options& options = fingerprint_options());
+
+			/**
+			 * @brief Destroys the index builder.
+			 */
+			~fingerprint_index_builder();
+
+			/**
+			 * @brief Adds an image (thread-safe).
+			 *
+			 * @param image describes the image (the size is taken from the data).
+			 * @param data specifies the contents of the image (at most 4 GiB).
+			 *
+			 * @return The index of the image.
+			 */
+			uint32_t add(fingerprint_image image, std::span<const uint8_t> data);
+
+			/**
+			 * @brief Gets the number of images added so far.
+			 */
+			std::size_t num_images();
+
+			/**
+			 * @brief Gets the number of postings added so far.
+			 */
+			std::size_t num_postings();
+
+			/**
+			 * @brief Writes the index file (atomically replacing an existing file).
+			 *
+			 * @param filename specifies the name (and path) of the index file.
+			 */
+			void write(const std::string& filename);
+
+		private:
+			// Non-copyable
+			fingerprint_index_builder(const fingerprint_index_builder&) =delete;
+			fingerprint_index_builder& operator=(const fingerprint_index_builder&) =delete;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Read access to a fingerprint index file.
+		 *
+		 * Opening an index reads the parameters, the image table and the bucket directory; the
+		 * postings are read on demand (one read per bucket touched by a query).
+		 */
+		class fingerprint_index
+		{
+		private:
+			/**
+			 * @brief Index file.
+			 */
+			mutable std::ifstream file_;
+
+			/**
+			 * @brief Parameters of the index.
+			 */
+			fingerprint_options options_;
+
+			/**
+			 * @brief Indexed images.
+			 */
+			std::vector<fingerprint_image> images_;
+
+			/**
+			 * @brief Bucket directory (first posting of each bucket, plus the end).
+			 */
+			std::vector<uint64_t> buckets_;
+
+			/**
+			 * @brief File offset of the postings.
+			 */
+			uint64_t postings_offset_;
+
+		public:
+			/**
+			 * @brief Opens an index file.
+			 *
+			 * @param filename specifies the name (and path) of the index file.
+			 */
+			explicit fingerprint_index(const std::string& filename);
+
+			/**
+			 * @brief Closes the index file.
+			 */
+			~fingerprint_index();
+
+			/**
+			 * @brief Gets the parameters of the index.
+			 */
+			inline const fingerprint_options& options() const noexcept
+			{
+				return options_;
+			}
+
+			/**
+			 * @brief Gets the indexed images.
+			 */
+			inline const std::vector<fingerprint_image>& images() const noexcept
+			{
+				return images_;
+			}
+
+			/**
+			 * @brief Gets the number of postings in the index.
+			 */
+			inline uint64_t num_postings() const noexcept
+			{
+				return buckets_.back();
+			}
+
+			/**
+			 * @brief Finds the images containing (a copy of) a binary.
+			 *
+			 * @param binary specifies the binary to be searched.
+			 * @param min_coverage specifies the minimum fraction of the expected windows that must
+			 *   match (0.0 to 1.0).
+			 *
+			 * @return The matches (in descending order of coverage).
+			 */
+			std::vector<fingerprint_match> query(std::span<const uint8_t> binary, double min_coverage = 0.5) const;
+
+		private:
+			// Non-copyable
+			fingerprint_index(const fingerprint_index&) =delete;
+			fingerprint_index& operator=(const fingerprint_index&) =delete;
+		};
+	}
+}
+
+#endif // UNBIT_RUNTIME_FINGERPRINT_INDEX_HPP_
@@ -0,0 +1,322 @@
+/**
+ * @file
+ * @brief Memory footprint accounting and peak-RSS reporting.
+ */
+#ifndef UNBIT_RUNTIME_MEM_STATS_HPP_
+#define UNBIT_RUNTIME_MEM_STATS_HPP_ 1
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace runtime
+	{
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Subsystems with tracked memory usage.
+		 */
+		enum class mem_subsystem : uint32_t
+		{
+			/**
+			 * @brief Raw input data (e.g. bitstream and readback files loaded into memory).
+			 */
+			input_buffers = 0u,
+
+			/**
+			 * @brief Materialized configuration frames (frame stores).
+			 */
+			frame_store = 1u,
+
+			/**
+			 * @brief Memory map information (MMI address spaces and bit lanes).
+			 */
+			mmi_maps = 2u,
+
+			/**
+			 * @brief Packet and (sub-)stream indices derived from bitstreams.
+			 */
+			packet_index = 3u
+		};
+
+		/**
+		 * @brief Number of tracked subsystems.
+		 */
+		static constexpr std::size_t NUM_MEM_SUBSYSTEMS = 4u;
+
+		/**
+		 * @brief Gets the display name of a subsystem.
+		 */
+		const char* mem_subsystem_name(mem_subsystem subsystem);
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Tracked memory usage of a subsystem.
+		 */
+		struct mem_usage
+		{
+			/**
+			 * @brief Currently tracked bytes.
+			 */
+			uint64_t current_bytes = 0u;
+
+			/**
+			 * @brief Maximum of the tracked bytes since process start.
+			 */
+			uint64_t peak_bytes = 0u;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Memory usage sample taken at a phase boundary.
+		 */
+		struct mem_phase_sample
+		{
+			/**
+			 * @brief Name of the phase that ended at this boundary.
+			 */
+			std::string name;
+
+			/**
+			 * @brief Tracked bytes per subsystem at the end of the phase.
+			 */
+			std::array<uint64_t, NUM_MEM_SUBSYSTEMS> tracked_bytes {};
+
+			/**
+			 * @brief Total tracked bytes at the end of the phase.
+			 */
+			uint64_t tracked_total = 0u;
+
+			/**
+			 * @brief Maximum of the total tracked bytes during the phase.
+			 */
+			uint64_t peak_tracked_total = 0u;
+
+			/**
+			 * @brief Resident set size at the end of the phase (if known).
+			 */
+			std::optional<uint64_t> rss_bytes;
+
+			/**
+			 * @brief Peak resident set size (if known).
+			 *
+			 * @note The peak covers only the phase itself if @ref peak_rss_per_phase is set. Otherwise
+			 *   (the kernel refused to reset the high-water mark) it is the peak since process start.
+			 */
+			std::optional<uint64_t> peak_rss_bytes;
+
+			/**
+			 * @brief Indicates if @ref peak_rss_bytes is restricted to this phase.
+			 */
+			bool peak_rss_per_phase = false;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Snapshot of the memory statistics of the process.
+		 */
+		struct mem_snapshot
+		{
+			/**
+			 * @brief Tracked usage per subsystem (indexed by @ref mem_subsystem).
+			 */
+			std::array<mem_usage, NUM_MEM_SUBSYSTEMS> subsystems {};
+
+			/**
+			 * @brief Total tracked usage (all subsystems).
+			 */
+			mem_usage total;
+
+			/**
+			 * @brief Current resident set size (if known).
+			 */
+			std::optional<uint64_t> rss_bytes;
+
+			/**
+			 * @brief Peak resident set size since process start (or the last phase boundary).
+			 */
+			std::optional<uint64_t> peak_rss_bytes;
+
+			/**
+			 * @brief Samples taken at the phase boundaries (in order).
+			 */
+			std::vector<mem_phase_sample> phases;
+
+			/**
+			 * @brief Gets the tracked usage of a subsystem.
+			 */
+			inline const mem_usage& operator[](mem_subsystem subsystem) const
+			{
+				return subsystems[static_cast<std::size_t>(subsystem)];
+			}
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Process-wide memory accounting (utility class).
+		 *
+		 * Components that own large allocations (input buffers, frame stores, MMI maps, packet
+		 * indices) register their footprint with @ref track and @ref untrack, typically through a
+		 * @ref mem_account member. Tools mark phase boundaries with @ref end_phase; each boundary
+		 * records the tracked bytes and the resident set size (RSS) reported by the operating
+		 * system, which allows checking that supposedly zero-copy paths do not duplicate data.
+		 * Phase boundaries are only recorded after @ref enable_phases.
+		 *
+		 * Tracking is lock-free and may be used from any thread.
+		 */
+		struct mem_stats
+		{
+		private:
+			// Utility class (no constructor/destructor)
+			mem_stats() =delete;
+			~mem_stats() =delete;
+
+		public:
+			/**
+			 * @brief Adds bytes to the tracked usage of a subsystem.
+			 */
+			static void track(mem_subsystem subsystem, std::size_t num_bytes) noexcept;
+
+			/**
+			 * @brief Removes bytes from the tracked usage of a subsystem.
+			 */
+			static void untrack(mem_subsystem subsystem, std::size_t num_bytes) noexcept;
+
+			/**
+			 * @brief Gets the current tracked usage of a subsystem.
+			 */
+			static mem_usage usage(mem_subsystem subsystem) noexcept;
+
+			/**
+			 * @brief Takes a snapshot of the memory statistics.
+			 */
+			static mem_snapshot snapshot();
+
+			/**
+			 * @brief Enables the recording of phase samples (e.g. for a --mem-report option).
+			 *
+			 * Phase boundaries read the resident set size from the operating system and reset its
+			 * high-water mark; @ref end_phase does nothing until recording is enabled. Enabling
+			 * resets the high-water mark, so that the first sample covers the first phase only.
+			 */
+			static void enable_phases();
+
+			/**
+			 * @brief Indicates if the recording of phase samples is enabled.
+			 */
+			static bool phases_enabled() noexcept;
+
+			/**
+			 * @brief Marks the end of a processing phase.
+			 *
+			 * Records the tracked bytes and the (peak) resident set size, then resets the peak
+			 * values so that the next sample covers the following phase only. Without
+			 * @ref enable_phases nothing is sampled or recorded.
+			 *
+			 * @param[in] name is the name of the phase that just ended.
+			 *
+			 * @return The recorded sample (only the name, if recording is disabled).
+			 */
+			static mem_phase_sample end_phase(const std::string& name);
+
+			/**
+			 * @brief Discards all recorded phase samples.
+			 */
+			static void clear_phases();
+
+			/**
+			 * @brief Gets the current resident set size of the process (if supported).
+			 */
+			static std::optional<uint64_t> current_rss();
+
+			/**
+			 * @brief Gets the peak resident set size of the process (if supported).
+			 */
+			static std::optional<uint64_t> peak_rss();
+
+			/**
+			 * @brief Writes a human-readable memory report (phases and subsystems).
+			 */
+			static void report(std::ostream& os);
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Tracked allocation of a subsystem (RAII handle).
+		 *
+		 * The account registers its byte count with @ref mem_stats on construction (and on
+		 * @ref resize), and deregisters it on destruction. Accounts are movable, so that they can be
+		 * embedded as members of movable owners.
+		 */
+		class mem_account
+		{
+		private:
+			/**
+			 * @brief Subsystem of this account.
+			 */
+			mem_subsystem subsystem_;
+
+			/**
+			 * @brief Number of bytes registered by this account.
+			 */
+			std::size_t num_bytes_;
+
+		public:
+			/**
+			 * @brief Constructs a new account.
+			 *
+			 * @param[in] subsystem is the subsystem to charge.
+			 * @param[in] num_bytes is the initial number of bytes.
+			 */
+			explicit mem_account(mem_subsystem subsystem, std::size_t num_bytes = 0u) noexcept;
+
+			/**
+			 * @brief Move constructor (transfers the registered bytes).
+			 */
+			mem_account(mem_account&& other) noexcept;
+
+			/**
+			 * @brief Move assignment (transfers the registered bytes).
+			 */
+			mem_account& operator=(mem_account&& other) noexcept;
+
+			/**
+			 * @brief Deregisters the bytes of this account.
+			 */
+			~mem_account();
+
+			/**
+			 * @brief Changes the number of registered bytes.
+			 */
+			void resize(std::size_t num_bytes) noexcept;
+
+			/**
+			 * @brief Gets the number of registered bytes.
+			 */
+			inline std::size_t bytes() const noexcept
+			{
+				return num_bytes_;
+			}
+
+			/**
+			 * @brief Gets the subsystem of this account.
+			 */
+			inline mem_subsystem subsystem() const noexcept
+			{
+				return subsystem_;
+			}
+
+		private:
+			// Non-copyable
+			mem_account(const mem_account&) =delete;
+			mem_account& operator=(const mem_account&) =delete;
+		};
+	}
+}
+
+#endif // UNBIT_RUNTIME_MEM_STATS_HPP_
@@ -0,0 +1,134 @@
+/**
+ * @file
+ * @brief SHA-256 message digest (content addressing of frames and files).
+ */
+#ifndef UNBIT_RUNTIME_SHA256_HPP_
+#define UNBIT_RUNTIME_SHA256_HPP_ 1
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace unbit
+{
+	namespace runtime
+	{
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Incremental SHA-256 message digest (FIPS 180-4).
+		 */
+		class sha256
+		{
+		public:
+			/**
+			 * @brief Size of a digest in bytes.
+			 */
+			static constexpr std::size_t DIGEST_SIZE = 32u;
+
+			/**
+			 * @brief Digest type.
+			 */
+			using digest = std::array<uint8_t, DIGEST_SIZE>;
+
+		private:
+			/**
+			 * @brief Chaining state.
+			 */
+			std::array<uint32_t, 8u> state_;
+
+			/**
+			 * @brief Partial input block.
+			 */
+			std::array<uint8_t, 64u> block_;
+
+			/**
+			 * @brief Number of bytes in the partial input block.
+			 */
+			std::size_t block_len_;
+
+			/**
+			 * @brief Total number of bytes processed so far.
+			 */
+			uint64_t total_len_;
+
+		public:
+			/**
+			 * @brief Constructs a new (reset) digest.
+			 */
+			sha256() noexcept;
+
+			/**
+			 * @brief Resets the digest.
+			 */
+			void reset() noexcept;
+
+			/**
+			 * @brief Processes a block of data.
+			 *
+			 * @param data specifies the data to be processed.
+			 */
+			void update(std::span<const uint8_t> data) noexcept;
+
+			/**
+			 * @brief Processes a sequence of 32-bit words (in big-endian byte order).
+			 *
+			 * @param words specifies the words to be processed.
+			 */
+			void update_be(std::span<const uint32_t> words) noexcept;
+
+			/**
+			 * @brief Finishes the digest (the digest is reset afterwards).
+			 *
+			 * @return The message digest.
+			 */
+			digest finish() noexcept;
+
+			/**
+			 * @brief Computes the digest of a block of data.
+			 *
+			 * @param data specifies the data to be hashed.
+			 */
+			static digest hash(std::span<const uint8_t> data) noexcept;
+
+			/**
+			 * @brief Computes the digest of a sequence of 32-bit words (in big-endian byte order).
+			 *
+			 * @param words specifies the words to be hashed.
+			 */
+			static digest hash_be(std::span<const uint32_t> words) noexcept;
+
+			/**
+			 * @brief Formats a digest as hexadecimal string.
+			 */
+			static std::string to_hex(const digest& d);
+
+		private:
+			/**
+			 * @brief Processes a complete 64-byte block.
+			 */
+			void compress(const uint8_t* block) noexcept;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Hash functor for digests (for use with unordered containers).
+		 */
+		struct sha256_digest_hash
+		{
+			inline std::size_t operator()(const sha256::digest& d) const noexcept
+			{
+				// The digest is uniformly distributed; its leading bytes are a good hash
+				std::size_t h = 0u;
+
+				for (std::size_t i = 0u; i < sizeof(std::size_t); ++i)
+					h = (h << 8u) | d[i];
+
+				return h;
+			}
+		};
+	}
+}
+
+#endif // UNBIT_RUNTIME_SHA256_HPP_
@@ -0,0 +1,206 @@
+/**
+ * @file
+ * @brief Micro-benchmark harness with optional hardware performance counters.
+ */
+#include "bench_harness.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+namespace unbit
+{
+	namespace bench
+	{
+		namespace
+		{
+			/**
+			 * @brief Sink for consumed benchmark values.
+			 */
+			static volatile uint64_t value_sink = 0u;
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Writes a per-iteration event count (or n/a) to an output stream.
+			 */
+			static void print_per_iteration(std::ostream& os, const bench_result& r, perf_event ev, int width)
+			{
+				const auto& count = r.counters[ev];
+
+				if (count && r.iterations > 0u)
+				{
+					os << std::setw(width) << (static_cast<double>(*count) / static_cast<double>(r.iterations));
+				}
+				else
+				{
+					os << std::setw(width) << "n/a";
+				}
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void consume(uint64_t value)
+		{
+			value_sink = value_sink + value;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		double bench_result::mib_per_second() const
+		{
+			if (seconds <= 0.0)
+				return 0.0;
+
+			return (static_cast<double>(bytes_per_iteration) * static_cast<double>(iterations)) /
+				(seconds * 1024.0 * 1024.0);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		double bench_result::ipc() const
+		{
+			const auto& cycles = counters[perf_event::cycles];
+			const auto& instructions = counters[perf_event::instructions];
+
+			if (!cycles || !instructions || *cycles == 0u)
+				return 0.0;
+
+			return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		double bench_result::bytes_per_cycle() const
+		{
+			const auto& cycles = counters[perf_event::cycles];
+
+			if (!cycles || *cycles == 0u)
+				return 0.0;
+
+			return (static_cast<double>(bytes_per_iteration) * static_cast<double>(iterations)) /
+				static_cast<double>(*cycles);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bench_harness::bench_harness(const bench_options& options)
+			: options_(options), counters_(options.use_perf)
+		{
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bench_harness::~bench_harness()
+		{
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bool bench_harness::selected(const std::string& name) const
+		{
+			return options_.filter.empty() || (name.find(options_.filter) != std::string::npos);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void bench_harness::run(const std::string& name, uint64_t bytes_per_iteration, const std::function<void()>& body)
+		{
+			if (!selected(name))
+				return;
+
+			typedef std::chrono::steady_clock clock_type;
+
+			// Warm-up (caches, page faults, branch predictors)
+			body();
+
+			bench_result result;
+			result.name = name;
+			result.bytes_per_iteration = bytes_per_iteration;
+
+			// Measure
+			const auto start = clock_type::now();
+			auto now = start;
+
+			counters_.start();
+
+			do
+			{
+				body();
+				++result.iterations;
+
+				now = clock_type::now();
+			}
+			while (result.iterations < options_.min_iterations ||
+				std::chrono::duration<double>(now - start).count() < options_.min_time);
+
+			counters_.stop();
+
+			result.seconds  = std::chrono::duration<double>(now - start).count();
+			result.counters = counters_.read();
+
+			results_.push_back(std::move(result));
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void bench_harness::report(std::ostream& os) const
+		{
+			const auto old_flags = os.flags();
+			const auto old_precision = os.precision();
+
+			os << std::left << std::setw(28) << "benchmark" << std::right
+				<< std::setw(8)  << "iters"
+				<< std::setw(12) << "us/iter"
+				<< std::setw(11) << "MiB/s"
+				<< std::setw(7)  << "IPC"
+				<< std::setw(9)  << "B/cycle"
+				<< std::setw(13) << "L1D-miss/it"
+				<< std::setw(13) << "LLC-miss/it"
+				<< std::setw(13) << "br-miss/it"
+				<< std::setw(13) << "dTLB-miss/it"
+				<< std::endl;
+
+			os << std::fixed;
+
+			for (const auto& r : results_)
+			{
+				const double us_per_iteration = (r.iterations > 0u) ?
+					(r.seconds * 1000000.0 / static_cast<double>(r.iterations)) : 0.0;
+
+				os << std::left << std::setw(28) << r.name << std::right
+					<< std::setw(8) << r.iterations
+					<< std::setprecision(3) << std::setw(12) << us_per_iteration
+					<< std::setprecision(1) << std::setw(11) << r.mib_per_second()
+					<< std::setprecision(2);
+
+				if (r.counters[perf_event::cycles] && r.counters[perf_event::instructions])
+				{
+					os << std::setw(7) << r.ipc();
+				}
+				else
+				{
+					os << std::setw(7) << "n/a";
+				}
+
+				if (r.counters[perf_event::cycles])
+				{
+					os << std::setw(9) << r.bytes_per_cycle();
+				}
+				else
+				{
+					os << std::setw(9) << "n/a";
+				}
+
+				os << std::setprecision(0);
+				print_per_iteration(os, r, perf_event::l1d_misses, 13);
+				print_per_iteration(os, r, perf_event::llc_misses, 13);
+				print_per_iteration(os, r, perf_event::branch_misses, 13);
+				print_per_iteration(os, r, perf_event::dtlb_misses, 13);
+				os << std::endl;
+			}
+
+			if (options_.use_perf && !counters_.any_available())
+			{
+				os << std::endl
+					<< "note: hardware performance counters are unavailable (no PMU access, e.g. due to"
+					<< " perf_event_paranoid or container restrictions); reporting wall-clock figures only."
+					<< std::endl;
+			}
+
+			os.flags(old_flags);
+			os.precision(old_precision);
+		}
+	}
+}
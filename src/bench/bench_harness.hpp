@@ -0,0 +1,188 @@
+/**
+ * @file
+ * @brief Micro-benchmark harness with optional hardware performance counters.
+ */
+#ifndef UNBIT_BENCH_BENCH_HARNESS_HPP_
+#define UNBIT_BENCH_BENCH_HARNESS_HPP_ 1
+
+#include "perf_counters.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace bench
+	{
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Options of the benchmark harness.
+		 */
+		struct bench_options
+		{
+			/**
+			 * @brief Minimum measurement time per benchmark (in seconds).
+			 */
+			double min_time = 0.5;
+
+			/**
+			 * @brief Minimum number of iterations per benchmark.
+			 */
+			std::size_t min_iterations = 1u;
+
+			/**
+			 * @brief Use hardware performance counters (if available).
+			 */
+			bool use_perf = true;
+
+			/**
+			 * @brief Only run benchmarks whose name contains this string (empty runs all).
+			 */
+			std::string filter;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Result of a single benchmark.
+		 */
+		struct bench_result
+		{
+			/**
+			 * @brief Name of the benchmark.
+			 */
+			std::string name;
+
+			/**
+			 * @brief Number of measured iterations.
+			 */
+			std::size_t iterations = 0u;
+
+			/**
+			 * @brief Total wall-clock time of the measured iterations (in seconds).
+			 */
+			double seconds = 0.0;
+
+			/**
+			 * @brief Number of bytes processed per iteration.
+			 */
+			uint64_t bytes_per_iteration = 0u;
+
+			/**
+			 * @brief Hardware event counts (total over all measured iterations).
+			 */
+			perf_sample counters;
+
+			/**
+			 * @brief Gets the throughput in MiB/s.
+			 */
+			double mib_per_second() const;
+
+			/**
+			 * @brief Gets the instructions per cycle (0 if unavailable).
+			 */
+			double ipc() const;
+
+			/**
+			 * @brief Gets the processed bytes per cycle (0 if unavailable).
+			 */
+			double bytes_per_cycle() const;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Micro-benchmark harness.
+		 *
+		 * Each benchmark body is run once for warm-up, and then repeatedly until the minimum
+		 * measurement time has elapsed. Hardware performance counters (if available) cover the
+		 * measured iterations.
+		 */
+		class bench_harness
+		{
+		private:
+			/**
+			 * @brief Options of this harness.
+			 */
+			bench_options options_;
+
+			/**
+			 * @brief Hardware performance counters (of the benchmark thread).
+			 */
+			perf_counters counters_;
+
+			/**
+			 * @brief Results of the benchmarks run so far.
+			 */
+			std::vector<bench_result> results_;
+
+		public:
+			/**
+			 * @brief Constructs a new benchmark harness.
+			 *
+			 * @param options specifies the options of the harness.
+			 */
+			explicit bench_harness(const bench_options& options);
+
+			/**
+			 * @brief Destroys the benchmark harness.
+			 */
+			~bench_harness();
+
+			/**
+			 * @brief Tests if a benchmark is selected by the name filter.
+			 *
+			 * @param name is the name of the benchmark.
+			 */
+			bool selected(const std::string& name) const;
+
+			/**
+			 * @brief Tests if hardware performance counters are available.
+			 */
+			inline bool have_counters() const
+			{
+				return counters_.any_available();
+			}
+
+			/**
+			 * @brief Runs a benchmark (if it is selected by the name filter).
+			 *
+			 * @param name is the name of the benchmark.
+			 * @param bytes_per_iteration is the number of bytes processed by each iteration.
+			 * @param body is the benchmark body (one iteration).
+			 */
+			void run(const std::string& name, uint64_t bytes_per_iteration, const std::function<void()>& body);
+
+			/**
+			 * @brief Gets the results of the benchmarks run so far.
+			 */
+			inline const std::vector<bench_result>& results() const
+			{
+				return results_;
+			}
+
+			/**
+			 * @brief Writes a report of all results.
+			 *
+			 * @param os is the output stream to write to.
+			 */
+			void report(std::ostream& os) const;
+
+		private:
+			// Non-copyable
+			bench_harness(const bench_harness&) =delete;
+			bench_harness& operator=(const bench_harness&) =delete;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Consumes a value (prevents the compiler from optimizing away benchmark results).
+		 */
+		void consume(uint64_t value);
+	}
+}
+
+#endif // UNBIT_BENCH_BENCH_HARNESS_HPP_
@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief Differential verification harness (reference vs. optimized implementations).
+ */
+#include "diff_harness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+
+namespace unbit
+{
+	namespace bench
+	{
+		//----------------------------------------------------------------------------------------------
+		double diff_result::speedup() const
+		{
+			if (reference_seconds <= 0.0 || candidate_seconds <= 0.0)
+				return 0.0;
+
+			return reference_seconds / candidate_seconds;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		diff_harness::diff_harness(const diff_options& options)
+			: options_(options)
+		{
+		}
+
+		//----------------------------------------------------------------------------------------------
+		diff_harness::~diff_harness()
+		{
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bool diff_harness::selected(const std::string& name) const
+		{
+			return options_.filter.empty() || (name.find(options_.filter) != std::string::npos);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::vector<uint8_t> diff_harness::measure(const impl_type& impl, double& seconds) const
+		{
+			typedef std::chrono::steady_clock clock_type;
+
+			const auto start = clock_type::now();
+			auto now = start;
+
+			// The first run produces the output to be compared (and counts as a measured run)
+			std::vector<uint8_t> output = impl();
+			std::size_t iterations = 1u;
+			now = clock_type::now();
+
+			while (std::chrono::duration<double>(now - start).count() < options_.min_time)
+			{
+				impl();
+				++iterations;
+
+				now = clock_type::now();
+			}
+
+			seconds = std::chrono::duration<double>(now - start).count() / static_cast<double>(iterations);
+			return output;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bool diff_harness::check(const std::string& name, const impl_type& reference, const impl_type& candidate)
+		{
+			if (!selected(name))
+				return true;
+
+			diff_result& result = results_.emplace_back();
+			result.name = name;
+
+			try
+			{
+				const auto expected = measure(reference, result.reference_seconds);
+				const auto actual = measure(candidate, result.candidate_seconds);
+
+				result.bytes = expected.size();
+
+				const auto diff = std::mismatch(expected.begin(), expected.end(), actual.begin(), actual.end());
+
+				if (diff.first == expected.end() && diff.second == actual.end())
+				{
+					result.match = true;
+				}
+				else if (expected.size() != actual.size())
+				{
+					result.detail = "size mismatch (" + std::to_string(expected.size()) + " vs. " +
+						std::to_string(actual.size()) + " bytes)";
+				}
+				else
+				{
+					const std::size_t offset = static_cast<std::size_t>(diff.first - expected.begin());
+					const std::size_t count = static_cast<std::size_t>(
+						std::inner_product(expected.begin(), expected.end(), actual.begin(), std::size_t(0u),
+							std::plus<std::size_t>(), std::not_equal_to<uint8_t>()));
+
+					result.detail = std::to_string(count) + " byte(s) differ, first at offset " + std::to_string(offset);
+				}
+			}
+			catch (std::exception& e)
+			{
+				result.match = false;
+				result.detail = std::string("exception: ") + e.what();
+			}
+
+			return result.match;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::size_t diff_harness::num_failures() const
+		{
+			return static_cast<std::size_t>(std::count_if(results_.begin(), results_.end(),
+				[](const diff_result& r) { return !r.match; }));
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void diff_harness::report(std::ostream& os) const
+		{
+			const auto old_flags = os.flags();
+			const auto old_precision = os.precision();
+
+			os << std::left << std::setw(36) << "check" << std::right
+				<< std::setw(11) << "bytes"
+				<< std::setw(14) << "legacy ms"
+				<< std::setw(14) << "optimized ms"
+				<< std::setw(10) << "speedup"
+				<< "  result"
+				<< std::endl;
+
+			os << std::fixed;
+
+			for (const auto& r : results_)
+			{
+				os << std::left << std::setw(36) << r.name << std::right
+					<< std::setw(11) << r.bytes
+					<< std::setprecision(3)
+					<< std::setw(14) << (r.reference_seconds * 1000.0)
+					<< std::setw(14) << (r.candidate_seconds * 1000.0)
+					<< std::setprecision(1);
+
+				if (r.speedup() > 0.0)
+				{
+					os << std::setw(9) << r.speedup() << 'x';
+				}
+				else
+				{
+					os << std::setw(10) << "n/a";
+				}
+
+				os << "  " << (r.match ? "ok" : "FAILED: " + r.detail) << std::endl;
+			}
+
+			os << std::endl << (results_.size() - num_failures()) << " of " << results_.size()
+				<< " check(s) passed" << std::endl;
+
+			os.flags(old_flags);
+			os.precision(old_precision);
+		}
+	}
+}
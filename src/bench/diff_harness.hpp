@@ -0,0 +1,172 @@
+/**
+ * @file
+ * @brief Differential verification harness (reference vs. optimized implementations).
+ */
+#ifndef UNBIT_BENCH_DIFF_HARNESS_HPP_
+#define UNBIT_BENCH_DIFF_HARNESS_HPP_ 1
+
+#include <cstdint>
+#include <cstddef>
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace unbit
+{
+	namespace bench
+	{
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Options of the differential harness.
+		 */
+		struct diff_options
+		{
+			/**
+			 * @brief Minimum measurement time per implementation and check (in seconds).
+			 */
+			double min_time = 0.1;
+
+			/**
+			 * @brief Only run checks whose name contains this string (empty runs all).
+			 */
+			std::string filter;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Result of a single differential check.
+		 */
+		struct diff_result
+		{
+			/**
+			 * @brief Name of the check.
+			 */
+			std::string name;
+
+			/**
+			 * @brief The outputs of both implementations are identical.
+			 */
+			bool match = false;
+
+			/**
+			 * @brief Description of the difference (or of the failure) if the outputs do not match.
+			 */
+			std::string detail;
+
+			/**
+			 * @brief Size of the compared output (in bytes, of the reference implementation).
+			 */
+			std::size_t bytes = 0u;
+
+			/**
+			 * @brief Average run time of the reference implementation (in seconds).
+			 */
+			double reference_seconds = 0.0;
+
+			/**
+			 * @brief Average run time of the optimized implementation (in seconds).
+			 */
+			double candidate_seconds = 0.0;
+
+			/**
+			 * @brief Gets the speedup of the optimized implementation (0 if unavailable).
+			 */
+			double speedup() const;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Differential verification harness.
+		 *
+		 * Each check runs a reference implementation (the known-correct legacy code) and an
+		 * optimized implementation on the same input, compares their outputs byte-for-byte and
+		 * measures the run time of both (each implementation is run repeatedly until the minimum
+		 * measurement time has elapsed, the output of the first run is compared). Exceptions
+		 * thrown by either implementation fail the check.
+		 */
+		class diff_harness
+		{
+		public:
+			/**
+			 * @brief Implementation under test (produces the output to be compared).
+			 */
+			typedef std::function<std::vector<uint8_t>()> impl_type;
+
+		private:
+			/**
+			 * @brief Options of this harness.
+			 */
+			diff_options options_;
+
+			/**
+			 * @brief Results of the checks run so far.
+			 */
+			std::vector<diff_result> results_;
+
+		public:
+			/**
+			 * @brief Constructs a new differential harness.
+			 *
+			 * @param options specifies the options of the harness.
+			 */
+			explicit diff_harness(const diff_options& options);
+
+			/**
+			 * @brief Destroys the differential harness.
+			 */
+			~diff_harness();
+
+			/**
+			 * @brief Tests if a check is selected by the name filter.
+			 *
+			 * @param name is the name of the check.
+			 */
+			bool selected(const std::string& name) const;
+
+			/**
+			 * @brief Runs a check (if it is selected by the name filter).
+			 *
+			 * @param name is the name of the check.
+			 * @param reference is the reference implementation.
+			 * @param candidate is the optimized implementation.
+			 *
+			 * @return @c false if the check was run and failed.
+			 */
+			bool check(const std::string& name, const impl_type& reference, const impl_type& candidate);
+
+			/**
+			 * @brief Gets the results of the checks run so far.
+			 */
+			inline const std::vector<diff_result>& results() const
+			{
+				return results_;
+			}
+
+			/**
+			 * @brief Gets the number of failed checks.
+			 */
+			std::size_t num_failures() const;
+
+			/**
+			 * @brief Writes a report of all results.
+			 *
+			 * @param os is the output stream to write to.
+			 */
+			void report(std::ostream& os) const;
+
+		private:
+			/**
+			 * @brief Runs an implementation (repeatedly) and measures its average run time.
+			 */
+			std::vector<uint8_t> measure(const impl_type& impl, double& seconds) const;
+
+			// Non-copyable
+			diff_harness(const diff_harness&) =delete;
+			diff_harness& operator=(const diff_harness&) =delete;
+		};
+	}
+}
+
+#endif // UNBIT_BENCH_DIFF_HARNESS_HPP_
@@ -0,0 +1,195 @@
+/**
+ * @file
+ * @brief Hardware performance counters (Linux perf_event_open) for benchmarks.
+ */
+#include "perf_counters.hpp"
+
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace unbit
+{
+	namespace bench
+	{
+		namespace
+		{
+#if defined(__linux__)
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Encodes a generic hardware cache event (read misses).
+			 */
+			static constexpr uint64_t cache_read_miss(uint64_t cache_id)
+			{
+				return cache_id |
+					(static_cast<uint64_t>(PERF_COUNT_HW_CACHE_OP_READ) << 8u) |
+					(static_cast<uint64_t>(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16u);
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Event type/config pairs (indexed by perf_event).
+			 */
+			static const struct
+			{
+				uint32_t type;
+				uint64_t config;
+			}
+			PERF_EVENT_CONFIG[NUM_PERF_EVENTS] =
+			{
+				{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+				{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+				{ PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_L1D) },
+				{ PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_LL) },
+				{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+				{ PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_DTLB) },
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Opens a single counter for the calling thread (returns -1 on failure).
+			 */
+			static int open_counter(uint32_t type, uint64_t config)
+			{
+				struct perf_event_attr attr;
+				std::memset(&attr, 0, sizeof(attr));
+
+				attr.size           = sizeof(attr);
+				attr.type           = type;
+				attr.config         = config;
+				attr.disabled       = 1;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv     = 1;
+				attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+				const long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+				return (fd >= 0) ? static_cast<int>(fd) : -1;
+			}
+#endif
+		}
+
+		//----------------------------------------------------------------------------------------------
+		const char* perf_event_name(perf_event ev)
+		{
+			switch (ev)
+			{
+				case perf_event::cycles:        return "cycles";
+				case perf_event::instructions:  return "instructions";
+				case perf_event::l1d_misses:    return "L1D-misses";
+				case perf_event::llc_misses:    return "LLC-misses";
+				case perf_event::branch_misses: return "branch-misses";
+				case perf_event::dtlb_misses:   return "dTLB-misses";
+				default:                        return "unknown";
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		perf_counters::perf_counters(bool enable)
+		{
+			fds_.fill(-1);
+
+#if defined(__linux__)
+			if (enable)
+			{
+				for (std::size_t i = 0u; i < NUM_PERF_EVENTS; ++i)
+					fds_[i] = open_counter(PERF_EVENT_CONFIG[i].type, PERF_EVENT_CONFIG[i].config);
+			}
+#else
+			static_cast<void>(enable);
+#endif
+		}
+
+		//----------------------------------------------------------------------------------------------
+		perf_counters::~perf_counters()
+		{
+#if defined(__linux__)
+			for (int fd : fds_)
+			{
+				if (fd >= 0)
+					::close(fd);
+			}
+#endif
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bool perf_counters::available(perf_event ev) const
+		{
+			return fds_[static_cast<std::size_t>(ev)] >= 0;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bool perf_counters::any_available() const
+		{
+			for (int fd : fds_)
+			{
+				if (fd >= 0)
+					return true;
+			}
+
+			return false;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void perf_counters::start()
+		{
+#if defined(__linux__)
+			for (int fd : fds_)
+			{
+				if (fd >= 0)
+				{
+					::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+					::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+				}
+			}
+#endif
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void perf_counters::stop()
+		{
+#if defined(__linux__)
+			for (int fd : fds_)
+			{
+				if (fd >= 0)
+					::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			}
+#endif
+		}
+
+		//----------------------------------------------------------------------------------------------
+		perf_sample perf_counters::read() const
+		{
+			perf_sample sample;
+
+#if defined(__linux__)
+			for (std::size_t i = 0u; i < NUM_PERF_EVENTS; ++i)
+			{
+				if (fds_[i] < 0)
+					continue;
+
+				// Value, time enabled, time running (PERF_FORMAT_TOTAL_TIME_*)
+				uint64_t data[3u] = { 0u, 0u, 0u };
+				if (::read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+					continue;
+
+				if (data[2u] == 0u)
+				{
+					// Counter was never scheduled (e.g. all PMU slots taken)
+					continue;
+				}
+
+				// Scale for multiplexing
+				const double scale = static_cast<double>(data[1u]) / static_cast<double>(data[2u]);
+				sample.values[i] = static_cast<uint64_t>(static_cast<double>(data[0u]) * scale);
+			}
+#endif
+
+			return sample;
+		}
+	}
+}
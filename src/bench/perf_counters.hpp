@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @brief Hardware performance counters (Linux perf_event_open) for benchmarks.
+ */
+#ifndef UNBIT_BENCH_PERF_COUNTERS_HPP_
+#define UNBIT_BENCH_PERF_COUNTERS_HPP_ 1
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+#include <optional>
+
+namespace unbit
+{
+	namespace bench
+	{
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Hardware events tracked by the benchmark harness.
+		 */
+		enum class perf_event : uint32_t
+		{
+			cycles        = 0u, //!< CPU cycles (user space)
+			instructions  = 1u, //!< Retired instructions
+			l1d_misses    = 2u, //!< L1 data cache read misses
+			llc_misses    = 3u, //!< Last level cache read misses
+			branch_misses = 4u, //!< Mispredicted branches
+			dtlb_misses   = 5u, //!< Data TLB read misses
+		};
+
+		/**
+		 * @brief Number of hardware events tracked by the benchmark harness.
+		 */
+		static constexpr std::size_t NUM_PERF_EVENTS = 6u;
+
+		/**
+		 * @brief Gets the display name of a hardware event.
+		 */
+		const char* perf_event_name(perf_event ev);
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Sampled values of the hardware events (missing values are unavailable).
+		 */
+		struct perf_sample
+		{
+			/**
+			 * @brief Event counts (indexed by @ref perf_event).
+			 */
+			std::array<std::optional<uint64_t>, NUM_PERF_EVENTS> values;
+
+			/**
+			 * @brief Gets the count of an event (if available).
+			 */
+			inline const std::optional<uint64_t>& operator[](perf_event ev) const
+			{
+				return values[static_cast<std::size_t>(ev)];
+			}
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Hardware performance counters of the calling thread.
+		 *
+		 * Each event is opened as an individual counter via @c perf_event_open (restricted to user
+		 * space). Events that cannot be opened (e.g. missing PMU support in virtual machines, or a
+		 * restrictive @c perf_event_paranoid setting in containers) are reported as unavailable;
+		 * the remaining events keep working. Counts are scaled if the kernel had to multiplex the
+		 * counters.
+		 */
+		class perf_counters
+		{
+		private:
+			/**
+			 * @brief File descriptors of the opened events (-1 if unavailable).
+			 */
+			std::array<int, NUM_PERF_EVENTS> fds_;
+
+		public:
+			/**
+			 * @brief Opens the hardware performance counters.
+			 *
+			 * @param enable specifies if counters should be opened at all (false disables all
+			 *   counters).
+			 */
+			explicit perf_counters(bool enable = true);
+
+			/**
+			 * @brief Closes the hardware performance counters.
+			 */
+			~perf_counters();
+
+			/**
+			 * @brief Tests if an event is available.
+			 */
+			bool available(perf_event ev) const;
+
+			/**
+			 * @brief Tests if any event is available.
+			 */
+			bool any_available() const;
+
+			/**
+			 * @brief Resets and starts all available counters.
+			 */
+			void start();
+
+			/**
+			 * @brief Stops all available counters.
+			 */
+			void stop();
+
+			/**
+			 * @brief Reads the (scaled) counts of all available counters.
+			 */
+			perf_sample read() const;
+
+		private:
+			// Non-copyable
+			perf_counters(const perf_counters&) =delete;
+			perf_counters& operator=(const perf_counters&) =delete;
+		};
+	}
+}
+
+#endif // UNBIT_BENCH_PERF_COUNTERS_HPP_
@@ -0,0 +1,233 @@
+/**
+ * @file
+ * @brief Synthetic (uncompressed) configuration bitstreams for benchmarks.
+ */
+#include "synthetic_bitstream.hpp"
+
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/config_cmd.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/config_reg.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using unbit::fpga::xilinx::bitstream_engine;
+using unbit::fpga::xilinx::config_cmd;
+using unbit::fpga::xilinx::config_crc;
+using unbit::fpga::xilinx::config_reg;
+
+namespace unbit
+{
+	namespace bench
+	{
+		namespace
+		{
+			/**
+			 * @brief NOOP packet (type 1).
+			 */
+			static constexpr uint32_t NOOP = 0x20000000u;
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Pseudo-random number generator (xorshift64*).
+			 */
+			class xorshift64
+			{
+			private:
+				uint64_t state_;
+
+			public:
+				explicit xorshift64(uint64_t seed)
+					: state_(seed ? seed : 0x9E3779B97F4A7C15u)
+				{
+				}
+
+				uint64_t next()
+				{
+					state_ ^= state_ >> 12u;
+					state_ ^= state_ << 25u;
+					state_ ^= state_ >> 27u;
+					return state_ * 0x2545F4914F6CDD1Du;
+				}
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Configuration stream writer (tracks the CRC of the written registers).
+			 */
+			class stream_writer
+			{
+			private:
+				std::vector<uint32_t>& out_;
+				config_crc crc_;
+
+			public:
+				explicit stream_writer(std::vector<uint32_t>& out)
+					: out_(out)
+				{
+				}
+
+				void raw(uint32_t w)
+				{
+					out_.push_back(w);
+				}
+
+				void write(config_reg reg, std::span<const uint32_t> data)
+				{
+					const uint32_t reg_bits = static_cast<uint32_t>(reg) << 13u;
+
+					if (data.size() < 0x800u)
+					{
+						// Type 1 write
+						raw(0x30000000u | reg_bits | static_cast<uint32_t>(data.size()));
+					}
+					else
+					{
+						// Type 1 write (zero words), followed by type 2 write
+						if (data.size() > 0x07FFFFFFu)
+							throw std::invalid_argument("payload too large for a type 2 packet");
+
+						raw(0x30000000u | reg_bits);
+						raw(0x50000000u | static_cast<uint32_t>(data.size()));
+					}
+
+					out_.insert(out_.end(), data.begin(), data.end());
+					crc_.process_write(reg, data);
+				}
+
+				void write(config_reg reg, uint32_t value)
+				{
+					write(reg, std::span<const uint32_t>(&value, 1u));
+				}
+
+				void command(config_cmd cmd)
+				{
+					write(config_reg::CMD, static_cast<uint32_t>(cmd));
+				}
+
+				uint32_t crc() const
+				{
+					return crc_.value();
+				}
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Encodes the configuration stream of an SLR (and all following SLRs).
+			 */
+			static std::vector<uint32_t> encode_slr(const synthetic_options& options, std::size_t slr, xorshift64& rng)
+			{
+				std::vector<uint32_t> words;
+				stream_writer w(words);
+
+				// Dummy words, bus width detection, sync
+				for (unsigned i = 0u; i < 8u; ++i)
+					w.raw(0xFFFFFFFFu);
+
+				w.raw(0x000000BBu);
+				w.raw(0x11220044u);
+				w.raw(0xFFFFFFFFu);
+				w.raw(0xFFFFFFFFu);
+				w.raw(bitstream_engine::FPGA_SYNC_WORD_LE);
+				w.raw(NOOP);
+
+				// Header
+				w.command(config_cmd::RCRC);
+				w.raw(NOOP);
+				w.raw(NOOP);
+				w.write(config_reg::IDCODE, options.slrs[slr].idcode);
+				w.command(config_cmd::NUL);
+				w.write(config_reg::FAR, 0u);
+				w.command(config_cmd::WCFG);
+				w.raw(NOOP);
+
+				// Frame data
+				std::vector<uint32_t> frames(options.slrs[slr].num_frames * options.frame_words);
+				const uint64_t zero_threshold = static_cast<uint64_t>(options.zero_frame_ratio * 1000000.0);
+
+				for (std::size_t f = 0u; f < options.slrs[slr].num_frames; ++f)
+				{
+					if ((rng.next() % 1000000u) < zero_threshold)
+						continue;
+
+					auto first = frames.begin() + f * options.frame_words;
+					std::generate(first, first + options.frame_words, [&]() { return static_cast<uint32_t>(rng.next() >> 32u); });
+				}
+
+				w.write(config_reg::FDRI, frames);
+
+				// Nested configuration stream of the next SLR
+				if (slr + 1u < options.slrs.size())
+					w.write(config_reg::RSVD30, encode_slr(options, slr + 1u, rng));
+
+				// Trailer
+				if (options.with_crc)
+					w.write(config_reg::CRC, w.crc());
+
+				w.raw(NOOP);
+				w.raw(NOOP);
+				w.command(config_cmd::DESYNC);
+
+				for (unsigned i = 0u; i < 16u; ++i)
+					w.raw(NOOP);
+
+				return words;
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::vector<uint8_t> make_synthetic_bitstream(const synthetic_options& options)
+		{
+			if (options.slrs.empty())
+				throw std::invalid_argument("synthetic bitstream needs at least one slr");
+
+			xorshift64 rng(options.seed);
+			const auto words = encode_slr(options, 0u, rng);
+
+			std::vector<uint8_t> data;
+			data.reserve(words.size() * 4u);
+
+			for (const uint32_t w : words)
+			{
+				data.push_back(static_cast<uint8_t>(w >> 24u));
+				data.push_back(static_cast<uint8_t>(w >> 16u));
+				data.push_back(static_cast<uint8_t>(w >> 8u));
+				data.push_back(static_cast<uint8_t>(w));
+			}
+
+			return data;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::vector<uint32_t> to_config_words(std::span<const uint8_t> data)
+		{
+			// Locate the first sync word (byte-wise scan)
+			uint32_t sync_w = 0u;
+			std::size_t pos = 0u;
+
+			while (pos < data.size() && sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			{
+				sync_w = (sync_w << 8u) | data[pos++];
+			}
+
+			if (sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+				throw std::invalid_argument("sync word was not found in the bitstream");
+
+			pos -= 4u;
+
+			std::vector<uint32_t> words((data.size() - pos) / 4u);
+			for (auto& w : words)
+			{
+				w = (static_cast<uint32_t>(data[pos]) << 24u) |
+					(static_cast<uint32_t>(data[pos + 1u]) << 16u) |
+					(static_cast<uint32_t>(data[pos + 2u]) << 8u) |
+					static_cast<uint32_t>(data[pos + 3u]);
+
+				pos += 4u;
+			}
+
+			return words;
+		}
+	}
+}
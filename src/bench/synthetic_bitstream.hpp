@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @brief Synthetic (uncompressed) configuration bitstreams for benchmarks.
+ */
+#ifndef UNBIT_BENCH_SYNTHETIC_BITSTREAM_HPP_
+#define UNBIT_BENCH_SYNTHETIC_BITSTREAM_HPP_ 1
+
+#include <cstdint>
+#include <cstddef>
+
+#include <span>
+#include <vector>
+
+namespace unbit
+{
+	namespace bench
+	{
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Description of a synthetic SLR.
+		 */
+		struct synthetic_slr
+		{
+			/**
+			 * @brief IDCODE of the SLR.
+			 */
+			uint32_t idcode = 0u;
+
+			/**
+			 * @brief Number of configuration frames of the SLR.
+			 */
+			std::size_t num_frames = 0u;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Options for the generation of synthetic bitstreams.
+		 */
+		struct synthetic_options
+		{
+			/**
+			 * @brief Number of 32-bit words per frame.
+			 */
+			std::size_t frame_words = 101u;
+
+			/**
+			 * @brief SLRs of the device (in configuration order).
+			 */
+			std::vector<synthetic_slr> slrs;
+
+			/**
+			 * @brief Seed of the pseudo-random frame content.
+			 */
+			uint64_t seed = 1u;
+
+			/**
+			 * @brief Fraction of frames that are all-zero (0.0 to 1.0).
+			 */
+			double zero_frame_ratio = 0.0;
+
+			/**
+			 * @brief Emit a (correct) CRC check at the end of each SLR.
+			 */
+			bool with_crc = true;
+		};
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Generates a synthetic, uncompressed configuration bitstream.
+		 *
+		 * Each SLR is encoded as a complete configuration stream (dummy words, bus width detection,
+		 * sync word, RCRC, IDCODE, FAR, WCFG, FDRI, CRC, DESYNC). The stream of the next SLR is
+		 * nested into the preceding SLR via a write to the RSVD30 register following the FDRI write,
+		 * matching the layout expected by both the legacy parser and the configuration engine.
+		 *
+		 * @param options specifies the bitstream to be generated.
+		 *
+		 * @return The bitstream data (big-endian byte order, as found in a .bit/.bin file).
+		 */
+		std::vector<uint8_t> make_synthetic_bitstream(const synthetic_options& options);
+
+		//----------------------------------------------------------------------------------------------
+		/**
+		 * @brief Converts bitstream bytes to native configuration words (starting at the first sync word).
+		 *
+		 * @param data specifies the bitstream data (big-endian byte order).
+		 *
+		 * @return The configuration words (in native byte order).
+		 */
+		std::vector<uint32_t> to_config_words(std::span<const uint8_t> data);
+	}
+}
+
+#endif // UNBIT_BENCH_SYNTHETIC_BITSTREAM_HPP_
@@ -0,0 +1,363 @@
+/**
+ * @file
+ * @brief Micro-benchmarks for the unbit bitstream processing kernels.
+ */
+#include "bench_harness.hpp"
+#include "synthetic_bitstream.hpp"
+
+#include "unbit/fpga/xilinx/bitstream_serializer.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/config_engine.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+
+#if defined(UNBIT_BENCH_LEGACY)
+# include "unbit/fpga/old/xilinx/bitstream.hpp"
+# include "unbit/fpga/old/xilinx/fpga.hpp"
+#endif
+
+#if defined(UNBIT_BENCH_MMI)
+# include "unbit/fpga/old/xilinx/mmi.hpp"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using unbit::bench::bench_harness;
+using unbit::bench::bench_options;
+using unbit::bench::consume;
+using unbit::bench::make_synthetic_bitstream;
+using unbit::bench::synthetic_options;
+using unbit::bench::to_config_words;
+using unbit::fpga::xilinx::bitstream_serializer;
+using unbit::fpga::xilinx::config_crc;
+using unbit::fpga::xilinx::config_engine;
+using unbit::fpga::xilinx::config_reg;
+using unbit::fpga::xilinx::frame_alloc_policy;
+using unbit::fpga::xilinx::frame_buffer;
+using unbit::fpga::xilinx::frame_store;
+using unbit::fpga::xilinx::serializer_options;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Configuration engine that counts packets and frame data words (parser benchmark).
+	 */
+	class counting_engine final : public config_engine
+	{
+	public:
+		uint64_t num_writes = 0u;
+		uint64_t num_fdri_words = 0u;
+
+	protected:
+		bool on_config_write(config_reg reg, word_span_type data) override
+		{
+			++num_writes;
+			return config_engine::on_config_write(reg, data);
+		}
+
+		void on_config_fdri(word_span_type data) override
+		{
+			num_fdri_words += data.size();
+		}
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Command line options of the benchmark tool.
+	 */
+	struct tool_options
+	{
+		bench_options bench;
+		std::size_t num_frames  = 10000u;
+		std::size_t num_slrs    = 1u;
+		std::size_t frame_words = 101u;
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	static void usage(const char* argv0)
+	{
+		std::cerr << "usage: " << argv0 << " [options]" << std::endl
+			<< std::endl
+			<< "Runs micro-benchmarks of the bitstream parsing, frame store, MMI translation and CRC kernels" << std::endl
+			<< "on synthetic bitstreams." << std::endl
+			<< std::endl
+			<< "options:" << std::endl
+			<< "  --filter <text>       only run benchmarks whose name contains <text>" << std::endl
+			<< "  --min-time <seconds>  minimum measurement time per benchmark (default: 0.5)" << std::endl
+			<< "  --no-perf             do not use hardware performance counters" << std::endl
+			<< "  --frames <n>          frames per SLR of the synthetic bitstream (default: 10000)" << std::endl
+			<< "  --slrs <n>            number of SLRs of the synthetic bitstream (default: 1)" << std::endl
+			<< "  --frame-words <n>     words per frame of the synthetic bitstream (default: 101)" << std::endl
+			<< std::endl;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	static bool parse_args(int argc, char* argv[], tool_options& opts)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg(argv[i]);
+			const bool have_value = (i + 1 < argc);
+
+			if (arg == "--no-perf")
+			{
+				opts.bench.use_perf = false;
+			}
+			else if (arg == "--filter" && have_value)
+			{
+				opts.bench.filter = argv[++i];
+			}
+			else if (arg == "--min-time" && have_value)
+			{
+				opts.bench.min_time = std::stod(argv[++i]);
+			}
+			else if (arg == "--frames" && have_value)
+			{
+				opts.num_frames = std::stoul(argv[++i]);
+			}
+			else if (arg == "--slrs" && have_value)
+			{
+				opts.num_slrs = std::stoul(argv[++i]);
+			}
+			else if (arg == "--frame-words" && have_value)
+			{
+				opts.frame_words = std::stoul(argv[++i]);
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return (opts.num_slrs > 0u) && (opts.frame_words > 0u);
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Parser and CRC kernels (new library).
+	 */
+	static void run_core_benchmarks(bench_harness& harness, const tool_options& opts)
+	{
+		synthetic_options syn;
+		syn.frame_words = opts.frame_words;
+		syn.slrs.assign(opts.num_slrs, unbit::bench::synthetic_slr { 0x03727093u, opts.num_frames });
+
+		const auto bitstream_bytes = make_synthetic_bitstream(syn);
+		const auto words = to_config_words(bitstream_bytes);
+		const uint64_t stream_bytes = words.size() * sizeof(uint32_t);
+
+		// Packet parsing with the configuration engine
+		harness.run("parse/config-engine", stream_bytes, [&]()
+		{
+			counting_engine engine;
+			engine.process(words);
+			consume(engine.num_fdri_words);
+		});
+
+		// Materialization of the frame store (regular and huge pages)
+		harness.run("frame-store/load", stream_bytes, [&]()
+		{
+			const auto store = frame_store::load(words, opts.frame_words);
+			consume(store.num_slrs());
+		});
+
+		harness.run("frame-store/load-thp", stream_bytes, [&]()
+		{
+			const frame_alloc_policy policy { frame_buffer::page_mode::transparent_huge, false };
+			const auto store = frame_store::load(words, opts.frame_words, policy);
+			consume(store.num_slrs());
+		});
+
+		harness.run("frame-store/load-thp-numa", stream_bytes, [&]()
+		{
+			const frame_alloc_policy policy { frame_buffer::page_mode::transparent_huge, true };
+			const auto store = frame_store::load(words, opts.frame_words, policy);
+			consume(store.num_slrs());
+		});
+
+		// Serialization of the frame store (sequential and per-SLR parallel encoding)
+		if (harness.selected("serialize/encode") || harness.selected("serialize/encode-parallel"))
+		{
+			const auto store = frame_store::load(words, opts.frame_words);
+
+			for (const bool parallel : { false, true })
+			{
+				harness.run(parallel ? "serialize/encode-parallel" : "serialize/encode", stream_bytes, [&]()
+				{
+					serializer_options ser_opts;
+					ser_opts.parallel = parallel;
+
+					bitstream_serializer ser(store, ser_opts);
+					ser.encode();
+					consume(ser.size());
+				});
+			}
+		}
+
+		// Configuration CRC over the complete stream (table-driven or SSE4.2)
+		harness.run("crc/config", stream_bytes, [&]()
+		{
+			config_crc crc;
+			crc.update(config_reg::FDRI, words);
+			consume(crc.value());
+		});
+
+		harness.run("crc/config-bitwise", stream_bytes, [&]()
+		{
+			uint32_t crc = 0u;
+			for (const uint32_t w : words)
+				crc = config_crc::step_bitwise(crc, static_cast<uint32_t>(config_reg::FDRI), w);
+
+			consume(crc);
+		});
+
+#if defined(UNBIT_BENCH_LEGACY)
+		// Packet parsing with the legacy parser
+		harness.run("parse/legacy", bitstream_bytes.size(), [&]()
+		{
+			uint64_t num_packets = 0u;
+
+			unbit::old::xilinx::bitstream::parse(bitstream_bytes.cbegin(), bitstream_bytes.cend(),
+				[&](const unbit::old::xilinx::bitstream::packet&)
+				{
+					++num_packets;
+					return true;
+				});
+
+			consume(num_packets);
+		});
+#endif
+	}
+
+#if defined(UNBIT_BENCH_MMI)
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief MMI address translation kernels (legacy library, XC7Z020 geometry).
+	 */
+	static void run_mmi_benchmarks(bench_harness& harness)
+	{
+		using unbit::old::xilinx::bram_category;
+
+		if (!harness.selected("mmi/read-byte") && !harness.selected("mmi/bram-extract"))
+			return;
+
+		constexpr uint32_t XC7Z020_IDCODE = 0x03727093u;
+		const auto& fpga = unbit::old::xilinx::fpga_by_idcode(XC7Z020_IDCODE);
+
+		// Size the frame data to cover all block RAMs of the device
+		std::size_t frame_data_bits = 0u;
+		for (std::size_t i = 0u; i < fpga.num_brams(bram_category::ramb36); ++i)
+		{
+			const auto& ram = fpga.bram_at(bram_category::ramb36, i);
+			frame_data_bits = std::max(frame_data_bits, ram.map_to_bitstream(ram.num_words() * ram.data_bits() - 1u, false) + 1u);
+			frame_data_bits = std::max(frame_data_bits, ram.map_to_bitstream(ram.num_words() * ram.parity_bits() - 1u, true) + 1u);
+		}
+
+		const std::size_t frame_bits = fpga.frame_size() * 8u;
+
+		synthetic_options syn;
+		syn.frame_words = fpga.frame_size() / 4u;
+		syn.slrs.push_back(unbit::bench::synthetic_slr { XC7Z020_IDCODE, (frame_data_bits + frame_bits - 1u) / frame_bits + 1u });
+
+		const auto bitstream_bytes = make_synthetic_bitstream(syn);
+		std::string bitstream_str(bitstream_bytes.begin(), bitstream_bytes.end());
+		std::istringstream bitstream_stm(bitstream_str);
+		const unbit::old::xilinx::bitstream bs(bitstream_stm);
+
+		// Synthetic MMI file: One 32-bit processor address space (16 KiB) on four byte lanes
+		const auto mmi_path = std::filesystem::temp_directory_path() / ("unbit-bench-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".mmi");
+		{
+			std::ofstream mmi(mmi_path);
+
+			mmi << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>" << std::endl
+				<< "<MemInfo Version=\"1\" Minor=\"0\">" << std::endl
+				<< "  <Processor Endianness=\"Little\" InstPath=\"bench/cpu\">" << std::endl
+				<< "    <AddressSpace Name=\"bench_bram\" Begin=\"0\" End=\"16383\">" << std::endl
+				<< "      <BusBlock>" << std::endl;
+
+			for (unsigned lane = 0u; lane < 4u; ++lane)
+			{
+				const auto& ram = fpga.bram_at(bram_category::ramb36, lane);
+
+				mmi << "        <BitLane MemType=\"RAMB36\" Placement=\"X" << ram.x() << "Y" << ram.y() << "\">" << std::endl
+					<< "          <DataWidth MSB=\"" << (lane * 8u + 7u) << "\" LSB=\"" << (lane * 8u) << "\"/>" << std::endl
+					<< "          <AddressRange Begin=\"0\" End=\"4095\"/>" << std::endl
+					<< "          <Parity ON=\"false\" NumBits=\"0\"/>" << std::endl
+					<< "        </BitLane>" << std::endl;
+			}
+
+			mmi << "      </BusBlock>" << std::endl
+				<< "    </AddressSpace>" << std::endl
+				<< "  </Processor>" << std::endl
+				<< "</MemInfo>" << std::endl;
+		}
+
+		const auto map = unbit::old::xilinx::mmi::memory_map::load(mmi_path.string(), "bench/cpu");
+		std::filesystem::remove(mmi_path);
+
+		harness.run("mmi/read-byte", 16384u, [&]()
+		{
+			uint64_t sum = 0u;
+
+			for (uint64_t addr = 0u; addr < 16384u; ++addr)
+				sum += map->read_byte(fpga, bs, addr);
+
+			consume(sum);
+		});
+
+		harness.run("mmi/bram-extract", 4u * 4096u, [&]()
+		{
+			uint64_t sum = 0u;
+
+			for (unsigned lane = 0u; lane < 4u; ++lane)
+				sum += fpga.bram_at(bram_category::ramb36, lane).extract(bs, false)[0u];
+
+			consume(sum);
+		});
+	}
+#endif
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		tool_options opts;
+
+		if (!parse_args(argc, argv, opts))
+		{
+			usage(argv[0u]);
+			return EXIT_FAILURE;
+		}
+
+		bench_harness harness(opts.bench);
+
+		run_core_benchmarks(harness, opts);
+
+#if defined(UNBIT_BENCH_MMI)
+		run_mmi_benchmarks(harness);
+#endif
+
+		harness.report(std::cout);
+		return EXIT_SUCCESS;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
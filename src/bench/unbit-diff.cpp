@@ -0,0 +1,1294 @@
+/**
+ * @file
+ * @brief Differential verification of the optimized kernels against the legacy implementation.
+ */
+#include "diff_harness.hpp"
+#include "synthetic_bitstream.hpp"
+
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/fpga/xilinx/compressed_frame_store.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/frame_archive.hpp"
+#include "unbit/fpga/xilinx/frame_delta.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+
+#include "unbit/fpga/old/xilinx/bitstream.hpp"
+#include "unbit/fpga/old/xilinx/fpga.hpp"
+#include "unbit/fpga/old/xilinx/frame_source.hpp"
+
+#include "unbit/ihex/ihex.hpp"
+
+#if defined(UNBIT_BENCH_MMI)
+# include "unbit/fpga/old/xilinx/mmi.hpp"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <span>
+#include <string>
+#include <vector>
+
+using unbit::bench::diff_harness;
+using unbit::bench::diff_options;
+using unbit::bench::make_synthetic_bitstream;
+using unbit::bench::synthetic_options;
+using unbit::bench::to_config_words;
+using unbit::fpga::xilinx::bitstream_error;
+using unbit::fpga::xilinx::compressed_frame_store;
+using unbit::fpga::xilinx::config_crc;
+using unbit::fpga::xilinx::frame_archive;
+using unbit::fpga::xilinx::frame_delta_decoder;
+using unbit::fpga::xilinx::frame_delta_encoder;
+using unbit::fpga::xilinx::frame_store;
+using unbit::old::xilinx::bram;
+using unbit::old::xilinx::bram_category;
+using unbit::old::xilinx::const_word_frames;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Device supported by the legacy library.
+	 */
+	struct device_info
+	{
+		/** @brief Name of the device. */
+		const char* name;
+
+		/** @brief IDCODEs of the SLRs (in configuration order, the first selects the device model). */
+		std::vector<uint32_t> idcodes;
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Devices supported by the legacy library (cf. @ref unbit::old::xilinx::fpga_by_idcode).
+	 */
+	static const std::vector<device_info> known_devices =
+	{
+		{ "xc7z010", { 0x03722093u } },
+		{ "xc7z015", { 0x0373B093u } },
+		{ "xc7z020", { 0x03727093u } },
+		{ "xcvu9p",  { 0x04B31093u, 0x04B22039u, 0x04B24039u } }
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Command line options of the differential tool.
+	 */
+	struct tool_options
+	{
+		diff_options diff;
+		uint64_t    seed        = 1u;
+		std::size_t num_brams   = 8u;
+		std::size_t num_layouts = 4u;
+		std::size_t num_ranges  = 1000u;
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	static void usage(const char* argv0)
+	{
+		std::cerr << "usage: " << argv0 << " [options]" << std::endl
+			<< std::endl
+			<< "Runs the legacy (per-bit) implementations and the optimized implementations side by side on" << std::endl
+			<< "synthetic bitstreams for every supported device, compares their outputs byte-for-byte and" << std::endl
+			<< "reports the speedups. Exits with a failure status if any output differs." << std::endl
+			<< std::endl
+			<< "options:" << std::endl
+			<< "  --filter <text>       only run checks whose name contains <text>" << std::endl
+			<< "  --min-time <seconds>  minimum measurement time per implementation (default: 0.1)" << std::endl
+			<< "  --seed <n>            seed of the synthetic bitstreams and MMI layouts (default: 1)" << std::endl
+			<< "  --brams <n>           block RAMs per category for the extraction checks (default: 8)" << std::endl
+			<< "  --layouts <n>         randomized MMI layouts per device (default: 4)" << std::endl
+			<< "  --ranges <n>          byte ranges per MMI layout for the batched range reads (default: 1000)" << std::endl
+			<< std::endl;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	static bool parse_args(int argc, char* argv[], tool_options& opts)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg(argv[i]);
+			const bool have_value = (i + 1 < argc);
+
+			if (arg == "--filter" && have_value)
+			{
+				opts.diff.filter = argv[++i];
+			}
+			else if (arg == "--min-time" && have_value)
+			{
+				opts.diff.min_time = std::stod(argv[++i]);
+			}
+			else if (arg == "--seed" && have_value)
+			{
+				opts.seed = std::stoull(argv[++i]);
+			}
+			else if (arg == "--brams" && have_value)
+			{
+				opts.num_brams = std::stoul(argv[++i]);
+			}
+			else if (arg == "--layouts" && have_value)
+			{
+				opts.num_layouts = std::stoul(argv[++i]);
+			}
+			else if (arg == "--ranges" && have_value)
+			{
+				opts.num_ranges = std::stoul(argv[++i]);
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Selects random block RAMs of a category.
+	 */
+	static std::vector<const bram*> pick_brams(const unbit::old::xilinx::fpga& fpga, bram_category category,
+		std::size_t count, std::mt19937_64& rng)
+	{
+		std::vector<const bram*> result;
+
+		const std::size_t num_brams = fpga.num_brams(category);
+		if (num_brams == 0u)
+			return result;
+
+		for (std::size_t i = 0u; i < count; ++i)
+			result.push_back(&fpga.bram_at(category, rng() % num_brams));
+
+		return result;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Extracts a block RAM bit by bit (reference path, independent of @ref bram::map_range_to_bitstream).
+	 */
+	template<unbit::old::xilinx::frame_source Source>
+	static std::vector<uint8_t> reference_extract(const bram& ram, const Source& src, bool extract_parity)
+	{
+		const std::size_t bit_length = (extract_parity ? ram.parity_bits() : ram.data_bits()) * ram.num_words();
+		std::vector<uint8_t> out((bit_length + 7u) / 8u);
+
+		for (std::size_t i = 0u; i < bit_length; ++i)
+		{
+			if (unbit::old::xilinx::read_frame_bit(src, ram.slr(), ram.map_to_bitstream(i, extract_parity)))
+				out[i / 8u] |= static_cast<uint8_t>(1u << (i % 8u));
+		}
+
+		return out;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Appends a digest (64-bit FNV-1a) of the bitstream offsets of the data (and parity) bits of a block RAM.
+	 *
+	 * The offsets are either mapped bit by bit (@ref bram::map_to_bitstream, @p chunk_bits of zero), or in chunks
+	 * of the given size (@ref bram::map_range_to_bitstream).
+	 */
+	static void append_offset_digest(std::vector<uint8_t>& out, const bram& ram, bool with_parity, std::size_t chunk_bits)
+	{
+		std::vector<std::size_t> offsets;
+		uint64_t digest = 0xCBF29CE484222325u;
+
+		for (const bool is_parity : { false, true })
+		{
+			if (is_parity && !with_parity)
+				break;
+
+			const std::size_t bit_length = (is_parity ? ram.parity_bits() : ram.data_bits()) * ram.num_words();
+			offsets.resize(bit_length);
+
+			if (chunk_bits == 0u)
+			{
+				for (std::size_t i = 0u; i < bit_length; ++i)
+					offsets[i] = ram.map_to_bitstream(i, is_parity);
+			}
+			else
+			{
+				for (std::size_t first = 0u; first < bit_length; first += chunk_bits)
+				{
+					const std::size_t count = std::min(chunk_bits, bit_length - first);
+					ram.map_range_to_bitstream(first, is_parity, std::span<std::size_t>(offsets.data() + first, count));
+				}
+			}
+
+			for (const std::size_t offset : offsets)
+				digest = (digest ^ offset) * 0x00000100000001B3u;
+		}
+
+		for (unsigned i = 0u; i < 8u; ++i)
+			out.push_back(static_cast<uint8_t>(digest >> (8u * i)));
+	}
+
+#if defined(UNBIT_BENCH_MMI)
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Reads a byte of a memory map bit by bit (reference path via @ref memory_map::locate_bit).
+	 */
+	template<unbit::old::xilinx::frame_source Source>
+	static uint8_t reference_read_byte(const unbit::old::xilinx::mmi::memory_map& map,
+		const unbit::old::xilinx::fpga& fpga, const Source& src, uint64_t byte_addr)
+	{
+		uint8_t value = 0u;
+
+		for (unsigned i = 0u; i < 8u; ++i)
+		{
+			const auto loc = map.locate_bit(fpga, byte_addr * 8u + i);
+
+			if (unbit::old::xilinx::read_frame_bit(src, loc.ram->slr(), loc.ram->map_to_bitstream(loc.offset, loc.is_parity)))
+				value |= static_cast<uint8_t>(1u << i);
+		}
+
+		return value;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Writes a byte of a memory map bit by bit (reference path via @ref memory_map::locate_bit).
+	 */
+	template<unbit::old::xilinx::frame_sink Sink>
+	static void reference_write_byte(const unbit::old::xilinx::mmi::memory_map& map, Sink& dst,
+		const unbit::old::xilinx::fpga& fpga, uint64_t byte_addr, uint8_t value)
+	{
+		for (unsigned i = 0u; i < 8u; ++i)
+		{
+			const auto loc = map.locate_bit(fpga, byte_addr * 8u + i);
+			dst.write_frame_bit(loc.ram->slr(), loc.ram->map_to_bitstream(loc.offset, loc.is_parity), ((value >> i) & 1u) != 0u);
+		}
+	}
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Writes a randomized MMI file (one processor, one to three address spaces).
+	 *
+	 * Each address space has a random word size (8 to 64 bits), split into bit lanes of random (power of two)
+	 * widths on random RAMB36/RAMB18 tiles, with an occasional bit-reversed lane and an occasional lane that
+	 * is shadowed by a preceding lane.
+	 */
+	static void write_random_mmi(const std::filesystem::path& path, const unbit::old::xilinx::fpga& fpga,
+		std::mt19937_64& rng)
+	{
+		// Upper bound of the region size (keeps the per-bit legacy reads reasonably fast)
+		constexpr uint64_t max_region_bytes = 16384u;
+
+		std::ofstream mmi(path);
+
+		mmi << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>" << std::endl
+			<< "<MemInfo Version=\"1\" Minor=\"0\">" << std::endl
+			<< "  <Processor Endianness=\"Little\" InstPath=\"diff/cpu\">" << std::endl;
+
+		const std::size_t num_spaces = 1u + rng() % 3u;
+		uint64_t base = 0u;
+
+		for (std::size_t s = 0u; s < num_spaces; ++s)
+		{
+			struct lane_spec
+			{
+				const bram* ram;
+				unsigned lsb;
+				unsigned width;
+				bool bitrev;
+			};
+
+			const unsigned word_size = 8u << (rng() % 4u);
+			std::vector<lane_spec> lanes;
+
+			auto pick_ram = [&]() -> const bram&
+			{
+				const bool use_18 = (fpga.num_brams(bram_category::ramb18) > 0u) && (rng() % 2u != 0u);
+				const auto category = use_18 ? bram_category::ramb18 : bram_category::ramb36;
+				return fpga.bram_at(category, rng() % fpga.num_brams(category));
+			};
+
+			for (unsigned lsb = 0u; lsb < word_size; )
+			{
+				unsigned width = 1u << (rng() % 6u);
+				while (lsb + width > word_size)
+					width /= 2u;
+
+				lanes.push_back(lane_spec { &pick_ram(), lsb, width, (rng() % 8u) == 0u });
+				lsb += width;
+			}
+
+			if (rng() % 3u == 0u)
+			{
+				// Shadowed lane (the first matching lane wins)
+				const auto& shadowed = lanes[rng() % lanes.size()];
+				lanes.push_back(lane_spec { &pick_ram(), shadowed.lsb, shadowed.width, false });
+			}
+
+			// Number of words (bounded by the capacity of the smallest lane)
+			uint64_t max_words = max_region_bytes * 8u / word_size;
+			for (const auto& lane : lanes)
+				max_words = std::min<uint64_t>(max_words, lane.ram->num_words() * lane.ram->data_bits() / lane.width);
+
+			const uint64_t num_words = 1u + rng() % max_words;
+			const uint64_t begin = base;
+			const uint64_t end = begin + num_words * word_size / 8u - 1u;
+
+			mmi << "    <AddressSpace Name=\"diff_space" << s << "\" Begin=\"" << begin << "\" End=\"" << end << "\">" << std::endl
+				<< "      <BusBlock>" << std::endl;
+
+			for (const auto& lane : lanes)
+			{
+				const unsigned msb = lane.lsb + lane.width - 1u;
+
+				mmi << "        <BitLane MemType=\"" << (lane.ram->category() == bram_category::ramb18 ? "RAMB18" : "RAMB36")
+					<< "\" Placement=\"X" << lane.ram->x() << "Y" << lane.ram->y() << "\">" << std::endl
+					<< "          <DataWidth MSB=\"" << (lane.bitrev ? lane.lsb : msb) << "\" LSB=\""
+					<< (lane.bitrev ? msb : lane.lsb) << "\"/>" << std::endl
+					<< "          <AddressRange Begin=\"0\" End=\"" << (num_words - 1u) << "\"/>" << std::endl
+					<< "          <Parity ON=\"false\" NumBits=\"0\"/>" << std::endl
+					<< "        </BitLane>" << std::endl;
+			}
+
+			mmi << "      </BusBlock>" << std::endl
+				<< "    </AddressSpace>" << std::endl;
+
+			// Next address space (aligned, with a random gap)
+			base = ((end + 1u + 0xFFFu) & ~static_cast<uint64_t>(0xFFFu)) + (rng() % 4u) * 0x1000u;
+		}
+
+		mmi << "  </Processor>" << std::endl
+			<< "</MemInfo>" << std::endl;
+	}
+#endif
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Runs all checks of a device.
+	 */
+	static void run_device_checks(diff_harness& harness, const device_info& device, const tool_options& opts)
+	{
+		const std::string prefix = std::string(device.name) + "/";
+
+		if (!harness.selected(prefix + "frames") && !harness.selected(prefix + "bram-extract/ramb36") &&
+			!harness.selected(prefix + "bram-extract/ramb18") && !harness.selected(prefix + "bram-map-range/ramb36") &&
+			!harness.selected(prefix + "bram-map-range/ramb18") && !harness.selected(prefix + "mmi-region/") &&
+			!harness.selected(prefix + "mmi-ranges/") && !harness.selected(prefix + "mmi-write/") &&
+			!harness.selected(prefix + "delta-apply/raw") && !harness.selected(prefix + "delta-apply/xor-rle") &&
+			!harness.selected(prefix + "delta-reject"))
+		{
+			return;
+		}
+
+		const auto& fpga = unbit::old::xilinx::fpga_by_idcode(device.idcodes.front());
+		const std::size_t frame_words = fpga.frame_size() / 4u;
+		const std::size_t frame_bits = fpga.frame_size() * 8u;
+
+		// Size the frame data of each SLR to cover all block RAMs (RAMB18 tiles are halves of RAMB36 tiles)
+		std::vector<std::size_t> num_frames(device.idcodes.size(), 2u);
+
+		for (std::size_t i = 0u; i < fpga.num_brams(bram_category::ramb36); ++i)
+		{
+			const auto& ram = fpga.bram_at(bram_category::ramb36, i);
+			const std::size_t end_bit = std::max(
+				ram.map_to_bitstream(ram.num_words() * ram.data_bits() - 1u, false),
+				ram.map_to_bitstream(ram.num_words() * ram.parity_bits() - 1u, true)) + 1u;
+
+			auto& frames = num_frames.at(ram.slr());
+			frames = std::max(frames, (end_bit + frame_bits - 1u) / frame_bits + 1u);
+		}
+
+		synthetic_options syn;
+		syn.frame_words = frame_words;
+		syn.seed = opts.seed;
+
+		for (std::size_t k = 0u; k < device.idcodes.size(); ++k)
+			syn.slrs.push_back(unbit::bench::synthetic_slr { device.idcodes[k], num_frames[k] });
+
+		const auto bitstream_bytes = make_synthetic_bitstream(syn);
+		const std::string bitstream_str(bitstream_bytes.begin(), bitstream_bytes.end());
+
+		// Frame data: legacy bitstream parser vs. configuration engine (frame store)
+		harness.check(prefix + "frames",
+			[&]()
+			{
+				std::istringstream stm(bitstream_str);
+				const unbit::old::xilinx::bitstream bs(stm);
+
+				std::vector<uint8_t> frames;
+				for (unsigned k = 0u; k < bs.slrs().size(); ++k)
+					frames.insert(frames.end(), bs.frame_data_begin(k), bs.frame_data_end(k));
+
+				return frames;
+			},
+			[&]()
+			{
+				const auto store = frame_store::load(to_config_words(bitstream_bytes), frame_words);
+
+				std::size_t num_words = 0u;
+				for (std::size_t k = 0u; k < store.num_slrs(); ++k)
+					num_words += store.words(k).size();
+
+				// Frame data in bitstream (big-endian) byte order
+				std::vector<uint8_t> frames(num_words * 4u);
+				uint8_t* out = frames.data();
+
+				for (std::size_t k = 0u; k < store.num_slrs(); ++k)
+				{
+					for (const uint32_t w : store.words(k))
+					{
+						out[0u] = static_cast<uint8_t>(w >> 24u);
+						out[1u] = static_cast<uint8_t>(w >> 16u);
+						out[2u] = static_cast<uint8_t>(w >> 8u);
+						out[3u] = static_cast<uint8_t>(w);
+						out += 4u;
+					}
+				}
+
+				return frames;
+			});
+
+		std::istringstream bitstream_stm(bitstream_str);
+		const unbit::old::xilinx::bitstream bs(bitstream_stm);
+		const auto store = frame_store::load(to_config_words(bitstream_bytes), frame_words);
+		const auto frames = const_word_frames::of(store);
+		const compressed_frame_store packed(store);
+
+		// Compressed frames: flat frame store vs. decompressed frame store
+		const auto frame_bytes = [](const frame_store& src)
+		{
+			std::vector<uint8_t> out;
+			for (std::size_t k = 0u; k < src.num_slrs(); ++k)
+			{
+				const auto words = std::as_bytes(src.words(k));
+				for (const std::byte b : words)
+					out.push_back(static_cast<uint8_t>(b));
+			}
+
+			return out;
+		};
+
+		harness.check(prefix + "compressed-frames",
+			[&]()
+			{
+				return frame_bytes(store);
+			},
+			[&]()
+			{
+				return frame_bytes(packed.decompress());
+			});
+
+		// Frame deltas: target frames vs. encode -> apply (frame store and streaming) -> re-serialize
+		if (harness.selected(prefix + "delta-apply/raw") || harness.selected(prefix + "delta-apply/xor-rle") ||
+			harness.selected(prefix + "delta-reject"))
+		{
+			auto target = frame_store::load(to_config_words(bitstream_bytes), frame_words);
+
+			// Sparse word changes (zero runs and literals of the XOR encoding), cleared and replaced frames
+			for (std::size_t k = 0u; k < target.num_slrs(); ++k)
+			{
+				for (std::size_t f = k; f < target.num_frames(k); f += 37u)
+				{
+					auto frame = target.frame(k, f);
+
+					if (f % 3u == 0u)
+					{
+						frame[f % frame_words] ^= 0x00010000u;
+						frame[(f * 7u) % frame_words] ^= 0x80000001u;
+					}
+					else if (f % 3u == 1u)
+					{
+						std::fill(frame.begin(), frame.end(), 0u);
+					}
+					else
+					{
+						for (std::size_t i = 0u; i < frame.size(); ++i)
+							frame[i] = ~frame[i] + static_cast<uint32_t>(i);
+					}
+				}
+			}
+
+			const auto encode_delta = [&](bool xor_rle)
+			{
+				unbit::fpga::xilinx::delta_options delta_opts;
+				delta_opts.xor_rle = xor_rle;
+
+				frame_delta_encoder encoder(store, target, delta_opts);
+				std::ostringstream delta;
+				encoder.encode(delta);
+
+				return delta.str();
+			};
+
+			const auto apply_to_bitstream = [](const std::string& delta, const std::string& base)
+			{
+				std::istringstream delta_stm(delta);
+				frame_delta_decoder decoder(delta_stm);
+
+				std::istringstream base_stm(base);
+				std::ostringstream output_stm;
+				decoder.apply(base_stm, output_stm);
+
+				return output_stm.str();
+			};
+
+			const auto target_bytes = frame_bytes(target);
+
+			for (const bool xor_rle : { false, true })
+			{
+				const std::string delta = encode_delta(xor_rle);
+
+				harness.check(prefix + (xor_rle ? "delta-apply/xor-rle" : "delta-apply/raw"),
+					[&]()
+					{
+						// Target frames (applied to the frame store and to the bitstream), no CRC mismatch
+						std::vector<uint8_t> out(target_bytes);
+						out.insert(out.end(), target_bytes.begin(), target_bytes.end());
+						out.push_back(0u);
+						return out;
+					},
+					[&]()
+					{
+						auto patched = frame_store::load(to_config_words(bitstream_bytes), frame_words);
+
+						{
+							std::istringstream delta_stm(delta);
+							frame_delta_decoder decoder(delta_stm);
+							decoder.apply(patched);
+						}
+
+						// Re-serialized target bitstream
+						const std::string output = apply_to_bitstream(delta, bitstream_str);
+						const std::span<const uint8_t> output_bytes(reinterpret_cast<const uint8_t*>(output.data()),
+							output.size());
+
+						std::vector<uint8_t> out(frame_bytes(patched));
+						const auto reloaded = frame_bytes(frame_store::load(to_config_words(output_bytes), frame_words));
+						out.insert(out.end(), reloaded.begin(), reloaded.end());
+						out.push_back(static_cast<uint8_t>(config_crc::verify_checks(output_bytes)));
+						return out;
+					});
+			}
+
+			// Rejected deltas: wrong base image (frame store and bitstream), corrupted payload and final CRC
+			harness.check(prefix + "delta-reject",
+				[&]()
+				{
+					return std::vector<uint8_t>(4u, 1u);
+				},
+				[&]()
+				{
+					const std::string delta = encode_delta(true);
+
+					// Rejected with the expected error (and not by some other check)
+					const auto rejects = [](const char* reason, const auto& apply)
+					{
+						try
+						{
+							apply();
+						}
+						catch (const bitstream_error& e)
+						{
+							return static_cast<uint8_t>(std::string(e.what()).find(reason) != std::string::npos);
+						}
+
+						return static_cast<uint8_t>(0u);
+					};
+
+					std::vector<uint8_t> out;
+
+					out.push_back(rejects("digest mismatch", [&]()
+					{
+						// The base frames differ in one bit
+						auto wrong_base = frame_store::load(to_config_words(bitstream_bytes), frame_words);
+						wrong_base.frame(0u, 0u)[0u] ^= 1u;
+
+						std::istringstream delta_stm(delta);
+						frame_delta_decoder decoder(delta_stm);
+						decoder.apply(wrong_base);
+					}));
+
+					out.push_back(rejects("digest mismatch", [&]()
+					{
+						// A (valid) bitstream of another image: the target bitstream itself
+						apply_to_bitstream(delta, apply_to_bitstream(delta, bitstream_str));
+					}));
+
+					for (const std::size_t offset : { delta.size() / 2u, delta.size() - 1u })
+					{
+						out.push_back(rejects("CRC mismatch", [&]()
+						{
+							// Corrupted record payload / final CRC word
+							std::string corrupt(delta);
+							corrupt[offset] ^= 0x01;
+
+							std::istringstream delta_stm(corrupt);
+							frame_delta_decoder decoder(delta_stm);
+						}));
+					}
+
+					return out;
+				});
+		}
+
+		std::mt19937_64 rng(opts.seed);
+
+		// Block RAM bit mapping: per-bit mapping vs. chunked range mapping (every block RAM of the device)
+		for (const auto category : { bram_category::ramb36, bram_category::ramb18 })
+		{
+			const bool is_18 = (category == bram_category::ramb18);
+			const std::string name = prefix + (is_18 ? "bram-map-range/ramb18" : "bram-map-range/ramb36");
+
+			if (fpga.num_brams(category) == 0u || !harness.selected(name))
+				continue;
+
+			const auto all_offsets = [&](std::size_t chunk_bits)
+			{
+				std::vector<uint8_t> out;
+				for (std::size_t i = 0u; i < fpga.num_brams(category); ++i)
+				{
+					// NOTE: Parity bits of RAMB18E1 halves are not mapped by the legacy library
+					const auto& ram = fpga.bram_at(category, i);
+					append_offset_digest(out, ram, ram.primitive() != "RAMB18E1", chunk_bits);
+				}
+
+				return out;
+			};
+
+			harness.check(name,
+				[&]()
+				{
+					return all_offsets(0u);
+				},
+				[&]()
+				{
+					return all_offsets(bram::map_chunk_bits);
+				});
+		}
+
+		// Block RAM extraction: legacy bitstream vs. frame store (word frame source)
+		for (const auto category : { bram_category::ramb36, bram_category::ramb18 })
+		{
+			const bool is_18 = (category == bram_category::ramb18);
+			const auto rams = pick_brams(fpga, category, opts.num_brams, rng);
+
+			if (rams.empty())
+				continue;
+
+			// NOTE: Parity bits of RAMB18E1 halves are not mapped by the legacy library (only data bits are compared)
+			const bool with_parity = !is_18;
+
+			harness.check(prefix + (is_18 ? "bram-extract/ramb18" : "bram-extract/ramb36"),
+				[&]()
+				{
+					std::vector<uint8_t> out;
+					for (const auto* ram : rams)
+					{
+						const auto data = reference_extract(*ram, bs, false);
+						out.insert(out.end(), data.begin(), data.end());
+
+						if (with_parity)
+						{
+							const auto parity = reference_extract(*ram, bs, true);
+							out.insert(out.end(), parity.begin(), parity.end());
+						}
+					}
+
+					return out;
+				},
+				[&]()
+				{
+					std::vector<uint8_t> out;
+					for (const auto* ram : rams)
+					{
+						const auto data = ram->extract(frames, false);
+						out.insert(out.end(), data.begin(), data.end());
+
+						if (with_parity)
+						{
+							const auto parity = ram->extract(frames, true);
+							out.insert(out.end(), parity.begin(), parity.end());
+						}
+					}
+
+					return out;
+				});
+
+			harness.check(prefix + (is_18 ? "bram-extract-compressed/ramb18" : "bram-extract-compressed/ramb36"),
+				[&]()
+				{
+					std::vector<uint8_t> out;
+					for (const auto* ram : rams)
+					{
+						const auto data = reference_extract(*ram, bs, false);
+						out.insert(out.end(), data.begin(), data.end());
+					}
+
+					return out;
+				},
+				[&]()
+				{
+					std::vector<uint8_t> out;
+					for (const auto* ram : rams)
+					{
+						const auto data = ram->extract(packed, false);
+						out.insert(out.end(), data.begin(), data.end());
+					}
+
+					return out;
+				});
+		}
+
+#if defined(UNBIT_BENCH_MMI)
+		// MMI regions: per-byte (per-bit) legacy reads vs. bulk region extraction from the frame store
+		for (std::size_t layout = 0u; layout < opts.num_layouts; ++layout)
+		{
+			const std::string name = prefix + "mmi-region/" + std::to_string(layout);
+			const std::string ranges_name = prefix + "mmi-ranges/" + std::to_string(layout);
+			const std::string write_name = prefix + "mmi-write/" + std::to_string(layout);
+			const std::string packed_name = prefix + "mmi-region-compressed/" + std::to_string(layout);
+
+			const auto mmi_path = std::filesystem::temp_directory_path() / ("unbit-diff-" +
+				std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".mmi");
+
+			// Always generate the layout (keeps the random sequence independent of the filter)
+			write_random_mmi(mmi_path, fpga, rng);
+			std::mt19937_64 ranges_rng(rng());
+
+			if (!harness.selected(name) && !harness.selected(ranges_name) && !harness.selected(write_name) &&
+				!harness.selected(packed_name))
+			{
+				std::filesystem::remove(mmi_path);
+				continue;
+			}
+
+			std::unique_ptr<unbit::old::xilinx::mmi::memory_map> map;
+
+			try
+			{
+				map = unbit::old::xilinx::mmi::memory_map::load(mmi_path.string(), "diff/cpu");
+			}
+			catch (...)
+			{
+				std::filesystem::remove(mmi_path);
+				throw;
+			}
+
+			std::filesystem::remove(mmi_path);
+
+			// Per-byte reads (each bit mapped and read individually)
+			const auto per_byte_regions = [&]()
+			{
+				std::vector<uint8_t> out;
+				for (std::size_t r = 0u; r < map->num_regions(); ++r)
+				{
+					const auto& rgn = map->region(r);
+
+					for (uint64_t addr = rgn.start_bit_addr() / 8u; addr <= rgn.end_bit_addr() / 8u; ++addr)
+						out.push_back(reference_read_byte(*map, fpga, bs, addr));
+				}
+
+				return out;
+			};
+
+			harness.check(name, per_byte_regions,
+				[&]()
+				{
+					std::vector<uint8_t> out;
+					for (std::size_t r = 0u; r < map->num_regions(); ++r)
+					{
+						const auto data = map->read_region(fpga, frames, r);
+						out.insert(out.end(), data.begin(), data.end());
+					}
+
+					return out;
+				});
+
+			// Bulk region extraction from the compressed frames (decompresses the touched frames only)
+			harness.check(packed_name, per_byte_regions,
+				[&]()
+				{
+					std::vector<uint8_t> out;
+					for (std::size_t r = 0u; r < map->num_regions(); ++r)
+					{
+						const auto data = map->read_region(fpga, packed, r);
+						out.insert(out.end(), data.begin(), data.end());
+					}
+
+					return out;
+				});
+
+			// Symbol-like byte ranges: per-byte reads vs. one batched read (grouped by block RAM)
+			std::vector<unbit::old::xilinx::mmi::memory_map::byte_range> ranges(opts.num_ranges);
+
+			for (auto& range : ranges)
+			{
+				const auto& rgn = map->region(ranges_rng() % map->num_regions());
+				const uint64_t first = rgn.start_bit_addr() / 8u;
+				const uint64_t size = rgn.end_bit_addr() / 8u - first + 1u;
+
+				range.size = static_cast<std::size_t>(std::min<uint64_t>(size, 1u << (ranges_rng() % 7u)));
+				range.address = first + ranges_rng() % (size - range.size + 1u);
+			}
+
+			harness.check(ranges_name,
+				[&]()
+				{
+					std::vector<uint8_t> out;
+					for (const auto& range : ranges)
+					{
+						for (std::size_t i = 0u; i < range.size; ++i)
+							out.push_back(reference_read_byte(*map, fpga, bs, range.address + i));
+					}
+
+					return out;
+				},
+				[&]()
+				{
+					std::vector<uint8_t> out;
+					for (const auto& data : map->read_ranges(fpga, frames, std::span<const unbit::old::xilinx::mmi::memory_map::byte_range>(ranges)))
+						out.insert(out.end(), data.begin(), data.end());
+
+					return out;
+				});
+
+			// Image-like writes of the same ranges: per-byte writes vs. one merged block RAM write plan
+			std::vector<std::vector<uint8_t>> values(ranges.size());
+
+			for (std::size_t r = 0u; r < ranges.size(); ++r)
+			{
+				values[r].resize(ranges[r].size);
+				for (auto& v : values[r])
+					v = static_cast<uint8_t>(ranges_rng());
+			}
+
+			const auto written_frames = [](const unbit::old::xilinx::bitstream& out)
+			{
+				std::vector<uint8_t> frames;
+				for (unsigned k = 0u; k < out.slrs().size(); ++k)
+					frames.insert(frames.end(), out.frame_data_begin(k), out.frame_data_end(k));
+
+				return frames;
+			};
+
+			// Lanes on distinct RAM objects of the same tile (a RAMB18 half and its RAMB36) alias each other. The
+			// merged plan does not preserve the order of such writes (implemented designs never alias block RAMs).
+			std::vector<const bram*> lane_rams;
+			for (std::size_t r = 0u; r < map->num_regions(); ++r)
+			{
+				for (const auto& lane : map->plan_region(fpga, r).lanes)
+					lane_rams.push_back(lane.ram);
+			}
+
+			const bool aliased = std::any_of(lane_rams.begin(), lane_rams.end(), [&](const bram* a)
+			{
+				return std::any_of(lane_rams.begin(), lane_rams.end(), [&](const bram* b)
+				{
+					return a != b && a->slr() == b->slr() && a->bitstream_offset() == b->bitstream_offset();
+				});
+			});
+
+			if (!aliased)
+			{
+				harness.check(write_name,
+					[&]()
+					{
+						std::istringstream stm(bitstream_str);
+						unbit::old::xilinx::bitstream out(stm);
+
+						for (std::size_t r = 0u; r < ranges.size(); ++r)
+						{
+							for (std::size_t i = 0u; i < ranges[r].size; ++i)
+								reference_write_byte(*map, out, fpga, ranges[r].address + i, values[r][i]);
+						}
+
+						return written_frames(out);
+					},
+					[&]()
+					{
+						std::istringstream stm(bitstream_str);
+						unbit::old::xilinx::bitstream out(stm);
+
+						unbit::old::xilinx::mmi::bram_write_plan plan(fpga);
+						for (std::size_t r = 0u; r < ranges.size(); ++r)
+							plan.add(*map, ranges[r].address, values[r]);
+
+						plan.apply(out);
+						return written_frames(out);
+					});
+			}
+		}
+#endif
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Formats an Intel-Hex record (with checksum).
+	 */
+	static std::string make_hex_record(uint8_t type, uint16_t address, std::span<const uint8_t> payload)
+	{
+		static const char digits[] = "0123456789ABCDEF";
+
+		std::vector<uint8_t> bytes { static_cast<uint8_t>(payload.size()), static_cast<uint8_t>(address >> 8u),
+			static_cast<uint8_t>(address), type };
+		bytes.insert(bytes.end(), payload.begin(), payload.end());
+
+		uint8_t sum = 0u;
+		for (const uint8_t b : bytes)
+			sum = static_cast<uint8_t>(sum + b);
+
+		bytes.push_back(static_cast<uint8_t>(0u - sum));
+
+		std::string line(":");
+		for (const uint8_t b : bytes)
+		{
+			line.push_back(digits[b >> 4u]);
+			line.push_back(digits[b & 0xFu]);
+		}
+
+		line.push_back('\n');
+		return line;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Generates Intel-Hex text with dense extended address records (type 2/4).
+	 *
+	 * Address records follow each other within a few lines, i.e. every chunk boundary of the parallel loader is
+	 * close to one. Data records overlap each other. Records behind the end of file record are to be ignored.
+	 */
+	static std::string make_random_hex(std::mt19937_64& rng, std::size_t num_lines, bool with_eof)
+	{
+		std::string text;
+
+		for (std::size_t i = 0u; i < num_lines; ++i)
+		{
+			const uint32_t kind = static_cast<uint32_t>(rng() % 16u);
+
+			if (kind < 2u)
+			{
+				// Extended linear address (type 4)
+				const uint16_t upper = static_cast<uint16_t>(rng() % 64u);
+				const uint8_t payload[2u] = { static_cast<uint8_t>(upper >> 8u), static_cast<uint8_t>(upper) };
+				text += make_hex_record(0x04u, 0u, payload);
+			}
+			else if (kind < 4u)
+			{
+				// Extended segment address (type 2)
+				const uint16_t segment = static_cast<uint16_t>(rng());
+				const uint8_t payload[2u] = { static_cast<uint8_t>(segment >> 8u), static_cast<uint8_t>(segment) };
+				text += make_hex_record(0x02u, 0u, payload);
+			}
+			else if (kind == 4u)
+			{
+				// Start linear address (type 5)
+				const uint32_t entry = static_cast<uint32_t>(rng());
+				const uint8_t payload[4u] = { static_cast<uint8_t>(entry >> 24u), static_cast<uint8_t>(entry >> 16u),
+					static_cast<uint8_t>(entry >> 8u), static_cast<uint8_t>(entry) };
+				text += make_hex_record(0x05u, 0u, payload);
+			}
+			else
+			{
+				// Data (type 0)
+				std::vector<uint8_t> payload(1u + rng() % 32u);
+				for (auto& b : payload)
+					b = static_cast<uint8_t>(rng());
+
+				text += make_hex_record(0x00u, static_cast<uint16_t>(rng() % 0x4000u), payload);
+			}
+		}
+
+		if (with_eof)
+		{
+			text += make_hex_record(0x01u, 0u, std::span<const uint8_t>());
+
+			const uint8_t ignored[4u] = { 0xDEu, 0xADu, 0xBEu, 0xEFu };
+			text += make_hex_record(0x00u, 0x1000u, ignored);
+		}
+
+		return text;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Appends a memory image as (address, value) pairs in increasing address order (0xFF if loading failed).
+	 */
+	static void append_hex_bytes(std::vector<uint8_t>& out, bool ok, uint32_t entrypoint,
+		const std::vector<std::pair<uint32_t, uint8_t>>& bytes)
+	{
+		const auto put_word = [&](uint32_t w)
+		{
+			for (unsigned k = 0u; k < 4u; ++k)
+				out.push_back(static_cast<uint8_t>(w >> (8u * k)));
+		};
+
+		if (!ok)
+		{
+			out.push_back(0xFFu);
+			return;
+		}
+
+		out.push_back(0x00u);
+		put_word(entrypoint);
+
+		for (const auto& [address, value] : bytes)
+		{
+			put_word(address);
+			out.push_back(value);
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Runs the image file checks.
+	 */
+	static void run_image_checks(diff_harness& harness, const tool_options& opts)
+	{
+		if (!harness.selected("ihex-parse-image"))
+			return;
+
+		// Several inputs with many chunks each; the last one lacks the end of file record
+		std::mt19937_64 rng(opts.seed);
+		std::vector<std::string> inputs;
+
+		for (const std::size_t num_lines : { 1u, 50u, 5000u, 50000u })
+			inputs.push_back(make_random_hex(rng, num_lines, true));
+
+		inputs.push_back(make_random_hex(rng, 5000u, false));
+
+		// Serial loader (per-record callback) vs. parallel two-phase loader
+		harness.check("ihex-parse-image",
+			[&]()
+			{
+				std::vector<uint8_t> out;
+				for (const auto& text : inputs)
+				{
+					std::map<uint32_t, uint8_t> memory;
+					uint32_t entrypoint = 0u;
+					bool ok = true;
+
+					try
+					{
+						std::istringstream stm(text);
+						entrypoint = unbit::ihex::load(stm, [&](uint32_t address, const std::vector<uint8_t>& data)
+						{
+							for (std::size_t i = 0u; i < data.size(); ++i)
+								memory[address + static_cast<uint32_t>(i)] = data[i];
+						});
+					}
+					catch (const std::exception&)
+					{
+						ok = false;
+					}
+
+					append_hex_bytes(out, ok, entrypoint, std::vector<std::pair<uint32_t, uint8_t>>(memory.begin(), memory.end()));
+				}
+
+				return out;
+			},
+			[&]()
+			{
+				std::vector<uint8_t> out;
+				for (const auto& text : inputs)
+				{
+					unbit::memory_image image;
+					bool ok = true;
+
+					try
+					{
+						image = unbit::ihex::parse_image(text);
+					}
+					catch (const std::exception&)
+					{
+						ok = false;
+					}
+
+					// Segments are expected in increasing address order
+					std::vector<std::pair<uint32_t, uint8_t>> bytes;
+					for (const auto& seg : image.segments)
+					{
+						for (std::size_t i = 0u; i < seg.data.size(); ++i)
+							bytes.emplace_back(seg.address + static_cast<uint32_t>(i), seg.data[i]);
+					}
+
+					append_hex_bytes(out, ok, image.entrypoint, bytes);
+				}
+
+				return out;
+			});
+	}
+
+#if defined(UNBIT_DIFF_FRAME_ARCHIVE) && (defined(__unix__) || defined(__APPLE__))
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Runs a shell command and captures its standard output (throws if the command fails).
+	 */
+	static std::string run_command(const std::string& command)
+	{
+		FILE* pipe = ::popen(command.c_str(), "r");
+		if (!pipe)
+			throw std::runtime_error("unable to run '" + command + "'");
+
+		std::string output;
+		char buffer[4096u];
+		std::size_t n;
+
+		while ((n = std::fread(buffer, 1u, sizeof(buffer), pipe)) > 0u)
+			output.append(buffer, n);
+
+		if (::pclose(pipe) != 0)
+			throw std::runtime_error("command '" + command + "' failed:\n" + output);
+
+		return output;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Runs the frame archive synchronization check (server and client in separate processes).
+	 */
+	static void run_archive_checks(diff_harness& harness, const tool_options& opts)
+	{
+		if (!harness.selected("archive-sync"))
+			return;
+
+		// Base build, and a target build with a few changed frames (each with content new to both archives)
+		synthetic_options syn;
+		syn.frame_words = 93u;
+		syn.seed = opts.seed;
+		syn.slrs = { unbit::bench::synthetic_slr { 0x04B31093u, 3000u }, unbit::bench::synthetic_slr { 0x04B22039u, 3000u } };
+
+		const auto config_words = to_config_words(make_synthetic_bitstream(syn));
+		const auto base = frame_store::load(config_words, syn.frame_words);
+		auto target = frame_store::load(config_words, syn.frame_words);
+
+		uint32_t num_changed = 0u;
+
+		for (std::size_t k = 0u; k < target.num_slrs(); ++k)
+		{
+			for (std::size_t f = 11u * k + 5u; f < target.num_frames(k); f += 401u, ++num_changed)
+			{
+				auto frame = target.frame(k, f);
+				frame[0u] = 0x5EED0000u ^ num_changed;
+				frame[1u] = ~frame[1u];
+			}
+		}
+
+		const auto frame_bytes = [](const frame_store& src)
+		{
+			std::vector<uint8_t> out;
+			for (std::size_t k = 0u; k < src.num_slrs(); ++k)
+			{
+				for (const std::byte b : std::as_bytes(src.words(k)))
+					out.push_back(static_cast<uint8_t>(b));
+			}
+
+			return out;
+		};
+
+		const auto put_word = [](std::vector<uint8_t>& out, uint32_t w)
+		{
+			for (unsigned k = 0u; k < 4u; ++k)
+				out.push_back(static_cast<uint8_t>(w >> (8u * k)));
+		};
+
+		const auto tmp = std::filesystem::temp_directory_path() / ("unbit-diff-" +
+			std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+		const std::string server_dir = (tmp / "server").string();
+		const std::string client_dir = (tmp / "client").string();
+		const std::string tool = UNBIT_DIFF_FRAME_ARCHIVE;
+
+		try
+		{
+			{
+				frame_archive server(server_dir);
+				server.add("base", base);
+				server.add("target", target);
+			}
+
+			std::ostringstream server_bitstream;
+			frame_archive(server_dir).reconstruct("target", server_bitstream);
+
+			// Target frames, only the changed frames transferred, identical reconstructed bitstreams
+			harness.check("archive-sync",
+				[&]()
+				{
+					std::vector<uint8_t> out(frame_bytes(target));
+					put_word(out, num_changed);
+					out.push_back(1u);
+					return out;
+				},
+				[&]()
+				{
+					std::filesystem::remove_all(client_dir);
+					frame_archive(client_dir).add("base", base);
+
+					// 'sync' runs 'serve' as a child process (talking over pipes)
+					const std::string output = run_command("'" + tool + "' sync '" + client_dir + "' target --base base " +
+						"--exec \"'" + tool + "' serve '" + server_dir + "'\"");
+
+					const auto pos = output.find("': ");
+					if (pos == std::string::npos)
+						throw std::runtime_error("unexpected output of the sync command:\n" + output);
+
+					const frame_archive client(client_dir);
+					std::ostringstream client_bitstream;
+					client.reconstruct("target", client_bitstream);
+
+					std::vector<uint8_t> out(frame_bytes(client.load("target")));
+					put_word(out, static_cast<uint32_t>(std::stoul(output.substr(pos + 3u))));
+					out.push_back(client_bitstream.str() == server_bitstream.str() ? 1u : 0u);
+					return out;
+				});
+		}
+		catch (...)
+		{
+			std::filesystem::remove_all(tmp);
+			throw;
+		}
+
+		std::filesystem::remove_all(tmp);
+	}
+#endif
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		tool_options opts;
+
+		if (!parse_args(argc, argv, opts))
+		{
+			usage(argv[0u]);
+			return EXIT_FAILURE;
+		}
+
+		diff_harness harness(opts.diff);
+
+		for (const auto& device : known_devices)
+			run_device_checks(harness, device, opts);
+
+		run_image_checks(harness, opts);
+
+#if defined(UNBIT_DIFF_FRAME_ARCHIVE) && (defined(__unix__) || defined(__APPLE__))
+		run_archive_checks(harness, opts);
+#endif
+
+		harness.report(std::cout);
+		return (harness.num_failures() == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
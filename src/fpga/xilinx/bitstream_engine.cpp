@@ -89,9 +89,9 @@ namespace unbit
 				//
 				if (hdr == FPGA_SYNC_WORD_LE)
 				{
-					// Silently tolerate SYNC packets where TYPE1 packets are allowed (for now)
-					// TODO: Raise a dedicated event? Or handle DESYNC?
-					return parser_status_type(pos, true);
+					// Tolerate SYNC packets where TYPE1 packets are allowed (e.g. re-synchronization
+					// following a DESYNC command)
+					return parser_status_type(pos, on_config_sync());
 				}
 				else if (packet_type == 0x1u)
 				{
@@ -106,7 +106,7 @@ namespace unbit
 					// Type-1 packet
 					pkt_op      = (hdr >> 27u) & 0x3u;
 					pkt_reg     = (hdr >> 13u) & 0x1Fu;
-					word_count  = hdr & 0x3FFu;
+					word_count  = hdr & 0x7FFu;
 				}
 				else
 				{
@@ -216,6 +216,13 @@ namespace unbit
 				// Reject reserved packets by default
 				return false;
 			}
+
+			//------------------------------------------------------------------------------------------
+			bool bitstream_engine::on_config_sync()
+			{
+				// Ignore (repeated) SYNC words by default
+				return true;
+			}
 		}
 	}
 }
@@ -0,0 +1,433 @@
+/**
+ * @file
+ * @brief Parallel serializer for configuration bitstreams (per-SLR segments, vectored writes).
+ */
+#include "unbit/fpga/xilinx/bitstream_serializer.hpp"
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/config_cmd.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/runtime/executor.hpp"
+
+#include "config_packet.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <fcntl.h>
+# include <limits.h>
+# include <sys/uio.h>
+# include <unistd.h>
+# define UNBIT_HAVE_PWRITEV 1
+#endif
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				using detail::begin_fdri;
+				using detail::segment_writer;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Hashes the contents of a frame (FNV-1a over the words).
+				 */
+				static uint64_t hash_frame(std::span<const uint32_t> frame)
+				{
+					uint64_t h = 0xCBF29CE484222325u;
+
+					for (const uint32_t w : frame)
+						h = (h ^ w) * 0x100000001B3u;
+
+					return h;
+				}
+
+			}
+
+			//------------------------------------------------------------------------------------------
+			bitstream_serializer::bitstream_serializer(const frame_store& frames, const serializer_options& opts)
+				: frames_(frames), options_(opts), configs_(frames.num_slrs())
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			bitstream_serializer::~bitstream_serializer()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			bitstream_serializer::slr_config& bitstream_serializer::config(std::size_t slr)
+			{
+				if (slr >= configs_.size())
+					throw std::out_of_range("slr index is out of range");
+
+				return configs_[slr];
+			}
+
+			//------------------------------------------------------------------------------------------
+			void bitstream_serializer::encode()
+			{
+				const std::size_t num_slrs = frames_.num_slrs();
+
+				if (num_slrs == 0u)
+					throw std::invalid_argument("frame store does not contain any slr");
+
+				buffers_.clear();
+				images_.clear();
+				images_.resize(num_slrs);
+
+				if (options_.parallel && num_slrs > 1u)
+				{
+					// One task per SLR (on the shared executor)
+					runtime::parallel_for(0u, num_slrs, [this](std::size_t i) { encode_head(i); });
+				}
+				else
+				{
+					for (std::size_t i = 0u; i < num_slrs; ++i)
+						encode_head(i);
+				}
+
+				link();
+
+				// Collect the segment buffers in file order
+				buffers_.reserve(3u * num_slrs);
+
+				const auto add_buffer = [&](const std::vector<uint32_t>& words)
+				{
+					if (!words.empty())
+						buffers_.emplace_back(reinterpret_cast<const uint8_t*>(words.data()), words.size() * sizeof(uint32_t));
+				};
+
+				for (const auto& image : images_)
+				{
+					add_buffer(image.head);
+					add_buffer(image.link);
+				}
+
+				for (auto it = images_.rbegin(); it != images_.rend(); ++it)
+					add_buffer(it->tail);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void bitstream_serializer::encode_head(std::size_t slr)
+			{
+				const slr_config& cfg = configs_[slr];
+				slr_image& image = images_[slr];
+
+				const std::size_t frame_words = frames_.frame_words();
+				const std::size_t num_frames = frames_.num_frames(slr);
+
+				const bool have_fars = !cfg.frame_addresses.empty();
+				if (have_fars && cfg.frame_addresses.size() != num_frames)
+					throw std::invalid_argument("frame address map does not match the number of frames of the slr");
+
+				if (options_.compress && !have_fars)
+					throw std::invalid_argument("mfwr compression requires a frame address map");
+
+				image.head.reserve(64u + num_frames * frame_words);
+
+				segment_writer w(image.head, 0u, slr > 0u);
+
+				// Dummy words, bus width detection, sync and header
+				detail::write_stream_header(w);
+
+				if (const auto& idcode = frames_.idcode(slr))
+					w.write(config_reg::IDCODE, *idcode);
+
+				for (const auto& reg_write : cfg.header)
+					w.write(reg_write.reg, reg_write.data);
+
+				// Frame data
+				const auto words = frames_.words(slr);
+
+				if (!options_.compress)
+				{
+					// Single FDRI write spanning all frames
+					begin_fdri(w, have_fars ? cfg.frame_addresses.front() : 0u);
+					w.write(config_reg::FDRI, words);
+
+					image.num_fdri_frames = num_frames;
+				}
+				else
+				{
+					// Group frames with identical contents (only frames with a known address)
+					std::unordered_map<uint64_t, std::vector<std::size_t>> buckets;
+					std::vector<std::vector<std::size_t>> groups;
+					std::vector<bool> duplicated(num_frames, false);
+
+					for (std::size_t f = 0u; f < num_frames; ++f)
+					{
+						if (cfg.frame_addresses[f] == NO_FRAME_ADDRESS)
+							continue;
+
+						const auto frame = frames_.frame(slr, f);
+						auto& bucket = buckets[hash_frame(frame)];
+
+						bool found = false;
+						for (const std::size_t g : bucket)
+						{
+							const auto other = frames_.frame(slr, groups[g].front());
+							if (std::equal(frame.begin(), frame.end(), other.begin()))
+							{
+								groups[g].push_back(f);
+								found = true;
+								break;
+							}
+						}
+
+						if (!found)
+						{
+							bucket.push_back(groups.size());
+							groups.push_back({ f });
+						}
+					}
+
+					for (const auto& group : groups)
+					{
+						if (group.size() > 1u)
+						{
+							for (const std::size_t f : group)
+								duplicated[f] = true;
+						}
+					}
+
+					const std::vector<uint32_t> pad_frame(frame_words, 0u);
+					const std::vector<uint32_t> mfwr_data(options_.mfwr_words, 0u);
+
+					// Literal runs (consecutive frames in auto-increment order), each followed by a
+					// pipeline flush frame
+					std::size_t f = 0u;
+					while (f < num_frames)
+					{
+						// Runs start at a unique frame with a known address
+						if (duplicated[f] || cfg.frame_addresses[f] == NO_FRAME_ADDRESS)
+						{
+							++f;
+							continue;
+						}
+
+						std::size_t end = f + 1u;
+						while (end < num_frames && !duplicated[end])
+							++end;
+
+						// Trailing padding frames are not needed (replaced by the flush frame)
+						std::size_t last = end;
+						while (last > f && cfg.frame_addresses[last - 1u] == NO_FRAME_ADDRESS)
+							--last;
+
+						begin_fdri(w, cfg.frame_addresses[f]);
+
+						std::vector<uint32_t> run(words.begin() + f * frame_words, words.begin() + last * frame_words);
+						run.insert(run.end(), pad_frame.begin(), pad_frame.end());
+						w.write(config_reg::FDRI, run);
+
+						image.num_fdri_frames += last - f;
+						f = end;
+					}
+
+					// Duplicated frames: One FDRI write of the contents, followed by FAR/MFWR pairs
+					for (const auto& group : groups)
+					{
+						if (group.size() < 2u)
+							continue;
+
+						const auto frame = frames_.frame(slr, group.front());
+
+						begin_fdri(w, cfg.frame_addresses[group.front()]);
+
+						std::vector<uint32_t> data(frame.begin(), frame.end());
+						data.insert(data.end(), pad_frame.begin(), pad_frame.end());
+						w.write(config_reg::FDRI, data);
+
+						w.command(config_cmd::MFW);
+
+						for (std::size_t i = 1u; i < group.size(); ++i)
+						{
+							w.write(config_reg::FAR, cfg.frame_addresses[group[i]]);
+							w.write(config_reg::MFWR, mfwr_data);
+						}
+
+						image.num_fdri_frames += 1u;
+						image.num_mfwr_frames += group.size() - 1u;
+					}
+				}
+
+				image.head_crc = w.crc();
+				image.head_nested_crc = w.nested_crc();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void bitstream_serializer::link()
+			{
+				// Trailer, CRC check and DESYNC
+				detail::link_segments(std::span<slr_image>(images_), options_.with_crc,
+					[this](std::size_t k, segment_writer& tw)
+					{
+						for (const auto& reg_write : configs_[k].trailer)
+							tw.write(reg_write.reg, reg_write.data);
+					});
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t bitstream_serializer::size() const noexcept
+			{
+				std::size_t total = 0u;
+
+				for (const auto& buffer : buffers_)
+					total += buffer.size();
+
+				return total;
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t bitstream_serializer::num_fdri_frames() const noexcept
+			{
+				std::size_t total = 0u;
+
+				for (const auto& image : images_)
+					total += image.num_fdri_frames;
+
+				return total;
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t bitstream_serializer::num_mfwr_frames() const noexcept
+			{
+				std::size_t total = 0u;
+
+				for (const auto& image : images_)
+					total += image.num_mfwr_frames;
+
+				return total;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void bitstream_serializer::write(int fd, uint64_t offset) const
+			{
+				if (!encoded())
+					throw std::logic_error("bitstream has not been encoded");
+
+#if defined(UNBIT_HAVE_PWRITEV)
+				std::vector<struct iovec> iov(buffers_.size());
+
+				for (std::size_t i = 0u; i < buffers_.size(); ++i)
+				{
+					iov[i].iov_base = const_cast<uint8_t*>(buffers_[i].data());
+					iov[i].iov_len  = buffers_[i].size();
+				}
+
+				// Vectored write (resumed on partial writes, and in chunks of at most IOV_MAX buffers)
+				std::size_t first = 0u;
+
+				while (first < iov.size())
+				{
+					const int count = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+					const ssize_t n = ::pwritev(fd, &iov[first], count, static_cast<off_t>(offset));
+
+					if (n < 0)
+					{
+						if (errno == EINTR)
+							continue;
+
+						throw std::system_error(errno, std::generic_category(), "i/o error while writing bitstream data");
+					}
+					else if (n == 0 && iov[first].iov_len > 0u)
+					{
+						// No progress (e.g. a full device); retrying would never finish
+						throw std::system_error(EIO, std::generic_category(), "i/o error while writing bitstream data");
+					}
+
+					offset += static_cast<uint64_t>(n);
+
+					// Skip the completely written buffers, and adjust a partially written one
+					std::size_t remaining = static_cast<std::size_t>(n);
+					while (first < iov.size() && remaining >= iov[first].iov_len)
+					{
+						remaining -= iov[first].iov_len;
+						++first;
+					}
+
+					if (remaining > 0u)
+					{
+						iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + remaining;
+						iov[first].iov_len -= remaining;
+					}
+				}
+#else
+				static_cast<void>(fd);
+				static_cast<void>(offset);
+				throw std::runtime_error("vectored writes are not supported on this platform");
+#endif
+			}
+
+			//------------------------------------------------------------------------------------------
+			void bitstream_serializer::write(const std::string& filename) const
+			{
+				if (!encoded())
+					throw std::logic_error("bitstream has not been encoded");
+
+#if defined(UNBIT_HAVE_PWRITEV)
+				const int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+				if (fd < 0)
+					throw std::system_error(errno, std::generic_category(), "unable to open output file '" + filename + "'");
+
+				try
+				{
+					write(fd, 0u);
+				}
+				catch (...)
+				{
+					::close(fd);
+					throw;
+				}
+
+				if (::close(fd) != 0)
+					throw std::system_error(errno, std::generic_category(), "i/o error while closing bitstream file");
+#else
+				std::ofstream stm(filename, std::ios_base::out | std::ios_base::binary);
+				write(stm);
+#endif
+			}
+
+			//------------------------------------------------------------------------------------------
+			void bitstream_serializer::write(std::ostream& os) const
+			{
+				if (!encoded())
+					throw std::logic_error("bitstream has not been encoded");
+
+				static_assert(sizeof(std::ostream::char_type) == sizeof(uint8_t),
+					"unsupported: sizeof(std::ostream::char_type) != sizeof(uint8_t)");
+
+				for (const auto& buffer : buffers_)
+					os.write(reinterpret_cast<const std::ostream::char_type*>(buffer.data()), buffer.size());
+
+				if (os.fail())
+					throw std::ios_base::failure("i/o error while writing bitstream data");
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::vector<uint8_t> bitstream_serializer::to_bytes() const
+			{
+				if (!encoded())
+					throw std::logic_error("bitstream has not been encoded");
+
+				std::vector<uint8_t> result;
+				result.reserve(size());
+
+				for (const auto& buffer : buffers_)
+					result.insert(result.end(), buffer.begin(), buffer.end());
+
+				return result;
+			}
+		}
+	}
+}
@@ -0,0 +1,794 @@
+/**
+ * @file
+ * @brief Compressed configuration frames of a (multi-SLR) Xilinx FPGA.
+ */
+#include "unbit/fpga/xilinx/compressed_frame_store.hpp"
+#include "unbit/runtime/executor.hpp"
+#include "unbit/runtime/mem_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				/**
+				 * @brief Token kinds of the frame encoding (upper two bits of a token word).
+				 *
+				 * - Zero run: @c count zero words.
+				 * - Repeat run: @c count copies of the following word.
+				 * - Literal run: the @c count following words.
+				 *
+				 * Words following the last token are zero.
+				 */
+				static constexpr uint32_t TOKEN_ZEROS   = 0u << 30u;
+				static constexpr uint32_t TOKEN_REPEAT  = 1u << 30u;
+				static constexpr uint32_t TOKEN_LITERAL = 2u << 30u;
+				static constexpr uint32_t TOKEN_KIND    = 3u << 30u;
+				static constexpr uint32_t TOKEN_COUNT   = ~TOKEN_KIND;
+
+				/**
+				 * @brief Code offset of empty frames.
+				 */
+				static constexpr uint32_t EMPTY_FRAME = 0xFFFFFFFFu;
+
+				/**
+				 * @brief Number of frames compressed per task.
+				 */
+				static constexpr std::size_t FRAMES_PER_TASK = 1024u;
+
+				/**
+				 * @brief Minimum number of stale code words before the codes of an SLR are compacted.
+				 */
+				static constexpr std::size_t MIN_COMPACT_WORDS = 4096u;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Appends the tokens of a frame (nothing for empty frames).
+				 */
+				static void encode_frame(std::span<const uint32_t> words, std::vector<uint32_t>& codes)
+				{
+					// Trailing zero words are implied
+					std::size_t n = words.size();
+					while (n > 0u && words[n - 1u] == 0u)
+						--n;
+
+					std::size_t literal_start = 0u;
+					std::size_t i = 0u;
+
+					const auto flush_literals = [&](std::size_t end)
+					{
+						if (end > literal_start)
+						{
+							codes.push_back(TOKEN_LITERAL | static_cast<uint32_t>(end - literal_start));
+							codes.insert(codes.end(), words.begin() + literal_start, words.begin() + end);
+						}
+					};
+
+					while (i < n)
+					{
+						const uint32_t w = words[i];
+
+						std::size_t j = i + 1u;
+						while (j < n && words[j] == w)
+							++j;
+
+						// Short runs are cheaper as part of a literal run
+						const std::size_t run = j - i;
+						if ((w == 0u && run >= 2u) || run >= 3u)
+						{
+							flush_literals(i);
+
+							if (w == 0u)
+							{
+								codes.push_back(TOKEN_ZEROS | static_cast<uint32_t>(run));
+							}
+							else
+							{
+								codes.push_back(TOKEN_REPEAT | static_cast<uint32_t>(run));
+								codes.push_back(w);
+							}
+
+							literal_start = j;
+						}
+
+						i = j;
+					}
+
+					flush_literals(n);
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Decodes a frame.
+				 */
+				static void decode_frame(const uint32_t* codes, std::size_t num_codes, std::span<uint32_t> words)
+				{
+					const uint32_t* const end = codes + num_codes;
+					uint32_t* out = words.data();
+					uint32_t* const out_end = out + words.size();
+
+					while (codes < end)
+					{
+						const uint32_t token = *codes++;
+						const std::size_t count = token & TOKEN_COUNT;
+
+						if (count > static_cast<std::size_t>(out_end - out))
+							throw std::logic_error("compressed frame exceeds the frame size");
+
+						switch (token & TOKEN_KIND)
+						{
+						case TOKEN_ZEROS:
+							out = std::fill_n(out, count, 0u);
+							break;
+
+						case TOKEN_REPEAT:
+							out = std::fill_n(out, count, *codes++);
+							break;
+
+						default:
+							out = std::copy_n(codes, count, out);
+							codes += count;
+							break;
+						}
+					}
+
+					std::fill(out, out_end, 0u);
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Appends the length word and the encoding of a frame.
+				 *
+				 * @return The offset of the encoding (@c EMPTY_FRAME for empty frames).
+				 */
+				static uint32_t append_frame(std::span<const uint32_t> words, std::vector<uint32_t>& codes)
+				{
+					const std::size_t start = codes.size();
+
+					codes.push_back(0u);
+					encode_frame(words, codes);
+
+					if (codes.size() == start + 1u)
+					{
+						codes.pop_back();
+						return EMPTY_FRAME;
+					}
+
+					codes[start] = static_cast<uint32_t>(codes.size() - start - 1u);
+					return static_cast<uint32_t>(start);
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Gets the number of code words (length word and tokens) of a frame.
+				 */
+				static std::size_t frame_code_words(const std::vector<uint32_t>& codes, uint32_t offset)
+				{
+					return (offset != EMPTY_FRAME) ? (codes[offset] + 1u) : 0u;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Decodes a frame given by the offset of its encoding.
+				 */
+				static void decode_frame_at(const std::vector<uint32_t>& codes, uint32_t offset, std::span<uint32_t> words)
+				{
+					if (offset == EMPTY_FRAME)
+						std::fill(words.begin(), words.end(), 0u);
+					else
+						decode_frame(codes.data() + offset + 1u, codes[offset], words);
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Gets the cache index key of a frame.
+				 */
+				static inline uint64_t cache_key(unsigned slr, std::size_t frame)
+				{
+					return (static_cast<uint64_t>(slr) << 32u) | static_cast<uint64_t>(frame);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Frame cache (decompressed frames, LRU replacement).
+			 */
+			struct compressed_frame_store::frame_cache
+			{
+				/**
+				 * @brief Cache slot.
+				 */
+				struct slot
+				{
+					uint32_t slr = 0u;
+					std::size_t frame = 0u;
+					uint64_t last_use = 0u;
+					bool dirty = false;
+				};
+
+				/**
+				 * @brief Lock protecting the cache and the compressed frames.
+				 */
+				std::mutex lock;
+
+				/**
+				 * @brief Maximum number of cached frames.
+				 */
+				std::size_t capacity = 0u;
+
+				/**
+				 * @brief Frame data of the slots.
+				 */
+				std::vector<uint32_t> words;
+
+				/**
+				 * @brief Slots in use.
+				 */
+				std::vector<slot> slots;
+
+				/**
+				 * @brief Slot of each cached frame (by cache key).
+				 */
+				std::unordered_map<uint64_t, uint32_t> index;
+
+				/**
+				 * @brief Use counter (for the LRU replacement).
+				 */
+				uint64_t clock = 0u;
+
+				/**
+				 * @brief Number of modified (not yet encoded) cached frames.
+				 *
+				 * Without modified frames the compressed frames do not change during reads, which
+				 * makes lock-free reads of empty frames and whole frames possible.
+				 */
+				std::atomic<std::size_t> num_dirty { 0u };
+
+				/**
+				 * @brief Number of decompressed frames.
+				 */
+				std::atomic<std::size_t> num_decoded { 0u };
+
+				/**
+				 * @brief Encoding buffer.
+				 */
+				std::vector<uint32_t> scratch;
+
+				/**
+				 * @brief Number of bytes reported to the memory statistics.
+				 */
+				std::size_t tracked_bytes = 0u;
+			};
+
+			//------------------------------------------------------------------------------------------
+			compressed_frame_store::compressed_frame_store() noexcept
+				: frame_words_(0u)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			compressed_frame_store::compressed_frame_store(const frame_store& frames, const compressed_store_options& opts)
+				: frame_words_(frames.frame_words()), cache_(std::make_unique<frame_cache>())
+			{
+				if (opts.cache_frames == 0u)
+					throw std::invalid_argument("frame cache capacity must not be zero");
+
+				cache_->capacity = opts.cache_frames;
+				cache_->words.resize(opts.cache_frames * frame_words_);
+				cache_->slots.reserve(opts.cache_frames);
+				cache_->index.reserve(opts.cache_frames);
+
+				slrs_.resize(frames.num_slrs());
+
+				for (std::size_t k = 0u; k < frames.num_slrs(); ++k)
+				{
+					auto& s = slrs_[k];
+					const std::size_t num_frames = frames.num_frames(k);
+					const std::size_t num_tasks = (num_frames + FRAMES_PER_TASK - 1u) / FRAMES_PER_TASK;
+
+					s.idcode = frames.idcode(k);
+					s.offsets.resize(num_frames);
+
+					// Encode blocks of frames in parallel (offsets relative to the block's codes)
+					std::vector<std::vector<uint32_t>> task_codes(num_tasks);
+
+					runtime::parallel_for(0u, num_tasks, [&](std::size_t t)
+					{
+						auto& codes = task_codes[t];
+						const std::size_t last = std::min(num_frames, (t + 1u) * FRAMES_PER_TASK);
+
+						for (std::size_t f = t * FRAMES_PER_TASK; f < last; ++f)
+							s.offsets[f] = append_frame(frames.frame(k, f), codes);
+					});
+
+					std::size_t total = 0u;
+					for (const auto& codes : task_codes)
+						total += codes.size();
+
+					if (total >= EMPTY_FRAME)
+						throw std::length_error("compressed frame data of an slr exceeds the index range");
+
+					s.codes.reserve(total);
+
+					for (std::size_t t = 0u; t < num_tasks; ++t)
+					{
+						const std::size_t last = std::min(num_frames, (t + 1u) * FRAMES_PER_TASK);
+						for (std::size_t f = t * FRAMES_PER_TASK; f < last; ++f)
+						{
+							if (s.offsets[f] != EMPTY_FRAME)
+								s.offsets[f] += static_cast<uint32_t>(s.codes.size());
+						}
+
+						s.codes.insert(s.codes.end(), task_codes[t].begin(), task_codes[t].end());
+						std::vector<uint32_t>().swap(task_codes[t]);
+					}
+				}
+
+				update_tracking();
+			}
+
+			//------------------------------------------------------------------------------------------
+			compressed_frame_store::compressed_frame_store(compressed_frame_store&& other) noexcept = default;
+
+			//------------------------------------------------------------------------------------------
+			compressed_frame_store& compressed_frame_store::operator=(compressed_frame_store&& other) noexcept
+			{
+				if (this != &other)
+				{
+					if (cache_)
+						runtime::mem_stats::untrack(runtime::mem_subsystem::frame_store, cache_->tracked_bytes);
+
+					frame_words_ = other.frame_words_;
+					slrs_ = std::move(other.slrs_);
+					cache_ = std::move(other.cache_);
+				}
+
+				return *this;
+			}
+
+			//------------------------------------------------------------------------------------------
+			compressed_frame_store::~compressed_frame_store()
+			{
+				if (cache_)
+					runtime::mem_stats::untrack(runtime::mem_subsystem::frame_store, cache_->tracked_bytes);
+			}
+
+			//------------------------------------------------------------------------------------------
+			compressed_frame_store compressed_frame_store::load(std::span<const uint32_t> cfg_data, std::size_t frame_words,
+				const compressed_store_options& opts)
+			{
+				return compressed_frame_store(frame_store::load(cfg_data, frame_words), opts);
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_store compressed_frame_store::decompress(const frame_alloc_policy& policy) const
+			{
+				std::vector<std::size_t> frames_per_slr(slrs_.size());
+				for (std::size_t k = 0u; k < slrs_.size(); ++k)
+					frames_per_slr[k] = slrs_[k].offsets.size();
+
+				frame_store store(frame_words_, frames_per_slr, policy);
+
+				for (std::size_t k = 0u; k < slrs_.size(); ++k)
+				{
+					if (slrs_[k].idcode)
+						store.set_idcode(k, *slrs_[k].idcode);
+
+					const auto words = store.words(k);
+
+					runtime::parallel_for(0u, frames_per_slr[k], [&](std::size_t f)
+					{
+						read_frame_words(static_cast<unsigned>(k), f * frame_words_,
+							words.subspan(f * frame_words_, frame_words_));
+					}, 256u);
+				}
+
+				return store;
+			}
+
+			//------------------------------------------------------------------------------------------
+			compressed_frame_store::slr_frames& compressed_frame_store::get_slr(std::size_t slr) const
+			{
+				if (slr >= slrs_.size())
+					throw std::out_of_range("slr index is out of range");
+
+				return slrs_[slr];
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t compressed_frame_store::frame_words() const noexcept
+			{
+				return frame_words_;
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t compressed_frame_store::num_slrs() const noexcept
+			{
+				return slrs_.size();
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t compressed_frame_store::num_frames(std::size_t slr) const
+			{
+				return get_slr(slr).offsets.size();
+			}
+
+			//------------------------------------------------------------------------------------------
+			const std::optional<uint32_t>& compressed_frame_store::idcode(std::size_t slr) const
+			{
+				return get_slr(slr).idcode;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::set_idcode(std::size_t slr, uint32_t new_idcode)
+			{
+				get_slr(slr).idcode = new_idcode;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::read_frame(std::size_t slr, std::size_t frame, std::span<uint32_t> words) const
+			{
+				if (frame >= get_slr(slr).offsets.size())
+					throw std::out_of_range("frame index is out of range");
+
+				if (words.size() != frame_words_)
+					throw std::invalid_argument("frame data size does not match the frame size");
+
+				read_frame_words(static_cast<unsigned>(slr), frame * frame_words_, words);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::write_frame(std::size_t slr, std::size_t frame, std::span<const uint32_t> words)
+			{
+				if (frame >= get_slr(slr).offsets.size())
+					throw std::out_of_range("frame index is out of range");
+
+				if (words.size() != frame_words_)
+					throw std::invalid_argument("frame data size does not match the frame size");
+
+				write_frame_words(static_cast<unsigned>(slr), frame * frame_words_, words);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::flush()
+			{
+				if (!cache_)
+					return;
+
+				std::lock_guard<std::mutex> guard(cache_->lock);
+
+				for (std::size_t i = 0u; i < cache_->slots.size(); ++i)
+				{
+					if (cache_->slots[i].dirty)
+						clean_slot(static_cast<uint32_t>(i));
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t compressed_frame_store::compressed_bytes() const
+			{
+				if (!cache_)
+					return 0u;
+
+				std::lock_guard<std::mutex> guard(cache_->lock);
+				return held_bytes();
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t compressed_frame_store::uncompressed_bytes() const noexcept
+			{
+				std::size_t num_frames = 0u;
+				for (const auto& s : slrs_)
+					num_frames += s.offsets.size();
+
+				return num_frames * frame_words_ * sizeof(uint32_t);
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t compressed_frame_store::num_decoded_frames() const
+			{
+				return cache_ ? cache_->num_decoded.load(std::memory_order_relaxed) : 0u;
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t compressed_frame_store::frame_data_words(unsigned slr) const
+			{
+				return get_slr(slr).offsets.size() * frame_words_;
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint32_t compressed_frame_store::read_frame_word(unsigned slr, std::size_t bit_offset) const
+			{
+				const auto& s = get_slr(slr);
+				const std::size_t word = bit_offset / 32u;
+
+				if (word >= s.offsets.size() * frame_words_)
+					throw std::out_of_range("frame data slice is out of bounds");
+
+				const std::size_t frame = word / frame_words_;
+
+				// Empty frames need no decompression
+				if (cache_->num_dirty.load(std::memory_order_acquire) == 0u && s.offsets[frame] == EMPTY_FRAME)
+					return 0u;
+
+				std::lock_guard<std::mutex> guard(cache_->lock);
+				return slot_words(fetch_slot(slr, frame))[word % frame_words_];
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::read_frame_words(unsigned slr, std::size_t first_word, std::span<uint32_t> words) const
+			{
+				const auto& s = get_slr(slr);
+				const std::size_t total = s.offsets.size() * frame_words_;
+
+				if (first_word > total || (total - first_word) < words.size())
+					throw std::out_of_range("frame data slice is out of bounds");
+
+				while (!words.empty())
+				{
+					const std::size_t frame = first_word / frame_words_;
+					const std::size_t offset = first_word % frame_words_;
+					const std::size_t n = std::min(frame_words_ - offset, words.size());
+
+					const bool empty = (s.offsets[frame] == EMPTY_FRAME);
+
+					if (cache_->num_dirty.load(std::memory_order_acquire) == 0u && (empty || n == frame_words_))
+					{
+						// Empty and whole frames bypass the cache (the codes do not change without modified frames)
+						decode_frame_at(s.codes, s.offsets[frame], words.first(n));
+
+						if (!empty)
+							cache_->num_decoded.fetch_add(1u, std::memory_order_relaxed);
+					}
+					else
+					{
+						std::lock_guard<std::mutex> guard(cache_->lock);
+						std::copy_n(slot_words(fetch_slot(slr, frame)) + offset, n, words.begin());
+					}
+
+					first_word += n;
+					words = words.subspan(n);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::write_frame_bit(unsigned slr, std::size_t bit_offset, bool value)
+			{
+				const auto& s = get_slr(slr);
+				const std::size_t word = bit_offset / 32u;
+
+				if (word >= s.offsets.size() * frame_words_)
+					throw std::out_of_range("frame data slice is out of bounds");
+
+				std::lock_guard<std::mutex> guard(cache_->lock);
+
+				const uint32_t slot = fetch_slot(slr, word / frame_words_);
+				uint32_t& w = slot_words(slot)[word % frame_words_];
+
+				const uint32_t mask = static_cast<uint32_t>(1u) << (bit_offset % 32u);
+				const uint32_t new_w = value ? (w | mask) : (w & ~mask);
+
+				if (new_w != w)
+				{
+					w = new_w;
+					mark_dirty(slot);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::write_frame_words(unsigned slr, std::size_t first_word, std::span<const uint32_t> words)
+			{
+				auto& s = get_slr(slr);
+				const std::size_t total = s.offsets.size() * frame_words_;
+
+				if (first_word > total || (total - first_word) < words.size())
+					throw std::out_of_range("frame data slice is out of bounds");
+
+				std::lock_guard<std::mutex> guard(cache_->lock);
+
+				while (!words.empty())
+				{
+					const std::size_t frame = first_word / frame_words_;
+					const std::size_t offset = first_word % frame_words_;
+					const std::size_t n = std::min(frame_words_ - offset, words.size());
+
+					if (n == frame_words_)
+					{
+						// Whole frames are encoded directly (a cached copy is updated)
+						store_frame(slr, frame, words.first(n));
+
+						if (const auto it = cache_->index.find(cache_key(slr, frame)); it != cache_->index.end())
+						{
+							const uint32_t slot = it->second;
+
+							std::copy_n(words.begin(), n, slot_words(slot));
+
+							if (cache_->slots[slot].dirty)
+							{
+								cache_->slots[slot].dirty = false;
+								cache_->num_dirty.fetch_sub(1u, std::memory_order_release);
+							}
+						}
+					}
+					else
+					{
+						const uint32_t slot = fetch_slot(slr, frame);
+						std::copy_n(words.begin(), n, slot_words(slot) + offset);
+						mark_dirty(slot);
+					}
+
+					first_word += n;
+					words = words.subspan(n);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint32_t* compressed_frame_store::slot_words(uint32_t slot) const noexcept
+			{
+				return cache_->words.data() + static_cast<std::size_t>(slot) * frame_words_;
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint32_t compressed_frame_store::fetch_slot(unsigned slr, std::size_t frame) const
+			{
+				auto& c = *cache_;
+				uint32_t slot;
+
+				if (const auto it = c.index.find(cache_key(slr, frame)); it != c.index.end())
+				{
+					slot = it->second;
+				}
+				else
+				{
+					if (c.slots.size() < c.capacity)
+					{
+						slot = static_cast<uint32_t>(c.slots.size());
+						c.slots.emplace_back();
+					}
+					else
+					{
+						// Replace the least recently used frame
+						const auto lru = std::min_element(c.slots.begin(), c.slots.end(),
+							[](const frame_cache::slot& a, const frame_cache::slot& b) { return a.last_use < b.last_use; });
+
+						slot = static_cast<uint32_t>(lru - c.slots.begin());
+
+						if (lru->dirty)
+							clean_slot(slot);
+
+						c.index.erase(cache_key(lru->slr, lru->frame));
+					}
+
+					const auto& s = slrs_[slr];
+					decode_frame_at(s.codes, s.offsets[frame], std::span<uint32_t>(slot_words(slot), frame_words_));
+
+					c.slots[slot].slr = slr;
+					c.slots[slot].frame = frame;
+					c.slots[slot].dirty = false;
+					c.index.emplace(cache_key(slr, frame), slot);
+
+					c.num_decoded.fetch_add(1u, std::memory_order_relaxed);
+				}
+
+				c.slots[slot].last_use = ++c.clock;
+				return slot;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::mark_dirty(uint32_t slot) const noexcept
+			{
+				auto& e = cache_->slots[slot];
+
+				if (!e.dirty)
+				{
+					e.dirty = true;
+					cache_->num_dirty.fetch_add(1u, std::memory_order_release);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::clean_slot(uint32_t slot) const
+			{
+				auto& e = cache_->slots[slot];
+
+				store_frame(e.slr, e.frame, std::span<const uint32_t>(slot_words(slot), frame_words_));
+
+				e.dirty = false;
+				cache_->num_dirty.fetch_sub(1u, std::memory_order_release);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::store_frame(unsigned slr, std::size_t frame, std::span<const uint32_t> words) const
+			{
+				auto& s = slrs_[slr];
+				auto& scratch = cache_->scratch;
+
+				scratch.clear();
+				const bool empty = (append_frame(words, scratch) == EMPTY_FRAME);
+
+				const std::size_t old_size = frame_code_words(s.codes, s.offsets[frame]);
+
+				if (empty)
+				{
+					s.offsets[frame] = EMPTY_FRAME;
+					s.stale_words += old_size;
+				}
+				else if (scratch.size() <= old_size)
+				{
+					// Overwrite in place (the tail of the old encoding becomes stale)
+					std::copy(scratch.begin(), scratch.end(), s.codes.begin() + s.offsets[frame]);
+					s.stale_words += old_size - scratch.size();
+				}
+				else
+				{
+					if (s.codes.size() + scratch.size() >= EMPTY_FRAME)
+						throw std::length_error("compressed frame data of an slr exceeds the index range");
+
+					s.stale_words += old_size;
+					s.offsets[frame] = static_cast<uint32_t>(s.codes.size());
+					s.codes.insert(s.codes.end(), scratch.begin(), scratch.end());
+				}
+
+				// Drop stale encodings once they make up half of the codes
+				if (s.stale_words >= MIN_COMPACT_WORDS && 2u * s.stale_words > s.codes.size())
+				{
+					std::vector<uint32_t> codes;
+					codes.reserve(s.codes.size() - s.stale_words);
+
+					for (auto& offset : s.offsets)
+					{
+						if (offset != EMPTY_FRAME)
+						{
+							const auto first = s.codes.begin() + offset;
+							const std::size_t n = frame_code_words(s.codes, offset);
+
+							offset = static_cast<uint32_t>(codes.size());
+							codes.insert(codes.end(), first, first + n);
+						}
+					}
+
+					s.codes = std::move(codes);
+					s.stale_words = 0u;
+				}
+
+				update_tracking();
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t compressed_frame_store::held_bytes() const noexcept
+			{
+				// Frame cache (the index holds at most one node per slot)
+				std::size_t bytes = cache_->words.capacity() * sizeof(uint32_t) +
+					cache_->slots.capacity() * sizeof(frame_cache::slot) +
+					cache_->capacity * (sizeof(std::pair<const uint64_t, uint32_t>) + 2u * sizeof(void*));
+
+				for (const auto& s : slrs_)
+					bytes += (s.codes.capacity() + s.offsets.capacity()) * sizeof(uint32_t);
+
+				return bytes;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void compressed_frame_store::update_tracking() const noexcept
+			{
+				const std::size_t bytes = held_bytes();
+
+				if (bytes > cache_->tracked_bytes)
+					runtime::mem_stats::track(runtime::mem_subsystem::frame_store, bytes - cache_->tracked_bytes);
+				else
+					runtime::mem_stats::untrack(runtime::mem_subsystem::frame_store, cache_->tracked_bytes - bytes);
+
+				cache_->tracked_bytes = bytes;
+			}
+		}
+	}
+}
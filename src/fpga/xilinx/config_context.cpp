@@ -16,7 +16,8 @@ namespace unbit
 			//------------------------------------------------------------------------------------------
 			config_context::config_context(config_engine& engine, uint32_t slr_index)
 				: engine_(engine), slr_index_(slr_index), far_(0), idcode_(std::nullopt), 
-				  write_mode_(wmode::read_only)
+				  write_mode_(wmode::read_only), regs_{}, regs_written_(0u), state_(cstate::synchronized),
+				  started_(false)
 			{
 			}
 
@@ -73,6 +74,34 @@ namespace unbit
 			{
 				write_bitmap_.insert(frame_addr);
 			}
+
+			//------------------------------------------------------------------------------------------
+			void config_context::write_reg(config_reg reg, uint32_t value)
+			{
+				const uint32_t index = static_cast<uint32_t>(reg) % NUM_REGS;
+
+				if (reg == config_reg::CTL0 || reg == config_reg::CTL1)
+				{
+					// MASK-qualified write (only the bits enabled by MASK are changed)
+					const uint32_t mask = this->reg(config_reg::MASK).value_or(0xFFFFFFFFu);
+					value = (regs_[index] & ~mask) | (value & mask);
+				}
+
+				regs_[index]   = value;
+				regs_written_ |= (1u << index);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_context::set_state(cstate new_state)
+			{
+				if (state_ == cstate::startup && new_state == cstate::desynchronized)
+				{
+					// START followed by DESYNC: The device enters the start-up sequence.
+					started_ = true;
+				}
+
+				state_ = new_state;
+			}
 		}
 	}
 }
@@ -0,0 +1,314 @@
+/**
+ * @file
+ * @brief Configuration CRC of Xilinx Series-7 and UltraScale FPGAs.
+ */
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/config_cmd.hpp"
+#include "unbit/fpga/xilinx/stream_engine.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+# include <nmmintrin.h>
+#endif
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				/**
+				 * @brief CRC-32C (Castagnoli) polynomial in reflected form.
+				 */
+				static constexpr uint32_t CRC32C_POLY_REFLECTED = 0x82F63B78u;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Advances a (reflected) CRC by a number of zero-valued input bits.
+				 */
+				static constexpr uint32_t crc_shift_bits(uint32_t crc, unsigned num_bits)
+				{
+					for (unsigned i = 0u; i < num_bits; ++i)
+						crc = (crc >> 1u) ^ ((crc & 1u) ? CRC32C_POLY_REFLECTED : 0u);
+
+					return crc;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Slicing-by-4 lookup tables for the data part of the CRC.
+				 */
+				static constexpr auto CRC_DATA_TABLES = []()
+				{
+					std::array<std::array<uint32_t, 256u>, 4u> tables {};
+
+					for (uint32_t i = 0u; i < 256u; ++i)
+						tables[0u][i] = crc_shift_bits(i, 8u);
+
+					for (uint32_t i = 0u; i < 256u; ++i)
+					{
+						for (std::size_t k = 1u; k < 4u; ++k)
+						{
+							const uint32_t prev = tables[k - 1u][i];
+							tables[k][i] = (prev >> 8u) ^ tables[0u][prev & 0xFFu];
+						}
+					}
+
+					return tables;
+				}();
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Lookup table for the 5-bit register address part of the CRC.
+				 */
+				static constexpr auto CRC_ADDR_TABLE = []()
+				{
+					std::array<uint32_t, 32u> table {};
+
+					for (uint32_t i = 0u; i < 32u; ++i)
+						table[i] = crc_shift_bits(i, 5u);
+
+					return table;
+				}();
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Feeds a 32-bit data word (LSB first) into the CRC.
+				 */
+				static inline uint32_t crc_data_word(uint32_t crc, uint32_t data)
+				{
+#if defined(__SSE4_2__)
+					return _mm_crc32_u32(crc, data);
+#else
+					crc ^= data;
+
+					return CRC_DATA_TABLES[3u][crc & 0xFFu] ^
+						CRC_DATA_TABLES[2u][(crc >> 8u) & 0xFFu] ^
+						CRC_DATA_TABLES[1u][(crc >> 16u) & 0xFFu] ^
+						CRC_DATA_TABLES[0u][crc >> 24u];
+#endif
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Feeds a 5-bit register address (LSB first) into the CRC.
+				 */
+				static inline uint32_t crc_addr_bits(uint32_t crc, uint32_t reg_addr)
+				{
+					return (crc >> 5u) ^ CRC_ADDR_TABLE[(crc ^ reg_addr) & 0x1Fu];
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Multiplies a GF(2) 32x32 matrix (given as column vectors) with a vector.
+				 */
+				static uint32_t gf2_matrix_times(const std::array<uint32_t, 32u>& mat, uint32_t vec)
+				{
+					uint32_t sum = 0u;
+
+					for (std::size_t i = 0u; vec != 0u; ++i, vec >>= 1u)
+					{
+						if (vec & 1u)
+							sum ^= mat[i];
+					}
+
+					return sum;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Squares a GF(2) 32x32 matrix (given as column vectors).
+				 */
+				static std::array<uint32_t, 32u> gf2_matrix_square(const std::array<uint32_t, 32u>& mat)
+				{
+					std::array<uint32_t, 32u> result {};
+
+					for (std::size_t i = 0u; i < 32u; ++i)
+						result[i] = gf2_matrix_times(mat, mat[i]);
+
+					return result;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Compares (and optionally replaces) the CRC checks of an in-memory bitstream (file
+				 *   format).
+				 */
+				class check_scanner : public stream_engine
+				{
+				private:
+					std::span<const uint8_t> data_;
+					uint8_t* out_;
+					std::size_t pos_;
+					std::size_t num_mismatched_;
+
+				public:
+					/**
+					 * @param data is the bitstream data.
+					 * @param out receives the replaced checks (the bitstream data itself, or null to compare only).
+					 */
+					check_scanner(std::span<const uint8_t> data, uint8_t* out)
+						: data_(data), out_(out), pos_(0u), num_mismatched_(0u)
+					{
+					}
+
+					std::size_t num_mismatched() const noexcept
+					{
+						return num_mismatched_;
+					}
+
+				protected:
+					std::size_t read_bytes(uint8_t* dst, std::size_t size) override
+					{
+						const std::size_t n = std::min(size, data_.size() - pos_);
+						std::memcpy(dst, data_.data() + pos_, n);
+
+						pos_ += n;
+						return n;
+					}
+
+					void on_payload(const packet& pkt, uint64_t offset, std::span<const uint32_t> input,
+						std::span<uint32_t> output) override
+					{
+						if (pkt.op != packet_op::write || pkt.reg != config_reg::CRC)
+							return;
+
+						// Compare with (and substitute) the accumulated CRC; the chunk ends at the current
+						// read position
+						const uint32_t crc = current_level().crc.value();
+						std::size_t at = pos_ - output.size() * sizeof(uint32_t);
+
+						for (std::size_t i = 0u; i < output.size(); ++i, at += sizeof(uint32_t))
+						{
+							if (input[i] == crc)
+								continue;
+
+							++num_mismatched_;
+
+							if (out_)
+							{
+								output[i] = crc;
+
+								out_[at]      = static_cast<uint8_t>(crc >> 24u);
+								out_[at + 1u] = static_cast<uint8_t>(crc >> 16u);
+								out_[at + 2u] = static_cast<uint8_t>(crc >> 8u);
+								out_[at + 3u] = static_cast<uint8_t>(crc);
+							}
+						}
+					}
+				};
+			}
+
+			//------------------------------------------------------------------------------------------
+			config_crc::config_crc() noexcept
+				: value_(0u)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			config_crc::config_crc(uint32_t initial) noexcept
+				: value_(initial)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint32_t config_crc::step(uint32_t crc, uint32_t reg_addr, uint32_t data) noexcept
+			{
+				return crc_addr_bits(crc_data_word(crc, data), reg_addr);
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint32_t config_crc::step_bitwise(uint32_t crc, uint32_t reg_addr, uint32_t data) noexcept
+			{
+				// 37-bit input value (data in the lower 32 bits, register address in the upper 5 bits)
+				uint64_t value = (static_cast<uint64_t>(reg_addr & 0x1Fu) << 32u) | data;
+
+				for (unsigned i = 0u; i < 37u; ++i)
+				{
+					const bool feedback = ((crc ^ static_cast<uint32_t>(value)) & 1u) != 0u;
+
+					crc = (crc >> 1u) ^ (feedback ? CRC32C_POLY_REFLECTED : 0u);
+					value >>= 1u;
+				}
+
+				return crc;
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint32_t config_crc::combine(uint32_t crc_a, uint32_t crc_b, uint64_t num_words_b) noexcept
+			{
+				// Operator for a single zero-valued input bit
+				std::array<uint32_t, 32u> op {};
+
+				op[0u] = CRC32C_POLY_REFLECTED;
+				for (std::size_t i = 1u; i < 32u; ++i)
+					op[i] = 1u << (i - 1u);
+
+				// Advance crc_a over (37 * num_words_b) zero bits (square-and-multiply)
+				for (uint64_t num_bits = 37u * num_words_b; num_bits != 0u; num_bits >>= 1u)
+				{
+					if (num_bits & 1u)
+						crc_a = gf2_matrix_times(op, crc_a);
+
+					if (num_bits > 1u)
+						op = gf2_matrix_square(op);
+				}
+
+				return crc_a ^ crc_b;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_crc::update(config_reg reg, std::span<const uint32_t> data) noexcept
+			{
+				const uint32_t reg_addr = static_cast<uint32_t>(reg);
+				uint32_t crc = value_;
+
+				for (const uint32_t w : data)
+					crc = crc_addr_bits(crc_data_word(crc, w), reg_addr);
+
+				value_ = crc;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_crc::process_write(config_reg reg, std::span<const uint32_t> data) noexcept
+			{
+				if (reg == config_reg::CRC)
+				{
+					// CRC checks do not contribute to the CRC
+					return;
+				}
+				else if (reg == config_reg::CMD && !data.empty() && data[0u] == static_cast<uint32_t>(config_cmd::RCRC))
+				{
+					// Reset CRC command
+					reset();
+					return;
+				}
+
+				update(reg, data);
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t config_crc::verify_checks(std::span<const uint8_t> data)
+			{
+				check_scanner scanner(data, nullptr);
+				scanner.process();
+
+				return scanner.num_mismatched();
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t config_crc::update_checks(std::span<uint8_t> data)
+			{
+				check_scanner scanner(data, data.data());
+				scanner.process();
+
+				return scanner.num_mismatched();
+			}
+		}
+	}
+}
@@ -0,0 +1,162 @@
+/**
+ * @file
+ * @brief Single-pass fan-out of configuration events to multiple (lightweight) visitors.
+ */
+#include "unbit/fpga/xilinx/config_dispatcher.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			config_visitor::~config_visitor()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_visitor::on_slr_begin(const config_context& ctx)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_visitor::on_slr_end(const config_context& ctx)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_visitor::on_write(const config_context& ctx, config_reg reg, word_span_type data)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_visitor::on_read(const config_context& ctx, config_reg reg, word_span_type data)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_visitor::on_frame(const config_context& ctx, std::size_t frame_index, word_span_type frame)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			config_dispatcher::config_dispatcher(std::size_t frame_words)
+				: frame_words_(frame_words)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			config_dispatcher::~config_dispatcher()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_dispatcher::add(config_visitor& visitor, const visitor_filter& filter)
+			{
+				if (filter.frames && frame_words_ == 0u)
+					throw std::invalid_argument("frame events require a dispatcher with a known frame size");
+
+				visitors_.push_back(&visitor);
+
+				for (std::size_t i = 0u; i < reg_visitors_.size(); ++i)
+				{
+					if ((filter.regs & (1u << i)) != 0u)
+						reg_visitors_[i].push_back(&visitor);
+				}
+
+				if (filter.frames)
+					frame_visitors_.push_back(&visitor);
+			}
+
+			//------------------------------------------------------------------------------------------
+			config_dispatcher::parser_status_type config_dispatcher::process_packets(word_span_type cfg_data, bool is_synchronized)
+			{
+				frame_counts_.clear();
+				return config_engine::process_packets(cfg_data, is_synchronized);
+			}
+
+			//------------------------------------------------------------------------------------------
+			bool config_dispatcher::on_config_write(config_reg reg, word_span_type data)
+			{
+				const auto& visitors = reg_visitors_[static_cast<uint32_t>(reg) % config_context::NUM_REGS];
+
+				if (!visitors.empty())
+				{
+					const config_context& ctx = get_context();
+
+					for (config_visitor* visitor : visitors)
+						visitor->on_write(ctx, reg, data);
+				}
+
+				return config_engine::on_config_write(reg, data);
+			}
+
+			//------------------------------------------------------------------------------------------
+			bool config_dispatcher::on_config_read(config_reg reg, word_span_type data)
+			{
+				const auto& visitors = reg_visitors_[static_cast<uint32_t>(reg) % config_context::NUM_REGS];
+
+				if (!visitors.empty())
+				{
+					const config_context& ctx = get_context();
+
+					for (config_visitor* visitor : visitors)
+						visitor->on_read(ctx, reg, data);
+				}
+
+				return config_engine::on_config_read(reg, data);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_dispatcher::on_config_fdri(word_span_type data)
+			{
+				config_engine::on_config_fdri(data);
+
+				if (frame_visitors_.empty())
+					return;
+
+				if ((data.size() % frame_words_) != 0u)
+					throw bitstream_error("FDRI payload size is not a multiple of the frame size");
+
+				const config_context& ctx = get_context();
+
+				if (frame_counts_.size() <= ctx.slr_index())
+					frame_counts_.resize(ctx.slr_index() + 1u, 0u);
+
+				std::size_t& frame_index = frame_counts_[ctx.slr_index()];
+
+				for (std::size_t offset = 0u; offset < data.size(); offset += frame_words_, ++frame_index)
+				{
+					const word_span_type frame = data.subspan(offset, frame_words_);
+
+					for (config_visitor* visitor : frame_visitors_)
+						visitor->on_frame(ctx, frame_index, frame);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_dispatcher::on_slr_begin()
+			{
+				config_engine::on_slr_begin();
+
+				const config_context& ctx = get_context();
+				for (config_visitor* visitor : visitors_)
+					visitor->on_slr_begin(ctx);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_dispatcher::on_slr_end()
+			{
+				const config_context& ctx = get_context();
+				for (config_visitor* visitor : visitors_)
+					visitor->on_slr_end(ctx);
+
+				config_engine::on_slr_end();
+			}
+		}
+	}
+}
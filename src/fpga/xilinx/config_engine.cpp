@@ -56,6 +56,7 @@ namespace unbit
 
 			//------------------------------------------------------------------------------------------
 			config_engine::config_engine()
+				: stop_at_desync_(false)
 			{
 			}
 
@@ -86,12 +87,24 @@ namespace unbit
 				context_switch_guard guard(ctx_, create_context(0u));
 
 				// Process the payload data using the base bitstream engine (on the new context)
-				return bitstream_engine::process_packets(cfg_data, false);
+				on_slr_begin();
+				auto [pos, success] = bitstream_engine::process_packets(cfg_data, false);
+				on_slr_end();
+
+				// Stopping at a DESYNC command is a regular end of the configuration stream
+				if (!success && stop_at_desync_ && get_context().state() == config_context::cstate::desynchronized)
+					success = true;
+
+				return parser_status_type(pos, success);
 			}
 
 			//------------------------------------------------------------------------------------------
 			bool config_engine::on_config_write(config_reg reg, word_span_type data)
 			{
+				// Update the shadow register file (FDRI and RSVD30 writes carry payload data)
+				if (!data.empty() && reg != config_reg::FDRI && reg != config_reg::RSVD30)
+					get_context().write_reg(reg, data.back());
+
 				switch (reg)
 				{
 					case config_reg::CMD:
@@ -134,10 +147,18 @@ namespace unbit
 						break;
 
 					default:
-						// Ignored
+						// Ignored (tracked in the shadow register file)
 						break;
 				}
 
+				// Stop at the end of the configuration sequence (if requested)
+				return !(stop_at_desync_ && get_context().state() == config_context::cstate::desynchronized);
+			}
+
+			//------------------------------------------------------------------------------------------
+			bool config_engine::on_config_sync()
+			{
+				get_context().set_state(config_context::cstate::synchronized);
 				return true;
 			}
 
@@ -149,7 +170,19 @@ namespace unbit
 				context_switch_guard guard(ctx_, create_context(next_slr_index));
 
 				// Process the payload data using the base bitstream engine (on the new context)
+				on_slr_begin();
 				bitstream_engine::process_packets(data, false);
+				on_slr_end();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_engine::on_slr_begin()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_engine::on_slr_end()
+			{
 			}
 
 			//------------------------------------------------------------------------------------------
@@ -194,12 +227,34 @@ namespace unbit
 						on_cmd_mfw();
 						break;
 
+					case config_cmd::START:
+						// Begin start-up sequence
+						on_cmd_start();
+						break;
+
+					case config_cmd::DESYNC:
+						// End of the configuration sequence
+						on_cmd_desync();
+						break;
+
 					default:
 						// Ignored
 						break;
 				}
 			}
 
+			//------------------------------------------------------------------------------------------
+			void config_engine::on_cmd_start()
+			{
+				get_context().set_state(config_context::cstate::startup);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void config_engine::on_cmd_desync()
+			{
+				get_context().set_state(config_context::cstate::desynchronized);
+			}
+
 			//------------------------------------------------------------------------------------------
 			void config_engine::on_cmd_nul()
 			{
@@ -0,0 +1,353 @@
+/**
+ * @file
+ * @brief Detail implementation of configuration packet encoding (shared by the bitstream writers).
+ */
+#ifndef UNBIT_XILINX_CONFIG_PACKET_HPP_
+#define UNBIT_XILINX_CONFIG_PACKET_HPP_ 1
+
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/config_cmd.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/config_reg.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace detail
+			{
+				/**
+				 * @brief NOOP packet (type 1).
+				 */
+				static constexpr uint32_t NOOP = 0x20000000u;
+
+				/**
+				 * @brief Maximum payload size of a type 1 packet.
+				 */
+				static constexpr std::size_t TYPE1_MAX_WORDS = 0x7FFu;
+
+				/**
+				 * @brief Maximum payload size of a type 2 packet.
+				 */
+				static constexpr std::size_t TYPE2_MAX_WORDS = 0x07FFFFFFu;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Converts a native word to its in-memory representation in the (big-endian)
+				 *   bitstream file format (and vice versa).
+				 */
+				static inline uint32_t to_file_order(uint32_t w)
+				{
+					if constexpr (std::endian::native == std::endian::little)
+					{
+						return ((w >> 24u) & 0x000000FFu) | ((w >> 8u) & 0x0000FF00u) |
+							((w << 8u) & 0x00FF0000u) | ((w << 24u) & 0xFF000000u);
+					}
+					else
+					{
+						return w;
+					}
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Encodes the packet headers of a register write.
+				 *
+				 * @return The number of header words (1 for type 1 packets, 2 for type 2 packets).
+				 */
+				static inline std::size_t encode_write_header(uint32_t (&hdr)[2u], config_reg reg, std::size_t num_words)
+				{
+					const uint32_t reg_bits = static_cast<uint32_t>(reg) << 13u;
+
+					if (num_words <= TYPE1_MAX_WORDS)
+					{
+						// Type 1 write
+						hdr[0u] = 0x30000000u | reg_bits | static_cast<uint32_t>(num_words);
+						return 1u;
+					}
+					else if (num_words <= TYPE2_MAX_WORDS)
+					{
+						// Type 1 write (zero words), followed by a type 2 write
+						hdr[0u] = 0x30000000u | reg_bits;
+						hdr[1u] = 0x50000000u | static_cast<uint32_t>(num_words);
+						return 2u;
+					}
+					else
+					{
+						throw std::invalid_argument("register write exceeds the maximum packet size");
+					}
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Packet stream writer for the stream of an SLR (or a segment of it).
+				 *
+				 * Passes the emitted words (native order) to the sink and tracks the configuration CRC
+				 * of the SLR, as well as the CRC of the emitted words as nested payload (register 30)
+				 * of the enclosing SLR. A segment continues the stream of the preceding segment if it
+				 * is constructed with the CRCs and word count of that segment.
+				 *
+				 * @tparam Sink receives the words (@c put) and skipped payloads of dry runs (@c skip).
+				 */
+				template<typename Sink>
+				class packet_writer
+				{
+				private:
+					Sink sink_;
+					config_crc crc_;
+					config_crc nested_crc_;
+					bool track_nested_;
+					uint64_t words_;
+
+				public:
+					packet_writer(Sink sink, uint32_t crc, bool track_nested, uint32_t nested_crc = 0u, uint64_t words = 0u)
+						: sink_(sink), crc_(crc), nested_crc_(nested_crc), track_nested_(track_nested), words_(words)
+					{
+					}
+
+					void raw(std::span<const uint32_t> words)
+					{
+						sink_.put(words);
+						words_ += words.size();
+
+						if (track_nested_)
+							nested_crc_.update(config_reg::RSVD30, words);
+					}
+
+					void raw(uint32_t w)
+					{
+						raw(std::span<const uint32_t>(&w, 1u));
+					}
+
+					void begin_write(config_reg reg, std::size_t num_words)
+					{
+						uint32_t hdr[2u];
+						const std::size_t num_hdr = encode_write_header(hdr, reg, num_words);
+
+						raw(std::span<const uint32_t>(hdr, num_hdr));
+					}
+
+					void payload(config_reg reg, std::span<const uint32_t> data)
+					{
+						raw(data);
+						crc_.process_write(reg, data);
+					}
+
+					void skip_payload(uint64_t num_words)
+					{
+						// Dry run only (the CRCs are not tracked)
+						sink_.skip(num_words);
+						words_ += num_words;
+					}
+
+					void write(config_reg reg, std::span<const uint32_t> data)
+					{
+						begin_write(reg, data.size());
+						payload(reg, data);
+					}
+
+					void write(config_reg reg, uint32_t value)
+					{
+						write(reg, std::span<const uint32_t>(&value, 1u));
+					}
+
+					void command(config_cmd cmd)
+					{
+						write(config_reg::CMD, static_cast<uint32_t>(cmd));
+					}
+
+					void nest(uint32_t nested_crc, uint64_t nested_words)
+					{
+						// The nested stream has been emitted as payload of this SLR's register 30 write
+						crc_ = config_crc(config_crc::combine(crc_.value(), nested_crc, nested_words));
+						nested_crc_ = config_crc(config_crc::combine(nested_crc_.value(), nested_crc, nested_words));
+						words_ += nested_words;
+					}
+
+					uint32_t crc() const
+					{
+						return crc_.value();
+					}
+
+					uint32_t nested_crc() const
+					{
+						return nested_crc_.value();
+					}
+
+					uint64_t words() const
+					{
+						return words_;
+					}
+				};
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Sink appending words to an in-memory segment (in file order).
+				 */
+				class segment_sink
+				{
+				private:
+					std::vector<uint32_t>* out_;
+
+				public:
+					segment_sink(std::vector<uint32_t>& out) noexcept
+						: out_(&out)
+					{
+					}
+
+					void put(std::span<const uint32_t> words)
+					{
+						const std::size_t pos = out_->size();
+
+						out_->resize(pos + words.size());
+						std::transform(words.begin(), words.end(), out_->begin() + pos, to_file_order);
+					}
+				};
+
+				/**
+				 * @brief Packet stream writer for an in-memory segment.
+				 */
+				using segment_writer = packet_writer<segment_sink>;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Encoded segments of the stream of an SLR.
+				 *
+				 * The stream of an SLR consists of its head, the link (the header of the register 30
+				 * write carrying the streams of all following SLRs), the nested streams and its tail.
+				 */
+				struct slr_segments
+				{
+					/** @brief Sync, header and frame data packets (big-endian). */
+					std::vector<uint32_t> head;
+
+					/** @brief Packet header of the nested write of the next SLR (big-endian). */
+					std::vector<uint32_t> link;
+
+					/** @brief Trailer, CRC check and DESYNC packets (big-endian). */
+					std::vector<uint32_t> tail;
+
+					/** @brief Configuration CRC at the end of the head segment. */
+					uint32_t head_crc = 0u;
+
+					/** @brief CRC of the head segment as nested payload (register 30, from zero). */
+					uint32_t head_nested_crc = 0u;
+
+					/** @brief CRC of the complete stream of this SLR as nested payload. */
+					uint32_t nested_crc = 0u;
+
+					/** @brief Number of words of the complete stream of this SLR (incl. nested SLRs). */
+					uint64_t stream_words = 0u;
+				};
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Emits the dummy words, bus width detection and sync words, and resets the CRC.
+				 */
+				template<typename Writer>
+				void write_stream_header(Writer& w)
+				{
+					for (unsigned i = 0u; i < 8u; ++i)
+						w.raw(0xFFFFFFFFu);
+
+					w.raw(0x000000BBu);
+					w.raw(0x11220044u);
+					w.raw(0xFFFFFFFFu);
+					w.raw(0xFFFFFFFFu);
+					w.raw(bitstream_engine::FPGA_SYNC_WORD_LE);
+					w.raw(NOOP);
+
+					w.command(config_cmd::RCRC);
+					w.raw(NOOP);
+					w.raw(NOOP);
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Emits the (optional) CRC check and the DESYNC sequence.
+				 */
+				template<typename Writer>
+				void write_stream_end(Writer& w, bool with_crc)
+				{
+					if (with_crc)
+						w.write(config_reg::CRC, w.crc());
+
+					w.raw(NOOP);
+					w.raw(NOOP);
+					w.command(config_cmd::DESYNC);
+
+					for (unsigned i = 0u; i < 16u; ++i)
+						w.raw(NOOP);
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Starts an FDRI write sequence at a given frame address.
+				 */
+				template<typename Writer>
+				void begin_fdri(Writer& w, uint32_t far)
+				{
+					w.command(config_cmd::NUL);
+					w.write(config_reg::FAR, far);
+					w.command(config_cmd::WCFG);
+					w.raw(NOOP);
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Links the encoded head segments of the SLRs into a nested stream.
+				 *
+				 * Links from the innermost SLR outwards (the nested write headers and CRCs depend on the
+				 * complete streams of all following SLRs): emits the link and tail segments, and
+				 * computes the nested CRC and stream size of each SLR.
+				 *
+				 * @param slrs are the SLR segments (with the encoded heads and their CRCs).
+				 * @param with_crc specifies if a CRC check is emitted before the DESYNC sequence.
+				 * @param trailer emits the trailer register writes of an SLR (index, writer).
+				 */
+				template<typename Segments, typename Trailer>
+				void link_segments(std::span<Segments> slrs, bool with_crc, Trailer&& trailer)
+				{
+					for (std::size_t k = slrs.size(); k-- > 0u; )
+					{
+						Segments& s = slrs[k];
+
+						s.link.clear();
+						s.tail.clear();
+
+						segment_writer lw(s.link, s.head_crc, k > 0u, s.head_nested_crc, s.head.size());
+
+						if (k + 1u < slrs.size())
+						{
+							// The nested stream is payload of this SLR's register 30 write
+							const Segments& next = slrs[k + 1u];
+
+							lw.begin_write(config_reg::RSVD30, next.stream_words);
+							lw.nest(next.nested_crc, next.stream_words);
+						}
+
+						segment_writer tw(s.tail, lw.crc(), k > 0u, lw.nested_crc(), lw.words());
+
+						trailer(k, tw);
+						write_stream_end(tw, with_crc);
+
+						s.nested_crc = tw.nested_crc();
+						s.stream_words = tw.words();
+					}
+				}
+			}
+		}
+	}
+}
+
+#endif // UNBIT_XILINX_CONFIG_PACKET_HPP_
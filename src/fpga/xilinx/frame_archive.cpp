@@ -0,0 +1,611 @@
+/**
+ * @file
+ * @brief Content-addressable archive of configuration frames (deduplicated across builds).
+ */
+#include "unbit/fpga/xilinx/frame_archive.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/runtime/byte_io.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				using runtime::detail::put_le;
+
+				/**
+				 * @brief Reader for manifests and index entries.
+				 */
+				using archive_reader = runtime::detail::le_reader<bitstream_error>;
+
+				/**
+				 * @brief Magic number (and version) of the pack file.
+				 */
+				static constexpr char PACK_MAGIC[8u] = { 'U', 'N', 'B', 'F', 'P', 'K', '0', '1' };
+
+				/**
+				 * @brief Magic number (and version) of the index file.
+				 */
+				static constexpr char INDEX_MAGIC[8u] = { 'U', 'N', 'B', 'F', 'I', 'X', '0', '1' };
+
+				/**
+				 * @brief Magic number (and version) of manifest files.
+				 */
+				static constexpr char MANIFEST_MAGIC[8u] = { 'U', 'N', 'B', 'F', 'M', 'F', '0', '1' };
+
+				/**
+				 * @brief Size of an index entry (digest, 64-bit offset, 32-bit size).
+				 */
+				static constexpr std::size_t INDEX_ENTRY_SIZE = runtime::sha256::DIGEST_SIZE + 8u + 4u;
+
+				/**
+				 * @brief File name suffix of manifests.
+				 */
+				static const std::string MANIFEST_SUFFIX = ".manifest";
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Reads a complete file into memory.
+				 */
+				static std::vector<uint8_t> read_file(const std::filesystem::path& path)
+				{
+					std::ifstream stm(path, std::ios_base::in | std::ios_base::binary);
+					if (!stm)
+						throw std::ios_base::failure("unable to open archive file '" + path.string() + "'");
+
+					std::vector<uint8_t> data((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+
+					if (stm.bad())
+						throw std::ios_base::failure("i/o error while reading archive file '" + path.string() + "'");
+
+					return data;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Appends data to a file (and flushes it).
+				 */
+				static void append_file(const std::filesystem::path& path, std::span<const uint8_t> data)
+				{
+					std::ofstream stm(path, std::ios_base::out | std::ios_base::binary | std::ios_base::app);
+					stm.write(reinterpret_cast<const char*>(data.data()), data.size());
+					stm.flush();
+
+					if (stm.fail())
+						throw std::ios_base::failure("i/o error while writing archive file '" + path.string() + "'");
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Creates a file with the given contents (if it does not exist yet).
+				 */
+				static void create_file(const std::filesystem::path& path, std::span<const char> contents)
+				{
+					if (std::filesystem::exists(path))
+						return;
+
+					std::ofstream stm(path, std::ios_base::out | std::ios_base::binary);
+					stm.write(contents.data(), contents.size());
+
+					if (stm.fail())
+						throw std::ios_base::failure("unable to create archive file '" + path.string() + "'");
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Checks the magic number at the start of a file.
+				 */
+				static void check_magic(std::span<const uint8_t> data, const char (&magic)[8u], const std::filesystem::path& path)
+				{
+					if (data.size() < sizeof(magic) || std::memcmp(data.data(), magic, sizeof(magic)) != 0)
+						throw bitstream_error("corrupt frame archive: bad header of '" + path.string() + "'");
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Encodes a manifest.
+				 */
+				static std::vector<uint8_t> encode_manifest(const archive_manifest& manifest)
+				{
+					std::vector<uint8_t> out(std::begin(MANIFEST_MAGIC), std::end(MANIFEST_MAGIC));
+
+					put_le<uint32_t>(out, static_cast<uint32_t>(manifest.frame_words));
+					put_le<uint32_t>(out, static_cast<uint32_t>(manifest.slrs.size()));
+
+					for (const auto& slr : manifest.slrs)
+					{
+						put_le<uint32_t>(out, slr.idcode ? 1u : 0u);
+						put_le<uint32_t>(out, slr.idcode.value_or(0u));
+						put_le<uint64_t>(out, slr.frames.size());
+						put_le<uint64_t>(out, slr.frame_addresses.size());
+
+						for (const uint32_t far : slr.frame_addresses)
+							put_le<uint32_t>(out, far);
+
+						for (const auto& hash : slr.frames)
+							out.insert(out.end(), hash.begin(), hash.end());
+					}
+
+					return out;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Decodes a manifest.
+				 */
+				static archive_manifest decode_manifest(std::span<const uint8_t> data, const std::filesystem::path& path)
+				{
+					check_magic(data, MANIFEST_MAGIC, path);
+
+					archive_reader in(data.subspan(sizeof(MANIFEST_MAGIC)), "corrupt frame archive: truncated manifest");
+					archive_manifest manifest;
+
+					manifest.frame_words = in.get<uint32_t>();
+					const uint32_t num_slrs = in.get<uint32_t>();
+
+					if (manifest.frame_words == 0u)
+						throw bitstream_error("corrupt frame archive: bad frame size in '" + path.string() + "'");
+
+					for (uint32_t i = 0u; i < num_slrs; ++i)
+					{
+						auto& slr = manifest.slrs.emplace_back();
+
+						const uint32_t flags = in.get<uint32_t>();
+						const uint32_t idcode = in.get<uint32_t>();
+						if (flags & 1u)
+							slr.idcode = idcode;
+
+						const uint64_t num_frames = in.get<uint64_t>();
+						const uint64_t num_fars = in.get<uint64_t>();
+
+						if (num_frames > data.size() || (num_fars != 0u && num_fars != num_frames))
+							throw bitstream_error("corrupt frame archive: bad frame address map in '" + path.string() + "'");
+
+						const auto far_bytes = in.bytes(num_fars * 4u);
+						slr.frame_addresses.resize(num_fars);
+
+						for (std::size_t f = 0u; f < num_fars; ++f)
+						{
+							slr.frame_addresses[f] = static_cast<uint32_t>(far_bytes[4u * f]) |
+								(static_cast<uint32_t>(far_bytes[4u * f + 1u]) << 8u) |
+								(static_cast<uint32_t>(far_bytes[4u * f + 2u]) << 16u) |
+								(static_cast<uint32_t>(far_bytes[4u * f + 3u]) << 24u);
+						}
+
+						const auto hash_bytes = in.bytes(num_frames * runtime::sha256::DIGEST_SIZE);
+						slr.frames.resize(num_frames);
+
+						for (std::size_t f = 0u; f < num_frames; ++f)
+						{
+							std::memcpy(slr.frames[f].data(), hash_bytes.data() + f * runtime::sha256::DIGEST_SIZE,
+								runtime::sha256::DIGEST_SIZE);
+						}
+					}
+
+					if (!in.at_end())
+						throw bitstream_error("corrupt frame archive: trailing data in '" + path.string() + "'");
+
+					return manifest;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_archive::frame_archive(const std::string& directory)
+				: root_(directory), pack_size_(0u)
+			{
+				std::filesystem::create_directories(root_ / "builds");
+
+				create_file(root_ / "frames.pack", PACK_MAGIC);
+				create_file(root_ / "frames.idx", INDEX_MAGIC);
+
+				load_index();
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_archive::~frame_archive()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_archive::load_index()
+			{
+				const auto pack_path = root_ / "frames.pack";
+				const auto index_path = root_ / "frames.idx";
+
+				{
+					std::ifstream pack(pack_path, std::ios_base::in | std::ios_base::binary);
+					char magic[sizeof(PACK_MAGIC)];
+
+					pack.read(magic, sizeof(magic));
+					if (!pack || std::memcmp(magic, PACK_MAGIC, sizeof(magic)) != 0)
+						throw bitstream_error("corrupt frame archive: bad header of '" + pack_path.string() + "'");
+				}
+
+				pack_size_ = std::filesystem::file_size(pack_path);
+
+				const auto data = read_file(index_path);
+				check_magic(data, INDEX_MAGIC, index_path);
+
+				index_.clear();
+
+				// Entries of an interrupted append (partial entries, or entries beyond the end of the
+				// pack file) are ignored
+				const std::size_t num_entries = (data.size() - sizeof(INDEX_MAGIC)) / INDEX_ENTRY_SIZE;
+				index_.reserve(num_entries);
+
+				for (std::size_t i = 0u; i < num_entries; ++i)
+				{
+					archive_reader in(std::span<const uint8_t>(data).subspan(sizeof(INDEX_MAGIC) + i * INDEX_ENTRY_SIZE, INDEX_ENTRY_SIZE),
+						"corrupt frame archive: truncated index");
+
+					frame_hash hash;
+					const auto hash_bytes = in.bytes(hash.size());
+					std::copy(hash_bytes.begin(), hash_bytes.end(), hash.begin());
+
+					frame_location loc;
+					loc.offset    = in.get<uint64_t>();
+					loc.num_words = in.get<uint32_t>();
+
+					if (loc.offset < sizeof(PACK_MAGIC) || loc.offset + loc.num_words * 4u > pack_size_)
+						continue;
+
+					index_.emplace(hash, loc);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::filesystem::path frame_archive::manifest_path(const std::string& build) const
+			{
+				const bool valid = !build.empty() && build.front() != '.' &&
+					std::all_of(build.begin(), build.end(), [](char c)
+					{
+						return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+							c == '.' || c == '_' || c == '+' || c == '-';
+					});
+
+				if (!valid)
+					throw std::invalid_argument("invalid build name '" + build + "'");
+
+				return root_ / "builds" / (build + MANIFEST_SUFFIX);
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t frame_archive::add(const std::string& build, const frame_store& frames,
+				std::span<const std::vector<uint32_t>> frame_addresses)
+			{
+				const auto path = manifest_path(build);
+
+				if (std::filesystem::exists(path))
+					throw std::invalid_argument("build '" + build + "' already exists in the archive");
+
+				if (!frame_addresses.empty() && frame_addresses.size() != frames.num_slrs())
+					throw std::invalid_argument("frame address maps do not match the number of slrs");
+
+				const std::size_t frame_words = frames.frame_words();
+
+				archive_manifest manifest;
+				manifest.frame_words = frame_words;
+
+				// Split the frames, and collect the new ones (in linear frame order)
+				std::vector<uint8_t> pack_data;
+				std::vector<uint8_t> index_data;
+				std::unordered_map<frame_hash, frame_location, runtime::sha256_digest_hash> added;
+
+				for (std::size_t k = 0u; k < frames.num_slrs(); ++k)
+				{
+					auto& slr = manifest.slrs.emplace_back();
+					slr.idcode = frames.idcode(k);
+
+					if (!frame_addresses.empty() && !frame_addresses[k].empty())
+					{
+						if (frame_addresses[k].size() != frames.num_frames(k))
+							throw std::invalid_argument("frame address map does not match the number of frames of the slr");
+
+						slr.frame_addresses = frame_addresses[k];
+					}
+
+					slr.frames.reserve(frames.num_frames(k));
+
+					for (std::size_t f = 0u; f < frames.num_frames(k); ++f)
+					{
+						const auto frame = frames.frame(k, f);
+						const frame_hash hash = runtime::sha256::hash_be(frame);
+
+						slr.frames.push_back(hash);
+
+						if (index_.count(hash) != 0u || added.count(hash) != 0u)
+							continue;
+
+						const frame_location loc { pack_size_ + pack_data.size(), static_cast<uint32_t>(frame_words) };
+
+						// Frames are stored in bitstream file order (big-endian)
+						for (const uint32_t w : frame)
+						{
+							pack_data.push_back(static_cast<uint8_t>(w >> 24u));
+							pack_data.push_back(static_cast<uint8_t>(w >> 16u));
+							pack_data.push_back(static_cast<uint8_t>(w >> 8u));
+							pack_data.push_back(static_cast<uint8_t>(w));
+						}
+
+						index_data.insert(index_data.end(), hash.begin(), hash.end());
+						put_le<uint64_t>(index_data, loc.offset);
+						put_le<uint32_t>(index_data, loc.num_words);
+
+						added.emplace(hash, loc);
+					}
+				}
+
+				// Pack first, then the index, then the manifest (atomically)
+				if (!pack_data.empty())
+				{
+					// Discard unreferenced data of an interrupted append
+					if (std::filesystem::file_size(root_ / "frames.pack") != pack_size_)
+						std::filesystem::resize_file(root_ / "frames.pack", pack_size_);
+
+					append_file(root_ / "frames.pack", pack_data);
+					append_file(root_ / "frames.idx", index_data);
+				}
+
+				runtime::detail::replace_file(path, encode_manifest(manifest), "manifest");
+
+				pack_size_ += pack_data.size();
+				index_.merge(added);
+
+				return index_data.size() / INDEX_ENTRY_SIZE;
+			}
+
+			//------------------------------------------------------------------------------------------
+			bool frame_archive::contains(const std::string& build) const
+			{
+				return std::filesystem::exists(manifest_path(build));
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::vector<std::string> frame_archive::builds() const
+			{
+				std::vector<std::string> result;
+
+				for (const auto& entry : std::filesystem::directory_iterator(root_ / "builds"))
+				{
+					const std::string name = entry.path().filename().string();
+
+					if (entry.is_regular_file() && name.size() > MANIFEST_SUFFIX.size() &&
+						name.compare(name.size() - MANIFEST_SUFFIX.size(), MANIFEST_SUFFIX.size(), MANIFEST_SUFFIX) == 0)
+					{
+						result.push_back(name.substr(0u, name.size() - MANIFEST_SUFFIX.size()));
+					}
+				}
+
+				std::sort(result.begin(), result.end());
+				return result;
+			}
+
+			//------------------------------------------------------------------------------------------
+			archive_manifest frame_archive::manifest(const std::string& build) const
+			{
+				const auto path = manifest_path(build);
+
+				if (!std::filesystem::exists(path))
+					throw std::out_of_range("build '" + build + "' does not exist in the archive");
+
+				return decode_manifest(read_file(path), path);
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_merkle frame_archive::merkle(const std::string& build) const
+			{
+				return frame_merkle(manifest(build));
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::vector<uint32_t> frame_archive::read_frames(std::span<const frame_hash> hashes, std::size_t frame_words) const
+			{
+				// Resolve the frames, and read them in pack order
+				std::vector<std::pair<uint64_t, std::size_t>> refs;
+				refs.reserve(hashes.size());
+
+				for (std::size_t i = 0u; i < hashes.size(); ++i)
+				{
+					const auto it = index_.find(hashes[i]);
+
+					if (it == index_.end())
+						throw std::out_of_range("frame " + runtime::sha256::to_hex(hashes[i]) + " does not exist in the archive");
+
+					if (it->second.num_words != frame_words)
+						throw std::invalid_argument("frame size mismatch of frame " + runtime::sha256::to_hex(hashes[i]));
+
+					refs.emplace_back(it->second.offset, i);
+				}
+
+				std::sort(refs.begin(), refs.end());
+
+				std::ifstream pack(root_ / "frames.pack", std::ios_base::in | std::ios_base::binary);
+				if (!pack)
+					throw std::ios_base::failure("unable to open archive file '" + (root_ / "frames.pack").string() + "'");
+
+				const std::size_t frame_bytes = frame_words * sizeof(uint32_t);
+				std::vector<uint32_t> result(hashes.size() * frame_words);
+				std::vector<uint8_t> buffer(frame_bytes);
+				uint64_t pos = 0u;
+
+				for (const auto& [offset, i] : refs)
+				{
+					if (offset != pos)
+						pack.seekg(static_cast<std::streamoff>(offset), std::ios_base::beg);
+
+					pack.read(reinterpret_cast<char*>(buffer.data()), frame_bytes);
+
+					if (pack.fail())
+						throw std::ios_base::failure("i/o error while reading frame pack");
+
+					pos = offset + frame_bytes;
+
+					uint32_t* const frame = result.data() + i * frame_words;
+					for (std::size_t j = 0u; j < frame_words; ++j)
+					{
+						frame[j] = (static_cast<uint32_t>(buffer[4u * j]) << 24u) | (static_cast<uint32_t>(buffer[4u * j + 1u]) << 16u) |
+							(static_cast<uint32_t>(buffer[4u * j + 2u]) << 8u) | static_cast<uint32_t>(buffer[4u * j + 3u]);
+					}
+				}
+
+				return result;
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_store frame_archive::load(const std::string& build, const frame_alloc_policy& policy) const
+			{
+				const archive_manifest m = manifest(build);
+
+				std::vector<std::size_t> frames_per_slr;
+				for (const auto& slr : m.slrs)
+					frames_per_slr.push_back(slr.frames.size());
+
+				frame_store result(m.frame_words, frames_per_slr, policy);
+
+				// Resolve the frames, and read them in pack order
+				struct frame_ref
+				{
+					uint64_t offset;
+					std::size_t slr;
+					std::size_t frame;
+				};
+
+				std::vector<frame_ref> refs;
+
+				for (std::size_t k = 0u; k < m.slrs.size(); ++k)
+				{
+					if (m.slrs[k].idcode)
+						result.set_idcode(k, *m.slrs[k].idcode);
+
+					for (std::size_t f = 0u; f < m.slrs[k].frames.size(); ++f)
+					{
+						const auto it = index_.find(m.slrs[k].frames[f]);
+
+						if (it == index_.end())
+							throw bitstream_error("corrupt frame archive: missing frame of build '" + build + "'");
+
+						if (it->second.num_words != m.frame_words)
+							throw bitstream_error("corrupt frame archive: frame size mismatch in build '" + build + "'");
+
+						refs.push_back(frame_ref { it->second.offset, k, f });
+					}
+				}
+
+				std::sort(refs.begin(), refs.end(), [](const frame_ref& a, const frame_ref& b)
+				{
+					return a.offset < b.offset;
+				});
+
+				std::vector<char> stream_buffer(1024u * 1024u);
+				std::ifstream pack;
+				pack.rdbuf()->pubsetbuf(stream_buffer.data(), stream_buffer.size());
+				pack.open(root_ / "frames.pack", std::ios_base::in | std::ios_base::binary);
+
+				if (!pack)
+					throw std::ios_base::failure("unable to open archive file '" + (root_ / "frames.pack").string() + "'");
+
+				const std::size_t frame_bytes = m.frame_words * sizeof(uint32_t);
+				std::vector<uint8_t> buffer(frame_bytes);
+				uint64_t pos = 0u;
+				uint64_t loaded = ~uint64_t(0u);
+
+				for (const auto& ref : refs)
+				{
+					if (ref.offset != loaded)
+					{
+						if (ref.offset != pos)
+							pack.seekg(static_cast<std::streamoff>(ref.offset), std::ios_base::beg);
+
+						pack.read(reinterpret_cast<char*>(buffer.data()), frame_bytes);
+
+						if (pack.fail())
+							throw std::ios_base::failure("i/o error while reading frame pack");
+
+						pos = ref.offset + frame_bytes;
+						loaded = ref.offset;
+					}
+
+					auto frame = result.frame(ref.slr, ref.frame);
+
+					for (std::size_t i = 0u; i < frame.size(); ++i)
+					{
+						frame[i] = (static_cast<uint32_t>(buffer[4u * i]) << 24u) | (static_cast<uint32_t>(buffer[4u * i + 1u]) << 16u) |
+							(static_cast<uint32_t>(buffer[4u * i + 2u]) << 8u) | static_cast<uint32_t>(buffer[4u * i + 3u]);
+					}
+				}
+
+				return result;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_archive::configure(bitstream_serializer& serializer, const archive_manifest& manifest)
+			{
+				for (std::size_t k = 0u; k < manifest.slrs.size(); ++k)
+					serializer.config(k).frame_addresses = manifest.slrs[k].frame_addresses;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_archive::reconstruct(const std::string& build, std::ostream& os, const serializer_options& opts) const
+			{
+				const archive_manifest m = manifest(build);
+				const frame_store frames = load(build);
+
+				bitstream_serializer serializer(frames, opts);
+				configure(serializer, m);
+
+				serializer.encode();
+				serializer.write(os);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_archive::reconstruct(const std::string& build, const std::string& filename, const serializer_options& opts) const
+			{
+				const archive_manifest m = manifest(build);
+				const frame_store frames = load(build);
+
+				bitstream_serializer serializer(frames, opts);
+				configure(serializer, m);
+
+				serializer.encode();
+				serializer.write(filename);
+			}
+
+			//------------------------------------------------------------------------------------------
+			archive_stats frame_archive::stats() const
+			{
+				archive_stats result;
+
+				result.num_unique_frames = index_.size();
+				result.pack_bytes = pack_size_;
+				result.metadata_bytes = std::filesystem::file_size(root_ / "frames.idx");
+
+				for (const auto& build : builds())
+				{
+					const auto path = manifest_path(build);
+					const archive_manifest m = decode_manifest(read_file(path), path);
+
+					result.num_builds += 1u;
+					result.metadata_bytes += std::filesystem::file_size(path);
+
+					for (const auto& slr : m.slrs)
+					{
+						result.num_frame_refs += slr.frames.size();
+						result.logical_bytes += slr.frames.size() * m.frame_words * sizeof(uint32_t);
+					}
+				}
+
+				return result;
+			}
+		}
+	}
+}
@@ -0,0 +1,213 @@
+/**
+ * @file
+ * @brief Page-aligned backing storage for materialized configuration frames.
+ */
+#include "unbit/fpga/xilinx/frame_buffer.hpp"
+#include "unbit/runtime/mem_stats.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if defined(__linux__)
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Rounds a size up to the next multiple of a (power of two) granule.
+				 */
+				static std::size_t round_up(std::size_t value, std::size_t granule)
+				{
+					return (value + granule - 1u) & ~(granule - 1u);
+				}
+
+#if defined(__linux__)
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Maps anonymous memory (returns nullptr on failure).
+				 */
+				static void* map_anonymous(std::size_t num_bytes, int extra_flags)
+				{
+					void* mem = ::mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+
+					return (mem != MAP_FAILED) ? mem : nullptr;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Maps anonymous memory that is aligned to the huge page size.
+				 *
+				 * The mapping is over-allocated by one huge page, followed by trimming of the
+				 * unaligned head and tail portions.
+				 */
+				static void* map_huge_aligned(std::size_t num_bytes)
+				{
+					const std::size_t align = frame_buffer::HUGE_PAGE_SIZE;
+
+					auto* raw = static_cast<uint8_t*>(map_anonymous(num_bytes + align, 0));
+					if (!raw)
+						return nullptr;
+
+					const auto raw_addr = reinterpret_cast<std::uintptr_t>(raw);
+					const std::size_t head = round_up(raw_addr, align) - raw_addr;
+					const std::size_t tail = align - head;
+
+					if (head > 0u)
+						::munmap(raw, head);
+
+					if (tail > 0u)
+						::munmap(raw + head + num_bytes, tail);
+
+					return raw + head;
+				}
+#endif
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_buffer::frame_buffer() noexcept
+				: data_(nullptr), num_words_(0u), reserved_bytes_(0u), mode_(page_mode::standard)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_buffer::frame_buffer(std::size_t num_words, page_mode mode)
+				: frame_buffer()
+			{
+				if (num_words == 0u)
+					return;
+
+				if (num_words > (SIZE_MAX - HUGE_PAGE_SIZE) / sizeof(uint32_t))
+					throw std::bad_alloc();
+
+				const std::size_t num_bytes = num_words * sizeof(uint32_t);
+
+#if defined(__linux__)
+				void* mem = nullptr;
+				std::size_t reserved = 0u;
+				page_mode effective = mode;
+
+# if defined(MAP_HUGETLB)
+				if (effective == page_mode::explicit_huge)
+				{
+					// Explicit huge pages (fails if the huge page reservation is exhausted)
+					reserved = round_up(num_bytes, HUGE_PAGE_SIZE);
+					mem = map_anonymous(reserved, MAP_HUGETLB);
+				}
+# endif
+
+				if (!mem && effective != page_mode::standard)
+				{
+					// Transparent huge pages (also used as fallback for explicit huge pages)
+					effective = page_mode::transparent_huge;
+					reserved = round_up(num_bytes, HUGE_PAGE_SIZE);
+					mem = map_huge_aligned(reserved);
+
+# if defined(MADV_HUGEPAGE)
+					if (mem && ::madvise(mem, reserved, MADV_HUGEPAGE) != 0)
+					{
+						// Kernel without THP support (the mapping is still usable)
+						effective = page_mode::standard;
+					}
+# else
+					effective = page_mode::standard;
+# endif
+				}
+
+				if (!mem)
+				{
+					// Regular pages
+					effective = page_mode::standard;
+					reserved = round_up(num_bytes, static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)));
+					mem = map_anonymous(reserved, 0);
+				}
+
+				if (!mem)
+					throw std::bad_alloc();
+
+				// Anonymous mappings are zero-filled (on first touch)
+				data_           = static_cast<uint32_t*>(mem);
+				reserved_bytes_ = reserved;
+				mode_           = effective;
+#else
+				// Portable fallback: Aligned allocation with regular pages (huge page requests are
+				// silently degraded)
+				static_cast<void>(mode);
+
+				const std::size_t reserved = round_up(num_bytes, 4096u);
+				void* mem = ::operator new(reserved, std::align_val_t(4096u));
+				std::memset(mem, 0, reserved);
+
+				data_           = static_cast<uint32_t*>(mem);
+				reserved_bytes_ = reserved;
+				mode_           = page_mode::standard;
+#endif
+
+				num_words_ = num_words;
+
+				runtime::mem_stats::track(runtime::mem_subsystem::frame_store, reserved_bytes_);
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_buffer::frame_buffer(frame_buffer&& other) noexcept
+				: data_(std::exchange(other.data_, nullptr)),
+				  num_words_(std::exchange(other.num_words_, 0u)),
+				  reserved_bytes_(std::exchange(other.reserved_bytes_, 0u)),
+				  mode_(other.mode_)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_buffer& frame_buffer::operator=(frame_buffer&& other) noexcept
+			{
+				if (this != &other)
+				{
+					release();
+
+					data_           = std::exchange(other.data_, nullptr);
+					num_words_      = std::exchange(other.num_words_, 0u);
+					reserved_bytes_ = std::exchange(other.reserved_bytes_, 0u);
+					mode_           = other.mode_;
+				}
+
+				return *this;
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_buffer::~frame_buffer()
+			{
+				release();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_buffer::release() noexcept
+			{
+				if (data_)
+				{
+					runtime::mem_stats::untrack(runtime::mem_subsystem::frame_store, reserved_bytes_);
+
+#if defined(__linux__)
+					::munmap(data_, reserved_bytes_);
+#else
+					::operator delete(data_, std::align_val_t(4096u));
+#endif
+				}
+
+				data_           = nullptr;
+				num_words_      = 0u;
+				reserved_bytes_ = 0u;
+			}
+		}
+	}
+}
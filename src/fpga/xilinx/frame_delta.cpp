@@ -0,0 +1,895 @@
+/**
+ * @file
+ * @brief Frame-level delta patches between configuration bitstreams (OTA updates).
+ */
+#include "unbit/fpga/xilinx/frame_delta.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/stream_engine.hpp"
+#include "unbit/runtime/executor.hpp"
+#include "unbit/runtime/mem_stats.hpp"
+
+#include "config_packet.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				using detail::to_file_order;
+
+				/**
+				 * @brief Magic number (and version) of delta files (as little-endian words).
+				 */
+				static constexpr uint32_t DELTA_MAGIC[2u] =
+				{
+					0x46424E55u, // "UNBF"
+					0x31304C44u  // "DL01"
+				};
+
+				/**
+				 * @brief Number of header words per SLR (frames, records and section size).
+				 */
+				static constexpr std::size_t SLR_HEADER_WORDS = 3u;
+
+				/**
+				 * @brief Number of words of a digest.
+				 */
+				static constexpr std::size_t DIGEST_WORDS = runtime::sha256::DIGEST_SIZE / 4u;
+
+				/**
+				 * @brief Number of header words per record.
+				 */
+				static constexpr std::size_t RECORD_HEADER_WORDS = 4u;
+
+				/**
+				 * @brief Maximum number of zero (or literal) words per token.
+				 */
+				static constexpr std::size_t MAX_TOKEN_WORDS = 0xFFFFu;
+
+				/**
+				 * @brief Size of the I/O buffers (in bytes, kept small for embedded targets).
+				 */
+				static constexpr std::size_t IO_CHUNK_BYTES = 64u * 1024u;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Converts a native word to its little-endian representation (and vice versa).
+				 */
+				static inline uint32_t to_le(uint32_t w)
+				{
+					if constexpr (std::endian::native == std::endian::little)
+					{
+						return w;
+					}
+					else
+					{
+						return ((w >> 24u) & 0x000000FFu) | ((w >> 8u) & 0x0000FF00u) |
+							((w << 8u) & 0x00FF0000u) | ((w << 24u) & 0xFF000000u);
+					}
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Number of header words of a delta (up to the first section).
+				 */
+				static inline uint64_t header_words(std::size_t num_slrs)
+				{
+					return 4u + SLR_HEADER_WORDS * num_slrs + 2u * DIGEST_WORDS;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Appends a digest (as little-endian words, preserving the byte order).
+				 */
+				static void put_digest(std::vector<uint32_t>& out, const runtime::sha256::digest& d)
+				{
+					for (std::size_t i = 0u; i < DIGEST_WORDS; ++i)
+					{
+						out.push_back(static_cast<uint32_t>(d[4u * i]) | (static_cast<uint32_t>(d[4u * i + 1u]) << 8u) |
+							(static_cast<uint32_t>(d[4u * i + 2u]) << 16u) | (static_cast<uint32_t>(d[4u * i + 3u]) << 24u));
+					}
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Buffered (optionally seekable) byte reader.
+				 */
+				class byte_reader
+				{
+				private:
+					std::istream& is_;
+					std::vector<uint8_t> buffer_;
+					runtime::mem_account account_;
+					uint64_t base_;
+					std::size_t pos_;
+					std::size_t end_;
+
+				public:
+					explicit byte_reader(std::istream& is)
+						: is_(is), buffer_(IO_CHUNK_BYTES),
+						account_(runtime::mem_subsystem::input_buffers, IO_CHUNK_BYTES),
+						base_(0u), pos_(0u), end_(0u)
+					{
+					}
+
+					uint64_t tell() const
+					{
+						return base_ + pos_;
+					}
+
+					void seek(uint64_t offset)
+					{
+						if (offset >= base_ && offset <= base_ + end_)
+						{
+							// Still buffered
+							pos_ = static_cast<std::size_t>(offset - base_);
+							return;
+						}
+
+						is_.clear();
+						is_.seekg(static_cast<std::streamoff>(offset), std::ios_base::beg);
+
+						if (is_.fail())
+							throw std::ios_base::failure("i/o error while seeking in delta");
+
+						base_ = offset;
+						pos_  = 0u;
+						end_  = 0u;
+					}
+
+					std::size_t read(uint8_t* dst, std::size_t size)
+					{
+						std::size_t done = 0u;
+
+						while (done < size && fill())
+						{
+							const std::size_t n = std::min(size - done, end_ - pos_);
+							std::memcpy(dst + done, buffer_.data() + pos_, n);
+
+							pos_ += n;
+							done += n;
+						}
+
+						return done;
+					}
+
+				private:
+					bool fill()
+					{
+						if (pos_ < end_)
+							return true;
+
+						static_assert(sizeof(std::istream::char_type) == sizeof(uint8_t),
+							"unsupported: sizeof(std::istream::char_type) != sizeof(uint8_t)");
+
+						base_ += end_;
+						pos_   = 0u;
+
+						is_.read(reinterpret_cast<std::istream::char_type*>(buffer_.data()), buffer_.size());
+						end_ = static_cast<std::size_t>(is_.gcount());
+
+						if (is_.bad())
+							throw std::ios_base::failure("i/o error while reading input data");
+
+						return end_ > 0u;
+					}
+				};
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Reads little-endian words of the delta (throws on truncated deltas).
+				 */
+				static void read_le(byte_reader& reader, std::span<uint32_t> words)
+				{
+					const std::size_t size = words.size() * sizeof(uint32_t);
+
+					if (reader.read(reinterpret_cast<uint8_t*>(words.data()), size) != size)
+						throw bitstream_error("corrupt delta: truncated file");
+
+					std::transform(words.begin(), words.end(), words.begin(), to_le);
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Reads a single little-endian word of the delta.
+				 */
+				static uint32_t read_le(byte_reader& reader)
+				{
+					uint32_t w;
+					read_le(reader, std::span<uint32_t>(&w, 1u));
+					return w;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Buffered byte writer.
+				 */
+				class byte_writer
+				{
+				private:
+					std::ostream& os_;
+					std::vector<uint8_t> buffer_;
+
+				public:
+					explicit byte_writer(std::ostream& os)
+						: os_(os)
+					{
+						buffer_.reserve(IO_CHUNK_BYTES);
+					}
+
+					void put_byte(uint8_t b)
+					{
+						buffer_.push_back(b);
+
+						if (buffer_.size() == IO_CHUNK_BYTES)
+							flush();
+					}
+
+					void put_be(std::span<const uint32_t> words)
+					{
+						for (uint32_t w : words)
+						{
+							const uint32_t f = to_file_order(w);
+							const uint8_t* p = reinterpret_cast<const uint8_t*>(&f);
+
+							buffer_.insert(buffer_.end(), p, p + sizeof(f));
+
+							if (buffer_.size() + sizeof(f) > IO_CHUNK_BYTES)
+								flush();
+						}
+					}
+
+					void flush()
+					{
+						os_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+						buffer_.clear();
+
+						if (os_.fail())
+							throw std::ios_base::failure("i/o error while writing output data");
+					}
+				};
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Applies the records of an SLR section, frame by frame.
+				 */
+				class record_cursor
+				{
+				private:
+					byte_reader& reader_;
+					std::size_t frame_words_;
+					std::size_t num_frames_;
+					std::size_t records_left_;
+					uint64_t words_left_;
+
+					// Current record
+					std::size_t first_ = 0u;
+					std::size_t end_ = 0u;
+					uint32_t encoding_ = frame_delta::ENCODING_RAW;
+					uint64_t payload_left_ = 0u;
+
+					// Current token (XOR/RLE encoding)
+					std::size_t zeros_left_ = 0u;
+					std::size_t literals_left_ = 0u;
+
+				public:
+					record_cursor(byte_reader& reader, const frame_delta_decoder::slr_section& section, std::size_t frame_words)
+						: reader_(reader), frame_words_(frame_words), num_frames_(section.num_frames),
+						records_left_(section.num_records), words_left_(section.words)
+					{
+						reader_.seek(section.offset);
+						next_record();
+					}
+
+					/**
+					 * @brief Patches a frame (in place), frames must be visited in ascending order.
+					 */
+					void patch(std::size_t frame_index, std::span<uint32_t> frame)
+					{
+						if (frame_index < first_ || frame_index >= end_)
+							return;
+
+						if (encoding_ == frame_delta::ENCODING_RAW)
+						{
+							take_payload(frame.size());
+							read_le(reader_, frame);
+						}
+						else
+						{
+							std::size_t i = 0u;
+							while (i < frame.size())
+							{
+								if (zeros_left_ == 0u && literals_left_ == 0u)
+								{
+									take_payload(1u);
+
+									const uint32_t token = read_le(reader_);
+									zeros_left_    = token >> 16u;
+									literals_left_ = token & 0xFFFFu;
+									continue;
+								}
+
+								const std::size_t skip = std::min(zeros_left_, frame.size() - i);
+								zeros_left_ -= skip;
+								i += skip;
+
+								while (i < frame.size() && zeros_left_ == 0u && literals_left_ > 0u)
+								{
+									take_payload(1u);
+									frame[i++] ^= read_le(reader_);
+									--literals_left_;
+								}
+							}
+						}
+
+						if (frame_index + 1u == end_)
+						{
+							if (payload_left_ != 0u || zeros_left_ != 0u || literals_left_ != 0u)
+								throw bitstream_error("corrupt delta: record payload does not match the frame data");
+
+							next_record();
+						}
+					}
+
+					/**
+					 * @brief Checks that all records have been applied.
+					 */
+					void finish() const
+					{
+						if (end_ != 0u || records_left_ != 0u || words_left_ != 0u)
+							throw bitstream_error("corrupt delta: records exceed the frames of the slr");
+					}
+
+				private:
+					void take_payload(uint64_t n)
+					{
+						if (n > payload_left_)
+							throw bitstream_error("corrupt delta: record payload too short");
+
+						payload_left_ -= n;
+					}
+
+					void next_record()
+					{
+						if (records_left_ == 0u)
+						{
+							first_ = end_ = 0u;
+							return;
+						}
+
+						if (words_left_ < RECORD_HEADER_WORDS)
+							throw bitstream_error("corrupt delta: truncated record");
+
+						uint32_t hdr[RECORD_HEADER_WORDS];
+						read_le(reader_, hdr);
+
+						const std::size_t first = hdr[0u];
+						const std::size_t count = hdr[1u];
+						encoding_     = hdr[3u] >> 28u;
+						payload_left_ = hdr[3u] & 0x0FFFFFFFu;
+
+						if (count == 0u || first < end_ || first > num_frames_ || count > num_frames_ - first ||
+							encoding_ > frame_delta::ENCODING_XOR_RLE || payload_left_ > words_left_ - RECORD_HEADER_WORDS)
+						{
+							throw bitstream_error("corrupt delta: bad record header");
+						}
+
+						words_left_ -= RECORD_HEADER_WORDS + payload_left_;
+						--records_left_;
+
+						first_ = first;
+						end_   = first + count;
+						zeros_left_ = literals_left_ = 0u;
+					}
+				};
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Applies a delta to a streamed base bitstream.
+				 *
+				 * The frame data of each SLR is patched as it passes; CRC checks of the base bitstream
+				 * are verified and replaced by the checks of the output.
+				 */
+				class delta_applier : public stream_engine
+				{
+				private:
+					byte_reader input_;
+					byte_reader& delta_;
+					byte_writer out_;
+					const std::vector<frame_delta_decoder::slr_section>& slrs_;
+					std::size_t frame_words_;
+					std::vector<runtime::sha256> base_hash_;
+					std::vector<runtime::sha256> target_hash_;
+					std::vector<bool> fdri_seen_;
+					std::optional<record_cursor> cursor_;
+
+				public:
+					delta_applier(std::istream& base, byte_reader& delta, std::ostream& output,
+						const std::vector<frame_delta_decoder::slr_section>& slrs, std::size_t frame_words)
+						: stream_engine(frame_words), input_(base), delta_(delta), out_(output), slrs_(slrs),
+						frame_words_(frame_words), base_hash_(slrs.size()), target_hash_(slrs.size()),
+						fdri_seen_(slrs.size(), false)
+					{
+						set_track_input_crc(true);
+					}
+
+					/**
+					 * @brief Flushes the output and gets the digests of the base and target images.
+					 */
+					void finish(std::vector<runtime::sha256::digest>& base_digests,
+						std::vector<runtime::sha256::digest>& target_digests)
+					{
+						out_.flush();
+
+						for (std::size_t slr = 0u; slr < slrs_.size(); ++slr)
+						{
+							if (!fdri_seen_[slr] && slrs_[slr].num_frames > 0u)
+								throw bitstream_error("base bitstream does not match the delta (missing frame data)");
+
+							base_digests.push_back(base_hash_[slr].finish());
+							target_digests.push_back(target_hash_[slr].finish());
+						}
+					}
+
+				protected:
+					std::size_t read_bytes(uint8_t* dst, std::size_t size) override
+					{
+						return input_.read(dst, size);
+					}
+
+					void on_raw_bytes(std::span<const uint8_t> bytes) override
+					{
+						// Leading data (e.g. the .bit file header) and trailing bytes are copied verbatim
+						for (const uint8_t b : bytes)
+							out_.put_byte(b);
+					}
+
+					bool on_packet(const packet& pkt) override
+					{
+						if (pkt.op != packet_op::write)
+							return true;
+
+						if (pkt.reg == config_reg::MFWR)
+							throw bitstream_error("MFWR-compressed base bitstreams are not supported");
+
+						if (pkt.reg == config_reg::FDRI)
+						{
+							// Frame data of the current SLR
+							const std::size_t slr = current_level().slr;
+
+							if (slr >= slrs_.size() || fdri_seen_[slr])
+								throw bitstream_error("base bitstream does not match the delta (unexpected FDRI write)");
+
+							if (pkt.word_count != static_cast<uint64_t>(slrs_[slr].num_frames) * frame_words_)
+								throw bitstream_error("base bitstream does not match the delta (frame count mismatch)");
+
+							fdri_seen_[slr] = true;
+							cursor_.emplace(delta_, slrs_[slr], frame_words_);
+						}
+
+						return true;
+					}
+
+					void on_payload(const packet& pkt, uint64_t offset, std::span<const uint32_t> input,
+						std::span<uint32_t> output) override
+					{
+						if (pkt.op != packet_op::write)
+							return;
+
+						const auto& cur = current_level();
+
+						if (pkt.reg == config_reg::FDRI)
+						{
+							// Chunks are single frames
+							cursor_->patch(static_cast<std::size_t>(offset / frame_words_), output);
+
+							base_hash_[cur.slr].update_be(input);
+							target_hash_[cur.slr].update_be(output);
+						}
+						else if (pkt.reg == config_reg::CRC)
+						{
+							// Verify the check of the base bitstream, substitute the check of the output
+							for (std::size_t i = 0u; i < input.size(); ++i)
+							{
+								if (input[i] != cur.input_crc.value())
+									throw bitstream_error("CRC check failed in base bitstream");
+
+								output[i] = cur.crc.value();
+							}
+						}
+					}
+
+					void on_packet_end(const packet& pkt) override
+					{
+						if (cursor_)
+						{
+							cursor_->finish();
+							cursor_.reset();
+						}
+					}
+
+					void on_words(std::span<const uint32_t> input, std::span<const uint32_t> output) override
+					{
+						out_.put_be(output);
+					}
+				};
+			}
+
+			//------------------------------------------------------------------------------------------
+			runtime::sha256::digest frame_delta::image_digest(const frame_store& frames)
+			{
+				std::vector<runtime::sha256::digest> slr_digests;
+				slr_digests.reserve(frames.num_slrs());
+
+				for (std::size_t slr = 0u; slr < frames.num_slrs(); ++slr)
+					slr_digests.push_back(runtime::sha256::hash_be(frames.words(slr)));
+
+				return image_digest(slr_digests);
+			}
+
+			//------------------------------------------------------------------------------------------
+			runtime::sha256::digest frame_delta::image_digest(std::span<const runtime::sha256::digest> slr_digests)
+			{
+				runtime::sha256 hash;
+
+				for (const auto& d : slr_digests)
+					hash.update(d);
+
+				return hash.finish();
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_delta_encoder::frame_delta_encoder(const frame_store& base, const frame_store& target,
+				const delta_options& opts)
+				: base_(base), target_(target), options_(opts), frame_addresses_(base.num_slrs()),
+				num_records_(0u), num_changed_frames_(0u), size_(0u)
+			{
+				if (base.frame_words() != target.frame_words() || base.num_slrs() != target.num_slrs())
+					throw std::invalid_argument("base and target frames differ in geometry");
+
+				for (std::size_t slr = 0u; slr < base.num_slrs(); ++slr)
+				{
+					if (base.num_frames(slr) != target.num_frames(slr))
+						throw std::invalid_argument("base and target frames differ in geometry");
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_delta_encoder::~frame_delta_encoder()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_delta_encoder::set_frame_addresses(std::size_t slr, std::vector<uint32_t> addresses)
+			{
+				if (slr >= frame_addresses_.size())
+					throw std::out_of_range("slr index is out of range");
+
+				if (addresses.size() != base_.num_frames(slr))
+					throw std::invalid_argument("frame address map does not match the number of frames");
+
+				frame_addresses_[slr] = std::move(addresses);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_delta_encoder::encode(std::ostream& os)
+			{
+				struct slr_result
+				{
+					std::vector<uint32_t> section;
+					std::size_t num_records = 0u;
+					std::size_t num_changed = 0u;
+					runtime::sha256::digest base_digest;
+					runtime::sha256::digest target_digest;
+				};
+
+				const std::size_t num_slrs = base_.num_slrs();
+				const std::size_t fw = base_.frame_words();
+				std::vector<slr_result> results(num_slrs);
+
+				auto encode_slr = [&](std::size_t slr)
+				{
+					auto& r = results[slr];
+					const auto base = base_.words(slr);
+					const auto target = target_.words(slr);
+					const std::size_t num_frames = base_.num_frames(slr);
+
+					r.base_digest   = runtime::sha256::hash_be(base);
+					r.target_digest = runtime::sha256::hash_be(target);
+
+					auto same = [&](std::size_t f)
+					{
+						return std::memcmp(base.data() + f * fw, target.data() + f * fw, fw * sizeof(uint32_t)) == 0;
+					};
+
+					for (std::size_t f = 0u; f < num_frames; )
+					{
+						if (same(f))
+						{
+							++f;
+							continue;
+						}
+
+						// Run of changed frames
+						const std::size_t first = f;
+						while (f < num_frames && !same(f))
+							++f;
+
+						const std::size_t count = f - first;
+						const std::size_t num_words = count * fw;
+						const uint32_t far = frame_addresses_[slr].empty() ? bitstream_serializer::NO_FRAME_ADDRESS : frame_addresses_[slr][first];
+
+						auto& out = r.section;
+						const std::size_t hdr_pos = out.size();
+						out.insert(out.end(), { static_cast<uint32_t>(first), static_cast<uint32_t>(count), far, 0u });
+
+						uint32_t encoding = frame_delta::ENCODING_RAW;
+
+						if (options_.xor_rle)
+						{
+							const uint32_t* b = base.data() + first * fw;
+							const uint32_t* t = target.data() + first * fw;
+
+							std::size_t i = 0u;
+							while (i < num_words && out.size() - hdr_pos - RECORD_HEADER_WORDS < num_words)
+							{
+								std::size_t zeros = 0u;
+								while (i < num_words && b[i] == t[i] && zeros < MAX_TOKEN_WORDS)
+								{
+									++zeros;
+									++i;
+								}
+
+								const std::size_t token_pos = out.size();
+								out.push_back(0u);
+
+								std::size_t literals = 0u;
+								while (i < num_words && b[i] != t[i] && literals < MAX_TOKEN_WORDS)
+								{
+									out.push_back(b[i] ^ t[i]);
+									++literals;
+									++i;
+								}
+
+								out[token_pos] = static_cast<uint32_t>((zeros << 16u) | literals);
+							}
+
+							if (i == num_words && out.size() - hdr_pos - RECORD_HEADER_WORDS < num_words)
+								encoding = frame_delta::ENCODING_XOR_RLE;
+							else
+								out.resize(hdr_pos + RECORD_HEADER_WORDS);
+						}
+
+						if (encoding == frame_delta::ENCODING_RAW)
+							out.insert(out.end(), target.begin() + first * fw, target.begin() + first * fw + num_words);
+
+						const std::size_t payload_words = out.size() - hdr_pos - RECORD_HEADER_WORDS;
+						if (payload_words > 0x0FFFFFFFu)
+							throw std::invalid_argument("delta record exceeds the maximum payload size");
+
+						out[hdr_pos + 3u] = (encoding << 28u) | static_cast<uint32_t>(payload_words);
+
+						++r.num_records;
+						r.num_changed += count;
+					}
+				};
+
+				if (options_.parallel && num_slrs > 1u)
+				{
+					// One task per SLR (on the shared executor)
+					runtime::parallel_for(0u, num_slrs, encode_slr);
+				}
+				else
+				{
+					for (std::size_t i = 0u; i < num_slrs; ++i)
+						encode_slr(i);
+				}
+
+				// Header
+				std::vector<uint32_t> header(std::begin(DELTA_MAGIC), std::end(DELTA_MAGIC));
+				header.push_back(static_cast<uint32_t>(fw));
+				header.push_back(static_cast<uint32_t>(num_slrs));
+
+				std::vector<runtime::sha256::digest> base_digests, target_digests;
+				num_records_ = 0u;
+				num_changed_frames_ = 0u;
+
+				for (std::size_t i = 0u; i < num_slrs; ++i)
+				{
+					header.push_back(static_cast<uint32_t>(base_.num_frames(i)));
+					header.push_back(static_cast<uint32_t>(results[i].num_records));
+					header.push_back(static_cast<uint32_t>(results[i].section.size()));
+
+					base_digests.push_back(results[i].base_digest);
+					target_digests.push_back(results[i].target_digest);
+
+					num_records_ += results[i].num_records;
+					num_changed_frames_ += results[i].num_changed;
+				}
+
+				put_digest(header, frame_delta::image_digest(base_digests));
+				put_digest(header, frame_delta::image_digest(target_digests));
+
+				// Write the header, the sections and the CRC
+				config_crc crc;
+				size_ = 0u;
+
+				auto put = [&](std::span<const uint32_t> words)
+				{
+					crc.update(config_reg::FDRI, words);
+
+					std::vector<uint32_t> chunk;
+					for (std::size_t pos = 0u; pos < words.size(); pos += IO_CHUNK_BYTES / sizeof(uint32_t))
+					{
+						const auto part = words.subspan(pos, std::min(IO_CHUNK_BYTES / sizeof(uint32_t), words.size() - pos));
+
+						chunk.resize(part.size());
+						std::transform(part.begin(), part.end(), chunk.begin(), to_le);
+						os.write(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(uint32_t));
+					}
+
+					size_ += words.size() * sizeof(uint32_t);
+				};
+
+				put(header);
+
+				for (const auto& r : results)
+					put(r.section);
+
+				const uint32_t crc_le = to_le(crc.value());
+				os.write(reinterpret_cast<const char*>(&crc_le), sizeof(crc_le));
+				size_ += sizeof(crc_le);
+
+				if (os.fail())
+					throw std::ios_base::failure("i/o error while writing delta");
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_delta_decoder::frame_delta_decoder(std::istream& delta)
+				: delta_(delta), origin_(0u), frame_words_(0u), base_digest_(), target_digest_()
+			{
+				const auto origin = delta.tellg();
+				if (origin < 0)
+					throw std::ios_base::failure("delta input stream is not seekable");
+
+				origin_ = static_cast<uint64_t>(origin);
+
+				delta.seekg(0, std::ios_base::end);
+				const auto end = delta.tellg();
+				delta.seekg(origin);
+
+				if (end < origin || delta.fail())
+					throw std::ios_base::failure("delta input stream is not seekable");
+
+				const uint64_t size = static_cast<uint64_t>(end) - origin_;
+				if ((size % 4u) != 0u || size < 4u * (header_words(0u) + 1u))
+					throw bitstream_error("corrupt delta: bad file size");
+
+				const uint64_t total_words = size / 4u;
+
+				byte_reader reader(delta);
+				reader.seek(origin_);
+
+				// Header
+				uint32_t fixed[4u];
+				read_le(reader, fixed);
+
+				if (fixed[0u] != DELTA_MAGIC[0u] || fixed[1u] != DELTA_MAGIC[1u])
+					throw bitstream_error("corrupt delta: bad header");
+
+				frame_words_ = fixed[2u];
+				const std::size_t num_slrs = fixed[3u];
+
+				if (frame_words_ == 0u || header_words(num_slrs) + 1u > total_words)
+					throw bitstream_error("corrupt delta: bad header");
+
+				uint64_t offset = origin_ + 4u * header_words(num_slrs);
+				slrs_.resize(num_slrs);
+
+				for (auto& s : slrs_)
+				{
+					uint32_t w[SLR_HEADER_WORDS];
+					read_le(reader, w);
+
+					s.num_frames  = w[0u];
+					s.num_records = w[1u];
+					s.offset      = offset;
+					s.words       = w[2u];
+
+					offset += 4u * s.words;
+				}
+
+				if (offset + 4u != origin_ + size)
+					throw bitstream_error("corrupt delta: section sizes do not match the file size");
+
+				for (auto* d : { &base_digest_, &target_digest_ })
+				{
+					if (reader.read(d->data(), d->size()) != d->size())
+						throw bitstream_error("corrupt delta: truncated file");
+				}
+
+				// Check the CRC of the complete delta
+				reader.seek(origin_);
+
+				config_crc crc;
+				std::vector<uint32_t> chunk(IO_CHUNK_BYTES / sizeof(uint32_t));
+
+				for (uint64_t pos = 0u; pos + 1u < total_words; )
+				{
+					const std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(chunk.size(), total_words - 1u - pos));
+					read_le(reader, std::span<uint32_t>(chunk.data(), n));
+					crc.update(config_reg::FDRI, std::span<const uint32_t>(chunk.data(), n));
+					pos += n;
+				}
+
+				if (read_le(reader) != crc.value())
+					throw bitstream_error("corrupt delta: CRC mismatch");
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_delta_decoder::~frame_delta_decoder()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_delta_decoder::apply(frame_store& frames)
+			{
+				if (frames.frame_words() != frame_words_ || frames.num_slrs() != slrs_.size())
+					throw std::invalid_argument("delta does not match the geometry of the frames");
+
+				for (std::size_t slr = 0u; slr < slrs_.size(); ++slr)
+				{
+					if (frames.num_frames(slr) != slrs_[slr].num_frames)
+						throw std::invalid_argument("delta does not match the geometry of the frames");
+				}
+
+				if (frame_delta::image_digest(frames) != base_digest_)
+					throw bitstream_error("delta does not apply to the base image (digest mismatch)");
+
+				byte_reader reader(delta_);
+
+				for (std::size_t slr = 0u; slr < slrs_.size(); ++slr)
+				{
+					record_cursor cursor(reader, slrs_[slr], frame_words_);
+
+					for (std::size_t f = 0u; f < slrs_[slr].num_frames; ++f)
+						cursor.patch(f, frames.frame(slr, f));
+
+					cursor.finish();
+				}
+
+				if (frame_delta::image_digest(frames) != target_digest_)
+					throw bitstream_error("delta produced an unexpected target image (digest mismatch)");
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_delta_decoder::apply(std::istream& base, std::ostream& output)
+			{
+				byte_reader reader(delta_);
+				delta_applier applier(base, reader, output, slrs_, frame_words_);
+
+				applier.process();
+
+				// Check the images
+				std::vector<runtime::sha256::digest> base_digests, target_digests;
+				applier.finish(base_digests, target_digests);
+
+				if (frame_delta::image_digest(base_digests) != base_digest_)
+					throw bitstream_error("delta does not apply to the base bitstream (digest mismatch)");
+
+				if (frame_delta::image_digest(target_digests) != target_digest_)
+					throw bitstream_error("delta produced an unexpected target image (digest mismatch)");
+			}
+		}
+	}
+}
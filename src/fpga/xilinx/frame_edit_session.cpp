@@ -0,0 +1,176 @@
+/**
+ * @file
+ * @brief Transactional edit sessions on materialized configuration frames.
+ */
+#include "unbit/fpga/xilinx/frame_edit_session.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			frame_edit_session::frame_edit_session(frame_store& store)
+				: store_(store)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_edit_session::~frame_edit_session()
+			{
+				rollback();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::journal(std::size_t slr, std::size_t word_offset, std::size_t num_words)
+			{
+				const auto words = store_.words(slr);
+				if (word_offset > words.size() || num_words > (words.size() - word_offset))
+					throw std::out_of_range("word range is out of range of the frame data");
+
+				if (num_words == 0u)
+					return;
+
+				// Try to extend (or reuse) the last journal entry, as long as it was recorded after the
+				// innermost savepoint. Sequential word and bit writes thus share a single entry.
+				const std::size_t fence = savepoints_.empty() ? 0u : savepoints_.back();
+
+				if (journal_.size() > fence)
+				{
+					auto& last = journal_.back();
+
+					if (last.slr == slr)
+					{
+						const std::size_t last_end = last.offset + last.count;
+
+						if (word_offset >= last.offset && (word_offset + num_words) <= last_end)
+						{
+							// Already journaled
+							return;
+						}
+						else if (word_offset == last_end)
+						{
+							// Contiguous extension (the undo data of the last entry is at the end of the
+							// undo buffer)
+							undo_.insert(undo_.end(), words.begin() + word_offset,
+								words.begin() + word_offset + num_words);
+
+							last.count += num_words;
+							return;
+						}
+					}
+				}
+
+				// New journal entry
+				journal_.push_back(journal_entry { slr, word_offset, num_words, undo_.size() });
+				undo_.insert(undo_.end(), words.begin() + word_offset, words.begin() + word_offset + num_words);
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::span<uint32_t> frame_edit_session::modify(std::size_t slr, std::size_t word_offset, std::size_t num_words)
+			{
+				journal(slr, word_offset, num_words);
+				return store_.words(slr).subspan(word_offset, num_words);
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::span<uint32_t> frame_edit_session::modify_frame(std::size_t slr, std::size_t frame)
+			{
+				if (frame >= store_.num_frames(slr))
+					throw std::out_of_range("frame index is out of range");
+
+				return modify(slr, frame * store_.frame_words(), store_.frame_words());
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::write_words(std::size_t slr, std::size_t word_offset, std::span<const uint32_t> data)
+			{
+				auto target = modify(slr, word_offset, data.size());
+				std::copy(data.begin(), data.end(), target.begin());
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::write_word(std::size_t slr, std::size_t word_offset, uint32_t value)
+			{
+				modify(slr, word_offset, 1u)[0u] = value;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::write_bit(std::size_t slr, std::size_t bit_offset, bool value)
+			{
+				if (store_.read_bit(slr, bit_offset) == value)
+					return;
+
+				uint32_t& w = modify(slr, bit_offset >> 5u, 1u)[0u];
+				w ^= (1u << (bit_offset & 0x1Fu));
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_edit_session::savepoint_id frame_edit_session::set_savepoint()
+			{
+				savepoints_.push_back(journal_.size());
+				return savepoints_.size() - 1u;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::check_savepoint(savepoint_id sp) const
+			{
+				if (sp >= savepoints_.size())
+					throw std::invalid_argument("savepoint is not active in this edit session");
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::rollback_to(savepoint_id sp)
+			{
+				check_savepoint(sp);
+
+				undo_to(savepoints_[sp]);
+				savepoints_.resize(sp + 1u);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::release(savepoint_id sp)
+			{
+				check_savepoint(sp);
+
+				// The journal entries are kept (they now belong to the enclosing savepoint)
+				savepoints_.resize(sp);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::commit() noexcept
+			{
+				journal_.clear();
+				undo_.clear();
+				savepoints_.clear();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::rollback() noexcept
+			{
+				undo_to(0u);
+				savepoints_.clear();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_edit_session::undo_to(std::size_t journal_size) noexcept
+			{
+				// Restore in reverse order (overlapping ranges end up with their oldest content)
+				while (journal_.size() > journal_size)
+				{
+					const auto& e = journal_.back();
+					const auto src = undo_.begin() + e.undo_pos;
+
+					std::copy(src, src + e.count, store_.words(e.slr).begin() + e.offset);
+
+					undo_.resize(e.undo_pos);
+					journal_.pop_back();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,288 @@
+/**
+ * @file
+ * @brief Merkle trees over the frame digests of a build (equality checks and difference search).
+ */
+#include "unbit/fpga/xilinx/frame_merkle.hpp"
+#include "unbit/fpga/xilinx/frame_archive.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/runtime/byte_io.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				using runtime::detail::put_le;
+
+				/**
+				 * @brief Reader for Merkle tree files.
+				 */
+				using merkle_reader = runtime::detail::le_reader<bitstream_error>;
+
+				/**
+				 * @brief Magic number (and version) of Merkle tree files.
+				 */
+				static constexpr char MERKLE_MAGIC[8u] = { 'U', 'N', 'B', 'M', 'K', 'L', '0', '1' };
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Computes the level offsets of a tree with the given number of leaves.
+				 */
+				static std::vector<std::size_t> level_offsets(std::size_t num_leaves)
+				{
+					std::vector<std::size_t> levels { 0u };
+					std::size_t size = std::max<std::size_t>(num_leaves, 1u);
+
+					for (;;)
+					{
+						levels.push_back(levels.back() + size);
+
+						if (size == 1u)
+							break;
+
+						size = (size + 1u) / 2u;
+					}
+
+					return levels;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			merkle_tree::merkle_tree()
+				: nodes_ { runtime::sha256().finish() }, levels_ { 0u, 1u }
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			merkle_tree::merkle_tree(std::span<const node_hash> leaves)
+				: merkle_tree()
+			{
+				if (leaves.empty())
+					return;
+
+				levels_ = level_offsets(leaves.size());
+				nodes_.resize(levels_.back());
+				std::copy(leaves.begin(), leaves.end(), nodes_.begin());
+
+				for (std::size_t level = 0u; level + 1u < num_levels(); ++level)
+				{
+					const std::size_t size = level_size(level);
+					const std::size_t first = levels_[level];
+					const std::size_t parent = levels_[level + 1u];
+
+					for (std::size_t i = 0u; i + 1u < size; i += 2u)
+						nodes_[parent + i / 2u] = combine(nodes_[first + i], nodes_[first + i + 1u]);
+
+					// Promote the last node of odd levels
+					if ((size % 2u) != 0u)
+						nodes_[parent + size / 2u] = nodes_[first + size - 1u];
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			merkle_tree::~merkle_tree()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t merkle_tree::level_size(std::size_t level) const
+			{
+				if (level >= num_levels())
+					throw std::out_of_range("merkle tree level is out of range");
+
+				return levels_[level + 1u] - levels_[level];
+			}
+
+			//------------------------------------------------------------------------------------------
+			const merkle_tree::node_hash& merkle_tree::node(std::size_t level, std::size_t index) const
+			{
+				if (index >= level_size(level))
+					throw std::out_of_range("merkle tree node index is out of range");
+
+				return nodes_[levels_[level] + index];
+			}
+
+			//------------------------------------------------------------------------------------------
+			merkle_tree::node_hash merkle_tree::combine(const node_hash& left, const node_hash& right) noexcept
+			{
+				static constexpr uint8_t INNER_NODE = 0x01u;
+
+				runtime::sha256 hash;
+				hash.update(std::span<const uint8_t>(&INNER_NODE, 1u));
+				hash.update(left);
+				hash.update(right);
+				return hash.finish();
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::vector<std::size_t> merkle_tree::diff(const merkle_tree& a, const merkle_tree& b)
+			{
+				if (a.num_leaves() != b.num_leaves())
+					throw std::invalid_argument("merkle trees differ in shape");
+
+				std::vector<std::size_t> current;
+				if (a.root() != b.root())
+					current.push_back(0u);
+
+				// Descend into the differing children of differing nodes
+				for (std::size_t level = a.num_levels() - 1u; level-- > 0u && !current.empty(); )
+				{
+					std::vector<std::size_t> next;
+					const std::size_t size = a.level_size(level);
+
+					for (const std::size_t n : current)
+					{
+						for (std::size_t c = 2u * n; c < std::min(2u * n + 2u, size); ++c)
+						{
+							if (a.node(level, c) != b.node(level, c))
+								next.push_back(c);
+						}
+					}
+
+					current = std::move(next);
+				}
+
+				return current;
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_merkle::frame_merkle()
+				: frame_words_(0u)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_merkle::frame_merkle(std::size_t frame_words, std::vector<merkle_tree> slrs)
+				: frame_words_(frame_words), slrs_(std::move(slrs))
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_merkle::frame_merkle(const frame_store& frames)
+				: frame_words_(frames.frame_words())
+			{
+				for (std::size_t slr = 0u; slr < frames.num_slrs(); ++slr)
+				{
+					std::vector<merkle_tree::node_hash> leaves;
+					leaves.reserve(frames.num_frames(slr));
+
+					for (std::size_t f = 0u; f < frames.num_frames(slr); ++f)
+						leaves.push_back(runtime::sha256::hash_be(frames.frame(slr, f)));
+
+					slrs_.emplace_back(leaves);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_merkle::frame_merkle(const archive_manifest& manifest)
+				: frame_words_(manifest.frame_words)
+			{
+				for (const auto& slr : manifest.slrs)
+					slrs_.emplace_back(slr.frames);
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_merkle::~frame_merkle()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			const merkle_tree& frame_merkle::slr(std::size_t slr) const
+			{
+				if (slr >= slrs_.size())
+					throw std::out_of_range("slr index is out of range");
+
+				return slrs_[slr];
+			}
+
+			//------------------------------------------------------------------------------------------
+			merkle_tree::node_hash frame_merkle::root() const
+			{
+				std::vector<uint8_t> header;
+				put_le<uint32_t>(header, static_cast<uint32_t>(frame_words_));
+				put_le<uint32_t>(header, static_cast<uint32_t>(slrs_.size()));
+
+				runtime::sha256 hash;
+				hash.update(header);
+
+				for (const auto& tree : slrs_)
+					hash.update(tree.root());
+
+				return hash.finish();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_merkle::save(const std::string& filename) const
+			{
+				std::vector<uint8_t> out(std::begin(MERKLE_MAGIC), std::end(MERKLE_MAGIC));
+				put_le<uint32_t>(out, static_cast<uint32_t>(frame_words_));
+				put_le<uint32_t>(out, static_cast<uint32_t>(slrs_.size()));
+
+				for (const auto& tree : slrs_)
+				{
+					put_le<uint64_t>(out, tree.num_leaves());
+
+					for (const auto& n : tree.nodes())
+						out.insert(out.end(), n.begin(), n.end());
+				}
+
+				runtime::detail::replace_file(filename, out, "merkle tree file");
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_merkle frame_merkle::load(const std::string& filename)
+			{
+				std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+				if (!stm)
+					throw std::ios_base::failure("unable to open merkle tree file '" + filename + "'");
+
+				const std::vector<uint8_t> data((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+
+				if (stm.bad())
+					throw std::ios_base::failure("i/o error while reading merkle tree file '" + filename + "'");
+
+				if (data.size() < sizeof(MERKLE_MAGIC) || std::memcmp(data.data(), MERKLE_MAGIC, sizeof(MERKLE_MAGIC)) != 0)
+					throw bitstream_error("corrupt merkle tree file: bad header of '" + filename + "'");
+
+				merkle_reader in(std::span<const uint8_t>(data).subspan(sizeof(MERKLE_MAGIC)), "corrupt merkle tree file: truncated file");
+				const uint32_t frame_words = in.get<uint32_t>();
+				const uint32_t num_slrs = in.get<uint32_t>();
+
+				if (num_slrs > data.size())
+					throw bitstream_error("corrupt merkle tree file: bad header of '" + filename + "'");
+
+				std::vector<merkle_tree> slrs(num_slrs);
+
+				for (auto& tree : slrs)
+				{
+					const uint64_t num_leaves = in.get<uint64_t>();
+					if (num_leaves > data.size())
+						throw bitstream_error("corrupt merkle tree file: bad leaf count in '" + filename + "'");
+
+					tree.levels_ = level_offsets(static_cast<std::size_t>(num_leaves));
+
+					const auto node_bytes = in.bytes(tree.levels_.back() * runtime::sha256::DIGEST_SIZE);
+
+					tree.nodes_.resize(tree.levels_.back());
+					for (std::size_t i = 0u; i < tree.nodes_.size(); ++i)
+						std::copy_n(node_bytes.begin() + i * runtime::sha256::DIGEST_SIZE, runtime::sha256::DIGEST_SIZE, tree.nodes_[i].begin());
+				}
+
+				if (!in.at_end())
+					throw bitstream_error("corrupt merkle tree file: trailing data in '" + filename + "'");
+
+				return frame_merkle(frame_words, std::move(slrs));
+			}
+		}
+	}
+}
@@ -0,0 +1,320 @@
+/**
+ * @file
+ * @brief Similarity sketches of configuration frame data (nearest-build search).
+ */
+#include "unbit/fpga/xilinx/frame_sketch.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/runtime/byte_io.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				using runtime::detail::put_le;
+
+				/**
+				 * @brief Reader for index files.
+				 */
+				using index_reader = runtime::detail::le_reader<bitstream_error>;
+
+				/**
+				 * @brief Magic number (and version) of index files.
+				 */
+				static constexpr char INDEX_MAGIC[8u] = { 'U', 'N', 'B', 'S', 'K', 'X', '0', '1' };
+
+				/**
+				 * @brief Unused signature value.
+				 */
+				static constexpr uint64_t UNUSED = std::numeric_limits<uint64_t>::max();
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief 64-bit finalizer (SplitMix64).
+				 */
+				static inline uint64_t mix64(uint64_t x) noexcept
+				{
+					x ^= x >> 30u;
+					x *= 0xBF58476D1CE4E5B9ull;
+					x ^= x >> 27u;
+					x *= 0x94D049BB133111EBull;
+					x ^= x >> 31u;
+					return x;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_sketch::frame_sketch(std::size_t size)
+				: size_(size)
+			{
+				if (size == 0u)
+					throw std::invalid_argument("sketch size must not be zero");
+
+				heap_.reserve(size);
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_sketch::~frame_sketch()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_sketch::add(uint32_t slr, std::size_t frame_index, uint64_t content_hash)
+			{
+				const uint64_t position = (static_cast<uint64_t>(slr) << 40u) ^ static_cast<uint64_t>(frame_index);
+				const uint64_t h = mix64(content_hash ^ mix64(position));
+
+				if (heap_.size() < size_)
+				{
+					// Filling up (duplicates are only possible for repeated frames)
+					if (std::find(heap_.begin(), heap_.end(), h) == heap_.end())
+					{
+						heap_.push_back(h);
+						std::push_heap(heap_.begin(), heap_.end());
+					}
+				}
+				else if (h < heap_.front() && std::find(heap_.begin(), heap_.end(), h) == heap_.end())
+				{
+					// Replace the largest element hash
+					std::pop_heap(heap_.begin(), heap_.end());
+					heap_.back() = h;
+					std::push_heap(heap_.begin(), heap_.end());
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_sketch::add(const frame_store& frames)
+			{
+				for (std::size_t slr = 0u; slr < frames.num_slrs(); ++slr)
+				{
+					const std::size_t num_frames = frames.num_frames(slr);
+
+					for (std::size_t i = 0u; i < num_frames; ++i)
+						add(static_cast<uint32_t>(slr), i, content_hash(frames.frame(slr, i)));
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_sketch::add(const archive_manifest& manifest)
+			{
+				for (std::size_t slr = 0u; slr < manifest.slrs.size(); ++slr)
+				{
+					const auto& frames = manifest.slrs[slr].frames;
+
+					for (std::size_t i = 0u; i < frames.size(); ++i)
+						add(static_cast<uint32_t>(slr), i, content_hash(frames[i]));
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::vector<uint64_t> frame_sketch::signature() const
+			{
+				std::vector<uint64_t> result(heap_);
+				std::sort(result.begin(), result.end());
+				return result;
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint64_t frame_sketch::content_hash(std::span<const uint32_t> frame) noexcept
+			{
+				return content_hash(runtime::sha256::hash_be(frame));
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint64_t frame_sketch::content_hash(const runtime::sha256::digest& digest) noexcept
+			{
+				uint64_t h = 0u;
+
+				for (std::size_t i = 0u; i < 8u; ++i)
+					h = (h << 8u) | digest[i];
+
+				return h;
+			}
+
+			//------------------------------------------------------------------------------------------
+			double frame_sketch::similarity(std::span<const uint64_t> a, std::span<const uint64_t> b, std::size_t size) noexcept
+			{
+				// Walk the k smallest elements of the union, and count the elements found in both
+				std::size_t i = 0u, j = 0u, n = 0u, common = 0u;
+
+				while (n < size && (i < a.size() || j < b.size()))
+				{
+					if (j == b.size() || (i < a.size() && a[i] < b[j]))
+					{
+						++i;
+					}
+					else if (i == a.size() || b[j] < a[i])
+					{
+						++j;
+					}
+					else
+					{
+						++i;
+						++j;
+						++common;
+					}
+
+					++n;
+				}
+
+				return (n > 0u) ? static_cast<double>(common) / static_cast<double>(n) : 1.0;
+			}
+
+			//------------------------------------------------------------------------------------------
+			double frame_sketch::cardinality(std::span<const uint64_t> sig, std::size_t size) noexcept
+			{
+				if (sig.size() < size || sig.empty())
+					return static_cast<double>(sig.size());
+
+				// The k-th smallest of n uniform hashes is expected at k/(n+1) of the range
+				const double kth = (static_cast<double>(sig.back()) + 1.0) / 18446744073709551616.0;
+				return static_cast<double>(size - 1u) / kth;
+			}
+
+			//------------------------------------------------------------------------------------------
+			sketch_index::sketch_index(std::size_t size)
+				: size_(size)
+			{
+				if (size == 0u)
+					throw std::invalid_argument("sketch size must not be zero");
+			}
+
+			//------------------------------------------------------------------------------------------
+			sketch_index::~sketch_index()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void sketch_index::add(const std::string& name, const frame_sketch& sketch)
+			{
+				if (sketch.size() != size_)
+					throw std::invalid_argument("sketch size does not match the index");
+
+				const auto sig = sketch.signature();
+
+				std::size_t entry = std::find(names_.begin(), names_.end(), name) - names_.begin();
+				if (entry == names_.size())
+				{
+					names_.push_back(name);
+					values_.resize(values_.size() + size_, UNUSED);
+					lengths_.push_back(0u);
+				}
+
+				std::fill_n(values_.begin() + entry * size_, size_, UNUSED);
+				std::copy(sig.begin(), sig.end(), values_.begin() + entry * size_);
+				lengths_[entry] = static_cast<uint32_t>(sig.size());
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::vector<sketch_match> sketch_index::nearest(const frame_sketch& sketch, std::size_t k) const
+			{
+				if (sketch.size() != size_)
+					throw std::invalid_argument("sketch size does not match the index");
+
+				const auto query = sketch.signature();
+
+				std::vector<sketch_match> matches;
+				matches.reserve(names_.size());
+
+				for (std::size_t i = 0u; i < names_.size(); ++i)
+				{
+					const std::span<const uint64_t> sig(values_.data() + i * size_, lengths_[i]);
+					matches.push_back(sketch_match { names_[i], frame_sketch::similarity(query, sig, size_) });
+				}
+
+				auto better = [](const sketch_match& a, const sketch_match& b)
+				{
+					return (a.similarity != b.similarity) ? (a.similarity > b.similarity) : (a.name < b.name);
+				};
+
+				k = std::min(k, matches.size());
+				std::partial_sort(matches.begin(), matches.begin() + k, matches.end(), better);
+				matches.resize(k);
+
+				return matches;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void sketch_index::save(const std::string& filename) const
+			{
+				std::vector<uint8_t> out(std::begin(INDEX_MAGIC), std::end(INDEX_MAGIC));
+				put_le<uint32_t>(out, static_cast<uint32_t>(size_));
+				put_le<uint32_t>(out, static_cast<uint32_t>(names_.size()));
+
+				for (std::size_t i = 0u; i < names_.size(); ++i)
+				{
+					put_le<uint32_t>(out, static_cast<uint32_t>(names_[i].size()));
+					out.insert(out.end(), names_[i].begin(), names_[i].end());
+
+					put_le<uint32_t>(out, lengths_[i]);
+					for (std::size_t j = 0u; j < lengths_[i]; ++j)
+						put_le<uint64_t>(out, values_[i * size_ + j]);
+				}
+
+				runtime::detail::replace_file(filename, out, "sketch index");
+			}
+
+			//------------------------------------------------------------------------------------------
+			sketch_index sketch_index::load(const std::string& filename)
+			{
+				std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+				if (!stm)
+					throw std::ios_base::failure("unable to open sketch index '" + filename + "'");
+
+				const std::vector<uint8_t> data((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+
+				if (stm.bad())
+					throw std::ios_base::failure("i/o error while reading sketch index '" + filename + "'");
+
+				if (data.size() < sizeof(INDEX_MAGIC) || std::memcmp(data.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+					throw bitstream_error("corrupt sketch index: bad header of '" + filename + "'");
+
+				index_reader in(std::span<const uint8_t>(data).subspan(sizeof(INDEX_MAGIC)), "corrupt sketch index: truncated file");
+				const uint32_t size = in.get<uint32_t>();
+				const uint32_t num_entries = in.get<uint32_t>();
+
+				// Each entry takes at least 8 bytes (name and signature length fields); the signature
+				// size is bounded by the file size (8 bytes per value) before the signatures are allocated
+				if (size == 0u || num_entries > data.size() / 8u || (num_entries > 0u && size > data.size() / 8u))
+					throw bitstream_error("corrupt sketch index: bad header of '" + filename + "'");
+
+				sketch_index index(size);
+				index.names_.reserve(num_entries);
+				index.lengths_.reserve(num_entries);
+				index.values_.reserve(static_cast<std::size_t>(num_entries) * size);
+
+				for (uint32_t i = 0u; i < num_entries; ++i)
+				{
+					const auto name = in.bytes(in.get<uint32_t>());
+					index.names_.emplace_back(reinterpret_cast<const char*>(name.data()), name.size());
+
+					const uint32_t length = in.get<uint32_t>();
+					if (length > size)
+						throw bitstream_error("corrupt sketch index: bad signature length in '" + filename + "'");
+
+					index.lengths_.push_back(length);
+					index.values_.resize(index.values_.size() + size, UNUSED);
+
+					for (uint32_t j = 0u; j < length; ++j)
+						index.values_[static_cast<std::size_t>(i) * size + j] = in.get<uint64_t>();
+				}
+
+				if (!in.at_end())
+					throw bitstream_error("corrupt sketch index: trailing data in '" + filename + "'");
+
+				return index;
+			}
+		}
+	}
+}
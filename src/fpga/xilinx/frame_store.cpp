@@ -0,0 +1,262 @@
+/**
+ * @file
+ * @brief Materialized configuration frames of a (multi-SLR) Xilinx FPGA.
+ */
+#include "unbit/fpga/xilinx/frame_store.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/fpga/xilinx/config_engine.hpp"
+#include "unbit/fpga/xilinx/config_context.hpp"
+#include "unbit/runtime/executor.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Configuration engine collecting the FDRI payload and IDCODE of each SLR.
+				 */
+				class fdri_collector final : public config_engine
+				{
+				public:
+					/**
+					 * @brief Collected per-SLR information (in configuration order).
+					 */
+					struct slr_info
+					{
+						word_span_type fdri;
+						std::optional<uint32_t> idcode;
+					};
+
+					std::vector<slr_info> slrs;
+
+				public:
+					fdri_collector()
+					{
+						// Do not scan trailing padding (or flash image contents) following the bitstream
+						set_stop_at_desync(true);
+					}
+					~fdri_collector() = default;
+
+				protected:
+					void on_config_idcode(uint32_t idcode) override
+					{
+						config_engine::on_config_idcode(idcode);
+						get_slr().idcode = idcode;
+					}
+
+					void on_config_fdri(word_span_type data) override
+					{
+						auto& slr = get_slr();
+
+						if (!slr.fdri.empty())
+							throw bitstream_error("multiple FDRI writes per SLR are not supported (compressed bitstream?)");
+
+						slr.fdri = data;
+					}
+
+				private:
+					slr_info& get_slr()
+					{
+						const uint32_t index = get_context().slr_index();
+						if (slrs.size() <= index)
+							slrs.resize(index + 1u);
+
+						return slrs[index];
+					}
+				};
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_store::frame_store() noexcept
+				: frame_words_(0u)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_store::frame_store(std::size_t frame_words, std::span<const std::size_t> frames_per_slr,
+				const frame_alloc_policy& policy)
+				: frame_words_(frame_words), policy_(policy)
+			{
+				if (frame_words == 0u)
+					throw std::invalid_argument("frame size must not be zero");
+
+				slrs_.resize(frames_per_slr.size());
+
+				for (std::size_t i = 0u; i < frames_per_slr.size(); ++i)
+				{
+					// Allocate (but do not touch) the storage.
+					slrs_[i].data       = frame_buffer(frames_per_slr[i] * frame_words, policy.pages);
+					slrs_[i].num_frames = frames_per_slr[i];
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_store::frame_store(frame_store&& other) noexcept = default;
+
+			//------------------------------------------------------------------------------------------
+			frame_store& frame_store::operator=(frame_store&& other) noexcept = default;
+
+			//------------------------------------------------------------------------------------------
+			frame_store::~frame_store()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_store frame_store::load(std::span<const uint32_t> cfg_data, std::size_t frame_words,
+				const frame_alloc_policy& policy)
+			{
+				if (frame_words == 0u)
+					throw std::invalid_argument("frame size must not be zero");
+
+				// Pass 1: Locate the FDRI payload of each SLR
+				fdri_collector collector;
+				collector.process(cfg_data);
+
+				std::vector<std::size_t> frames_per_slr(collector.slrs.size());
+				for (std::size_t i = 0u; i < collector.slrs.size(); ++i)
+				{
+					const auto& fdri = collector.slrs[i].fdri;
+					if ((fdri.size() % frame_words) != 0u)
+						throw bitstream_error("FDRI payload size is not a multiple of the frame size");
+
+					frames_per_slr[i] = fdri.size() / frame_words;
+				}
+
+				// Pass 2: Allocate and populate the frame buffers
+				frame_store store(frame_words, frames_per_slr, policy);
+
+				for (std::size_t i = 0u; i < collector.slrs.size(); ++i)
+					store.slrs_[i].idcode = collector.slrs[i].idcode;
+
+				auto populate = [&](std::size_t slr)
+				{
+					const auto& fdri = collector.slrs[slr].fdri;
+					std::copy(fdri.begin(), fdri.end(), store.slrs_[slr].data.data());
+				};
+
+				if (policy.first_touch && collector.slrs.size() > 1u)
+				{
+					// One task per SLR (the populating thread determines the NUMA placement)
+					runtime::parallel_for(0u, collector.slrs.size(), populate);
+				}
+				else
+				{
+					for (std::size_t i = 0u; i < collector.slrs.size(); ++i)
+						populate(i);
+				}
+
+				return store;
+			}
+
+			//------------------------------------------------------------------------------------------
+			const frame_store::slr_frames& frame_store::get_slr(std::size_t slr) const
+			{
+				if (slr >= slrs_.size())
+					throw std::out_of_range("slr index is out of range");
+
+				return slrs_[slr];
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_store::slr_frames& frame_store::get_slr(std::size_t slr)
+			{
+				if (slr >= slrs_.size())
+					throw std::out_of_range("slr index is out of range");
+
+				return slrs_[slr];
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t frame_store::num_frames(std::size_t slr) const
+			{
+				return get_slr(slr).num_frames;
+			}
+
+			//------------------------------------------------------------------------------------------
+			const std::optional<uint32_t>& frame_store::idcode(std::size_t slr) const
+			{
+				return get_slr(slr).idcode;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_store::set_idcode(std::size_t slr, uint32_t new_idcode)
+			{
+				get_slr(slr).idcode = new_idcode;
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::span<uint32_t> frame_store::words(std::size_t slr)
+			{
+				return get_slr(slr).data.words();
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::span<const uint32_t> frame_store::words(std::size_t slr) const
+			{
+				return get_slr(slr).data.words();
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::span<uint32_t> frame_store::frame(std::size_t slr, std::size_t frame)
+			{
+				auto& s = get_slr(slr);
+				if (frame >= s.num_frames)
+					throw std::out_of_range("frame index is out of range");
+
+				return s.data.words().subspan(frame * frame_words_, frame_words_);
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::span<const uint32_t> frame_store::frame(std::size_t slr, std::size_t frame) const
+			{
+				const auto& s = get_slr(slr);
+				if (frame >= s.num_frames)
+					throw std::out_of_range("frame index is out of range");
+
+				return s.data.words().subspan(frame * frame_words_, frame_words_);
+			}
+
+			//------------------------------------------------------------------------------------------
+			bool frame_store::read_bit(std::size_t slr, std::size_t bit_offset) const
+			{
+				const auto& s = get_slr(slr);
+				if ((bit_offset >> 5u) >= s.data.size())
+					throw std::out_of_range("bit offset is out of range");
+
+				return ((s.data.data()[bit_offset >> 5u] >> (bit_offset & 0x1Fu)) & 1u) != 0u;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_store::write_bit(std::size_t slr, std::size_t bit_offset, bool value)
+			{
+				auto& s = get_slr(slr);
+				if ((bit_offset >> 5u) >= s.data.size())
+					throw std::out_of_range("bit offset is out of range");
+
+				uint32_t& w = s.data.data()[bit_offset >> 5u];
+				const uint32_t mask = 1u << (bit_offset & 0x1Fu);
+
+				w = value ? (w | mask) : (w & ~mask);
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t frame_store::reserved_bytes() const noexcept
+			{
+				std::size_t total = 0u;
+
+				for (const auto& s : slrs_)
+					total += s.data.reserved_bytes();
+
+				return total;
+			}
+		}
+	}
+}
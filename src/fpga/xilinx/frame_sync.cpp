@@ -0,0 +1,729 @@
+/**
+ * @file
+ * @brief Synchronization of archived builds between hosts (Merkle tree walk over a byte stream).
+ */
+#include "unbit/fpga/xilinx/frame_sync.hpp"
+#include "unbit/runtime/byte_io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <unistd.h>
+# define UNBIT_HAVE_POSIX_IO 1
+#endif
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				using runtime::detail::put_le;
+
+				/**
+				 * @brief Maximum number of Merkle tree nodes per request.
+				 */
+				static constexpr std::size_t MAX_NODES_PER_REQUEST = 65536u;
+
+				/**
+				 * @brief Maximum size of the frame data per request (in bytes).
+				 */
+				static constexpr std::size_t MAX_FRAME_BYTES_PER_REQUEST = 16u * 1024u * 1024u;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Bounds-checked reader for little-endian integers in a message payload.
+				 */
+				class message_reader : public runtime::detail::le_reader<std::runtime_error>
+				{
+				public:
+					explicit message_reader(std::span<const uint8_t> data) noexcept
+						: le_reader(data, "corrupt sync message: truncated payload")
+					{
+					}
+
+					runtime::sha256::digest get_digest()
+					{
+						const auto b = bytes(runtime::sha256::DIGEST_SIZE);
+						runtime::sha256::digest result;
+						std::copy(b.begin(), b.end(), result.begin());
+						return result;
+					}
+
+					void expect_end() const
+					{
+						if (!at_end())
+							throw std::runtime_error("corrupt sync message: trailing data");
+					}
+				};
+			}
+
+			//------------------------------------------------------------------------------------------
+			sync_channel::sync_channel(int in_fd, int out_fd) noexcept
+				: in_fd_(in_fd), out_fd_(out_fd), bytes_sent_(0u), bytes_received_(0u)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			sync_channel::~sync_channel()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void sync_channel::send(uint32_t type, std::span<const uint8_t> payload)
+			{
+				if (payload.size() > MAX_PAYLOAD_SIZE)
+					throw std::invalid_argument("sync message payload is too large");
+
+				std::vector<uint8_t> message;
+				message.reserve(8u + payload.size());
+				put_le<uint32_t>(message, type);
+				put_le<uint32_t>(message, static_cast<uint32_t>(payload.size()));
+				message.insert(message.end(), payload.begin(), payload.end());
+
+#if defined(UNBIT_HAVE_POSIX_IO)
+				std::size_t pos = 0u;
+
+				while (pos < message.size())
+				{
+					const ssize_t n = ::write(out_fd_, message.data() + pos, message.size() - pos);
+
+					if (n < 0)
+					{
+						if (errno == EINTR)
+							continue;
+
+						throw std::system_error(errno, std::generic_category(), "i/o error while sending sync message");
+					}
+
+					pos += static_cast<std::size_t>(n);
+				}
+
+				bytes_sent_ += message.size();
+#else
+				throw std::runtime_error("sync channels are not supported on this platform");
+#endif
+			}
+
+			//------------------------------------------------------------------------------------------
+			bool sync_channel::receive(uint32_t& type, std::vector<uint8_t>& payload)
+			{
+#if defined(UNBIT_HAVE_POSIX_IO)
+				// Reads exactly n bytes (returns the number of bytes read before the end of the stream)
+				const auto read_fully = [this](uint8_t* data, std::size_t n)
+				{
+					std::size_t pos = 0u;
+
+					while (pos < n)
+					{
+						const ssize_t r = ::read(in_fd_, data + pos, n - pos);
+
+						if (r < 0)
+						{
+							if (errno == EINTR)
+								continue;
+
+							throw std::system_error(errno, std::generic_category(), "i/o error while receiving sync message");
+						}
+						else if (r == 0)
+						{
+							break;
+						}
+
+						pos += static_cast<std::size_t>(r);
+					}
+
+					bytes_received_ += pos;
+					return pos;
+				};
+
+				uint8_t header[8u];
+				const std::size_t n = read_fully(header, sizeof(header));
+
+				if (n == 0u)
+					return false;
+				else if (n != sizeof(header))
+					throw std::runtime_error("corrupt sync message: truncated header");
+
+				message_reader in(header);
+				type = in.get<uint32_t>();
+
+				const uint32_t size = in.get<uint32_t>();
+				if (size > MAX_PAYLOAD_SIZE)
+					throw std::runtime_error("corrupt sync message: payload is too large");
+
+				payload.resize(size);
+				if (read_fully(payload.data(), size) != size)
+					throw std::runtime_error("corrupt sync message: truncated payload");
+
+				return true;
+#else
+				static_cast<void>(type);
+				static_cast<void>(payload);
+				throw std::runtime_error("sync channels are not supported on this platform");
+#endif
+			}
+
+			//------------------------------------------------------------------------------------------
+			runtime::sha256::digest frame_sync::address_digest(std::span<const uint32_t> addresses) noexcept
+			{
+				return addresses.empty() ? runtime::sha256::digest {} : runtime::sha256::hash_be(addresses);
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_sync_server::frame_sync_server(const frame_archive& archive, int in_fd, int out_fd)
+				: archive_(archive), channel_(in_fd, out_fd)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_sync_server::~frame_sync_server()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void frame_sync_server::serve()
+			{
+				// The selected build
+				std::optional<archive_manifest> manifest;
+				frame_merkle trees;
+
+				const auto selected_slr = [&](message_reader& in) -> std::size_t
+				{
+					if (!manifest)
+						throw std::logic_error("no build selected");
+
+					const uint32_t slr = in.get<uint32_t>();
+					if (slr >= manifest->slrs.size())
+						throw std::out_of_range("slr index is out of range");
+
+					return slr;
+				};
+
+				uint32_t type;
+				std::vector<uint8_t> payload;
+
+				while (channel_.receive(type, payload))
+				{
+					if (type == frame_sync::MSG_BYE)
+						break;
+
+					std::vector<uint8_t> answer;
+					uint32_t answer_type = frame_sync::MSG_ERROR;
+
+					try
+					{
+						message_reader in(payload);
+
+						if (type == frame_sync::MSG_HELLO)
+						{
+							if (in.get<uint32_t>() != frame_sync::VERSION)
+								throw std::invalid_argument("unsupported protocol version");
+
+							put_le<uint32_t>(answer, frame_sync::VERSION);
+							answer_type = frame_sync::MSG_HELLO;
+						}
+						else if (type == frame_sync::MSG_INFO)
+						{
+							const std::string build(payload.begin(), payload.end());
+
+							manifest.reset();
+							answer_type = frame_sync::MSG_INFO;
+
+							if (!archive_.contains(build))
+							{
+								put_le<uint32_t>(answer, 0u);
+							}
+							else
+							{
+								manifest = archive_.manifest(build);
+								trees = archive_.merkle(build);
+
+								put_le<uint32_t>(answer, 1u);
+								put_le<uint32_t>(answer, static_cast<uint32_t>(manifest->frame_words));
+								put_le<uint32_t>(answer, static_cast<uint32_t>(manifest->slrs.size()));
+
+								for (std::size_t k = 0u; k < manifest->slrs.size(); ++k)
+								{
+									const auto& slr = manifest->slrs[k];
+
+									put_le<uint32_t>(answer, (slr.idcode ? frame_sync::SLR_HAS_IDCODE : 0u) |
+										(!slr.frame_addresses.empty() ? frame_sync::SLR_HAS_ADDRESSES : 0u));
+									put_le<uint32_t>(answer, slr.idcode.value_or(0u));
+									put_le<uint64_t>(answer, slr.frames.size());
+
+									const auto& root = trees.slr(k).root();
+									answer.insert(answer.end(), root.begin(), root.end());
+
+									const auto addresses = frame_sync::address_digest(slr.frame_addresses);
+									answer.insert(answer.end(), addresses.begin(), addresses.end());
+								}
+							}
+						}
+						else if (type == frame_sync::MSG_NODES)
+						{
+							const std::size_t slr = selected_slr(in);
+							const uint32_t level = in.get<uint32_t>();
+							const uint32_t count = in.get<uint32_t>();
+
+							if (count > MAX_NODES_PER_REQUEST || in.remaining() != count * sizeof(uint64_t))
+								throw std::invalid_argument("bad node request");
+
+							for (uint32_t i = 0u; i < count; ++i)
+							{
+								const auto& node = trees.slr(slr).node(level, static_cast<std::size_t>(in.get<uint64_t>()));
+								answer.insert(answer.end(), node.begin(), node.end());
+							}
+
+							answer_type = frame_sync::MSG_HASHES;
+						}
+						else if (type == frame_sync::MSG_FRAMES)
+						{
+							// Checks the selection before the manifest is accessed
+							const std::size_t k = selected_slr(in);
+							const auto& slr = manifest->slrs[k];
+							const uint32_t count = in.get<uint32_t>();
+
+							if (static_cast<uint64_t>(count) * manifest->frame_words * sizeof(uint32_t) > MAX_FRAME_BYTES_PER_REQUEST ||
+								in.remaining() != count * sizeof(uint64_t))
+							{
+								throw std::invalid_argument("bad frame request");
+							}
+
+							std::vector<frame_archive::frame_hash> hashes;
+							hashes.reserve(count);
+
+							for (uint32_t i = 0u; i < count; ++i)
+							{
+								const uint64_t index = in.get<uint64_t>();
+								if (index >= slr.frames.size())
+									throw std::out_of_range("frame index is out of range");
+
+								hashes.push_back(slr.frames[index]);
+							}
+
+							// Frames are sent in bitstream file order (big-endian)
+							answer.reserve(count * manifest->frame_words * sizeof(uint32_t));
+							for (const uint32_t w : archive_.read_frames(hashes, manifest->frame_words))
+							{
+								answer.push_back(static_cast<uint8_t>(w >> 24u));
+								answer.push_back(static_cast<uint8_t>(w >> 16u));
+								answer.push_back(static_cast<uint8_t>(w >> 8u));
+								answer.push_back(static_cast<uint8_t>(w));
+							}
+
+							answer_type = frame_sync::MSG_FRAME_DATA;
+						}
+						else if (type == frame_sync::MSG_ADDRESSES)
+						{
+							// Checks the selection before the manifest is accessed
+							const std::size_t k = selected_slr(in);
+							const auto& slr = manifest->slrs[k];
+							in.expect_end();
+
+							for (const uint32_t address : slr.frame_addresses)
+								put_le<uint32_t>(answer, address);
+
+							answer_type = frame_sync::MSG_ADDRESS_MAP;
+						}
+						else
+						{
+							throw std::invalid_argument("unknown request type " + std::to_string(type));
+						}
+					}
+					catch (const std::exception& e)
+					{
+						// Report the failed request, and continue with the next one
+						const std::string reason = e.what();
+
+						answer.assign(reason.begin(), reason.end());
+						answer_type = frame_sync::MSG_ERROR;
+					}
+
+					channel_.send(answer_type, answer);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_sync_client::frame_sync_client(int in_fd, int out_fd)
+				: channel_(in_fd, out_fd), round_trips_(0u)
+			{
+				std::vector<uint8_t> hello;
+				put_le<uint32_t>(hello, frame_sync::VERSION);
+
+				const auto answer = request(frame_sync::MSG_HELLO, hello, frame_sync::MSG_HELLO);
+
+				message_reader in(answer);
+				if (in.get<uint32_t>() != frame_sync::VERSION)
+					throw std::runtime_error("unsupported protocol version of the sync server");
+			}
+
+			//------------------------------------------------------------------------------------------
+			frame_sync_client::~frame_sync_client()
+			{
+				try
+				{
+					channel_.send(frame_sync::MSG_BYE, {});
+				}
+				catch (...)
+				{
+					// The server may already be gone
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::vector<uint8_t> frame_sync_client::request(uint32_t type, std::span<const uint8_t> payload, uint32_t answer)
+			{
+				channel_.send(type, payload);
+				++round_trips_;
+
+				uint32_t received_type;
+				std::vector<uint8_t> received;
+
+				if (!channel_.receive(received_type, received))
+					throw std::runtime_error("sync server closed the connection");
+
+				if (received_type == frame_sync::MSG_ERROR)
+					throw std::runtime_error("sync server error: " + std::string(received.begin(), received.end()));
+
+				if (received_type != answer)
+					throw std::runtime_error("corrupt sync message: unexpected message type");
+
+				return received;
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::vector<merkle_tree::node_hash> frame_sync_client::fetch_nodes(std::size_t slr, std::size_t level,
+				std::span<const std::size_t> indices)
+			{
+				std::vector<merkle_tree::node_hash> result;
+				result.reserve(indices.size());
+
+				for (std::size_t first = 0u; first < indices.size(); first += MAX_NODES_PER_REQUEST)
+				{
+					const auto batch = indices.subspan(first, std::min(indices.size() - first, MAX_NODES_PER_REQUEST));
+
+					std::vector<uint8_t> payload;
+					put_le<uint32_t>(payload, static_cast<uint32_t>(slr));
+					put_le<uint32_t>(payload, static_cast<uint32_t>(level));
+					put_le<uint32_t>(payload, static_cast<uint32_t>(batch.size()));
+
+					for (const std::size_t index : batch)
+						put_le<uint64_t>(payload, index);
+
+					const auto answer = request(frame_sync::MSG_NODES, payload, frame_sync::MSG_HASHES);
+					if (answer.size() != batch.size() * runtime::sha256::DIGEST_SIZE)
+						throw std::runtime_error("corrupt sync message: bad number of nodes");
+
+					message_reader in(answer);
+					for (std::size_t i = 0u; i < batch.size(); ++i)
+						result.push_back(in.get_digest());
+				}
+
+				return result;
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::optional<sync_build_info> frame_sync_client::info(const std::string& build)
+			{
+				const auto answer = request(frame_sync::MSG_INFO,
+					std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(build.data()), build.size()), frame_sync::MSG_INFO);
+
+				message_reader in(answer);
+				if (in.get<uint32_t>() == 0u)
+					return std::nullopt;
+
+				sync_build_info result;
+				result.frame_words = in.get<uint32_t>();
+
+				const uint32_t num_slrs = in.get<uint32_t>();
+				if (num_slrs > in.remaining())
+					throw std::runtime_error("corrupt sync message: bad number of slrs");
+
+				for (uint32_t k = 0u; k < num_slrs; ++k)
+				{
+					auto& slr = result.slrs.emplace_back();
+
+					const uint32_t flags = in.get<uint32_t>();
+					const uint32_t idcode = in.get<uint32_t>();
+
+					if ((flags & frame_sync::SLR_HAS_IDCODE) != 0u)
+						slr.idcode = idcode;
+
+					slr.has_addresses = (flags & frame_sync::SLR_HAS_ADDRESSES) != 0u;
+					slr.num_frames = static_cast<std::size_t>(in.get<uint64_t>());
+					slr.root = in.get_digest();
+					slr.address_digest = in.get_digest();
+				}
+
+				in.expect_end();
+				return result;
+			}
+
+			//------------------------------------------------------------------------------------------
+			sync_stats frame_sync_client::sync(frame_archive& local, const std::string& build, const std::string& base_build)
+			{
+				const uint64_t sent_before = channel_.bytes_sent();
+				const uint64_t received_before = channel_.bytes_received();
+				const std::size_t round_trips_before = round_trips_;
+
+				sync_stats stats;
+
+				const auto finish = [&]()
+				{
+					stats.round_trips = round_trips_ - round_trips_before;
+					stats.bytes_sent = channel_.bytes_sent() - sent_before;
+					stats.bytes_received = channel_.bytes_received() - received_before;
+					return stats;
+				};
+
+				const auto remote = info(build);
+				if (!remote)
+					throw std::out_of_range("build '" + build + "' does not exist on the sync server");
+
+				const auto same_trees = [&](const frame_merkle& trees)
+				{
+					if (trees.frame_words() != remote->frame_words || trees.num_slrs() != remote->slrs.size())
+						return false;
+
+					for (std::size_t k = 0u; k < trees.num_slrs(); ++k)
+					{
+						if (trees.slr(k).num_leaves() != remote->slrs[k].num_frames || trees.slr(k).root() != remote->slrs[k].root)
+							return false;
+					}
+
+					return true;
+				};
+
+				if (local.contains(build))
+				{
+					if (!same_trees(local.merkle(build)))
+						throw std::invalid_argument("build '" + build + "' exists in the local archive with different frames");
+
+					stats.up_to_date = true;
+					return finish();
+				}
+
+				// Trees and frame addresses of the base build (if any)
+				std::optional<archive_manifest> base_manifest;
+				frame_merkle base_trees;
+
+				if (!base_build.empty())
+				{
+					base_manifest = local.manifest(base_build);
+					base_trees = local.merkle(base_build);
+
+					if (base_trees.frame_words() != remote->frame_words)
+						base_manifest.reset();
+				}
+
+				std::vector<std::size_t> frames_per_slr;
+				for (const auto& slr : remote->slrs)
+					frames_per_slr.push_back(slr.num_frames);
+
+				frame_store frames(remote->frame_words, frames_per_slr);
+				std::vector<std::vector<uint32_t>> addresses(remote->slrs.size());
+				bool has_addresses = false;
+
+				for (std::size_t k = 0u; k < remote->slrs.size(); ++k)
+				{
+					const auto& slr = remote->slrs[k];
+
+					if (slr.idcode)
+						frames.set_idcode(k, *slr.idcode);
+
+					const merkle_tree* base_tree = (base_manifest && k < base_trees.num_slrs() &&
+						base_trees.slr(k).num_leaves() == slr.num_frames) ? &base_trees.slr(k) : nullptr;
+
+					// Find the frame digests of the build
+					std::vector<merkle_tree::node_hash> leaves;
+
+					if (base_tree)
+					{
+						// Walk the trees top-down (one round trip per level), following differing nodes only
+						leaves.assign(base_tree->leaves().begin(), base_tree->leaves().end());
+
+						std::vector<std::size_t> current;
+						std::vector<merkle_tree::node_hash> current_hashes;
+
+						if (slr.root != base_tree->root())
+						{
+							current.push_back(0u);
+							current_hashes.push_back(slr.root);
+						}
+
+						for (std::size_t level = base_tree->num_levels() - 1u; level-- > 0u && !current.empty(); )
+						{
+							const std::size_t size = base_tree->level_size(level);
+
+							std::vector<std::size_t> requested;
+							for (const std::size_t n : current)
+							{
+								if (2u * n + 1u < size)
+								{
+									requested.push_back(2u * n);
+									requested.push_back(2u * n + 1u);
+								}
+							}
+
+							const auto fetched = fetch_nodes(k, level, requested);
+							stats.nodes_received += fetched.size();
+
+							std::vector<std::size_t> next;
+							std::vector<merkle_tree::node_hash> next_hashes;
+							std::size_t pos = 0u;
+
+							for (std::size_t i = 0u; i < current.size(); ++i)
+							{
+								if (2u * current[i] + 1u < size)
+								{
+									for (std::size_t c = 0u; c < 2u; ++c, ++pos)
+									{
+										if (fetched[pos] != base_tree->node(level, requested[pos]))
+										{
+											next.push_back(requested[pos]);
+											next_hashes.push_back(fetched[pos]);
+										}
+									}
+								}
+								else
+								{
+									// Promoted node (same digest as its parent)
+									next.push_back(2u * current[i]);
+									next_hashes.push_back(current_hashes[i]);
+								}
+							}
+
+							current = std::move(next);
+							current_hashes = std::move(next_hashes);
+						}
+
+						for (std::size_t i = 0u; i < current.size(); ++i)
+							leaves[current[i]] = current_hashes[i];
+					}
+					else
+					{
+						// No comparable base tree, fetch all frame digests
+						std::vector<std::size_t> all(slr.num_frames);
+						for (std::size_t f = 0u; f < all.size(); ++f)
+							all[f] = f;
+
+						leaves = fetch_nodes(k, 0u, all);
+						stats.nodes_received += leaves.size();
+					}
+
+					if (merkle_tree(leaves).root() != slr.root)
+						throw std::runtime_error("frame digests of slr " + std::to_string(k) + " do not match the merkle tree root");
+
+					// Group the frames by their digest, and split them into local and remote frames
+					std::unordered_map<merkle_tree::node_hash, std::vector<std::size_t>, runtime::sha256_digest_hash> groups;
+					std::vector<merkle_tree::node_hash> local_hashes;
+					std::vector<merkle_tree::node_hash> remote_hashes;
+
+					for (std::size_t f = 0u; f < leaves.size(); ++f)
+					{
+						auto& group = groups[leaves[f]];
+
+						if (group.empty())
+							(local.contains_frame(leaves[f]) ? local_hashes : remote_hashes).push_back(leaves[f]);
+
+						group.push_back(f);
+					}
+
+					const std::size_t frame_words = remote->frame_words;
+
+					const auto store = [&](const merkle_tree::node_hash& hash, std::span<const uint32_t> frame)
+					{
+						for (const std::size_t f : groups[hash])
+							std::copy(frame.begin(), frame.end(), frames.frame(k, f).begin());
+					};
+
+					const auto local_data = local.read_frames(local_hashes, frame_words);
+					for (std::size_t i = 0u; i < local_hashes.size(); ++i)
+					{
+						store(local_hashes[i], std::span<const uint32_t>(local_data).subspan(i * frame_words, frame_words));
+						stats.frames_reused += groups[local_hashes[i]].size();
+					}
+
+					// Fetch the remaining frames (verified against their digests)
+					const std::size_t frames_per_request = std::max<std::size_t>(1u,
+						MAX_FRAME_BYTES_PER_REQUEST / std::max<std::size_t>(1u, frame_words * sizeof(uint32_t)));
+
+					std::vector<uint32_t> frame(frame_words);
+
+					for (std::size_t first = 0u; first < remote_hashes.size(); first += frames_per_request)
+					{
+						const std::size_t count = std::min(remote_hashes.size() - first, frames_per_request);
+
+						std::vector<uint8_t> payload;
+						put_le<uint32_t>(payload, static_cast<uint32_t>(k));
+						put_le<uint32_t>(payload, static_cast<uint32_t>(count));
+
+						for (std::size_t i = 0u; i < count; ++i)
+							put_le<uint64_t>(payload, groups[remote_hashes[first + i]].front());
+
+						const auto answer = request(frame_sync::MSG_FRAMES, payload, frame_sync::MSG_FRAME_DATA);
+						if (answer.size() != count * frame_words * sizeof(uint32_t))
+							throw std::runtime_error("corrupt sync message: bad size of frame data");
+
+						for (std::size_t i = 0u; i < count; ++i)
+						{
+							const uint8_t* const data = answer.data() + i * frame_words * sizeof(uint32_t);
+
+							for (std::size_t j = 0u; j < frame_words; ++j)
+							{
+								frame[j] = (static_cast<uint32_t>(data[4u * j]) << 24u) | (static_cast<uint32_t>(data[4u * j + 1u]) << 16u) |
+									(static_cast<uint32_t>(data[4u * j + 2u]) << 8u) | static_cast<uint32_t>(data[4u * j + 3u]);
+							}
+
+							if (runtime::sha256::hash_be(frame) != remote_hashes[first + i])
+								throw std::runtime_error("received frame does not match its digest");
+
+							store(remote_hashes[first + i], frame);
+							stats.frames_received += 1u;
+						}
+					}
+
+					// Frame addresses (reused from the base build if unchanged)
+					if (slr.has_addresses)
+					{
+						has_addresses = true;
+
+						if (base_manifest && k < base_manifest->slrs.size() &&
+							frame_sync::address_digest(base_manifest->slrs[k].frame_addresses) == slr.address_digest)
+						{
+							addresses[k] = base_manifest->slrs[k].frame_addresses;
+						}
+						else
+						{
+							std::vector<uint8_t> payload;
+							put_le<uint32_t>(payload, static_cast<uint32_t>(k));
+
+							const auto answer = request(frame_sync::MSG_ADDRESSES, payload, frame_sync::MSG_ADDRESS_MAP);
+							if (answer.size() != slr.num_frames * sizeof(uint32_t))
+								throw std::runtime_error("corrupt sync message: bad size of frame address map");
+
+							message_reader in(answer);
+							for (std::size_t f = 0u; f < slr.num_frames; ++f)
+								addresses[k].push_back(in.get<uint32_t>());
+
+							if (frame_sync::address_digest(addresses[k]) != slr.address_digest)
+								throw std::runtime_error("received frame address map does not match its digest");
+						}
+					}
+				}
+
+				local.add(build, frames, has_addresses ? std::span<const std::vector<uint32_t>>(addresses) :
+					std::span<const std::vector<uint32_t>>());
+
+				return finish();
+			}
+		}
+	}
+}
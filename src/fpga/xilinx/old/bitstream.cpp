@@ -42,6 +42,8 @@ namespace unbit
 			void bitstream::parse(std::istream& stm, std::function<bool(const packet&)> callback)
 			{
 				data_vector bs = load_binary_data(stm);
+				runtime::mem_account bs_account(runtime::mem_subsystem::input_buffers, bs.capacity());
+
 				parse(bs.cbegin(), bs.cend(), callback);
 			}
 
@@ -218,7 +220,9 @@ namespace unbit
 
 			//------------------------------------------------------------------------------------------
 			bitstream::bitstream(std::istream& stm, uint32_t idcode, bool accept_readback)
-				: data_(load_binary_data(stm)), is_readback_(false)
+				: data_(load_binary_data(stm)), is_readback_(false),
+				data_account_(runtime::mem_subsystem::input_buffers, data_.capacity()),
+				index_account_(runtime::mem_subsystem::packet_index)
 			{
 				// Bitstream format with synchronization word and header commands
 
@@ -382,11 +386,15 @@ namespace unbit
 					throw std::invalid_argument("unsupported bitstream features: bitstream did not"
 												" contain any frame data slices");
 				}
+
+				index_account_.resize(slrs_.capacity() * sizeof(slr_info));
 			}
 
 			//------------------------------------------------------------------------------------------
 			bitstream::bitstream(std::istream& stm, const bitstream& reference)
-				: data_(load_binary_data(stm)), is_readback_(true)
+				: data_(load_binary_data(stm)), is_readback_(true),
+				data_account_(runtime::mem_subsystem::input_buffers, data_.capacity()),
+				index_account_(runtime::mem_subsystem::packet_index)
 			{
 				// We replicate the layout information of the reference bitstream
 				//
@@ -484,13 +492,17 @@ namespace unbit
 						readback_storage_offset += fpga.back_padding();
 					}
 				}
+
+				index_account_.resize(slrs_.capacity() * sizeof(slr_info));
 			}
 
 			//------------------------------------------------------------------------------------------
 			bitstream::bitstream(bitstream&& other) noexcept
 				: slrs_(std::move(other.slrs_)),
 				data_(std::move(other.data_)),
-				is_readback_(std::move(other.is_readback_))
+				is_readback_(std::move(other.is_readback_)),
+				data_account_(std::move(other.data_account_)),
+				index_account_(std::move(other.index_account_))
 			{
 			}
 
@@ -674,6 +686,46 @@ namespace unbit
 				}
 			}
 
+			//------------------------------------------------------------------------------------------
+			void bitstream::read_frame_words(unsigned slr_idx, size_t first_word,
+											std::span<uint32_t> words) const
+			{
+				if (words.empty())
+					return;
+
+				check_frame_data_range(first_word * 4u, words.size() * 4u, slr_idx);
+
+				const uint8_t* src = data_.data() + slr(slr_idx).frame_data_offset + first_word * 4u;
+
+				for (auto& w : words)
+				{
+					w = (static_cast<uint32_t>(src[0u]) << 24u) | (static_cast<uint32_t>(src[1u]) << 16u) |
+						(static_cast<uint32_t>(src[2u]) << 8u) | static_cast<uint32_t>(src[3u]);
+					src += 4u;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void bitstream::write_frame_words(unsigned slr_idx, size_t first_word,
+											std::span<const uint32_t> words)
+			{
+				if (words.empty())
+					return;
+
+				check_frame_data_range(first_word * 4u, words.size() * 4u, slr_idx);
+
+				uint8_t* dst = data_.data() + slr(slr_idx).frame_data_offset + first_word * 4u;
+
+				for (const uint32_t w : words)
+				{
+					dst[0u] = static_cast<uint8_t>(w >> 24u);
+					dst[1u] = static_cast<uint8_t>(w >> 16u);
+					dst[2u] = static_cast<uint8_t>(w >> 8u);
+					dst[3u] = static_cast<uint8_t>(w);
+					dst += 4u;
+				}
+			}
+
 			//------------------------------------------------------------------------------------------
 			size_t bitstream::map_frame_data_offset(size_t offset) const
 			{
@@ -5,8 +5,10 @@
 #include "unbit/fpga/old/xilinx/bram.hpp"
 #include "unbit/fpga/old/xilinx/bitstream.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <limits>
 
 namespace unbit
 {
@@ -14,19 +16,6 @@ namespace unbit
 	{
 		namespace xilinx
 		{
-			//------------------------------------------------------------------------------------------
-			bram::bram(unsigned x, unsigned y, size_t num_words, size_t data_bits, size_t parity_bits,
-					bram_category category, size_t bitstream_offset, unsigned slr)
-				: slr_(slr), x_(x), y_(y), num_words_(num_words), data_bits_(data_bits),
-				parity_bits_(parity_bits), category_(category), bitstream_offset_(bitstream_offset)
-			{
-			}
-
-			//------------------------------------------------------------------------------------------
-			bram::~bram()
-			{
-			}
-
 			//------------------------------------------------------------------------------------------
 			size_t bram::map_via_table(size_t bit_addr, const uint32_t* map_table,
 									size_t table_size) const
@@ -41,73 +30,36 @@ namespace unbit
 			}
 
 			//------------------------------------------------------------------------------------------
-			std::vector<uint8_t> bram::extract(const bitstream& bits, bool extract_parity) const
+			void bram::map_range_to_bitstream(size_t first_bit, bool is_parity,
+											std::span<size_t> offsets) const
 			{
-				// Determine the length (in bits)
-				const size_t bit_length = (extract_parity ? parity_bits_ : data_bits_) * num_words_;
-				const size_t byte_length = (bit_length + 7u) / 8u;
-
-				// Prepare the result array
-				std::vector<uint8_t> extracted(byte_length);
-
-				// Extract data (bit-wise)
-				for (size_t i = 0u; i < bit_length; ++i)
-				{
-					const size_t src_bit = map_to_bitstream(i, extract_parity);
-
-					// Extract the source value and update the extracted byte array
-					if (bits.read_frame_data_bit(src_bit, slr_))
-						extracted[i / 8u] |= 1u << (i % 8u);
-				}
-
-				// Done
-				return extracted;
+				for (size_t k = 0u; k < offsets.size(); ++k)
+					offsets[k] = map_to_bitstream(first_bit + k, is_parity);
 			}
 
 			//------------------------------------------------------------------------------------------
-			bool bram::extract_bit(const bitstream& bits, size_t offset, bool extract_parity) const
+			std::pair<size_t, size_t> bram::map_word_range(bool is_parity) const
 			{
-				const size_t src_bit = map_to_bitstream(offset, extract_parity);
-
-				// Extract the source value and update the extracted byte array
-				return bits.read_frame_data_bit(src_bit, slr_);
-			}
+				const size_t bit_length = (is_parity ? parity_bits_ : data_bits_) * num_words_;
 
-			//------------------------------------------------------------------------------------------
-			void bram::inject(bitstream& bits, bool inject_parity,
-							const std::vector<uint8_t>& data) const
-			{
-				// Determine the length (in bits)
-				const size_t bit_length = (inject_parity ? parity_bits_ : data_bits_) * num_words_;
-				const size_t byte_length = (bit_length + 7u) / 8u;
+				if (bit_length == 0u)
+					return { 0u, 0u };
 
-				if (data.size() != byte_length)
-					throw std::invalid_argument("size of data to be injected does not match"
-												" block ram size");
+				std::array<size_t, map_chunk_bits> bits;
+				size_t lo = std::numeric_limits<size_t>::max();
+				size_t hi = 0u;
 
-				// Extract data (bit-wise)
-				for (size_t i = 0u; i < bit_length; ++i)
+				for (size_t first = 0u; first < bit_length; first += map_chunk_bits)
 				{
-					const size_t dst_bit = map_to_bitstream(i, inject_parity);
+					const size_t count = std::min(map_chunk_bits, bit_length - first);
+					map_range_to_bitstream(first, is_parity, std::span<size_t>(bits.data(), count));
 
-					const size_t src_byte_index = (i / 8u);
-					const size_t src_bit_shift = (i % 8u);
-
-					const bool src_value =
-						static_cast<bool>((data[src_byte_index] >> src_bit_shift) & 1u);
-
-					// Inject into the bitstream
-					bits.write_frame_data_bit(dst_bit, src_value, slr_);
+					const auto [min_it, max_it] = std::minmax_element(bits.begin(), bits.begin() + count);
+					lo = std::min(lo, *min_it / 32u);
+					hi = std::max(hi, *max_it / 32u);
 				}
-			}
-
-			//------------------------------------------------------------------------------------------
-			void bram::inject_bit(bitstream& bits, size_t offset, bool inject_parity, bool value) const
-			{
-				const size_t dst_bit = map_to_bitstream(offset, inject_parity);
 
-				// Inject into the bitstream
-				bits.write_frame_data_bit(dst_bit, value, slr_);
+				return { lo, hi - lo + 1u };
 			}
 
 			//------------------------------------------------------------------------------------------
@@ -0,0 +1,200 @@
+/**
+ * @file
+ * @brief Support for Xilinx logic location files (LUT INIT extraction and injection).
+ */
+#include "unbit/fpga/old/xilinx/logic_location.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <map>
+#include <string_view>
+
+namespace unbit
+{
+	namespace old
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				//--------------------------------------------------------------------------------------
+				/**
+				* @brief Splits the next whitespace-separated token from a line.
+				*/
+				static std::string_view next_token(std::string_view& line)
+				{
+					const size_t start = line.find_first_not_of(" \t\r");
+					if (start == std::string_view::npos)
+					{
+						line = std::string_view();
+						return std::string_view();
+					}
+
+					const size_t end = line.find_first_of(" \t\r", start);
+					const std::string_view token = line.substr(start, end - start);
+
+					line = (end == std::string_view::npos) ? std::string_view() : line.substr(end);
+					return token;
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				* @brief Parses a decimal number (with an optional non-digit prefix, e.g. "BIT12").
+				*/
+				static bool parse_number(std::string_view text, size_t& value)
+				{
+					const size_t digits = text.find_first_of("0123456789");
+					if (digits == std::string_view::npos)
+						return false;
+
+					const char* const end = text.data() + text.size();
+					const auto [ptr, ec] = std::from_chars(text.data() + digits, end, value);
+
+					return ec == std::errc() && ptr == end;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			logic_location::logic_location(unsigned slr)
+				: slr_(slr)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			size_t logic_location::find_lut(const std::string& name) const
+			{
+				const auto it = index_.find(name);
+				if (it == index_.end())
+					throw std::invalid_argument("lut '" + name + "' is not listed in the logic location file");
+
+				return it->second;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void logic_location::add_lut_bit(const std::string& name, size_t init_bit, size_t bit_offset)
+			{
+				if (init_bit >= lut_bits)
+					throw std::invalid_argument("lut init bit index is out of range");
+
+				const auto [it, inserted] = index_.try_emplace(name, luts_.size());
+				if (inserted)
+				{
+					lut_cell& cell = luts_.emplace_back();
+					cell.name = name;
+					cell.bits.fill(0u);
+				}
+
+				lut_cell& cell = luts_[it->second];
+				cell.bits[init_bit] = bit_offset;
+				cell.mask |= static_cast<uint64_t>(1u) << init_bit;
+			}
+
+			//------------------------------------------------------------------------------------------
+			logic_location logic_location::load(const std::string& filename, unsigned slr)
+			{
+				std::ifstream stm(filename, std::ios_base::in);
+				if (!stm)
+					throw std::runtime_error("failed to open the logic location file '" + filename + "'");
+
+				return parse(stm, slr);
+			}
+
+			//------------------------------------------------------------------------------------------
+			logic_location logic_location::parse(std::istream& stm, unsigned slr)
+			{
+				logic_location ll(slr);
+				std::string line;
+				std::string name;
+
+				while (std::getline(stm, line))
+				{
+					std::string_view rest(line);
+
+					// Bit <offset> <frame address> <frame offset> <kw>=<value> ...
+					if (next_token(rest) != "Bit")
+						continue;
+
+					size_t bit_offset = 0u;
+					if (!parse_number(next_token(rest), bit_offset))
+						throw std::runtime_error("malformed bit offset in logic location file");
+
+					next_token(rest); // Frame address
+					next_token(rest); // Frame offset
+
+					std::string_view block;
+					std::string_view cell;
+
+					for (std::string_view token = next_token(rest); !token.empty(); token = next_token(rest))
+					{
+						if (token.starts_with("Block="))
+						{
+							block = token.substr(6u);
+						}
+						else if (token.starts_with("Ram=") || token.starts_with("Rom="))
+						{
+							cell = token.substr(4u);
+						}
+					}
+
+					// LUT cells are the Ram/Rom bits of SLICE sites (block RAMs are handled by the bram classes)
+					if (!block.starts_with("SLICE") || cell.empty())
+						continue;
+
+					const size_t colon = cell.find(':');
+					size_t init_bit = 0u;
+
+					if (colon == std::string_view::npos || !parse_number(cell.substr(colon + 1u), init_bit))
+						throw std::runtime_error("malformed ram/rom bit in logic location file");
+
+					name.assign(block);
+					name.push_back('/');
+					name.append(cell.substr(0u, colon));
+
+					ll.add_lut_bit(name, init_bit, bit_offset);
+				}
+
+				if (stm.bad())
+					throw std::runtime_error("failed to read the logic location file");
+
+				return ll;
+			}
+
+			//------------------------------------------------------------------------------------------
+			lut_init_plan::lut_init_plan(const fpga& fpga, const logic_location& ll, std::span<const size_t> luts)
+				: slr_(ll.slr()), frame_words_(fpga.frame_size() / 4u)
+			{
+				const size_t frame_bits = frame_words_ * 32u;
+
+				// Group the INIT bits of all LUTs by frame
+				std::map<size_t, std::vector<bit_request>> groups;
+
+				masks_.reserve(luts.size());
+
+				for (size_t i = 0u; i < luts.size(); ++i)
+				{
+					const auto& cell = ll.lut(luts[i]);
+					masks_.push_back(cell.mask);
+
+					for (size_t b = 0u; b < logic_location::lut_bits; ++b)
+					{
+						if (!((cell.mask >> b) & 1u))
+							continue;
+
+						const size_t offset = cell.bits[b];
+
+						groups[offset / frame_bits].push_back(bit_request {
+							static_cast<uint32_t>(offset % frame_bits), static_cast<uint32_t>(i), static_cast<uint32_t>(b) });
+					}
+				}
+
+				frames_.reserve(groups.size());
+
+				for (auto& [frame, bits] : groups)
+				{
+					frames_.push_back(frame_group { frame, std::move(bits) });
+				}
+			}
+		}
+	}
+}
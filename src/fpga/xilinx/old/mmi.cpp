@@ -42,6 +42,27 @@ namespace unbit
 					return std::make_unique<cpu_memory_map>(xdoc, xproc);
 				}
 
+				//-------------------------------------------------------------------------------------
+				std::vector<std::unique_ptr<memory_map>> memory_map::load_all(const std::string& filename)
+				{
+					xml_doc xdoc(filename);
+
+					// One memory map per processor node (sharing the parsed document)
+					xpath_context xctx(xdoc);
+					auto xnodes = xctx.query("/MemInfo/Processor");
+
+					std::vector<std::unique_ptr<memory_map>> maps;
+					maps.reserve(xnodes.node_count());
+
+					for (size_t i = 0u; i < xnodes.node_count(); ++i)
+					{
+						auto xproc = xnodes.node_at(static_cast<unsigned>(i));
+						maps.push_back(std::make_unique<cpu_memory_map>(xdoc, xproc));
+					}
+
+					return maps;
+				}
+
 				//-------------------------------------------------------------------------------------
 				memory_map::memory_map()
 				{
@@ -53,26 +74,94 @@ namespace unbit
 				}
 
 				//-------------------------------------------------------------------------------------
-				uint8_t memory_map::read_byte(const fpga& fpga, const bitstream& bs,
-											uint64_t byte_addr) const
+				bram_write_plan::bram_write_plan(const fpga& fpga)
+					: fpga_(fpga)
+				{
+				}
+
+				//-------------------------------------------------------------------------------------
+				const std::vector<memory_map::region_plan>& bram_write_plan::plans_of(const memory_map& map)
 				{
-					uint8_t value = 0u;
-					for (size_t i = 0u; i < 8u; ++i)
+					auto [it, inserted] = plans_.try_emplace(&map);
+					if (inserted)
 					{
-						value |= ((uint8_t) read_bit(fpga, bs, byte_addr * 8u + i)) << i;
+						it->second.reserve(map.num_regions());
+
+						for (size_t index = 0u; index < map.num_regions(); ++index)
+						{
+							it->second.push_back(map.plan_region(fpga_, index));
+						}
 					}
 
-					return value;
+					return it->second;
 				}
 
 				//-------------------------------------------------------------------------------------
-				void memory_map::write_byte(bitstream& bs, const fpga& fpga,
-											uint64_t byte_addr, uint8_t value) const
+				void bram_write_plan::add(const memory_map& map, uint64_t address, std::span<const uint8_t> data)
 				{
-					for (size_t i = 0u; i < 8u; ++i)
+					const auto& plans = plans_of(map);
+					size_t index = 0u;
+
+					for (size_t i = 0u; i < data.size(); ++i)
 					{
-						const bool bit_value = !!((value >> i) & 1u);
-						write_bit(bs, fpga, byte_addr * 8u + i, bit_value);
+						const uint64_t byte_addr = address + i;
+
+						// Find the region of the byte (images rarely leave the region of their previous byte)
+						if (index >= map.num_regions() || byte_addr < map.region(index).start_bit_addr() / 8u ||
+							byte_addr > map.region(index).end_bit_addr() / 8u)
+						{
+							index = 0u;
+							while (index < map.num_regions() && (byte_addr < map.region(index).start_bit_addr() / 8u ||
+																 byte_addr > map.region(index).end_bit_addr() / 8u))
+							{
+								++index;
+							}
+
+							if (index == map.num_regions())
+							{
+								throw std::out_of_range("byte to be written is not covered by the memory map");
+							}
+						}
+
+						const auto& plan = plans[index];
+						const uint64_t region_bit = (byte_addr - map.region(index).start_bit_addr() / 8u) * 8u;
+
+						for (size_t k = 0u; k < 8u; ++k)
+						{
+							const size_t w = static_cast<size_t>((region_bit + k) / plan.word_size);
+							const size_t b = static_cast<size_t>((region_bit + k) % plan.word_size);
+
+							const auto& lane = plan.lanes[plan.owners[b]];
+
+							const auto [ram_it, inserted] = ram_index_.try_emplace(lane.ram, rams_.size());
+							if (inserted)
+							{
+								const size_t bram_bytes = (lane.ram->data_bits() * lane.ram->num_words() + 7u) / 8u;
+								rams_.push_back(ram_writes { lane.ram, std::vector<uint8_t>(bram_bytes),
+															 std::vector<uint8_t>(bram_bytes) });
+							}
+
+							auto& writes = rams_[ram_it->second];
+
+							const size_t bram_bit = w * (lane.msb - lane.lsb + 1u) + (b - lane.lsb);
+							if (bram_bit / 8u >= writes.mask.size())
+							{
+								throw std::out_of_range("bit address to be mapped is out of bounds");
+							}
+
+							const uint8_t bit_mask = static_cast<uint8_t>(1u << (bram_bit % 8u));
+
+							if (!(writes.mask[bram_bit / 8u] & bit_mask))
+							{
+								writes.mask[bram_bit / 8u] |= bit_mask;
+								++num_bits_;
+							}
+
+							if ((data[i] >> k) & 1u)
+								writes.data[bram_bit / 8u] |= bit_mask;
+							else
+								writes.data[bram_bit / 8u] &= static_cast<uint8_t>(~bit_mask);
+						}
 					}
 				}
 			}
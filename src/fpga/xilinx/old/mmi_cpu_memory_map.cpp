@@ -231,11 +231,29 @@ namespace unbit
 					return result;
 				}
 
+				//-------------------------------------------------------------------------------------
+				/**
+				* @brief Estimates the heap footprint of the address spaces of a memory map.
+				*/
+				static size_t get_mmi_footprint(const std::vector<cpu_memory_map::mmi_space>& spaces)
+				{
+					size_t total = spaces.capacity() * sizeof(cpu_memory_map::mmi_space);
+
+					for (const auto& space : spaces)
+					{
+						total += space.lanes.capacity() * sizeof(cpu_memory_map::mmi_bitlane);
+						total += space.region_name.capacity();
+					}
+
+					return total;
+				}
+
 				//-------------------------------------------------------------------------------------
 				cpu_memory_map::cpu_memory_map(xml_doc& xdoc, xml_node& xproc)
 					: spaces_(get_mmi_spaces(xdoc, xproc)),
 					name_(xproc.attribute("InstPath")),
-					endianness_(get_processor_endianness(xproc))
+					endianness_(get_processor_endianness(xproc)),
+					account_(runtime::mem_subsystem::mmi_maps, get_mmi_footprint(spaces_))
 				{
 				}
 
@@ -244,6 +262,12 @@ namespace unbit
 				{
 				}
 
+				//-------------------------------------------------------------------------------------
+				const std::string& cpu_memory_map::name() const
+				{
+					return name_;
+				}
+
 				//-------------------------------------------------------------------------------------
 				endian cpu_memory_map::endianness() const
 				{
@@ -345,10 +369,9 @@ namespace unbit
 				}
 
 				//-------------------------------------------------------------------------------------
-				bool cpu_memory_map::read_bit(const fpga& fpga, const bitstream& bs,
-											uint64_t bit_addr) const
+				memory_map::bit_location cpu_memory_map::locate_bit(const fpga& fpga, uint64_t bit_addr) const
 				{
-					// Map the bit to a block RAM, then extract
+					// Map the bit to a block RAM
 					const auto mapping = map_bit_address(bit_addr);
 
 					// Resolve the block RAM
@@ -356,24 +379,52 @@ namespace unbit
 														std::get<0>(mapping).x,
 														std::get<0>(mapping).y);
 
-					// And extract
-					return bram.extract_bit(bs, std::get<1>(mapping), std::get<2>(mapping));
+					return bit_location { &bram, std::get<1>(mapping), std::get<2>(mapping) };
 				}
 
 				//-------------------------------------------------------------------------------------
-				void cpu_memory_map::write_bit(bitstream& bs, const fpga& fpga,
-											uint64_t bit_addr, bool value) const
+				memory_map::region_plan cpu_memory_map::plan_region(const fpga& fpga, size_t index) const
 				{
-					// Map the bit to a block RAM, then extract
-					const auto mapping = map_bit_address(bit_addr);
+					const auto& space = spaces_.at(index);
 
-					// Resolve the block RAM
-					const auto& bram = fpga.bram_by_loc(std::get<0>(mapping).type,
-														std::get<0>(mapping).x,
-														std::get<0>(mapping).y);
+					region_plan plan;
+					plan.num_bytes = space.end_byte_addr - space.start_byte_addr + 1u;
+					plan.word_size = space.word_size;
+					plan.num_words = space.total_num_words;
+					plan.owners.resize(space.word_size);
+
+					// Assign each bit position of a word to its lane (first match, as in map_to_lane)
+					std::vector<const mmi_bitlane*> owners(space.word_size, nullptr);
+					for (size_t b = 0u; b < space.word_size; ++b)
+					{
+						owners[b] = &map_to_lane(space, b);
+					}
+
+					// Resolve the block RAM of each lane that owns at least one bit
+					for (const auto& lane : space.lanes)
+					{
+						if (std::find(owners.begin(), owners.end(), &lane) == owners.end())
+						{
+							// Shadowed by a preceding lane
+							continue;
+						}
+
+						if (lane.parity_bits > 0)
+						{
+							throw std::logic_error("parity bits are not (yet) implemented correctly");
+						}
+
+						for (size_t b = 0u; b < space.word_size; ++b)
+						{
+							if (owners[b] == &lane)
+								plan.owners[b] = plan.lanes.size();
+						}
+
+						const auto& bram = fpga.bram_by_loc(lane.bram.type, lane.bram.x, lane.bram.y);
+						plan.lanes.push_back(region_lane { &bram, lane.lsb, lane.msb });
+					}
 
-					// And inject
-					bram.inject_bit(bs, std::get<1>(mapping), std::get<2>(mapping), value);
+					return plan;
 				}
 			}
 		}
@@ -7,6 +7,7 @@
 
 #include "unbit/fpga/old/xilinx/mmi.hpp"
 #include "unbit/xml/xml.hpp"
+#include "unbit/runtime/mem_stats.hpp"
 
 namespace unbit
 {
@@ -119,6 +120,11 @@ namespace unbit
 					*/
 					const endian endianness_;
 
+					/**
+					* @brief Memory accounting for the address spaces and bit lanes
+					*/
+					runtime::mem_account account_;
+
 				public:
 					/**
 					* @brief Constructs a memory map from the given processor node.
@@ -135,6 +141,11 @@ namespace unbit
 					*/
 					virtual ~cpu_memory_map();
 
+					/**
+					* @brief Gets the instance name (InstPath) of this processor.
+					*/
+					virtual const std::string& name() const override;
+
 					/**
 					* @brief Gets the byte endianness of the memory map.
 					*/
@@ -153,16 +164,15 @@ namespace unbit
 					virtual const memory_region& region(size_t index) const override;
 
 					/**
-					* @brief Reads a single bit
+					* @brief Locates a single bit in the underlying block RAMs.
 					*/
-					virtual bool read_bit(const fpga& fpga, const bitstream& bs,
-										uint64_t bit_addr) const override;
+					virtual bit_location locate_bit(const fpga& fpga, uint64_t bit_addr) const override;
 
 					/**
-					* @brief Writes a single bit
+					* @brief Plans the extraction of a complete region (one block RAM per bit lane)
 					*/
-					virtual void write_bit(bitstream& bs, const fpga& fpga,
-										uint64_t bit_addr, bool value) const override;
+					virtual region_plan plan_region(const fpga& fpga, size_t index) const override;
+
 				protected:
 					/**
 					* @brief Maps a bit address to an address.
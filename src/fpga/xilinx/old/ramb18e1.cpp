@@ -50,6 +50,21 @@ namespace unbit
 					return ramb36.map_to_bitstream(bit_addr + (is_top ? 16384u : 0u), false);
 				}
 			}
+
+			//------------------------------------------------------------------------------------------
+			void ramb18e1::map_range_to_bitstream(size_t first_bit, bool is_parity,
+											std::span<size_t> offsets) const
+			{
+				// Consecutive bits of a half are consecutive bits of the enclosing RAMB36E1
+				if (is_parity)
+				{
+					ramb36.map_range_to_bitstream(first_bit + (is_top ? 2048u : 0u), true, offsets);
+				}
+				else
+				{
+					ramb36.map_range_to_bitstream(first_bit + (is_top ? 16384u : 0u), false, offsets);
+				}
+			}
 		}
 	}
 }
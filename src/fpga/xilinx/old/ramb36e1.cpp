@@ -163,6 +163,22 @@ namespace unbit
 					return bitstream_offset_ + ramb36e1_map_data_bit(bit_addr);
 				}
 			}
+
+			//------------------------------------------------------------------------------------------
+			void ramb36e1::map_range_to_bitstream(size_t first_bit, bool is_parity,
+											std::span<size_t> offsets) const
+			{
+				if (is_parity)
+				{
+					for (size_t k = 0u; k < offsets.size(); ++k)
+						offsets[k] = bitstream_offset_ + ramb36e1_map_parity_bit(static_cast<uint32_t>(first_bit + k));
+				}
+				else
+				{
+					for (size_t k = 0u; k < offsets.size(); ++k)
+						offsets[k] = bitstream_offset_ + ramb36e1_map_data_bit(static_cast<uint32_t>(first_bit + k));
+				}
+			}
 		}
 	}
 }
@@ -1,10 +1,12 @@
 /**
  * @file
- * @brief RAMB36E2 block RAM tile (Virtex UltraScale+)
+ * @brief RAMB36E2 and RAMB18E2 block RAM tiles (Virtex UltraScale+)
  */
 #include "unbit/fpga/old/xilinx/vup.hpp"
 #include "unbit/fpga/old/xilinx/bram.hpp"
 
+#include <array>
+
 namespace unbit
 {
 	namespace old
@@ -23,70 +25,132 @@ namespace unbit
 			//
 			//------------------------------------------------------------------------------------------
 
-			///! @brief Maps from (relative) data-bit addresses to BRAM-relative bit offsets
-			static uint32_t ramb36e2_map_data_bit(const uint32_t data_offset)
+			///! @brief Mapping table for the lower 8 bits of data-bit offsets (128 entry blocks)
+			static constexpr std::array<uint8_t, 128u> ramb36e2_data_bit_table =
 			{
-				// Mapping table for the lower 8 bits of the result
-				static const uint8_t bit_table[] =
-				{
-					0x00u, 0x84u, 0x0Cu, 0x90u, 0x18u, 0x9Cu, 0x24u, 0xA8u,
-					0x3Cu, 0xC0u, 0x48u, 0xCCu, 0x54u, 0xD8u, 0x60u, 0xE4u,
-					0x06u, 0x8Au, 0x12u, 0x96u, 0x1Eu, 0xA2u, 0x2Au, 0xAEu,
-					0x42u, 0xC6u, 0x4Eu, 0xD2u, 0x5Au, 0xDEu, 0x66u, 0xEAu,
-					0x03u, 0x87u, 0x0Fu, 0x93u, 0x1Bu, 0x9Fu, 0x27u, 0xABu,
-					0x3Fu, 0xC3u, 0x4Bu, 0xCFu, 0x57u, 0xDBu, 0x63u, 0xE7u,
-					0x09u, 0x8Du, 0x15u, 0x99u, 0x21u, 0xA5u, 0x2Du, 0xB1u,
-					0x45u, 0xC9u, 0x51u, 0xD5u, 0x5Du, 0xE1u, 0x69u, 0xEDu,
-					0x02u, 0x86u, 0x0Eu, 0x92u, 0x1Au, 0x9Eu, 0x26u, 0xAAu,
-					0x3Eu, 0xC2u, 0x4Au, 0xCEu, 0x56u, 0xDAu, 0x62u, 0xE6u,
-					0x08u, 0x8Cu, 0x14u, 0x98u, 0x20u, 0xA4u, 0x2Cu, 0xB0u,
-					0x44u, 0xC8u, 0x50u, 0xD4u, 0x5Cu, 0xE0u, 0x68u, 0xECu,
-					0x05u, 0x89u, 0x11u, 0x95u, 0x1Du, 0xA1u, 0x29u, 0xADu,
-					0x41u, 0xC5u, 0x4Du, 0xD1u, 0x59u, 0xDDu, 0x65u, 0xE9u,
-					0x0Bu, 0x8Fu, 0x17u, 0x9Bu, 0x23u, 0xA7u, 0x2Fu, 0xB3u,
-					0x47u, 0xCBu, 0x53u, 0xD7u, 0x5Fu, 0xE3u, 0x6Bu, 0xEFu
-				};
+				0x00u, 0x84u, 0x0Cu, 0x90u, 0x18u, 0x9Cu, 0x24u, 0xA8u,
+				0x3Cu, 0xC0u, 0x48u, 0xCCu, 0x54u, 0xD8u, 0x60u, 0xE4u,
+				0x06u, 0x8Au, 0x12u, 0x96u, 0x1Eu, 0xA2u, 0x2Au, 0xAEu,
+				0x42u, 0xC6u, 0x4Eu, 0xD2u, 0x5Au, 0xDEu, 0x66u, 0xEAu,
+				0x03u, 0x87u, 0x0Fu, 0x93u, 0x1Bu, 0x9Fu, 0x27u, 0xABu,
+				0x3Fu, 0xC3u, 0x4Bu, 0xCFu, 0x57u, 0xDBu, 0x63u, 0xE7u,
+				0x09u, 0x8Du, 0x15u, 0x99u, 0x21u, 0xA5u, 0x2Du, 0xB1u,
+				0x45u, 0xC9u, 0x51u, 0xD5u, 0x5Du, 0xE1u, 0x69u, 0xEDu,
+				0x02u, 0x86u, 0x0Eu, 0x92u, 0x1Au, 0x9Eu, 0x26u, 0xAAu,
+				0x3Eu, 0xC2u, 0x4Au, 0xCEu, 0x56u, 0xDAu, 0x62u, 0xE6u,
+				0x08u, 0x8Cu, 0x14u, 0x98u, 0x20u, 0xA4u, 0x2Cu, 0xB0u,
+				0x44u, 0xC8u, 0x50u, 0xD4u, 0x5Cu, 0xE0u, 0x68u, 0xECu,
+				0x05u, 0x89u, 0x11u, 0x95u, 0x1Du, 0xA1u, 0x29u, 0xADu,
+				0x41u, 0xC5u, 0x4Du, 0xD1u, 0x59u, 0xDDu, 0x65u, 0xE9u,
+				0x0Bu, 0x8Fu, 0x17u, 0x9Bu, 0x23u, 0xA7u, 0x2Fu, 0xB3u,
+				0x47u, 0xCBu, 0x53u, 0xD7u, 0x5Fu, 0xE3u, 0x6Bu, 0xEFu
+			};
+
+			///! @brief Mapping table for the lower 4 bits of parity-bit offsets (16 entry blocks)
+			static constexpr std::array<uint8_t, 16u> ramb36e2_parity_bit_table =
+			{
+				0x30u, 0xB4u, 0x36u, 0xBAu, 0x33u, 0xB7u, 0x39u, 0xBDu,
+				0x32u, 0xB6u, 0x38u, 0xBCu, 0x35u, 0xB9u, 0x3Bu, 0xBFu
+			};
 
+			///! @brief Block scale offset (one configuration frame per block)
+			static constexpr uint32_t ramb36e2_block_scale = 0xBA0u;
+
+			//------------------------------------------------------------------------------------------
+			///! @brief Maps from (relative) data-bit addresses to BRAM-relative bit offsets
+			static constexpr uint32_t ramb36e2_map_data_bit(const uint32_t data_offset)
+			{
 				if (data_offset >= 32768u)
 					throw std::out_of_range("data bit address to be mapped is out of bounds");
 
-				// Block scale offset (for 128 entry blocks)
-				static const uint32_t block_scale = 0xBA0u;
-
-				return (data_offset >> 7u) * block_scale + bit_table[data_offset & 0x7Fu];
+				return (data_offset >> 7u) * ramb36e2_block_scale + ramb36e2_data_bit_table[data_offset & 0x7Fu];
 			}
 
 			//------------------------------------------------------------------------------------------
 			///! @brief Maps from (relative) parity-bit addresses to BRAM-relative bit offsets
-			static uint32_t ramb36e2_map_parity_bit(const uint32_t parity_offset)
+			static constexpr uint32_t ramb36e2_map_parity_bit(const uint32_t parity_offset)
 			{
-				// Mapping table for the lower 4 bits of the result
-				static const uint8_t bit_table[] =
-				{
-					0x30u, 0xB4u, 0x36u, 0xBAu, 0x33u, 0xB7u, 0x39u, 0xBDu,
-					0x32u, 0xB6u, 0x38u, 0xBCu, 0x35u, 0xB9u, 0x3Bu, 0xBFu
-				};
-
 				if (parity_offset >= 4096u)
 					throw std::out_of_range("parity bit address to be mapped is out of bounds");
 
-				// Block scale offset (for 16 entry blocks)
-				static const uint32_t block_scale = 0xBA0u;
+				return (parity_offset >> 4u) * ramb36e2_block_scale + ramb36e2_parity_bit_table[parity_offset & 0xFu];
+			}
+
+			//------------------------------------------------------------------------------------------
+			// RAMB18E2 tiles are the bottom and top halves of a RAMB36E2 tile.
+			//
+			// As for the RAMB18E1 halves of the Virtex-7 series, the bottom (even Y) RAMB18E2 covers
+			// the lower and the top (odd Y) RAMB18E2 the upper half of the address range of the
+			// enclosing RAMB36E2: data bit N of a RAMB18E2 is data bit (N + 16384 * is_top) and
+			// parity bit N is parity bit (N + 2048 * is_top) of the RAMB36E2.
+			//
+			// (There is no logic location data for RAMB18E2 primitives yet; the split follows the
+			// RAMB18E1 layout.)
+			//
 
-				return (parity_offset >> 4u) * block_scale + bit_table[parity_offset & 0xF];
+			//------------------------------------------------------------------------------------------
+			///! @brief Maps from (relative) RAMB18E2 data-bit addresses to BRAM-relative bit offsets
+			static constexpr uint32_t ramb18e2_map_data_bit(const uint32_t data_offset, bool is_top)
+			{
+				if (data_offset >= 16384u)
+					throw std::out_of_range("data bit address to be mapped is out of bounds");
+
+				return ramb36e2_map_data_bit(data_offset + (is_top ? 16384u : 0u));
 			}
 
 			//------------------------------------------------------------------------------------------
-			ramb36e2::ramb36e2(unsigned x, unsigned y, size_t bitstream_offset, unsigned slr)
-				: bram(x, y, 1024u, 32u, 4u, bram_category::ramb36, bitstream_offset, slr)
+			///! @brief Maps from (relative) RAMB18E2 parity-bit addresses to BRAM-relative bit offsets
+			static constexpr uint32_t ramb18e2_map_parity_bit(const uint32_t parity_offset, bool is_top)
 			{
+				if (parity_offset >= 2048u)
+					throw std::out_of_range("parity bit address to be mapped is out of bounds");
+
+				return ramb36e2_map_parity_bit(parity_offset + (is_top ? 2048u : 0u));
 			}
 
+			// First and last bit of the first and last word (1024 x (16+2) bits) of both halves
+			static_assert(ramb18e2_map_data_bit(0u, false) == 0x00000u && ramb18e2_map_data_bit(15u, false) == 0x000E4u,
+				"unexpected mapping of the first data word of the bottom RAMB18E2");
+			static_assert(ramb18e2_map_data_bit(16368u, false) == 0x5C46Bu && ramb18e2_map_data_bit(16383u, false) == 0x5C54Fu,
+				"unexpected mapping of the last data word of the bottom RAMB18E2");
+			static_assert(ramb18e2_map_data_bit(0u, true) == 0x5D000u && ramb18e2_map_data_bit(15u, true) == 0x5D0E4u,
+				"unexpected mapping of the first data word of the top RAMB18E2");
+			static_assert(ramb18e2_map_data_bit(16368u, true) == 0xB946Bu && ramb18e2_map_data_bit(16383u, true) == 0xB954Fu,
+				"unexpected mapping of the last data word of the top RAMB18E2");
+
+			static_assert(ramb18e2_map_parity_bit(0u, false) == 0x00030u && ramb18e2_map_parity_bit(1u, false) == 0x000B4u,
+				"unexpected mapping of the first parity word of the bottom RAMB18E2");
+			static_assert(ramb18e2_map_parity_bit(2046u, false) == 0x5C49Bu && ramb18e2_map_parity_bit(2047u, false) == 0x5C51Fu,
+				"unexpected mapping of the last parity word of the bottom RAMB18E2");
+			static_assert(ramb18e2_map_parity_bit(0u, true) == 0x5D030u && ramb18e2_map_parity_bit(1u, true) == 0x5D0B4u,
+				"unexpected mapping of the first parity word of the top RAMB18E2");
+			static_assert(ramb18e2_map_parity_bit(2046u, true) == 0xB949Bu && ramb18e2_map_parity_bit(2047u, true) == 0xB951Fu,
+				"unexpected mapping of the last parity word of the top RAMB18E2");
+
 			//------------------------------------------------------------------------------------------
-			ramb36e2::~ramb36e2()
+			///! @brief Checks that the RAMB18E2 halves partition the bits of the enclosing RAMB36E2
+			static constexpr bool ramb18e2_halves_partition_ramb36e2()
 			{
+				for (uint32_t i = 0u; i < 16384u; ++i)
+				{
+					if (ramb18e2_map_data_bit(i, false) != ramb36e2_map_data_bit(i) ||
+						ramb18e2_map_data_bit(i, true) != ramb36e2_map_data_bit(16384u + i))
+						return false;
+				}
+
+				for (uint32_t i = 0u; i < 2048u; ++i)
+				{
+					if (ramb18e2_map_parity_bit(i, false) != ramb36e2_map_parity_bit(i) ||
+						ramb18e2_map_parity_bit(i, true) != ramb36e2_map_parity_bit(2048u + i))
+						return false;
+				}
+
+				return true;
 			}
 
+			static_assert(ramb18e2_halves_partition_ramb36e2(),
+				"RAMB18E2 halves are expected to cover the lower and upper half of the RAMB36E2");
+
 			//------------------------------------------------------------------------------------------
 			const std::string& ramb36e2::primitive() const
 			{
@@ -108,6 +172,60 @@ namespace unbit
 					return bitstream_offset_ + ramb36e2_map_data_bit(bit_addr);
 				}
 			}
+
+			//------------------------------------------------------------------------------------------
+			void ramb36e2::map_range_to_bitstream(size_t first_bit, bool is_parity,
+											std::span<size_t> offsets) const
+			{
+				if (is_parity)
+				{
+					for (size_t k = 0u; k < offsets.size(); ++k)
+						offsets[k] = bitstream_offset_ + ramb36e2_map_parity_bit(static_cast<uint32_t>(first_bit + k));
+				}
+				else
+				{
+					for (size_t k = 0u; k < offsets.size(); ++k)
+						offsets[k] = bitstream_offset_ + ramb36e2_map_data_bit(static_cast<uint32_t>(first_bit + k));
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			const std::string& ramb18e2::primitive() const
+			{
+				static const std::string primitive_name("RAMB18E2");
+				return primitive_name;
+			}
+
+			//------------------------------------------------------------------------------------------
+			size_t ramb18e2::map_to_bitstream(size_t bit_addr, bool is_parity) const
+			{
+				if (is_parity)
+				{
+					// Map parity bit space	(note that data is swapped at 32-bit word level)
+					return bitstream_offset_ + ramb18e2_map_parity_bit(bit_addr, is_top_);
+				}
+				else
+				{
+					// Map data bit space (note that data is swapped at 32-bit word level)
+					return bitstream_offset_ + ramb18e2_map_data_bit(bit_addr, is_top_);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void ramb18e2::map_range_to_bitstream(size_t first_bit, bool is_parity,
+											std::span<size_t> offsets) const
+			{
+				if (is_parity)
+				{
+					for (size_t k = 0u; k < offsets.size(); ++k)
+						offsets[k] = bitstream_offset_ + ramb18e2_map_parity_bit(static_cast<uint32_t>(first_bit + k), is_top_);
+				}
+				else
+				{
+					for (size_t k = 0u; k < offsets.size(); ++k)
+						offsets[k] = bitstream_offset_ + ramb18e2_map_data_bit(static_cast<uint32_t>(first_bit + k), is_top_);
+				}
+			}
 		}	
 	}
 }
@@ -21,7 +21,7 @@ namespace unbit
 				//
 
 				// RAMB36E2 blocks
-				static const std::array<ramb36e2, 2160u> brams_36 =
+				static constexpr std::array<ramb36e2, 2160u> brams_36 =
 				{
 					ramb36e2 {   0,   0, 0x0A036740, 0 }, ramb36e2 {   0,   1, 0x0A036830, 0 }, ramb36e2 {   0,   2, 0x0A036920, 0 }, ramb36e2 {   0,   3, 0x0A036A10, 0 },
 					ramb36e2 {   0,   4, 0x0A036B00, 0 }, ramb36e2 {   0,   5, 0x0A036BF0, 0 }, ramb36e2 {   0,   6, 0x0A036D40, 0 }, ramb36e2 {   0,   7, 0x0A036E30, 0 },
@@ -576,6 +576,10 @@ namespace unbit
 				//
 				typedef virtex_up_variant<0x4b31093u, 2160u> xcvu9p_variant;
 
+				// RAMB18E2 blocks (bottom and top halves of the RAMB36E2 blocks)
+				static constexpr std::array<ramb18e2, 4320u> brams_18 =
+					xcvu9p_variant::make_ramb18e2_halves(brams_36);
+
 				//--------------------------------------------------------------------------------------
 				bool xcvu9p::match(uint32_t idcode)
 				{
@@ -585,7 +589,7 @@ namespace unbit
 				//--------------------------------------------------------------------------------------
 				const virtex_up& xcvu9p::get()
 				{
-					static const xcvu9p_variant instance("xcvu9p", brams_36);
+					static const xcvu9p_variant instance("xcvu9p", brams_36, brams_18);
 					return instance;
 				}
 			}
@@ -0,0 +1,697 @@
+/**
+ * @file
+ * @brief Streaming conversion of readback data into configuration bitstreams.
+ */
+#include "unbit/fpga/xilinx/readback_converter.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/fpga/xilinx/config_cmd.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/stream_engine.hpp"
+#include "unbit/runtime/mem_stats.hpp"
+
+#include "config_packet.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				using detail::begin_fdri;
+				using detail::to_file_order;
+
+				/**
+				 * @brief Size of the input buffer (in bytes).
+				 */
+				static constexpr std::size_t INPUT_CHUNK_BYTES = 1024u * 1024u;
+
+				/**
+				 * @brief Size of the output buffer (in words).
+				 */
+				static constexpr std::size_t OUTPUT_CHUNK_WORDS = 256u * 1024u;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Buffered reader for (big-endian) words of the readback input.
+				 */
+				class word_reader
+				{
+				private:
+					std::istream& is_;
+					std::vector<uint8_t> buffer_;
+					runtime::mem_account account_;
+					uint64_t base_;
+					std::size_t pos_;
+					std::size_t end_;
+
+				public:
+					word_reader(std::istream& is, uint64_t offset)
+						: is_(is), buffer_(INPUT_CHUNK_BYTES),
+						account_(runtime::mem_subsystem::input_buffers, INPUT_CHUNK_BYTES),
+						base_(0u), pos_(0u), end_(0u)
+					{
+						seek(offset);
+					}
+
+					uint64_t tell() const
+					{
+						return base_ + pos_;
+					}
+
+					void seek(uint64_t offset)
+					{
+						if (offset >= base_ && offset <= base_ + end_)
+						{
+							// Still buffered
+							pos_ = static_cast<std::size_t>(offset - base_);
+							return;
+						}
+
+						is_.clear();
+						is_.seekg(static_cast<std::streamoff>(offset), std::ios_base::beg);
+
+						if (is_.fail())
+							throw std::ios_base::failure("i/o error while seeking in readback data");
+
+						base_ = offset;
+						pos_  = 0u;
+						end_  = 0u;
+					}
+
+					std::size_t read_some(uint8_t* dst, std::size_t size)
+					{
+						std::size_t done = 0u;
+
+						while (done < size && fill())
+						{
+							const std::size_t n = std::min(size - done, end_ - pos_);
+							std::memcpy(dst + done, buffer_.data() + pos_, n);
+
+							pos_ += n;
+							done += n;
+						}
+
+						return done;
+					}
+
+					void read(std::span<uint32_t> words)
+					{
+						const std::size_t size = words.size() * sizeof(uint32_t);
+
+						if (read_some(reinterpret_cast<uint8_t*>(words.data()), size) != size)
+							throw bitstream_error("unexpected end of readback data");
+
+						std::transform(words.begin(), words.end(), words.begin(), to_file_order);
+					}
+
+				private:
+					bool fill()
+					{
+						if (pos_ < end_)
+							return true;
+
+						static_assert(sizeof(std::istream::char_type) == sizeof(uint8_t),
+							"unsupported: sizeof(std::istream::char_type) != sizeof(uint8_t)");
+
+						base_ += end_;
+						pos_   = 0u;
+
+						is_.read(reinterpret_cast<std::istream::char_type*>(buffer_.data()), buffer_.size());
+						end_ = static_cast<std::size_t>(is_.gcount());
+
+						if (is_.bad())
+							throw std::ios_base::failure("i/o error while reading readback data");
+
+						return end_ > 0u;
+					}
+				};
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Indexes the FDRO reads of a readback stream (payloads are skipped).
+				 *
+				 * Every synchronized (sub-)stream is a candidate SLR; streams nested via register 30
+				 * writes are parsed inline.
+				 */
+				class fdro_scanner : public stream_engine
+				{
+				private:
+					word_reader reader_;
+					std::size_t frame_words_;
+					uint64_t pad_words_;
+					std::vector<readback_converter::slr_extent> candidates_;
+					std::vector<std::size_t> current_;
+
+				public:
+					fdro_scanner(std::istream& is, uint64_t offset, std::size_t frame_words, std::size_t pipeline_words)
+						: reader_(is, offset), frame_words_(frame_words), pad_words_(pipeline_words + frame_words),
+						current_(1u, 0u)
+					{
+						set_read_payloads(true);
+						set_skip_unknown_packets(true);
+					}
+
+					const std::vector<readback_converter::slr_extent>& candidates() const noexcept
+					{
+						return candidates_;
+					}
+
+				protected:
+					std::size_t read_bytes(uint8_t* dst, std::size_t size) override
+					{
+						return reader_.read_some(dst, size);
+					}
+
+					void skip_bytes(uint64_t size) override
+					{
+						reader_.seek(reader_.tell() + size);
+					}
+
+					void on_sync() override
+					{
+						current_.back() = candidates_.size();
+						candidates_.emplace_back();
+					}
+
+					void on_slr_begin() override
+					{
+						current_.push_back(current_.back());
+					}
+
+					void on_slr_end() override
+					{
+						current_.pop_back();
+					}
+
+					bool on_packet(const packet& pkt) override
+					{
+						if (pkt.op == packet_op::write)
+						{
+							// IDCODE and CMD (DESYNC) writes are processed
+							return pkt.reg == config_reg::IDCODE || pkt.reg == config_reg::CMD;
+						}
+						else if (pkt.op == packet_op::read && pkt.reg == config_reg::FDRO && pkt.word_count > 0u)
+						{
+							// Readback data (pipeline words, padding frame and the frames of the SLR)
+							auto& self = candidates_[current_.back()];
+
+							if (self.num_frames > 0u)
+								throw bitstream_error("unsupported readback stream: found multiple fdro reads in one stream");
+
+							if (pkt.word_count < pad_words_ || (pkt.word_count - pad_words_) % frame_words_ != 0u)
+								throw bitstream_error("bad frame data size of fdro read");
+
+							self.data_offset = reader_.tell() + pad_words_ * sizeof(uint32_t);
+							self.num_frames  = static_cast<std::size_t>((pkt.word_count - pad_words_) / frame_words_);
+						}
+
+						return false;
+					}
+
+					void on_payload(const packet& pkt, uint64_t offset, std::span<const uint32_t> input,
+						std::span<uint32_t> output) override
+					{
+						if (pkt.reg == config_reg::IDCODE && offset == 0u)
+							candidates_[current_.back()].idcode = input.front();
+					}
+				};
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Buffered output of (native) words in bitstream file order.
+				 *
+				 * A sink without an output stream only counts the words (dry run).
+				 */
+				class output_sink
+				{
+				private:
+					std::ostream* os_;
+					std::vector<uint32_t> buffer_;
+					uint64_t words_;
+
+				public:
+					explicit output_sink(std::ostream* os)
+						: os_(os), words_(0u)
+					{
+						if (os_)
+							buffer_.reserve(OUTPUT_CHUNK_WORDS);
+					}
+
+					uint64_t words() const
+					{
+						return words_;
+					}
+
+					void put(std::span<const uint32_t> words)
+					{
+						words_ += words.size();
+
+						if (!os_)
+							return;
+
+						while (!words.empty())
+						{
+							const std::size_t n = std::min(words.size(), OUTPUT_CHUNK_WORDS - buffer_.size());
+							std::transform(words.begin(), words.begin() + n, std::back_inserter(buffer_), to_file_order);
+							words = words.subspan(n);
+
+							if (buffer_.size() == OUTPUT_CHUNK_WORDS)
+								flush();
+						}
+					}
+
+					void skip(uint64_t num_words)
+					{
+						words_ += num_words;
+					}
+
+					void flush()
+					{
+						if (!os_ || buffer_.empty())
+							return;
+
+						static_assert(sizeof(std::ostream::char_type) == sizeof(uint8_t),
+							"unsupported: sizeof(std::ostream::char_type) != sizeof(uint8_t)");
+
+						os_->write(reinterpret_cast<const std::ostream::char_type*>(buffer_.data()),
+							buffer_.size() * sizeof(uint32_t));
+
+						if (os_->fail())
+							throw std::ios_base::failure("i/o error while writing bitstream data");
+
+						buffer_.clear();
+					}
+				};
+
+				/**
+				 * @brief Packet stream writer for the stream of an SLR (on the shared output sink).
+				 */
+				using stream_writer = detail::packet_writer<output_sink&>;
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Shared state of a conversion.
+				 */
+				struct convert_context
+				{
+					/** @brief Frame data extents of the SLRs. */
+					const std::vector<readback_converter::slr_extent>& slrs;
+
+					/** @brief Per-SLR serialization settings. */
+					const std::vector<bitstream_serializer::slr_config>& configs;
+
+					/** @brief Serializer options. */
+					const serializer_options& options;
+
+					/** @brief Number of words per frame. */
+					std::size_t frame_words;
+
+					/** @brief Input reader (null for the dry run). */
+					word_reader* input;
+
+					/** @brief All-zero frames (per SLR, MFWR compression only). */
+					std::vector<std::vector<bool>> zero_frames;
+
+					/** @brief Frame data transfer buffer. */
+					std::vector<uint32_t> chunk;
+
+					/** @brief Number of frames written via FDRI. */
+					std::size_t num_fdri_frames = 0u;
+
+					/** @brief Number of frames written via MFWR. */
+					std::size_t num_mfwr_frames = 0u;
+
+					convert_context(const std::vector<readback_converter::slr_extent>& slr_extents,
+						const std::vector<bitstream_serializer::slr_config>& slr_configs,
+						const serializer_options& opts, std::size_t words_per_frame)
+						: slrs(slr_extents), configs(slr_configs), options(opts), frame_words(words_per_frame), input(nullptr)
+					{
+					}
+				};
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Streams frames from the input as (part of the) payload of an FDRI write.
+				 */
+				static void stream_frames(convert_context& ctx, stream_writer& w, uint64_t offset, std::size_t num_frames)
+				{
+					const std::size_t num_words = num_frames * ctx.frame_words;
+
+					if (!ctx.input)
+					{
+						w.skip_payload(num_words);
+						return;
+					}
+
+					ctx.input->seek(offset);
+
+					for (std::size_t pos = 0u; pos < num_words; )
+					{
+						const std::size_t n = std::min(num_words - pos, ctx.chunk.size());
+						const std::span<uint32_t> data(ctx.chunk.data(), n);
+
+						ctx.input->read(data);
+						w.payload(config_reg::FDRI, data);
+
+						pos += n;
+					}
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Emits zero words as (part of the) payload of a write.
+				 */
+				static void stream_zeros(stream_writer& w, config_reg reg, std::size_t num_words)
+				{
+					const uint32_t zero[16u] = { 0u };
+
+					for (std::size_t pos = 0u; pos < num_words; pos += 16u)
+						w.payload(reg, std::span<const uint32_t>(zero, std::min<std::size_t>(num_words - pos, 16u)));
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Emits the head segment of an SLR (up to, and including, the frame data).
+				 */
+				static void emit_head(convert_context& ctx, stream_writer& w, std::size_t slr)
+				{
+					const auto& extent = ctx.slrs[slr];
+					const auto& cfg = ctx.configs[slr];
+					const std::size_t frame_words = ctx.frame_words;
+					const std::size_t num_frames = extent.num_frames;
+					const uint64_t frame_bytes = frame_words * sizeof(uint32_t);
+					const bool have_fars = !cfg.frame_addresses.empty();
+					const bool streaming = (ctx.input != nullptr);
+
+					// Dummy words, bus width detection, sync and header
+					detail::write_stream_header(w);
+
+					if (extent.idcode)
+						w.write(config_reg::IDCODE, *extent.idcode);
+
+					for (const auto& reg_write : cfg.header)
+						w.write(reg_write.reg, reg_write.data);
+
+					// Frame data
+					if (!ctx.options.compress)
+					{
+						// Single FDRI write spanning all frames
+						begin_fdri(w, have_fars ? cfg.frame_addresses.front() : 0u);
+						w.begin_write(config_reg::FDRI, num_frames * frame_words);
+						stream_frames(ctx, w, extent.data_offset, num_frames);
+
+						if (streaming)
+							ctx.num_fdri_frames += num_frames;
+
+						return;
+					}
+
+					// All-zero frames with a known address are written via MFWR (if there are at least
+					// two of them). Other frames are written in literal runs (consecutive frames in
+					// auto-increment order), each followed by a pipeline flush frame.
+					const auto& zero = ctx.zero_frames[slr];
+					std::vector<std::size_t> zero_group;
+
+					for (std::size_t f = 0u; f < num_frames; ++f)
+					{
+						if (zero[f] && cfg.frame_addresses[f] != bitstream_serializer::NO_FRAME_ADDRESS)
+							zero_group.push_back(f);
+					}
+
+					if (zero_group.size() < 2u)
+						zero_group.clear();
+
+					std::vector<bool> duplicated(num_frames, false);
+					for (const std::size_t f : zero_group)
+						duplicated[f] = true;
+
+					std::size_t f = 0u;
+					while (f < num_frames)
+					{
+						// Runs start at a unique frame with a known address
+						if (duplicated[f] || cfg.frame_addresses[f] == bitstream_serializer::NO_FRAME_ADDRESS)
+						{
+							++f;
+							continue;
+						}
+
+						std::size_t end = f + 1u;
+						while (end < num_frames && !duplicated[end])
+							++end;
+
+						// Trailing padding frames are not needed (replaced by the flush frame)
+						std::size_t last = end;
+						while (last > f && cfg.frame_addresses[last - 1u] == bitstream_serializer::NO_FRAME_ADDRESS)
+							--last;
+
+						begin_fdri(w, cfg.frame_addresses[f]);
+						w.begin_write(config_reg::FDRI, (last - f + 1u) * frame_words);
+						stream_frames(ctx, w, extent.data_offset + f * frame_bytes, last - f);
+
+						if (streaming)
+						{
+							stream_zeros(w, config_reg::FDRI, frame_words);
+							ctx.num_fdri_frames += last - f;
+						}
+						else
+						{
+							w.skip_payload(frame_words);
+						}
+
+						f = end;
+					}
+
+					if (!zero_group.empty())
+					{
+						// One FDRI write of the zero frame, followed by FAR/MFWR pairs
+						begin_fdri(w, cfg.frame_addresses[zero_group.front()]);
+						w.begin_write(config_reg::FDRI, 2u * frame_words);
+						stream_zeros(w, config_reg::FDRI, 2u * frame_words);
+
+						w.command(config_cmd::MFW);
+
+						const std::vector<uint32_t> mfwr_data(ctx.options.mfwr_words, 0u);
+
+						for (std::size_t i = 1u; i < zero_group.size(); ++i)
+						{
+							w.write(config_reg::FAR, cfg.frame_addresses[zero_group[i]]);
+							w.write(config_reg::MFWR, mfwr_data);
+						}
+
+						if (streaming)
+						{
+							ctx.num_fdri_frames += 1u;
+							ctx.num_mfwr_frames += zero_group.size() - 1u;
+						}
+					}
+				}
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Emits the tail segment of an SLR (trailer, CRC check and DESYNC).
+				 */
+				static void emit_tail(convert_context& ctx, stream_writer& w, std::size_t slr)
+				{
+					for (const auto& reg_write : ctx.configs[slr].trailer)
+						w.write(reg_write.reg, reg_write.data);
+
+					detail::write_stream_end(w, ctx.options.with_crc);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			readback_converter::readback_converter(std::istream& input, std::size_t frame_words,
+				const serializer_options& opts)
+				: input_(input), origin_(0u), frame_words_(frame_words), options_(opts),
+				num_fdri_frames_(0u), num_mfwr_frames_(0u), output_size_(0u)
+			{
+				if (frame_words_ == 0u)
+					throw std::invalid_argument("frame size must not be zero");
+
+				const auto pos = input_.tellg();
+				if (pos < 0)
+					throw std::ios_base::failure("readback input stream is not seekable");
+
+				origin_ = static_cast<uint64_t>(pos);
+			}
+
+			//------------------------------------------------------------------------------------------
+			readback_converter::~readback_converter()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void readback_converter::scan_fdro(std::size_t pipeline_words)
+			{
+				fdro_scanner scanner(input_, origin_, frame_words_, pipeline_words);
+				scanner.process();
+
+				// Streams without readback data are not SLRs
+				slrs_.clear();
+
+				for (const auto& candidate : scanner.candidates())
+				{
+					if (candidate.num_frames > 0u)
+						slrs_.push_back(candidate);
+				}
+
+				if (slrs_.empty())
+					throw bitstream_error("readback stream does not contain any fdro data");
+
+				configs_.assign(slrs_.size(), bitstream_serializer::slr_config());
+			}
+
+			//------------------------------------------------------------------------------------------
+			void readback_converter::set_layout(const readback_layout& layout)
+			{
+				if (layout.slrs.empty())
+					throw std::invalid_argument("readback layout does not contain any slr");
+
+				const uint64_t frame_bytes = frame_words_ * sizeof(uint32_t);
+				uint64_t offset = origin_;
+
+				slrs_.clear();
+
+				for (const auto& slr : layout.slrs)
+				{
+					offset += layout.front_padding_words * sizeof(uint32_t);
+
+					auto& self = slrs_.emplace_back();
+					self.idcode      = slr.idcode;
+					self.data_offset = offset;
+					self.num_frames  = slr.num_frames;
+
+					offset += slr.num_frames * frame_bytes;
+					offset += layout.back_padding_words * sizeof(uint32_t);
+				}
+
+				configs_.assign(slrs_.size(), bitstream_serializer::slr_config());
+			}
+
+			//------------------------------------------------------------------------------------------
+			bitstream_serializer::slr_config& readback_converter::config(std::size_t slr)
+			{
+				if (slr >= configs_.size())
+					throw std::out_of_range("slr index is out of range");
+
+				return configs_[slr];
+			}
+
+			//------------------------------------------------------------------------------------------
+			void readback_converter::convert(std::ostream& output)
+			{
+				if (slrs_.empty())
+					throw std::logic_error("readback data has not been indexed");
+
+				const std::size_t num_slrs = slrs_.size();
+
+				for (std::size_t k = 0u; k < num_slrs; ++k)
+				{
+					const auto& fars = configs_[k].frame_addresses;
+
+					if (!fars.empty() && fars.size() != slrs_[k].num_frames)
+						throw std::invalid_argument("frame address map does not match the number of frames of the slr");
+
+					if (options_.compress && fars.empty())
+						throw std::invalid_argument("mfwr compression requires a frame address map");
+				}
+
+				word_reader reader(input_, origin_);
+
+				convert_context ctx(slrs_, configs_, options_, frame_words_);
+				ctx.chunk.resize(std::max<std::size_t>(1u, OUTPUT_CHUNK_WORDS / frame_words_) * frame_words_);
+
+				runtime::mem_account chunk_account(runtime::mem_subsystem::input_buffers,
+					ctx.chunk.size() * sizeof(uint32_t));
+
+				if (options_.compress)
+				{
+					// Pass 1: Locate the all-zero frames (one bit per frame)
+					const std::size_t chunk_frames = ctx.chunk.size() / frame_words_;
+					ctx.zero_frames.resize(num_slrs);
+
+					for (std::size_t k = 0u; k < num_slrs; ++k)
+					{
+						auto& zero = ctx.zero_frames[k];
+						zero.assign(slrs_[k].num_frames, false);
+
+						reader.seek(slrs_[k].data_offset);
+
+						for (std::size_t f = 0u; f < zero.size(); f += chunk_frames)
+						{
+							const std::size_t n = std::min(zero.size() - f, chunk_frames);
+							reader.read(std::span<uint32_t>(ctx.chunk.data(), n * frame_words_));
+
+							for (std::size_t i = 0u; i < n; ++i)
+							{
+								const auto first = ctx.chunk.begin() + i * frame_words_;
+								zero[f + i] = std::all_of(first, first + frame_words_, [](uint32_t w) { return w == 0u; });
+							}
+						}
+					}
+				}
+
+				// Pass 2: Determine the stream sizes of all SLRs (dry run, innermost SLR first). The
+				// nested write headers depend on the size of all following SLRs.
+				std::vector<uint64_t> stream_words(num_slrs + 1u, 0u);
+
+				for (std::size_t k = num_slrs; k-- > 0u; )
+				{
+					output_sink dry(nullptr);
+					stream_writer w(dry, 0u, false);
+
+					emit_head(ctx, w, k);
+
+					if (k + 1u < num_slrs)
+						w.begin_write(config_reg::RSVD30, stream_words[k + 1u]);
+
+					emit_tail(ctx, w, k);
+
+					stream_words[k] = w.words() + stream_words[k + 1u];
+				}
+
+				// Pass 3: Stream the bitstream (heads and links outwards-in, tails innermost first)
+				output_sink sink(&output);
+				std::vector<stream_writer> writers;
+				writers.reserve(num_slrs);
+
+				ctx.input = &reader;
+
+				for (std::size_t k = 0u; k < num_slrs; ++k)
+				{
+					stream_writer& w = writers.emplace_back(sink, 0u, k > 0u);
+
+					emit_head(ctx, w, k);
+
+					if (k + 1u < num_slrs)
+						w.begin_write(config_reg::RSVD30, stream_words[k + 1u]);
+				}
+
+				for (std::size_t k = num_slrs; k-- > 0u; )
+				{
+					stream_writer& w = writers[k];
+
+					if (k + 1u < num_slrs)
+						w.nest(writers[k + 1u].nested_crc(), writers[k + 1u].words());
+
+					emit_tail(ctx, w, k);
+
+					if (w.words() != stream_words[k])
+						throw std::logic_error("stream size of slr does not match the precomputed size");
+				}
+
+				sink.flush();
+
+				num_fdri_frames_ = ctx.num_fdri_frames;
+				num_mfwr_frames_ = ctx.num_mfwr_frames;
+				output_size_     = sink.words() * sizeof(uint32_t);
+			}
+		}
+	}
+}
@@ -0,0 +1,317 @@
+/**
+ * @file
+ * @brief Scrub-repair partial bitstreams from readback data (masked comparison against a golden image).
+ */
+#include "unbit/fpga/xilinx/scrub_repair.hpp"
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/fpga/xilinx/config_cmd.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+
+#include "config_packet.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				using detail::segment_writer;
+				using detail::to_file_order;
+
+				/**
+				 * @brief Size of the readback input buffer (in bytes).
+				 */
+				static constexpr std::size_t INPUT_CHUNK_BYTES = 256u * 1024u;
+
+			}
+
+			//------------------------------------------------------------------------------------------
+			scrub_repair::scrub_repair(const frame_store& golden, const scrub_options& opts)
+				: golden_(golden), mask_(nullptr), options_(opts), frame_addresses_(golden.num_slrs()),
+				num_fdri_frames_(0u), output_size_(0u)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			scrub_repair::~scrub_repair()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void scrub_repair::set_mask(const frame_store& mask)
+			{
+				if (mask.frame_words() != golden_.frame_words() || mask.num_slrs() != golden_.num_slrs())
+					throw std::invalid_argument("mask image does not match the geometry of the golden image");
+
+				for (std::size_t k = 0u; k < golden_.num_slrs(); ++k)
+				{
+					if (mask.num_frames(k) != golden_.num_frames(k))
+						throw std::invalid_argument("mask image does not match the geometry of the golden image");
+				}
+
+				mask_ = &mask;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void scrub_repair::set_frame_addresses(std::size_t slr, std::vector<uint32_t> addresses)
+			{
+				if (slr >= frame_addresses_.size())
+					throw std::out_of_range("slr index is out of range");
+
+				if (addresses.size() != golden_.num_frames(slr))
+					throw std::invalid_argument("frame address map does not match the number of frames of the slr");
+
+				frame_addresses_[slr] = std::move(addresses);
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t scrub_repair::compare(std::size_t slr, std::size_t first_frame, std::span<const uint32_t> readback)
+			{
+				const std::size_t frame_words = golden_.frame_words();
+
+				if (slr >= golden_.num_slrs())
+					throw std::out_of_range("slr index is out of range");
+
+				if (readback.size() % frame_words != 0u)
+					throw std::invalid_argument("readback data is not a multiple of the frame size");
+
+				const std::size_t num_frames = readback.size() / frame_words;
+				if (first_frame > golden_.num_frames(slr) || num_frames > golden_.num_frames(slr) - first_frame)
+					throw std::out_of_range("readback frames are out of range");
+
+				const auto golden = golden_.words(slr);
+				const auto mask = mask_ ? mask_->words(slr) : std::span<const uint32_t>();
+				const auto& addresses = frame_addresses_[slr];
+
+				std::size_t found = 0u;
+
+				for (std::size_t i = 0u; i < num_frames && !limit_reached(); ++i)
+				{
+					const std::size_t f = first_frame + i;
+					const std::size_t offset = f * frame_words;
+					const uint32_t* const r = readback.data() + i * frame_words;
+					const uint32_t* const g = golden.data() + offset;
+					const uint32_t* const m = mask_ ? mask.data() + offset : nullptr;
+
+					// Fast path: Intact frame
+					uint32_t any = 0u;
+
+					if (m)
+					{
+						for (std::size_t j = 0u; j < frame_words; ++j)
+							any |= (r[j] ^ g[j]) & ~m[j];
+					}
+					else
+					{
+						for (std::size_t j = 0u; j < frame_words; ++j)
+							any |= r[j] ^ g[j];
+					}
+
+					if (any == 0u)
+						continue;
+
+					// Row padding frames can not be addressed (and are not used)
+					const uint32_t far = addresses.empty() ? bitstream_serializer::NO_FRAME_ADDRESS : addresses[f];
+					if (!addresses.empty() && far == bitstream_serializer::NO_FRAME_ADDRESS)
+						continue;
+
+					scrub_upset& upset = upsets_.emplace_back();
+					upset.slr = slr;
+					upset.frame = f;
+					upset.frame_address = far;
+
+					// Repaired frame: Golden bits, masked bits as read back
+					for (std::size_t j = 0u; j < frame_words; ++j)
+					{
+						const uint32_t keep = m ? m[j] : 0u;
+
+						upset.num_bits += std::popcount((r[j] ^ g[j]) & ~keep);
+						repaired_.push_back((g[j] & ~keep) | (r[j] & keep));
+					}
+
+					++found;
+				}
+
+				return found;
+			}
+
+			//------------------------------------------------------------------------------------------
+			std::size_t scrub_repair::scan(std::istream& readback, std::span<const readback_converter::slr_extent> extents)
+			{
+				const std::size_t frame_words = golden_.frame_words();
+				const uint64_t frame_bytes = frame_words * sizeof(uint32_t);
+
+				if (extents.size() != golden_.num_slrs())
+					throw std::invalid_argument("readback data does not match the number of slrs of the golden image");
+
+				for (std::size_t k = 0u; k < extents.size(); ++k)
+				{
+					if (extents[k].num_frames != golden_.num_frames(k))
+						throw std::invalid_argument("readback data does not match the number of frames of the golden image");
+				}
+
+				static_assert(sizeof(std::istream::char_type) == sizeof(uint8_t),
+					"unsupported: sizeof(std::istream::char_type) != sizeof(uint8_t)");
+
+				const std::size_t chunk_frames = std::max<std::size_t>(1u, INPUT_CHUNK_BYTES / frame_bytes);
+				std::vector<uint32_t> chunk(chunk_frames * frame_words);
+				std::size_t found = 0u;
+
+				for (std::size_t k = 0u; k < extents.size() && !limit_reached(); ++k)
+				{
+					readback.clear();
+					readback.seekg(static_cast<std::streamoff>(extents[k].data_offset), std::ios_base::beg);
+
+					if (readback.fail())
+						throw std::ios_base::failure("i/o error while seeking in readback data");
+
+					for (std::size_t f = 0u; f < extents[k].num_frames && !limit_reached(); f += chunk_frames)
+					{
+						const std::size_t n = std::min(extents[k].num_frames - f, chunk_frames);
+						const std::span<uint32_t> data(chunk.data(), n * frame_words);
+
+						readback.read(reinterpret_cast<std::istream::char_type*>(data.data()), data.size_bytes());
+
+						if (readback.bad())
+							throw std::ios_base::failure("i/o error while reading readback data");
+						else if (static_cast<std::size_t>(readback.gcount()) != data.size_bytes())
+							throw bitstream_error("unexpected end of readback data");
+
+						// Readback data is big-endian
+						std::transform(data.begin(), data.end(), data.begin(), to_file_order);
+
+						found += compare(k, f, data);
+					}
+				}
+
+				return found;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void scrub_repair::clear() noexcept
+			{
+				upsets_.clear();
+				repaired_.clear();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void scrub_repair::write(std::ostream& output)
+			{
+				const std::size_t frame_words = golden_.frame_words();
+
+				if (upsets_.empty())
+					throw std::logic_error("no upset frames to repair");
+
+				// Order the upsets by SLR and frame (the last comparison of a frame wins)
+				std::vector<std::size_t> order(upsets_.size());
+				std::iota(order.begin(), order.end(), std::size_t(0u));
+
+				std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+				{
+					return (upsets_[a].slr != upsets_[b].slr) ? (upsets_[a].slr < upsets_[b].slr) : (upsets_[a].frame < upsets_[b].frame);
+				});
+
+				std::vector<std::size_t> unique;
+				for (const std::size_t i : order)
+				{
+					if (upsets_[i].frame_address == bitstream_serializer::NO_FRAME_ADDRESS)
+						throw std::invalid_argument("repair bitstreams require a frame address map");
+
+					if (!unique.empty() && upsets_[unique.back()].slr == upsets_[i].slr && upsets_[unique.back()].frame == upsets_[i].frame)
+						unique.back() = i;
+					else
+						unique.push_back(i);
+				}
+
+				// SLRs after the last SLR with upsets are not needed
+				const std::size_t num_slrs = upsets_[unique.back()].slr + 1u;
+				std::vector<detail::slr_segments> streams(num_slrs);
+				const std::vector<uint32_t> pad_frame(frame_words, 0u);
+
+				num_fdri_frames_ = 0u;
+
+				std::size_t pos = 0u;
+				for (std::size_t k = 0u; k < num_slrs; ++k)
+				{
+					detail::slr_segments& s = streams[k];
+					segment_writer w(s.head, 0u, k > 0u);
+
+					// Dummy words, bus width detection, sync and header
+					detail::write_stream_header(w);
+
+					if (const auto& idcode = golden_.idcode(k))
+						w.write(config_reg::IDCODE, *idcode);
+
+					// Runs of consecutive upset frames, each followed by a pipeline flush frame
+					while (pos < unique.size() && upsets_[unique[pos]].slr == k)
+					{
+						std::size_t end = pos + 1u;
+						while (end < unique.size() && upsets_[unique[end]].slr == k &&
+							upsets_[unique[end]].frame == upsets_[unique[end - 1u]].frame + 1u)
+						{
+							++end;
+						}
+
+						std::vector<uint32_t> run;
+						run.reserve((end - pos + 1u) * frame_words);
+
+						for (std::size_t i = pos; i < end; ++i)
+						{
+							const auto first = repaired_.begin() + unique[i] * frame_words;
+							run.insert(run.end(), first, first + frame_words);
+						}
+
+						run.insert(run.end(), pad_frame.begin(), pad_frame.end());
+
+						detail::begin_fdri(w, upsets_[unique[pos]].frame_address);
+						w.write(config_reg::FDRI, run);
+
+						num_fdri_frames_ += end - pos;
+						pos = end;
+					}
+
+					s.head_crc = w.crc();
+					s.head_nested_crc = w.nested_crc();
+				}
+
+				// Link from the innermost SLR outwards; CRC check and DESYNC (no trailer, i.e. no
+				// start-up sequence)
+				detail::link_segments(std::span<detail::slr_segments>(streams), options_.with_crc,
+					[](std::size_t, segment_writer&)
+					{
+					});
+
+				// Heads and links outwards-in, tails innermost first
+				static_assert(sizeof(std::ostream::char_type) == sizeof(uint8_t),
+					"unsupported: sizeof(std::ostream::char_type) != sizeof(uint8_t)");
+
+				const auto put = [&](const std::vector<uint32_t>& words)
+				{
+					output.write(reinterpret_cast<const std::ostream::char_type*>(words.data()), words.size() * sizeof(uint32_t));
+				};
+
+				for (const auto& s : streams)
+				{
+					put(s.head);
+					put(s.link);
+				}
+
+				for (auto it = streams.rbegin(); it != streams.rend(); ++it)
+					put(it->tail);
+
+				if (output.fail())
+					throw std::ios_base::failure("i/o error while writing repair bitstream");
+
+				output_size_ = streams.front().stream_words * sizeof(uint32_t);
+			}
+		}
+	}
+}
@@ -0,0 +1,379 @@
+/**
+ * @file
+ * @brief Streaming packet walker for Xilinx Series-7 and UltraScale FPGAs.
+ */
+#include "unbit/fpga/xilinx/stream_engine.hpp"
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/bitstream_error.hpp"
+#include "unbit/fpga/xilinx/config_cmd.hpp"
+
+#include "config_packet.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			//------------------------------------------------------------------------------------------
+			stream_engine::stream_engine(std::size_t chunk_words)
+				: chunk_words_(chunk_words), track_input_crc_(false), skip_unknown_packets_(false),
+				read_payloads_(false), at_end_(false)
+			{
+				if (chunk_words_ == 0u)
+					throw std::invalid_argument("chunk size must not be zero");
+			}
+
+			//------------------------------------------------------------------------------------------
+			stream_engine::~stream_engine()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			const stream_engine::level& stream_engine::current_level() const
+			{
+				if (levels_.empty())
+					throw std::logic_error("no active configuration stream");
+
+				return levels_.back();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::process()
+			{
+				levels_.clear();
+				levels_.push_back(level { 0u, config_crc(), config_crc(), std::numeric_limits<uint64_t>::max(), config_reg::CRC, false });
+
+				input_.resize(chunk_words_);
+				output_.resize(chunk_words_);
+				at_end_ = false;
+
+				synchronize();
+
+				levels_.back().synced = true;
+				on_sync();
+
+				uint32_t pending = 0u;
+				bool have_pending = false;
+
+				for (;;)
+				{
+					// Leave completed nested streams (the enclosing stream is still synchronized)
+					while (!have_pending && levels_.size() > 1u && levels_.back().remaining == 0u)
+					{
+						on_slr_end();
+						levels_.pop_back();
+					}
+
+					uint32_t hdr;
+
+					if (have_pending)
+					{
+						hdr = pending;
+						have_pending = false;
+					}
+					else if (at_end_ || !read_header(hdr))
+					{
+						break;
+					}
+
+					emit(std::span<const uint32_t>(&hdr, 1u), std::span<const uint32_t>(&hdr, 1u));
+
+					level& cur = levels_.back();
+
+					if (hdr == bitstream_engine::FPGA_SYNC_WORD_LE)
+					{
+						// (Re-)synchronization, e.g. following a DESYNC command
+						if (!cur.synced)
+						{
+							cur.synced = true;
+							on_sync();
+						}
+
+						continue;
+					}
+					else if (!cur.synced)
+					{
+						// Raw word (e.g. padding following a DESYNC command)
+						continue;
+					}
+
+					const uint32_t packet_type = (hdr >> 29u) & 0x7u;
+					packet pkt;
+
+					if (packet_type == 0x1u)
+					{
+						// Type 1 packet
+						pkt.op         = static_cast<packet_op>((hdr >> 27u) & 0x3u);
+						pkt.reg        = static_cast<config_reg>((hdr >> 13u) & 0x1Fu);
+						pkt.word_count = hdr & 0x7FFu;
+
+						cur.last_reg = pkt.reg;
+
+						// A zero word count is followed by a type 2 packet with the actual word count
+						// (e.g. for long FDRI writes); otherwise the packet has no payload
+						if (pkt.word_count == 0u && pkt.op != packet_op::nop &&
+							(levels_.size() == 1u || cur.remaining > 0u) && read_header(pending))
+						{
+							if (((pending >> 29u) & 0x7u) == 0x2u)
+							{
+								emit(std::span<const uint32_t>(&pending, 1u), std::span<const uint32_t>(&pending, 1u));
+								pkt.word_count = pending & 0x07FFFFFFu;
+							}
+							else
+							{
+								have_pending = true;
+							}
+						}
+					}
+					else if (packet_type == 0x2u)
+					{
+						// Freestanding type 2 packet (addresses the register of the last type 1 packet)
+						pkt.op         = static_cast<packet_op>((hdr >> 27u) & 0x3u);
+						pkt.reg        = cur.last_reg;
+						pkt.word_count = hdr & 0x07FFFFFFu;
+					}
+					else if (skip_unknown_packets_)
+					{
+						continue;
+					}
+					else
+					{
+						throw bitstream_error("unhandled packet type in bitstream");
+					}
+
+					if (pkt.op == packet_op::write && pkt.reg == config_reg::RSVD30)
+					{
+						// Nested stream of the next SLR
+						if (levels_.size() > 1u && pkt.word_count > cur.remaining)
+							throw bitstream_error("packet exceeds the nested configuration stream");
+
+						const std::size_t slr = cur.slr + 1u;
+						levels_.push_back(level { slr, config_crc(), config_crc(), pkt.word_count, config_reg::CRC, false });
+						on_slr_begin();
+						continue;
+					}
+
+					process_payload(pkt);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::process_payload(const packet& pkt)
+			{
+				const std::size_t k = levels_.size() - 1u;
+				const bool is_write = (pkt.op == packet_op::write);
+				const uint64_t payload_words = (is_write || (pkt.op == packet_op::read && read_payloads_)) ? pkt.word_count : 0u;
+
+				if (k > 0u && payload_words > levels_[k].remaining)
+					throw bitstream_error("packet exceeds the nested configuration stream");
+
+				if (!on_packet(pkt))
+				{
+					skip_bytes(payload_words * sizeof(uint32_t));
+
+					for (std::size_t i = 1u; i <= k; ++i)
+						levels_[i].remaining -= payload_words;
+
+					on_packet_end(pkt);
+					return;
+				}
+
+				bool desync = false;
+
+				for (uint64_t done = 0u; done < payload_words; )
+				{
+					const std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(chunk_words_, payload_words - done));
+					const std::span<uint32_t> input(input_.data(), n);
+					const std::span<uint32_t> output(output_.data(), n);
+
+					read_words(input);
+					std::copy(input.begin(), input.end(), output.begin());
+
+					on_payload(pkt, done, input, output);
+
+					if (is_write)
+					{
+						level& cur = levels_[k];
+
+						// The first chunk carries the command code (RCRC resets the CRC)
+						if (done == 0u)
+						{
+							cur.crc.process_write(pkt.reg, output);
+
+							if (track_input_crc_)
+								cur.input_crc.process_write(pkt.reg, input);
+						}
+						else if (pkt.reg != config_reg::CRC)
+						{
+							cur.crc.update(pkt.reg, output);
+
+							if (track_input_crc_)
+								cur.input_crc.update(pkt.reg, input);
+						}
+
+						if (pkt.reg == config_reg::CMD)
+							desync = desync || std::find(input.begin(), input.end(), static_cast<uint32_t>(config_cmd::DESYNC)) != input.end();
+					}
+
+					emit(input, output);
+					done += n;
+				}
+
+				on_packet_end(pkt);
+
+				if (desync)
+					levels_[k].synced = false;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::synchronize()
+			{
+				uint8_t buffer[256u];
+				std::size_t n = 0u;
+				uint32_t shift = 0u;
+
+				while (shift != bitstream_engine::FPGA_SYNC_WORD_LE)
+				{
+					uint8_t b;
+					if (read_bytes(&b, 1u) != 1u)
+					{
+						on_raw_bytes(std::span<const uint8_t>(buffer, n));
+						throw bitstream_error("no sync word found in bitstream");
+					}
+
+					buffer[n++] = b;
+					shift = (shift << 8u) | b;
+
+					if (n == sizeof(buffer))
+					{
+						on_raw_bytes(std::span<const uint8_t>(buffer, n));
+						n = 0u;
+					}
+				}
+
+				on_raw_bytes(std::span<const uint8_t>(buffer, n));
+			}
+
+			//------------------------------------------------------------------------------------------
+			bool stream_engine::read_header(uint32_t& hdr)
+			{
+				if (levels_.size() > 1u)
+				{
+					read_words(std::span<uint32_t>(&hdr, 1u));
+					return true;
+				}
+
+				// The top-level stream ends with the data (a trailing partial word is raw data)
+				uint8_t bytes[4u];
+				const std::size_t n = read_bytes(bytes, sizeof(bytes));
+
+				if (n < sizeof(bytes))
+				{
+					on_raw_bytes(std::span<const uint8_t>(bytes, n));
+					at_end_ = true;
+					return false;
+				}
+
+				hdr = (static_cast<uint32_t>(bytes[0u]) << 24u) | (static_cast<uint32_t>(bytes[1u]) << 16u) |
+					(static_cast<uint32_t>(bytes[2u]) << 8u) | static_cast<uint32_t>(bytes[3u]);
+
+				return true;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::read_words(std::span<uint32_t> words)
+			{
+				// Nested streams are bounded by the enclosing register 30 writes (the innermost
+				// stream is the most restrictive one)
+				if (levels_.size() > 1u && levels_.back().remaining < words.size())
+					throw bitstream_error("packet exceeds the nested configuration stream");
+
+				const std::size_t size = words.size() * sizeof(uint32_t);
+				if (read_bytes(reinterpret_cast<uint8_t*>(words.data()), size) != size)
+					throw bitstream_error("unexpected end of bitstream");
+
+				std::transform(words.begin(), words.end(), words.begin(), detail::to_file_order);
+
+				for (std::size_t i = 1u; i < levels_.size(); ++i)
+					levels_[i].remaining -= words.size();
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::emit(std::span<const uint32_t> input, std::span<const uint32_t> output)
+			{
+				for (std::size_t i = 0u; i + 1u < levels_.size(); ++i)
+				{
+					levels_[i].crc.update(config_reg::RSVD30, output);
+
+					if (track_input_crc_)
+						levels_[i].input_crc.update(config_reg::RSVD30, input);
+				}
+
+				on_words(input, output);
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::skip_bytes(uint64_t size)
+			{
+				uint8_t buffer[4096u];
+
+				while (size > 0u)
+				{
+					const std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(size, sizeof(buffer)));
+					if (read_bytes(buffer, n) != n)
+						throw bitstream_error("unexpected end of bitstream");
+
+					size -= n;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::on_raw_bytes(std::span<const uint8_t> bytes)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::on_sync()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::on_slr_begin()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::on_slr_end()
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			bool stream_engine::on_packet(const packet& pkt)
+			{
+				// Process all payloads by default
+				return true;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::on_payload(const packet& pkt, uint64_t offset, std::span<const uint32_t> input,
+				std::span<uint32_t> output)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::on_packet_end(const packet& pkt)
+			{
+			}
+
+			//------------------------------------------------------------------------------------------
+			void stream_engine::on_words(std::span<const uint32_t> input, std::span<const uint32_t> output)
+			{
+			}
+		}
+	}
+}
@@ -0,0 +1,340 @@
+/**
+ * @file
+ * @brief Streaming SVF (serial vector format) writer for JTAG configuration of Xilinx FPGAs.
+ */
+#include "unbit/fpga/xilinx/svf_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <ios>
+#include <stdexcept>
+#include <string>
+
+namespace unbit
+{
+	namespace fpga
+	{
+		namespace xilinx
+		{
+			namespace
+			{
+				/**
+				 * @brief Number of instruction register bits per SLR.
+				 */
+				static constexpr std::size_t IR_BITS_PER_SLR = 6u;
+
+				/**
+				 * @brief IR capture value after the configuration memory has been cleared (INIT_COMPLETE set, DONE clear).
+				 */
+				static constexpr uint8_t IR_CAPTURE_INIT = 0x11u;
+
+				/**
+				 * @brief IR capture mask for the INIT_COMPLETE check (DONE, INIT_COMPLETE and the fixed '1' bit).
+				 */
+				static constexpr uint8_t IR_MASK_INIT = 0x31u;
+
+				/**
+				 * @brief IR capture value after a successful startup (DONE set).
+				 */
+				static constexpr uint8_t IR_CAPTURE_DONE = 0x21u;
+
+				/**
+				 * @brief IR capture mask for the DONE check (DONE and the fixed '1' bit).
+				 */
+				static constexpr uint8_t IR_MASK_DONE = 0x21u;
+
+				/**
+				 * @brief Hex digits.
+				 */
+				static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Builds the SDR formatting table (bit-reversed hex pair of each byte value).
+				 */
+				static constexpr std::array<std::array<char, 2u>, 256u> make_sdr_table()
+				{
+					std::array<std::array<char, 2u>, 256u> table {};
+
+					for (unsigned b = 0u; b < 256u; ++b)
+					{
+						unsigned r = 0u;
+						for (unsigned i = 0u; i < 8u; ++i)
+							r |= ((b >> i) & 1u) << (7u - i);
+
+						table[b][0u] = HEX_DIGITS[r >> 4u];
+						table[b][1u] = HEX_DIGITS[r & 0xFu];
+					}
+
+					return table;
+				}
+
+				static constexpr auto SDR_TABLE = make_sdr_table();
+
+				//--------------------------------------------------------------------------------------
+				/**
+				 * @brief Formats an all-ones hex number with the given number of bits.
+				 */
+				static std::string ones_hex(std::size_t bits)
+				{
+					std::string text((bits + 3u) / 4u, 'F');
+
+					if (const std::size_t top_bits = bits % 4u; top_bits != 0u)
+						text.front() = HEX_DIGITS[(1u << top_bits) - 1u];
+
+					return text;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			svf_writer::svf_writer(std::ostream& os, const svf_options& opts)
+				: os_(os), options_(opts)
+			{
+				if (options_.num_slrs == 0u || options_.num_slrs * IR_BITS_PER_SLR > 60u)
+					throw std::invalid_argument("unsupported number of slrs for svf output");
+
+				if (options_.chunk_bytes % 4u != 0u)
+					throw std::invalid_argument("svf chunk size must be a multiple of 4 bytes");
+
+				// Large buffers keep the number of stream writes low
+				buffer_.resize(std::max<std::size_t>(options_.buffer_bytes, 4096u));
+			}
+
+			//------------------------------------------------------------------------------------------
+			svf_writer::~svf_writer()
+			{
+				try
+				{
+					flush();
+				}
+				catch (...)
+				{
+					// Errors are reported by explicit flushes only
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void svf_writer::flush()
+			{
+				if (used_ > 0u)
+				{
+					os_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+					if (!os_)
+						throw std::ios_base::failure("i/o error while writing svf data");
+
+					text_size_ += used_;
+					used_ = 0u;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void svf_writer::put(std::string_view text)
+			{
+				while (!text.empty())
+				{
+					if (used_ == buffer_.size())
+						flush();
+
+					const std::size_t n = std::min(text.size(), buffer_.size() - used_);
+					std::copy_n(text.data(), n, buffer_.data() + used_);
+
+					used_ += n;
+					text.remove_prefix(n);
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			void svf_writer::put_hex(uint64_t value, std::size_t bits)
+			{
+				char text[16u];
+				const std::size_t digits = std::max<std::size_t>((bits + 3u) / 4u, 1u);
+
+				for (std::size_t i = 0u; i < digits; ++i)
+					text[digits - 1u - i] = HEX_DIGITS[(value >> (4u * i)) & 0xFu];
+
+				put(std::string_view(text, digits));
+			}
+
+			//------------------------------------------------------------------------------------------
+			uint64_t svf_writer::ir_value(uint8_t instr) const noexcept
+			{
+				uint64_t value = 0u;
+
+				for (std::size_t k = 0u; k < options_.num_slrs; ++k)
+					value |= static_cast<uint64_t>(instr & 0x3Fu) << (k * IR_BITS_PER_SLR);
+
+				return value;
+			}
+
+			//------------------------------------------------------------------------------------------
+			void svf_writer::write_sir(jtag_instruction instr, std::optional<uint8_t> tdo, uint8_t mask)
+			{
+				const std::size_t ir_bits = options_.num_slrs * IR_BITS_PER_SLR;
+
+				put("SIR ");
+				put(std::to_string(ir_bits));
+				put(" TDI (");
+				put_hex(ir_value(static_cast<uint8_t>(instr)), ir_bits);
+
+				if (tdo)
+				{
+					put(") TDO (");
+					put_hex(ir_value(*tdo), ir_bits);
+					put(") MASK (");
+					put_hex(ir_value(mask), ir_bits);
+				}
+
+				put(");\n");
+			}
+
+			//------------------------------------------------------------------------------------------
+			void svf_writer::write_sdr(std::span<const std::span<const uint8_t>> stream, uint64_t first, uint64_t count)
+			{
+				put("SDR ");
+				put(std::to_string(count * 8u));
+				put(" TDI (");
+
+				// The last byte of the range is shifted last, i.e. it is formatted first
+				uint64_t seg_end = 0u;
+				for (const auto& seg : stream)
+					seg_end += seg.size();
+
+				const uint64_t last = first + count;
+
+				for (auto it = stream.rbegin(); it != stream.rend(); ++it)
+				{
+					const uint64_t seg_begin = seg_end - it->size();
+					const uint64_t lo = std::max(seg_begin, first);
+					const uint64_t hi = std::min(seg_end, last);
+
+					seg_end = seg_begin;
+
+					if (lo >= hi)
+						continue;
+
+					// Format the bytes [lo, hi) of this segment backwards, one buffer fill at a time
+					const uint8_t* src = it->data() + (hi - seg_begin);
+					std::size_t remaining = static_cast<std::size_t>(hi - lo);
+
+					while (remaining > 0u)
+					{
+						if (buffer_.size() - used_ < 2u)
+							flush();
+
+						const std::size_t n = std::min(remaining, (buffer_.size() - used_) / 2u);
+						char* dst = buffer_.data() + used_;
+
+						for (std::size_t i = 0u; i < n; ++i)
+						{
+							const auto& hex = SDR_TABLE[*--src];
+							dst[0u] = hex[0u];
+							dst[1u] = hex[1u];
+							dst += 2u;
+						}
+
+						used_ += 2u * n;
+						remaining -= n;
+					}
+				}
+
+				put(");\n");
+			}
+
+			//------------------------------------------------------------------------------------------
+			void svf_writer::write_program(std::span<const uint8_t> stream)
+			{
+				const std::span<const uint8_t> buffers[1u] = { stream };
+				write_program(std::span<const std::span<const uint8_t>>(buffers));
+			}
+
+			//------------------------------------------------------------------------------------------
+			void svf_writer::write_program(std::span<const std::span<const uint8_t>> stream)
+			{
+				uint64_t total = 0u;
+				for (const auto& seg : stream)
+					total += seg.size();
+
+				if (total == 0u)
+					throw std::invalid_argument("empty configuration bitstream");
+
+				// Chain setup (other devices in BYPASS)
+				put("! unbit svf programming sequence\n");
+				put("TRST OFF;\nENDIR IDLE;\nENDDR IDLE;\nSTATE RESET;\nSTATE IDLE;\n");
+
+				const auto chain = [&](std::string_view cmd, std::size_t bits, bool ones)
+				{
+					put(cmd);
+					put(std::to_string(bits));
+
+					if (bits > 0u)
+					{
+						put(" TDI (");
+						put(ones ? ones_hex(bits) : std::string((bits + 3u) / 4u, '0'));
+						put(")");
+					}
+
+					put(";\n");
+				};
+
+				chain("HIR ", options_.header_ir_bits, true);
+				chain("TIR ", options_.trailer_ir_bits, true);
+				chain("HDR ", options_.header_dr_bits, false);
+				chain("TDR ", options_.trailer_dr_bits, false);
+
+				// Device check
+				if (options_.idcode)
+				{
+					write_sir(jtag_instruction::IDCODE);
+					put("SDR 32 TDI (00000000) TDO (");
+					put_hex(*options_.idcode & options_.idcode_mask, 32u);
+					put(") MASK (");
+					put_hex(options_.idcode_mask, 32u);
+					put(");\n");
+				}
+
+				// Clear the configuration memory
+				write_sir(jtag_instruction::JPROGRAM);
+				write_sir(jtag_instruction::ISC_NOOP);
+				put("RUNTEST ");
+				put(std::to_string(options_.clear_wait_tck));
+				put(" TCK;\n");
+
+				if (options_.check_status)
+					write_sir(jtag_instruction::ISC_NOOP, IR_CAPTURE_INIT, IR_MASK_INIT);
+
+				// Configuration data (chunked shifts pause in DRPAUSE to keep CFG_IN selected)
+				write_sir(jtag_instruction::CFG_IN);
+
+				const uint64_t chunk = (options_.chunk_bytes > 0u) ? options_.chunk_bytes : total;
+
+				if (chunk < total)
+					put("ENDDR DRPAUSE;\n");
+
+				for (uint64_t pos = 0u; pos < total; pos += chunk)
+				{
+					const uint64_t count = std::min(chunk, total - pos);
+
+					if (chunk < total && pos + count == total)
+						put("ENDDR IDLE;\n");
+
+					write_sdr(stream, pos, count);
+					++num_shifts_;
+				}
+
+				// Startup
+				write_sir(jtag_instruction::JSTART);
+				put("RUNTEST ");
+				put(std::to_string(options_.startup_wait_tck));
+				put(" TCK;\n");
+
+				if (options_.check_status)
+					write_sir(jtag_instruction::BYPASS, IR_CAPTURE_DONE, IR_MASK_DONE);
+				else
+					write_sir(jtag_instruction::BYPASS);
+
+				put("STATE RESET;\n");
+				flush();
+			}
+		}
+	}
+}
@@ -0,0 +1,263 @@
+/**
+ * @file
+ * @brief ELF symbol table support
+ */
+#include "unbit/ihex/elf.hpp"
+
+#include "image_detail.hpp"
+
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace
+	{
+		//-----------------------------------------------------------------------------------------
+		/** @brief Section type of the static symbol table (SHT_SYMTAB) */
+		static constexpr uint32_t SHT_SYMTAB = 2u;
+
+		/** @brief Section type of the dynamic symbol table (SHT_DYNSYM) */
+		static constexpr uint32_t SHT_DYNSYM = 11u;
+
+		/** @brief Section index of undefined symbols (SHN_UNDEF) */
+		static constexpr uint16_t SHN_UNDEF = 0u;
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Bounds-checked reader for the fields of an ELF file.
+		 */
+		class elf_reader
+		{
+		private:
+			/** @brief Content of the ELF file */
+			std::span<const uint8_t> data_;
+
+			/** @brief Byte order of the ELF file */
+			bool big_endian_;
+
+		public:
+			/**
+			 * @brief Constructs a reader.
+			 */
+			elf_reader(std::span<const uint8_t> data, bool big_endian)
+				: data_(data), big_endian_(big_endian)
+			{
+			}
+
+			/**
+			 * @brief Checks that a range lies within the file.
+			 */
+			void check(uint64_t offset, uint64_t size) const
+			{
+				if (offset > data_.size() || size > data_.size() - offset)
+				{
+					throw std::runtime_error("malformed ELF file (truncated)");
+				}
+			}
+
+			/**
+			 * @brief Reads an unsigned integer field (of 1 to 8 bytes).
+			 */
+			uint64_t read(uint64_t offset, unsigned size) const
+			{
+				check(offset, size);
+
+				uint64_t value = 0u;
+				for (unsigned i = 0u; i < size; ++i)
+				{
+					const unsigned shift = big_endian_ ? 8u * (size - 1u - i) : 8u * i;
+					value |= static_cast<uint64_t>(data_[offset + i]) << shift;
+				}
+
+				return value;
+			}
+
+			/**
+			 * @brief Reads a NUL-terminated string from a string table.
+			 */
+			std::string string(uint64_t table_offset, uint64_t table_size, uint64_t index) const
+			{
+				check(table_offset, table_size);
+
+				if (index >= table_size)
+				{
+					throw std::runtime_error("malformed ELF file (string index out of range)");
+				}
+
+				const char* const first = reinterpret_cast<const char*>(data_.data() + table_offset);
+				const char* const last = first + table_size;
+				const char* pos = first + index;
+				const char* end = pos;
+
+				while (end != last && *end != '\0')
+					++end;
+
+				return std::string(pos, end);
+			}
+		};
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Converts the type field of a symbol.
+		 */
+		static elf::symbol_type to_symbol_type(unsigned type)
+		{
+			return (type <= 6u) ? static_cast<elf::symbol_type>(type) : elf::symbol_type::other;
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Converts the binding field of a symbol.
+		 */
+		static elf::symbol_binding to_symbol_binding(unsigned binding)
+		{
+			return (binding <= 2u) ? static_cast<elf::symbol_binding>(binding) : elf::symbol_binding::other;
+		}
+	}
+
+	//---------------------------------------------------------------------------------------------
+	std::vector<elf::symbol> elf::load_symbols(const std::string& filename)
+	{
+		const detail::mapped_file file(filename);
+		const auto text = file.text();
+
+		return parse_symbols(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+	}
+
+	//---------------------------------------------------------------------------------------------
+	std::vector<elf::symbol> elf::parse_symbols(std::span<const uint8_t> data)
+	{
+		// Identification (magic, class and byte order)
+		if (data.size() < 16u || data[0u] != 0x7Fu || data[1u] != 'E' || data[2u] != 'L' || data[3u] != 'F')
+		{
+			throw std::runtime_error("not an ELF file");
+		}
+
+		const bool is_64bit = (data[4u] == 2u);
+		if (data[4u] != 1u && data[4u] != 2u)
+		{
+			throw std::runtime_error("unsupported ELF file class");
+		}
+
+		if (data[5u] != 1u && data[5u] != 2u)
+		{
+			throw std::runtime_error("unsupported ELF file byte order");
+		}
+
+		const elf_reader rd(data, data[5u] == 2u);
+
+		// Section header table
+		const unsigned addr_size = is_64bit ? 8u : 4u;
+		const uint64_t shoff     = rd.read(is_64bit ? 0x28u : 0x20u, addr_size);
+		const uint64_t shentsize = rd.read(is_64bit ? 0x3Au : 0x2Eu, 2u);
+		uint64_t shnum           = rd.read(is_64bit ? 0x3Cu : 0x30u, 2u);
+
+		// Layout of section headers and symbols
+		const uint64_t sh_type   = 4u;
+		const uint64_t sh_offset = is_64bit ? 24u : 16u;
+		const uint64_t sh_size   = is_64bit ? 32u : 20u;
+		const uint64_t sh_link   = is_64bit ? 40u : 24u;
+		const uint64_t sh_entsize = is_64bit ? 56u : 36u;
+		const uint64_t min_shentsize = is_64bit ? 64u : 40u;
+
+		const uint64_t st_value = is_64bit ? 8u : 4u;
+		const uint64_t st_size  = is_64bit ? 16u : 8u;
+		const uint64_t st_info  = is_64bit ? 4u : 12u;
+		const uint64_t st_shndx = is_64bit ? 6u : 14u;
+		const uint64_t min_symsize = is_64bit ? 24u : 16u;
+
+		if (shoff == 0u)
+		{
+			// No section headers (e.g. a stripped executable)
+			return {};
+		}
+
+		if (shentsize < min_shentsize)
+		{
+			throw std::runtime_error("malformed ELF file (section header size)");
+		}
+
+		if (shnum == 0u)
+		{
+			// Extended numbering (the number of sections is kept in the first section header)
+			shnum = rd.read(shoff + sh_size, addr_size);
+		}
+
+		if (shnum > data.size() / shentsize)
+		{
+			throw std::runtime_error("malformed ELF file (truncated)");
+		}
+
+		rd.check(shoff, shnum * shentsize);
+
+		// Prefer the static symbol table, fall back to the dynamic symbol table
+		uint64_t symtab = shnum;
+		for (uint64_t i = 0u; i < shnum; ++i)
+		{
+			const uint32_t type = static_cast<uint32_t>(rd.read(shoff + i * shentsize + sh_type, 4u));
+
+			if (type == SHT_SYMTAB)
+			{
+				symtab = i;
+				break;
+			}
+			else if (type == SHT_DYNSYM && symtab == shnum)
+			{
+				symtab = i;
+			}
+		}
+
+		if (symtab == shnum)
+		{
+			// No symbol table
+			return {};
+		}
+
+		const uint64_t symtab_hdr = shoff + symtab * shentsize;
+		const uint64_t sym_offset = rd.read(symtab_hdr + sh_offset, addr_size);
+		const uint64_t sym_size   = rd.read(symtab_hdr + sh_size, addr_size);
+		const uint64_t strtab     = rd.read(symtab_hdr + sh_link, 4u);
+		uint64_t sym_entsize      = rd.read(symtab_hdr + sh_entsize, addr_size);
+
+		if (sym_entsize == 0u)
+			sym_entsize = min_symsize;
+
+		if (sym_entsize < min_symsize || strtab >= shnum)
+		{
+			throw std::runtime_error("malformed ELF file (symbol table)");
+		}
+
+		rd.check(sym_offset, sym_size);
+
+		const uint64_t strtab_hdr = shoff + strtab * shentsize;
+		const uint64_t str_offset = rd.read(strtab_hdr + sh_offset, addr_size);
+		const uint64_t str_size   = rd.read(strtab_hdr + sh_size, addr_size);
+
+		// Collect the defined symbols (the first entry is the reserved null symbol)
+		const uint64_t num_symbols = sym_size / sym_entsize;
+
+		std::vector<symbol> symbols;
+		symbols.reserve(num_symbols);
+
+		for (uint64_t i = 1u; i < num_symbols; ++i)
+		{
+			const uint64_t entry = sym_offset + i * sym_entsize;
+
+			const unsigned info  = static_cast<unsigned>(rd.read(entry + st_info, 1u));
+			const uint16_t shndx = static_cast<uint16_t>(rd.read(entry + st_shndx, 2u));
+			const symbol_type type = to_symbol_type(info & 0xFu);
+
+			if (shndx == SHN_UNDEF || type == symbol_type::section || type == symbol_type::file)
+				continue;
+
+			symbol& sym = symbols.emplace_back();
+			sym.name    = rd.string(str_offset, str_size, rd.read(entry, 4u));
+			sym.address = rd.read(entry + st_value, addr_size);
+			sym.size    = rd.read(entry + st_size, addr_size);
+			sym.type    = type;
+			sym.binding = to_symbol_binding(info >> 4u);
+		}
+
+		return symbols;
+	}
+}
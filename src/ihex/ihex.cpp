@@ -3,10 +3,17 @@
  * @brief Intel-Hex support library
  */
 #include "unbit/ihex/ihex.hpp"
+#include "unbit/runtime/executor.hpp"
 
+#include "image_detail.hpp"
+
+#include <array>
 #include <cctype>
+#include <exception>
 #include <fstream>
+#include <iterator>
 #include <stdexcept>
+#include <tuple>
 
 namespace unbit
 {
@@ -18,19 +25,17 @@ namespace unbit
 		 *
 		 * @return A tuple of [start,end) iterators marking the start and end of the string.
 		 */
-		static auto trim(const std::string& line)
+		template<typename Iterator>
+		static auto trim(Iterator start, Iterator end)
 		{
-			auto start = line.begin();
-			auto end   = line.end();
-
 			// Skip leading whitespace
-			while (start != end && std::isspace(*start))
+			while (start != end && std::isspace(static_cast<unsigned char>(*start)))
 			{
 				++start;
 			}
 
 			// Skip trailing whitespace
-			while (start != end && std::isspace(*(end - 1u)))
+			while (start != end && std::isspace(static_cast<unsigned char>(*(end - 1u))))
 			{
 				--end;
 			}
@@ -42,7 +47,8 @@ namespace unbit
 		/**
 		 * @brief Extracts the next character from a line in an Intel-Hex file.
 		 */
-		static auto next(std::string::const_iterator& pos, std::string::const_iterator end)
+		template<typename Iterator>
+		static auto next(Iterator& pos, Iterator end)
 		{
 			if (pos == end)
 			{
@@ -58,33 +64,25 @@ namespace unbit
 		 *
 		 * @return The decoded nibble value
 		 */
-		static uint32_t nibble(std::string::const_iterator& pos, std::string::const_iterator end)
+		template<typename Iterator>
+		static uint32_t nibble(Iterator& pos, Iterator end)
 		{
-			auto xdigit = std::toupper(next(pos, end));
+			const uint32_t value = detail::hex_nibble(next(pos, end));
 
-			if (xdigit >= '0' && xdigit <= '9')
-			{
-				return static_cast<uint32_t>(xdigit - '0');
-			}
-			else if (xdigit >= 'A' && xdigit <= 'F')
-			{
-				return static_cast<uint32_t>(xdigit - 'A' + 10);
-			}
-			else if (xdigit >= 'a' && xdigit <= 'f')
-			{
-				return static_cast<uint32_t>(xdigit - 'a' + 10);
-			}
-			else
+			if (value > 0xFu)
 			{
 				throw std::invalid_argument("invalid hex digit in intel hex file");
 			}
+
+			return value;
 		}
 
 		//-----------------------------------------------------------------------------------------
 		/**
 		 * @brief Extracts an 8-bit usigned integer value
 		 */
-		static uint32_t u8(std::string::const_iterator& pos, std::string::const_iterator end)
+		template<typename Iterator>
+		static uint32_t u8(Iterator& pos, Iterator end)
 		{
 			const auto hi = nibble(pos, end);
 			const auto lo = nibble(pos, end);
@@ -95,7 +93,8 @@ namespace unbit
 		/**
 		 * @brief Extracts an 16-bit usigned integer value
 		 */
-		static uint32_t u16(std::string::const_iterator& pos, std::string::const_iterator end)
+		template<typename Iterator>
+		static uint32_t u16(Iterator& pos, Iterator end)
 		{
 			const auto hi = u8(pos, end);
 			const auto lo = u8(pos, end);
@@ -106,11 +105,12 @@ namespace unbit
 		/**
 		 * @brief Parses a single line from an Intel-Hex file.
 		 */
-		static bool parse_record(ihex::record& r, const std::string& line)
+		template<typename Iterator>
+		static bool parse_record(ihex::record& r, Iterator line_start, Iterator line_end)
 		{
-			std::string::const_iterator pos, end;
+			Iterator pos, end;
 
-			std::tie(pos, end) = trim(line);
+			std::tie(pos, end) = trim(line_start, line_end);
 			if (pos == end)
 			{
 				// Empty record (can be skipped)
@@ -147,97 +147,85 @@ namespace unbit
 			// Record parsed
 			return true;
 		}
-	}
-
-	//---------------------------------------------------------------------------------------------
-	uint32_t ihex::load(const std::string& filename,
-						const std::function<void(uint32_t,const std::vector<uint8_t>&)>& callback)
-	{
-		std::ifstream stm(filename, std::ios_base::in);
-
-		return load(stm, callback);
-	}
-
-	//---------------------------------------------------------------------------------------------
-	uint32_t ihex::load(std::istream& stm,
-						const std::function<void(uint32_t,const std::vector<uint8_t>&)>& load_callback)
-	{
-		uint32_t entrypoint    = 0u;
-		uint32_t segment_base  = 0u;
 
-		parse(stm, [&] (const auto& r)
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Applies a non-data record (types 1 to 5) to the loader state.
+		 *
+		 * @param[in] type is the type of the record to be applied.
+		 * @param[in] data is the payload of the record to be applied.
+		 * @param[in,out] segment_base is the base address of the following data records.
+		 * @param[in,out] entrypoint is the entrypoint indicated in the hex file.
+		 *
+		 * @return @c false if the record is an end of file record.
+		 */
+		static bool apply_record(uint8_t type, std::span<const uint8_t> data, uint32_t& segment_base, uint32_t& entrypoint)
 		{
-			if (r.type == 0x00u)
-			{
-				// Data Record (type 0)
-				load_callback(segment_base + r.address, r.data);
-				return true;
-			}
-			else if (r.type == 0x01u)
+			if (type == 0x01u)
 			{
 				// End of file record (type 1)
 				return false;
 			}
-			else if (r.type == 0x02u)
+			else if (type == 0x02u)
 			{
 				// Extended Segment Address Record (type 2)
-				if (r.data.size() != 2)
+				if (data.size() != 2)
 				{
 					throw std::invalid_argument("unsupported extended segment address "
 												"(type 2) record.");
 				}
 
-				const uint32_t segment = static_cast<uint32_t>(r.data[1u]) |
-					(static_cast<uint32_t>(r.data[0u]) << 8u);
+				const uint32_t segment = static_cast<uint32_t>(data[1u]) |
+					(static_cast<uint32_t>(data[0u]) << 8u);
 
 				segment_base = segment * 0x10u;
 				return true;
 			}
-			else if (r.type == 0x03u)
+			else if (type == 0x03u)
 			{
 				// Start Segment Address Record (type 3)
-				if (r.data.size() != 4)
+				if (data.size() != 4)
 				{
 					throw std::invalid_argument("unsupported start segment address "
 												"(type 3) record.");
 				}
 
-				const uint32_t segment = static_cast<uint32_t>(r.data[1u]) |
-					(static_cast<uint32_t>(r.data[0u]) << 8u);
+				const uint32_t segment = static_cast<uint32_t>(data[1u]) |
+					(static_cast<uint32_t>(data[0u]) << 8u);
 
-				const uint32_t offset = static_cast<uint32_t>(r.data[3u]) |
-					(static_cast<uint32_t>(r.data[2u]) << 8u);
+				const uint32_t offset = static_cast<uint32_t>(data[3u]) |
+					(static_cast<uint32_t>(data[2u]) << 8u);
 
 				entrypoint = segment * 0x10u + offset;
 				return true;
 			}
-			else if (r.type == 0x04u)
+			else if (type == 0x04u)
 			{
 				// Extended Linear Address Record (type 4)
-				if (r.data.size() != 2)
+				if (data.size() != 2)
 				{
 					throw std::invalid_argument("unsupported extended linear address "
 												"(type 4) record.");
 				}
 
-				segment_base = (static_cast<uint32_t>(r.data[0u]) << 24u) |
-					(static_cast<uint32_t>(r.data[1u]) << 16u);
+				segment_base = (static_cast<uint32_t>(data[0u]) << 24u) |
+					(static_cast<uint32_t>(data[1u]) << 16u);
 
 				return true;
 			}
-			else if (r.type == 0x05u)
+			else if (type == 0x05u)
 			{
 				// Start Linear Address Record (type 5)
-				if (r.data.size() != 4)
+				if (data.size() != 4)
 				{
 					throw std::invalid_argument("unsupported start linear address "
 												"(type 5) record.");
 				}
 
-				entrypoint = static_cast<uint32_t>(r.data[3u]) |
-					(static_cast<uint32_t>(r.data[2u]) << 8u)  |
-					(static_cast<uint32_t>(r.data[1u]) << 16u) |
-					(static_cast<uint32_t>(r.data[0u]) << 24u);
+				entrypoint = static_cast<uint32_t>(data[3u]) |
+					(static_cast<uint32_t>(data[2u]) << 8u)  |
+					(static_cast<uint32_t>(data[1u]) << 16u) |
+					(static_cast<uint32_t>(data[0u]) << 24u);
 
 				return true;
 			}
@@ -245,6 +233,127 @@ namespace unbit
 			{
 				throw std::invalid_argument("unsupported record type in intel hex file");
 			}
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Decoded Intel-Hex record (with inline payload storage).
+		 */
+		struct record_view
+		{
+			/** @brief Record type */
+			uint8_t type = 0u;
+
+			/** @brief Address field */
+			uint16_t address = 0u;
+
+			/** @brief Payload length */
+			uint8_t length = 0u;
+
+			/** @brief Payload data */
+			std::array<uint8_t, 255u> data;
+
+			/** @brief Gets the payload of the record */
+			inline std::span<const uint8_t> payload() const
+			{
+				return std::span<const uint8_t>(data.data(), length);
+			}
+		};
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Decodes a byte from a line in an Intel-Hex file (table-driven).
+		 */
+		static uint32_t decode_u8(const char*& pos, const char* end)
+		{
+			if ((end - pos) < 2)
+			{
+				throw std::runtime_error("unexpected end of line in intel hex file");
+			}
+
+			const uint32_t value = detail::hex_byte(pos);
+			if (value > 0xFFu)
+			{
+				throw std::invalid_argument("invalid hex digit in intel hex file");
+			}
+
+			pos += 2u;
+			return value;
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Decodes a single line from an Intel-Hex file (without allocating memory).
+		 *
+		 * @return @c false if the line is empty, @c true if a record was decoded.
+		 */
+		static bool decode_record(record_view& r, const char* pos, const char* end)
+		{
+			detail::trim_line(pos, end);
+			if (pos == end)
+			{
+				// Empty record (can be skipped)
+				return false;
+			}
+
+			// Start of record (':')
+			if (*pos++ != ':')
+			{
+				throw std::invalid_argument("unexpected character at start of record");
+			}
+
+			// Payload len, address (16-bit) and record type
+			r.length  = static_cast<uint8_t>(decode_u8(pos, end));
+			r.address = static_cast<uint16_t>(decode_u8(pos, end) << 8u);
+			r.address = static_cast<uint16_t>(r.address | decode_u8(pos, end));
+			r.type    = static_cast<uint8_t>(decode_u8(pos, end));
+
+			for (size_t i = 0u; i < r.length; ++i)
+			{
+				r.data[i] = static_cast<uint8_t>(decode_u8(pos, end));
+			}
+
+			// Checksum (not verified, as with the stream parser)
+			decode_u8(pos, end);
+
+			// Throw on unexpected extra data
+			if (pos != end)
+			{
+				throw std::invalid_argument("unexpected extra data at end of record");
+			}
+
+			return true;
+		}
+	}
+
+	//---------------------------------------------------------------------------------------------
+	uint32_t ihex::load(const std::string& filename,
+						const std::function<void(uint32_t,const std::vector<uint8_t>&)>& callback)
+	{
+		std::ifstream stm(filename, std::ios_base::in);
+
+		return load(stm, callback);
+	}
+
+	//---------------------------------------------------------------------------------------------
+	uint32_t ihex::load(std::istream& stm,
+						const std::function<void(uint32_t,const std::vector<uint8_t>&)>& load_callback)
+	{
+		uint32_t entrypoint    = 0u;
+		uint32_t segment_base  = 0u;
+
+		parse(stm, [&] (const auto& r)
+		{
+			if (r.type == 0x00u)
+			{
+				// Data Record (type 0)
+				load_callback(segment_base + r.address, r.data);
+				return true;
+			}
+			else
+			{
+				return apply_record(r.type, r.data, segment_base, entrypoint);
+			}
 		});
 
 		return entrypoint;
@@ -267,7 +376,7 @@ namespace unbit
 
 		while (std::getline(stm, line))
 		{
-			if (parse_record(r, line))
+			if (parse_record(r, line.cbegin(), line.cend()))
 			{
 				// Non-empty record (invoke parser callback)
 				if (!callback(r))
@@ -282,4 +391,223 @@ namespace unbit
 			throw std::runtime_error("failed to parse the intel-hex file");
 		}
 	}
+
+	//---------------------------------------------------------------------------------------------
+	uint32_t ihex::parse_records(std::string_view text, const record_callback& callback)
+	{
+		uint32_t entrypoint   = 0u;
+		uint32_t segment_base = 0u;
+		record_view r;
+
+		detail::for_each_line(text.data(), text.data() + text.size(), [&](const char* line, const char* line_end)
+		{
+			if (!decode_record(r, line, line_end))
+			{
+				// Empty record (can be skipped)
+				return true;
+			}
+
+			if (r.type == 0x00u)
+			{
+				// Data Record (type 0)
+				callback(segment_base + r.address, r.payload());
+				return true;
+			}
+
+			return apply_record(r.type, r.payload(), segment_base, entrypoint);
+		});
+
+		return entrypoint;
+	}
+
+	namespace
+	{
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Chunk of Intel-Hex text (with the results of the address record scan).
+		 */
+		struct hex_chunk : detail::text_chunk
+		{
+			/** @brief The chunk contains an extended address record (type 2/4) */
+			bool has_base = false;
+
+			/** @brief Base address after the last extended address record of the chunk */
+			uint32_t last_base = 0u;
+
+			/** @brief The chunk contains the end of file record */
+			bool has_eof = false;
+
+			/** @brief Error raised while scanning the chunk (scanning stops at the error) */
+			std::exception_ptr error;
+		};
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Result of loading a chunk.
+		 */
+		struct hex_chunk_result
+		{
+			/** @brief Data runs (in file order) */
+			std::vector<detail::data_run> runs;
+
+			/** @brief The chunk indicates an entrypoint (type 3/5 record) */
+			bool has_entry = false;
+
+			/** @brief Last entrypoint indicated in the chunk */
+			uint32_t entrypoint = 0u;
+		};
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Phase 1: Scans a chunk for extended address records and the end of file record.
+		 */
+		static void scan_chunk(hex_chunk& chunk)
+		{
+			try
+			{
+				record_view r;
+				uint32_t entrypoint = 0u;
+
+				detail::for_each_line(chunk.begin, chunk.end, [&](const char* line, const char* line_end)
+				{
+					const char* pos = line;
+					const char* end = line_end;
+					detail::trim_line(pos, end);
+
+					// Peek at the record type (malformed records are diagnosed in phase 2)
+					if ((end - pos) < 9 || *pos != ':')
+						return true;
+
+					const uint32_t type = detail::hex_byte(pos + 7);
+
+					if (type == 0x01u)
+					{
+						chunk.has_eof = true;
+						return false;
+					}
+					else if (type == 0x02u || type == 0x04u)
+					{
+						decode_record(r, pos, end);
+						apply_record(r.type, r.payload(), chunk.last_base, entrypoint);
+						chunk.has_base = true;
+					}
+
+					return true;
+				});
+			}
+			catch (...)
+			{
+				chunk.error = std::current_exception();
+			}
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Phase 2: Loads the records of a chunk (starting at the given base address).
+		 */
+		static hex_chunk_result load_chunk(const hex_chunk& chunk, uint32_t segment_base)
+		{
+			hex_chunk_result result;
+			record_view r;
+
+			detail::for_each_line(chunk.begin, chunk.end, [&](const char* line, const char* line_end)
+			{
+				if (!decode_record(r, line, line_end))
+				{
+					// Empty record (can be skipped)
+					return true;
+				}
+
+				if (r.type == 0x00u)
+				{
+					// Data Record (type 0), extends the current run if contiguous
+					detail::append_run(result.runs, segment_base + r.address, r.data.data(), r.length);
+					return true;
+				}
+
+				const bool more = apply_record(r.type, r.payload(), segment_base, result.entrypoint);
+				result.has_entry = result.has_entry || r.type == 0x03u || r.type == 0x05u;
+				return more;
+			});
+
+			return result;
+		}
+	}
+
+	//---------------------------------------------------------------------------------------------
+	ihex::image ihex::load_image(const std::string& filename)
+	{
+		const detail::mapped_file file(filename);
+
+		return parse_image(file.text());
+	}
+
+	//---------------------------------------------------------------------------------------------
+	ihex::image ihex::parse_image(std::string_view text)
+	{
+		auto& exec = runtime::executor::global();
+
+		// Phase 1: Split at line boundaries, then scan the chunks for address records
+		std::vector<hex_chunk> chunks;
+
+		for (const auto& c : detail::split_lines(text, 4u * exec.concurrency()))
+		{
+			hex_chunk& chunk = chunks.emplace_back();
+			chunk.begin = c.begin;
+			chunk.end = c.end;
+		}
+
+		runtime::parallel_for(exec, 0u, chunks.size(), [&](size_t i)
+		{
+			scan_chunk(chunks[i]);
+		});
+
+		// Base address at the start of each chunk (chunks behind the end of file are dropped)
+		std::vector<uint32_t> start_base(chunks.size());
+		uint32_t base = 0u;
+		size_t num_chunks = 0u;
+		bool has_eof = false;
+
+		while (num_chunks < chunks.size() && !has_eof)
+		{
+			const auto& chunk = chunks[num_chunks];
+
+			if (chunk.error)
+				std::rethrow_exception(chunk.error);
+
+			start_base[num_chunks++] = base;
+
+			if (chunk.has_base)
+				base = chunk.last_base;
+
+			has_eof = chunk.has_eof;
+		}
+
+		// The end of file record is mandatory (as with load)
+		if (!has_eof)
+			throw std::runtime_error("missing end of file record in intel hex file");
+
+		// Phase 2: Load the chunks
+		std::vector<hex_chunk_result> results(num_chunks);
+
+		runtime::parallel_for(exec, 0u, num_chunks, [&](size_t i)
+		{
+			results[i] = load_chunk(chunks[i], start_base[i]);
+		});
+
+		// Merge the results (in file order)
+		image result;
+		std::vector<detail::data_run> runs;
+
+		for (auto& r : results)
+		{
+			std::move(r.runs.begin(), r.runs.end(), std::back_inserter(runs));
+
+			if (r.has_entry)
+				result.entrypoint = r.entrypoint;
+		}
+
+		result.segments = detail::merge_runs(runs);
+		return result;
+	}
 }
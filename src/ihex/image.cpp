@@ -0,0 +1,176 @@
+/**
+ * @file
+ * @brief Sparse memory images (shared infrastructure of the image loaders)
+ */
+#include "unbit/ihex/image.hpp"
+
+#include "image_detail.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__linux__)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace unbit
+{
+	//---------------------------------------------------------------------------------------------
+	size_t memory_image::size() const
+	{
+		size_t total = 0u;
+		for (const auto& seg : segments)
+		{
+			total += seg.data.size();
+		}
+
+		return total;
+	}
+
+	namespace detail
+	{
+		//-----------------------------------------------------------------------------------------
+		std::vector<text_chunk> split_lines(std::string_view text, size_t max_chunks)
+		{
+			const size_t num_chunks = std::max<size_t>(1u, std::min(max_chunks, text.size() / MIN_CHUNK_SIZE));
+			const char* const end = text.data() + text.size();
+
+			std::vector<text_chunk> chunks;
+			chunks.reserve(num_chunks);
+
+			const char* pos = text.data();
+			for (size_t i = 1u; i <= num_chunks && pos != end; ++i)
+			{
+				const char* split = (i == num_chunks) ? end : text.data() + (text.size() / num_chunks) * i;
+
+				if (split <= pos)
+					continue;
+
+				// Move the split point behind the next line terminator
+				if (split != end)
+				{
+					const char* eol = static_cast<const char*>(std::memchr(split, '\n', static_cast<size_t>(end - split)));
+					split = eol ? eol + 1 : end;
+				}
+
+				chunks.push_back(text_chunk { pos, split });
+				pos = split;
+			}
+
+			return chunks;
+		}
+
+		//-----------------------------------------------------------------------------------------
+		void append_run(std::vector<data_run>& runs, uint32_t address, const uint8_t* data, size_t length)
+		{
+			if (runs.empty() ||
+				static_cast<uint64_t>(runs.back().address) + runs.back().data.size() != address)
+			{
+				runs.emplace_back().address = address;
+			}
+
+			auto& run = runs.back().data;
+			run.insert(run.end(), data, data + length);
+		}
+
+		//-----------------------------------------------------------------------------------------
+		std::vector<image_segment> merge_runs(std::vector<data_run>& runs)
+		{
+			std::vector<size_t> order(runs.size());
+			std::iota(order.begin(), order.end(), size_t(0u));
+
+			std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+			{
+				return runs[a].address < runs[b].address;
+			});
+
+			std::vector<image_segment> segments;
+
+			for (size_t i = 0u; i < order.size(); )
+			{
+				// Collect a cluster of overlapping or adjacent runs
+				const uint64_t start = runs[order[i]].address;
+				uint64_t end = start + runs[order[i]].data.size();
+				size_t j = i + 1u;
+
+				while (j < order.size() && runs[order[j]].address <= end)
+				{
+					end = std::max<uint64_t>(end, runs[order[j]].address + runs[order[j]].data.size());
+					++j;
+				}
+
+				image_segment& seg = segments.emplace_back();
+				seg.address = static_cast<uint32_t>(start);
+
+				if (j == i + 1u)
+				{
+					seg.data = std::move(runs[order[i]].data);
+				}
+				else
+				{
+					// Paint the runs in file order (the last run wins)
+					std::sort(order.begin() + i, order.begin() + j);
+					seg.data.resize(end - start);
+
+					for (size_t k = i; k < j; ++k)
+					{
+						const auto& run = runs[order[k]];
+						std::copy(run.data.begin(), run.data.end(), seg.data.begin() + (run.address - start));
+					}
+				}
+
+				i = j;
+			}
+
+			return segments;
+		}
+
+		//-----------------------------------------------------------------------------------------
+		mapped_file::mapped_file(const std::string& filename)
+			: mapping_(nullptr), size_(0u)
+		{
+#if defined(__linux__)
+			const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd >= 0)
+			{
+				struct stat st;
+				if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+				{
+					void* mem = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+					if (mem != MAP_FAILED)
+					{
+						::madvise(mem, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+						mapping_ = mem;
+						size_ = static_cast<size_t>(st.st_size);
+					}
+				}
+
+				::close(fd);
+			}
+
+			if (mapping_)
+				return;
+#endif
+			std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+			if (!stm)
+				throw std::runtime_error("failed to open the image file '" + filename + "'");
+
+			buffer_.assign(std::istreambuf_iterator<char>(stm), std::istreambuf_iterator<char>());
+		}
+
+		//-----------------------------------------------------------------------------------------
+		mapped_file::~mapped_file()
+		{
+#if defined(__linux__)
+			if (mapping_)
+				::munmap(mapping_, size_);
+#endif
+		}
+	}
+}
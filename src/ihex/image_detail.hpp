@@ -0,0 +1,204 @@
+/**
+ * @file
+ * @brief Detail implementation of the image loaders (hex decoding, chunking and merging).
+ */
+#ifndef UNBIT_IMAGE_DETAIL_HPP_
+#define UNBIT_IMAGE_DETAIL_HPP_ 1
+
+#include "unbit/ihex/image.hpp"
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace unbit
+{
+	namespace detail
+	{
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Minimum size of a chunk for parallel loading (in bytes).
+		 */
+		static constexpr size_t MIN_CHUNK_SIZE = 1024u * 1024u;
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Builds the hex digit decoding table (0xFF marks non-hex characters).
+		 */
+		constexpr std::array<uint8_t, 256u> make_hex_table()
+		{
+			std::array<uint8_t, 256u> table {};
+
+			for (auto& v : table)
+				v = 0xFFu;
+
+			for (unsigned c = '0'; c <= '9'; ++c)
+				table[c] = static_cast<uint8_t>(c - '0');
+
+			for (unsigned c = 'A'; c <= 'F'; ++c)
+				table[c] = static_cast<uint8_t>(c - 'A' + 10u);
+
+			for (unsigned c = 'a'; c <= 'f'; ++c)
+				table[c] = static_cast<uint8_t>(c - 'a' + 10u);
+
+			return table;
+		}
+
+		/**
+		 * @brief Hex digit decoding table.
+		 */
+		inline constexpr std::array<uint8_t, 256u> hex_table = make_hex_table();
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Decodes a hex digit.
+		 *
+		 * @return The nibble value, or 0xFF if the character is not a hex digit.
+		 */
+		inline uint32_t hex_nibble(char c)
+		{
+			return hex_table[static_cast<unsigned char>(c)];
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Decodes a pair of hex digits.
+		 *
+		 * @return The byte value, or a value above 0xFF if either character is not a hex digit.
+		 */
+		inline uint32_t hex_byte(const char* pos)
+		{
+			const uint32_t hi = hex_nibble(pos[0u]);
+			const uint32_t lo = hex_nibble(pos[1u]);
+
+			// Invalid digits (0xFF) spill into bit 8 and above
+			return (hi << 4u) + lo + ((hi | lo) & 0xF0u) * 0x10u;
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Trims leading and trailing whitespace from a line.
+		 */
+		inline void trim_line(const char*& pos, const char*& end)
+		{
+			while (pos != end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n' || *pos == '\v' || *pos == '\f'))
+				++pos;
+
+			while (pos != end && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n' || end[-1] == '\v' || end[-1] == '\f'))
+				--end;
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Invokes a function for each line of a text.
+		 *
+		 * @param[in] fn is invoked with the [start,end) pointers of each line (without the line
+		 *   terminator) and returns @c false to stop.
+		 */
+		template<typename Fn>
+		void for_each_line(const char* pos, const char* end, Fn&& fn)
+		{
+			while (pos != end)
+			{
+				const char* eol = static_cast<const char*>(std::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+				const char* line_end = eol ? eol : end;
+
+				if (!fn(pos, line_end))
+					break;
+
+				pos = eol ? eol + 1 : end;
+			}
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Chunk of text (a sequence of complete lines).
+		 */
+		struct text_chunk
+		{
+			/** @brief Start of the chunk */
+			const char* begin;
+
+			/** @brief End of the chunk */
+			const char* end;
+		};
+
+		/**
+		 * @brief Splits a text into (at most max_chunks) chunks of complete lines.
+		 */
+		std::vector<text_chunk> split_lines(std::string_view text, size_t max_chunks);
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Contiguous data loaded from a chunk.
+		 */
+		struct data_run
+		{
+			/** @brief Start address of the run */
+			uint32_t address = 0u;
+
+			/** @brief Data bytes of the run */
+			std::vector<uint8_t> data;
+		};
+
+		/**
+		 * @brief Appends a data record to a sequence of runs (extends the last run if contiguous).
+		 */
+		void append_run(std::vector<data_run>& runs, uint32_t address, const uint8_t* data, size_t length);
+
+		/**
+		 * @brief Merges data runs (in file order) into the segments of an image.
+		 *
+		 * Overlapping and adjacent runs are combined into one segment; overlapping bytes are
+		 * taken from the run that appears last in the file.
+		 */
+		std::vector<image_segment> merge_runs(std::vector<data_run>& runs);
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Read-only view of a file (memory mapped if supported).
+		 */
+		class mapped_file
+		{
+		private:
+			/** @brief Mapped file contents (or nullptr) */
+			void* mapping_;
+
+			/** @brief Size of the mapping */
+			size_t size_;
+
+			/** @brief File contents (if the file could not be mapped) */
+			std::string buffer_;
+
+		public:
+			/**
+			 * @brief Maps (or reads) a file.
+			 *
+			 * @throws std::runtime_error if the file cannot be opened.
+			 */
+			explicit mapped_file(const std::string& filename);
+
+			/**
+			 * @brief Unmaps the file.
+			 */
+			~mapped_file();
+
+			/**
+			 * @brief Gets the contents of the file.
+			 */
+			inline std::string_view text() const
+			{
+				return mapping_ ? std::string_view(static_cast<const char*>(mapping_), size_) : std::string_view(buffer_);
+			}
+
+		private:
+			// Non-copyable
+			mapped_file(const mapped_file&) =delete;
+			mapped_file& operator=(const mapped_file&) =delete;
+		};
+	}
+}
+
+#endif // UNBIT_IMAGE_DETAIL_HPP_
@@ -0,0 +1,295 @@
+/**
+ * @file
+ * @brief Motorola S-record and raw binary image support
+ */
+#include "unbit/ihex/srec.hpp"
+#include "unbit/runtime/executor.hpp"
+
+#include "image_detail.hpp"
+
+#include <array>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace
+	{
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Decoded S-record (with inline payload storage).
+		 */
+		struct srec_record
+		{
+			/** @brief Record type (0 to 9) */
+			uint8_t type = 0u;
+
+			/** @brief Address field */
+			uint32_t address = 0u;
+
+			/** @brief Payload length */
+			uint8_t length = 0u;
+
+			/** @brief Payload data */
+			std::array<uint8_t, 255u> data;
+
+			/** @brief Gets the payload of the record */
+			inline std::span<const uint8_t> payload() const
+			{
+				return std::span<const uint8_t>(data.data(), length);
+			}
+		};
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Size of the address field of each record type (0 for reserved types).
+		 */
+		static constexpr std::array<uint8_t, 10u> address_size = { 2u, 2u, 3u, 4u, 0u, 2u, 3u, 4u, 3u, 2u };
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Decodes a single line from an S-record file (without allocating memory).
+		 *
+		 * @return @c false if the line is empty, @c true if a record was decoded.
+		 */
+		static bool decode_record(srec_record& r, const char* pos, const char* end)
+		{
+			detail::trim_line(pos, end);
+			if (pos == end)
+			{
+				// Empty record (can be skipped)
+				return false;
+			}
+
+			// Start of record ('S') and record type
+			if ((end - pos) < 4 || pos[0u] != 'S')
+			{
+				throw std::invalid_argument("unexpected character at start of s-record");
+			}
+
+			const uint32_t type = detail::hex_nibble(pos[1u]);
+			if (type > 9u || address_size[type] == 0u)
+			{
+				throw std::invalid_argument("unsupported record type in s-record file");
+			}
+
+			// Byte count (address, data and checksum)
+			const uint32_t count = detail::hex_byte(pos + 2u);
+			if (count > 0xFFu)
+			{
+				throw std::invalid_argument("invalid hex digit in s-record file");
+			}
+
+			pos += 4u;
+
+			if (static_cast<size_t>(end - pos) != 2u * count)
+			{
+				throw std::invalid_argument("byte count does not match the length of the s-record");
+			}
+
+			if (count < address_size[type] + 1u)
+			{
+				throw std::invalid_argument("byte count too small for the s-record type");
+			}
+
+			// Address, payload and checksum (the sum over all bytes, including the count, is 0xFF)
+			uint32_t sum = count;
+			uint32_t invalid = 0u;
+			uint32_t address = 0u;
+
+			for (uint32_t i = 0u; i < address_size[type]; ++i, pos += 2u)
+			{
+				const uint32_t value = detail::hex_byte(pos);
+				address = (address << 8u) | (value & 0xFFu);
+				invalid |= value;
+				sum += value;
+			}
+
+			const uint32_t length = count - address_size[type] - 1u;
+
+			for (uint32_t i = 0u; i < length; ++i, pos += 2u)
+			{
+				const uint32_t value = detail::hex_byte(pos);
+				r.data[i] = static_cast<uint8_t>(value);
+				invalid |= value;
+				sum += value;
+			}
+
+			const uint32_t checksum = detail::hex_byte(pos);
+			invalid |= checksum;
+
+			if (invalid > 0xFFu)
+			{
+				throw std::invalid_argument("invalid hex digit in s-record file");
+			}
+
+			if (((sum + checksum) & 0xFFu) != 0xFFu)
+			{
+				throw std::invalid_argument("checksum mismatch in s-record file");
+			}
+
+			r.type    = static_cast<uint8_t>(type);
+			r.address = address;
+			r.length  = static_cast<uint8_t>(length);
+			return true;
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Processes the records of a text (or chunk).
+		 *
+		 * @param[in] fn is invoked with the address and payload of each data record.
+		 * @param[out] entrypoint receives the entrypoint of the termination record.
+		 *
+		 * @return @c true if a termination record (S7/S8/S9) was found.
+		 */
+		template<typename Fn>
+		static bool process_records(const char* begin, const char* end, uint32_t& entrypoint, Fn&& fn)
+		{
+			srec_record r;
+			bool terminated = false;
+
+			detail::for_each_line(begin, end, [&](const char* line, const char* line_end)
+			{
+				if (!decode_record(r, line, line_end))
+				{
+					// Empty record (can be skipped)
+					return true;
+				}
+
+				if (r.type >= 1u && r.type <= 3u)
+				{
+					// Data record (S1/S2/S3)
+					fn(r.address, r.payload());
+				}
+				else if (r.type >= 7u)
+				{
+					// Termination record (S7/S8/S9)
+					entrypoint = r.address;
+					terminated = true;
+					return false;
+				}
+
+				// Header (S0) and record count (S5/S6) records are skipped
+				return true;
+			});
+
+			return terminated;
+		}
+
+		//-----------------------------------------------------------------------------------------
+		/**
+		 * @brief Result of loading a chunk.
+		 */
+		struct srec_chunk_result
+		{
+			/** @brief Data runs (in file order) */
+			std::vector<detail::data_run> runs;
+
+			/** @brief The chunk contains the termination record */
+			bool has_end = false;
+
+			/** @brief Entrypoint indicated in the termination record */
+			uint32_t entrypoint = 0u;
+
+			/** @brief Error raised while loading the chunk (loading stops at the error) */
+			std::exception_ptr error;
+		};
+	}
+
+	//---------------------------------------------------------------------------------------------
+	uint32_t srec::parse_records(std::string_view text, const record_callback& callback)
+	{
+		uint32_t entrypoint = 0u;
+
+		process_records(text.data(), text.data() + text.size(), entrypoint, [&](uint32_t address, std::span<const uint8_t> data)
+		{
+			callback(address, data);
+		});
+
+		return entrypoint;
+	}
+
+	//---------------------------------------------------------------------------------------------
+	memory_image srec::load_image(const std::string& filename)
+	{
+		const detail::mapped_file file(filename);
+
+		return parse_image(file.text());
+	}
+
+	//---------------------------------------------------------------------------------------------
+	memory_image srec::parse_image(std::string_view text)
+	{
+		auto& exec = runtime::executor::global();
+
+		// Load the chunks independently (records carry absolute addresses)
+		const auto chunks = detail::split_lines(text, 4u * exec.concurrency());
+		std::vector<srec_chunk_result> results(chunks.size());
+
+		runtime::parallel_for(exec, 0u, chunks.size(), [&](size_t i)
+		{
+			auto& result = results[i];
+
+			try
+			{
+				result.has_end = process_records(chunks[i].begin, chunks[i].end, result.entrypoint,
+					[&](uint32_t address, std::span<const uint8_t> data)
+				{
+					detail::append_run(result.runs, address, data.data(), data.size());
+				});
+			}
+			catch (...)
+			{
+				result.error = std::current_exception();
+			}
+		});
+
+		// Merge the results in file order (chunks behind the termination record are dropped)
+		memory_image image;
+		std::vector<detail::data_run> runs;
+
+		for (auto& r : results)
+		{
+			if (r.error)
+				std::rethrow_exception(r.error);
+
+			std::move(r.runs.begin(), r.runs.end(), std::back_inserter(runs));
+
+			if (r.has_end)
+			{
+				image.entrypoint = r.entrypoint;
+				break;
+			}
+		}
+
+		image.segments = detail::merge_runs(runs);
+		return image;
+	}
+
+	//---------------------------------------------------------------------------------------------
+	memory_image raw_binary::load_image(const std::string& filename, uint32_t base_address)
+	{
+		const detail::mapped_file file(filename);
+		const auto data = file.text();
+
+		if (data.size() > (uint64_t(1u) << 32u) - base_address)
+		{
+			throw std::out_of_range("binary image exceeds the 32-bit address space");
+		}
+
+		memory_image image;
+		image.entrypoint = base_address;
+
+		if (!data.empty())
+		{
+			image_segment& seg = image.segments.emplace_back();
+			seg.address = base_address;
+			seg.data.assign(reinterpret_cast<const uint8_t*>(data.data()),
+							reinterpret_cast<const uint8_t*>(data.data()) + data.size());
+		}
+
+		return image;
+	}
+}
@@ -0,0 +1,356 @@
+/**
+ * @file
+ * @brief Shared work-stealing executor (task groups and parallel loops).
+ */
+#include "unbit/runtime/executor.hpp"
+#include "unbit/runtime/executor.h"
+
+#include <cstdlib>
+#include <deque>
+#include <stdexcept>
+
+namespace unbit
+{
+	namespace runtime
+	{
+		namespace
+		{
+			/**
+			 * @brief Executor of the current worker thread (null on non-worker threads).
+			 */
+			thread_local executor* tls_executor = nullptr;
+
+			/**
+			 * @brief Index of the current worker thread (in its executor).
+			 */
+			thread_local std::size_t tls_worker = 0u;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		struct executor::worker_queue
+		{
+			/** @brief Protects the deque. */
+			std::mutex lock;
+
+			/** @brief Queued tasks (the owner works at the back, thieves steal from the front). */
+			std::deque<task_type> tasks;
+
+			/** @brief Appends a task at the back. */
+			void push_back(task_type task)
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				tasks.push_back(std::move(task));
+			}
+
+			/** @brief Removes a task from the back (owner). */
+			bool pop_back(task_type& task)
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				if (tasks.empty())
+					return false;
+
+				task = std::move(tasks.back());
+				tasks.pop_back();
+				return true;
+			}
+
+			/** @brief Removes a task from the front (thieves, injection queue). */
+			bool pop_front(task_type& task)
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				if (tasks.empty())
+					return false;
+
+				task = std::move(tasks.front());
+				tasks.pop_front();
+				return true;
+			}
+		};
+
+		//----------------------------------------------------------------------------------------------
+		executor::executor(std::size_t concurrency)
+			: concurrency_(0u), injected_(std::make_unique<worker_queue>()), num_queued_(0u), stopping_(false)
+		{
+			start(concurrency);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		executor::~executor()
+		{
+			stop();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void executor::set_concurrency(std::size_t concurrency)
+		{
+			if (tls_executor == this)
+				throw std::logic_error("executor concurrency cannot be changed from a worker thread");
+
+			if (num_queued_.load() != 0u)
+				throw std::logic_error("executor concurrency cannot be changed while tasks are pending");
+
+			stop();
+			start(concurrency);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void executor::submit(task_type task)
+		{
+			// Count first (the task may be taken as soon as it is queued)
+			++num_queued_;
+
+			if (tls_executor == this)
+			{
+				queues_[tls_worker]->push_back(std::move(task));
+			}
+			else
+			{
+				injected_->push_back(std::move(task));
+			}
+
+			{
+				// Pairs with the predicate check of sleeping workers (no lost wake-ups)
+				std::lock_guard<std::mutex> guard(sleep_lock_);
+			}
+
+			wake_.notify_one();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::size_t executor::default_concurrency()
+		{
+			if (const char* value = std::getenv("UNBIT_THREADS"))
+			{
+				char* end = nullptr;
+				const unsigned long n = std::strtoul(value, &end, 10);
+
+				if (end != value && *end == '\0' && n > 0u)
+					return static_cast<std::size_t>(n);
+			}
+
+			return std::max<std::size_t>(1u, std::thread::hardware_concurrency());
+		}
+
+		//----------------------------------------------------------------------------------------------
+		executor& executor::global()
+		{
+			static executor instance;
+			return instance;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void executor::start(std::size_t concurrency)
+		{
+			concurrency_ = (concurrency > 0u) ? concurrency : default_concurrency();
+			stopping_ = false;
+
+			// The waiting thread is one of the executing threads
+			const std::size_t num_workers = concurrency_ - 1u;
+
+			queues_.clear();
+			for (std::size_t i = 0u; i < num_workers; ++i)
+				queues_.push_back(std::make_unique<worker_queue>());
+
+			threads_.reserve(num_workers);
+			for (std::size_t i = 0u; i < num_workers; ++i)
+				threads_.emplace_back(&executor::worker_main, this, i);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void executor::stop()
+		{
+			{
+				std::lock_guard<std::mutex> guard(sleep_lock_);
+				stopping_ = true;
+			}
+
+			wake_.notify_all();
+
+			for (auto& thread : threads_)
+				thread.join();
+
+			threads_.clear();
+
+			// Run the remaining tasks (e.g. tasks submitted to an executor without workers)
+			while (try_run_one())
+			{
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void executor::worker_main(std::size_t index)
+		{
+			tls_executor = this;
+			tls_worker = index;
+
+			for (;;)
+			{
+				if (try_run_one())
+					continue;
+
+				std::unique_lock<std::mutex> guard(sleep_lock_);
+				wake_.wait(guard, [this]() { return stopping_ || num_queued_.load() != 0u; });
+
+				if (stopping_ && num_queued_.load() == 0u)
+					break;
+			}
+
+			tls_executor = nullptr;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bool executor::try_run_one()
+		{
+			const bool is_worker = (tls_executor == this);
+			task_type task;
+
+			// Own deque first (LIFO), then the injection queue, then steal (FIFO) from the others
+			bool found = is_worker && queues_[tls_worker]->pop_back(task);
+
+			if (!found)
+				found = injected_->pop_front(task);
+
+			const std::size_t num_queues = queues_.size();
+			const std::size_t first_victim = is_worker ? (tls_worker + 1u) : 0u;
+
+			for (std::size_t k = 0u; !found && k < num_queues; ++k)
+				found = queues_[(first_victim + k) % num_queues]->pop_front(task);
+
+			if (!found)
+				return false;
+
+			--num_queued_;
+			task();
+			return true;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		task_group::task_group(executor& exec)
+			: exec_(exec), pending_(0u), failed_(false)
+		{
+		}
+
+		//----------------------------------------------------------------------------------------------
+		task_group::~task_group()
+		{
+			join();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void task_group::run(executor::task_type task)
+		{
+			++pending_;
+
+			exec_.submit([this, task = std::move(task)]()
+			{
+				if (!failed_.load())
+				{
+					try
+					{
+						task();
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> guard(lock_);
+
+						if (!error_)
+							error_ = std::current_exception();
+
+						failed_ = true;
+					}
+				}
+
+				--pending_;
+			});
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void task_group::wait()
+		{
+			join();
+
+			std::exception_ptr error;
+			{
+				std::lock_guard<std::mutex> guard(lock_);
+				std::swap(error, error_);
+			}
+
+			failed_ = false;
+
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void task_group::join() noexcept
+		{
+			// Help running tasks (of any group) until all tasks of this group completed
+			while (pending_.load() != 0u)
+			{
+				if (!exec_.try_run_one())
+					std::this_thread::yield();
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+// C interface
+//-------------------------------------------------------------------------------------------------
+
+namespace
+{
+	/**
+	 * @brief Non-zero result of a C loop body (aborts the loop).
+	 */
+	struct loop_abort
+	{
+		int code;
+	};
+}
+
+//-------------------------------------------------------------------------------------------------
+extern "C" size_t unbit_executor_concurrency(void)
+{
+	return unbit::runtime::executor::global().concurrency();
+}
+
+//-------------------------------------------------------------------------------------------------
+extern "C" int unbit_executor_set_concurrency(size_t concurrency)
+{
+	try
+	{
+		unbit::runtime::executor::global().set_concurrency(concurrency);
+		return 0;
+	}
+	catch (...)
+	{
+		return -1;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+extern "C" int unbit_parallel_for(size_t first, size_t last, size_t grain, unbit_loop_body body, void* context)
+{
+	if (body == nullptr)
+		return -1;
+
+	try
+	{
+		unbit::runtime::parallel_for(first, last, [body, context](std::size_t i)
+		{
+			if (const int code = body(context, i))
+				throw loop_abort { code };
+		}, grain);
+
+		return 0;
+	}
+	catch (const loop_abort& abort)
+	{
+		return abort.code;
+	}
+	catch (...)
+	{
+		return -1;
+	}
+}
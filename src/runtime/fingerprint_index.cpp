@@ -0,0 +1,421 @@
+/**
+ * @file
+ * @brief On-disk inverted index of rolling window hashes (firmware fingerprint search).
+ */
+#include "unbit/runtime/fingerprint_index.hpp"
+#include "unbit/runtime/byte_io.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace unbit
+{
+	namespace runtime
+	{
+		namespace
+		{
+			using detail::load_le;
+			using detail::put_le;
+
+			/**
+			 * @brief Magic number (and version) of index files.
+			 */
+			static constexpr char INDEX_MAGIC[8u] = { 'U', 'N', 'B', 'F', 'P', 'I', '0', '1' };
+
+			/**
+			 * @brief Number of hash buckets in the directory.
+			 */
+			static constexpr std::size_t NUM_BUCKETS = 65536u;
+
+			/**
+			 * @brief Size of a posting in the index file (hash, image, offset).
+			 */
+			static constexpr std::size_t POSTING_SIZE = 16u;
+
+			/**
+			 * @brief Base of the rolling hash (odd, so that powers never vanish modulo 2^64).
+			 */
+			static constexpr uint64_t HASH_BASE = 0x100000001B3ull;
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief 64-bit finalizer (SplitMix64), spreads the rolling hash over the bucket bits.
+			 */
+			static inline uint64_t mix64(uint64_t x) noexcept
+			{
+				x ^= x >> 30u;
+				x *= 0xBF58476D1CE4E5B9ull;
+				x ^= x >> 27u;
+				x *= 0x94D049BB133111EBull;
+				x ^= x >> 31u;
+				return x;
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Computes the window hashes of a byte sequence.
+			 *
+			 * Calls @p sink(offset, hash) for each window starting at a multiple of @p stride, skipping
+			 * windows that consist of a single repeated byte value.
+			 */
+			template<typename Sink>
+			static void hash_windows(std::span<const uint8_t> data, std::size_t window, std::size_t stride, Sink&& sink)
+			{
+				if (data.size() < window)
+					return;
+
+				// B^(window-1), to remove the outgoing byte
+				uint64_t top_power = 1u;
+				for (std::size_t i = 1u; i < window; ++i)
+					top_power *= HASH_BASE;
+
+				// Length of the run of identical bytes ending at the current window end
+				std::size_t run = 1u;
+
+				uint64_t h = 0u;
+				for (std::size_t i = 0u; i < window; ++i)
+				{
+					h = h * HASH_BASE + data[i];
+
+					if (i > 0u)
+						run = (data[i] == data[i - 1u]) ? run + 1u : 1u;
+				}
+
+				for (std::size_t offset = 0u; ; ++offset)
+				{
+					if ((offset % stride) == 0u && run < window)
+						sink(offset, mix64(h));
+
+					const std::size_t next = offset + window;
+					if (next >= data.size())
+						break;
+
+					h = (h - data[offset] * top_power) * HASH_BASE + data[next];
+					run = (data[next] == data[next - 1u]) ? run + 1u : 1u;
+				}
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Reads bytes from the index file (throws on truncated files).
+			 */
+			static void read_exact(std::ifstream& file, void* data, std::size_t size)
+			{
+				file.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+
+				if (static_cast<std::size_t>(file.gcount()) != size)
+					throw std::runtime_error("corrupt fingerprint index: truncated file");
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Reads a little-endian integer from the index file.
+			 */
+			template<typename T>
+			static T read_le(std::ifstream& file)
+			{
+				uint8_t buffer[sizeof(T)];
+				read_exact(file, buffer, sizeof(buffer));
+				return load_le<T>(buffer);
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Reads a length-prefixed string from the index file.
+			 */
+			static std::string read_string(std::ifstream& file, uint64_t file_size)
+			{
+				const uint32_t length = read_le<uint32_t>(file);
+				if (length > file_size)
+					throw std::runtime_error("corrupt fingerprint index: bad string length");
+
+				std::string result(length, '\0');
+				read_exact(file, result.data(), length);
+				return result;
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		fingerprint_index_builder::fingerprint_index_builder(const fingerprint_options& options)
+			: options_(options)
+		{
+			if (options.window == 0u || options.stride == 0u)
+				throw std::invalid_argument("fingerprint window and stride must not be zero");
+		}
+
+		//----------------------------------------------------------------------------------------------
+		fingerprint_index_builder::~fingerprint_index_builder()
+		{
+		}
+
+		//----------------------------------------------------------------------------------------------
+		uint32_t fingerprint_index_builder::add(fingerprint_image image, std::span<const uint8_t> data)
+		{
+			if (data.size() > UINT32_MAX)
+				throw std::invalid_argument("fingerprint image '" + image.source + "' exceeds 4 GiB");
+
+			image.size = data.size();
+
+			// Hash the windows (without holding the lock)
+			std::vector<posting> local;
+			local.reserve(data.size() / options_.stride + 1u);
+
+			hash_windows(data, options_.window, options_.stride, [&](std::size_t offset, uint64_t hash)
+			{
+				local.push_back(posting { hash, 0u, static_cast<uint32_t>(offset) });
+			});
+
+			std::lock_guard<std::mutex> guard(lock_);
+
+			const uint32_t id = static_cast<uint32_t>(images_.size());
+			images_.push_back(std::move(image));
+
+			for (auto& p : local)
+				p.image = id;
+
+			postings_.insert(postings_.end(), local.begin(), local.end());
+			return id;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::size_t fingerprint_index_builder::num_images()
+		{
+			std::lock_guard<std::mutex> guard(lock_);
+			return images_.size();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::size_t fingerprint_index_builder::num_postings()
+		{
+			std::lock_guard<std::mutex> guard(lock_);
+			return postings_.size();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void fingerprint_index_builder::write(const std::string& filename)
+		{
+			std::lock_guard<std::mutex> guard(lock_);
+
+			std::sort(postings_.begin(), postings_.end(), [](const posting& a, const posting& b)
+			{
+				return (a.hash != b.hash) ? (a.hash < b.hash) :
+					((a.image != b.image) ? (a.image < b.image) : (a.offset < b.offset));
+			});
+
+			// Header and image table
+			std::vector<uint8_t> out(std::begin(INDEX_MAGIC), std::end(INDEX_MAGIC));
+			put_le<uint32_t>(out, static_cast<uint32_t>(options_.window));
+			put_le<uint32_t>(out, static_cast<uint32_t>(options_.stride));
+			put_le<uint32_t>(out, static_cast<uint32_t>(images_.size()));
+			put_le<uint64_t>(out, postings_.size());
+
+			for (const auto& image : images_)
+			{
+				for (const std::string* s : { &image.source, &image.instance, &image.region })
+				{
+					put_le<uint32_t>(out, static_cast<uint32_t>(s->size()));
+					out.insert(out.end(), s->begin(), s->end());
+				}
+
+				put_le<uint64_t>(out, image.base_address);
+				put_le<uint64_t>(out, image.size);
+			}
+
+			// Bucket directory
+			std::size_t pos = 0u;
+			for (std::size_t b = 0u; b < NUM_BUCKETS; ++b)
+			{
+				while (pos < postings_.size() && (postings_[pos].hash >> 48u) < b)
+					++pos;
+
+				put_le<uint64_t>(out, pos);
+			}
+
+			put_le<uint64_t>(out, postings_.size());
+
+			detail::replace_file(filename, [&](std::ofstream& stm)
+			{
+				stm.write(reinterpret_cast<const char*>(out.data()), out.size());
+
+				// Postings (in chunks)
+				std::vector<uint8_t> chunk;
+				chunk.reserve(POSTING_SIZE * 65536u);
+
+				for (std::size_t i = 0u; i < postings_.size(); ++i)
+				{
+					put_le<uint64_t>(chunk, postings_[i].hash);
+					put_le<uint32_t>(chunk, postings_[i].image);
+					put_le<uint32_t>(chunk, postings_[i].offset);
+
+					if (chunk.size() == chunk.capacity() || i + 1u == postings_.size())
+					{
+						stm.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+						chunk.clear();
+					}
+				}
+			}, "fingerprint index");
+		}
+
+		//----------------------------------------------------------------------------------------------
+		fingerprint_index::fingerprint_index(const std::string& filename)
+			: file_(filename, std::ios_base::in | std::ios_base::binary), postings_offset_(0u)
+		{
+			if (!file_)
+				throw std::ios_base::failure("unable to open fingerprint index '" + filename + "'");
+
+			const uint64_t file_size = std::filesystem::file_size(filename);
+
+			char magic[sizeof(INDEX_MAGIC)];
+			read_exact(file_, magic, sizeof(magic));
+
+			if (std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0)
+				throw std::runtime_error("corrupt fingerprint index: bad header of '" + filename + "'");
+
+			options_.window = read_le<uint32_t>(file_);
+			options_.stride = read_le<uint32_t>(file_);
+
+			const uint32_t num_images = read_le<uint32_t>(file_);
+			const uint64_t num_postings = read_le<uint64_t>(file_);
+
+			if (options_.window == 0u || options_.stride == 0u || num_images > file_size)
+				throw std::runtime_error("corrupt fingerprint index: bad header of '" + filename + "'");
+
+			images_.resize(num_images);
+			for (auto& image : images_)
+			{
+				image.source       = read_string(file_, file_size);
+				image.instance     = read_string(file_, file_size);
+				image.region       = read_string(file_, file_size);
+				image.base_address = read_le<uint64_t>(file_);
+				image.size         = read_le<uint64_t>(file_);
+			}
+
+			std::vector<uint8_t> directory((NUM_BUCKETS + 1u) * 8u);
+			read_exact(file_, directory.data(), directory.size());
+
+			buckets_.resize(NUM_BUCKETS + 1u);
+			for (std::size_t b = 0u; b <= NUM_BUCKETS; ++b)
+			{
+				buckets_[b] = load_le<uint64_t>(directory.data() + 8u * b);
+
+				if ((b > 0u && buckets_[b] < buckets_[b - 1u]) || buckets_[b] > num_postings)
+					throw std::runtime_error("corrupt fingerprint index: bad bucket directory in '" + filename + "'");
+			}
+
+			postings_offset_ = static_cast<uint64_t>(file_.tellg());
+
+			if (buckets_.back() != num_postings || postings_offset_ + num_postings * POSTING_SIZE != file_size)
+				throw std::runtime_error("corrupt fingerprint index: size mismatch of '" + filename + "'");
+		}
+
+		//----------------------------------------------------------------------------------------------
+		fingerprint_index::~fingerprint_index()
+		{
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::vector<fingerprint_match> fingerprint_index::query(std::span<const uint8_t> binary, double min_coverage) const
+		{
+			const std::size_t window = options_.window;
+			const std::size_t stride = options_.stride;
+
+			// Hash the windows of the binary at all offsets
+			std::vector<std::pair<uint64_t, uint32_t>> probes;
+			std::vector<uint8_t> hashed(binary.size(), 0u);
+
+			hash_windows(binary, window, 1u, [&](std::size_t offset, uint64_t hash)
+			{
+				probes.emplace_back(hash, static_cast<uint32_t>(offset));
+				hashed[offset] = 1u;
+			});
+
+			std::sort(probes.begin(), probes.end());
+
+			// Vote for (image, alignment) pairs, reading each touched bucket once
+			std::map<std::pair<uint32_t, int64_t>, std::size_t> votes;
+			std::vector<uint8_t> bucket_data;
+
+			for (std::size_t i = 0u; i < probes.size(); )
+			{
+				const std::size_t bucket = static_cast<std::size_t>(probes[i].first >> 48u);
+				const uint64_t first = buckets_[bucket];
+				const uint64_t count = buckets_[bucket + 1u] - first;
+
+				bucket_data.resize(count * POSTING_SIZE);
+				if (count > 0u)
+				{
+					file_.clear();
+					file_.seekg(static_cast<std::streamoff>(postings_offset_ + first * POSTING_SIZE), std::ios_base::beg);
+					read_exact(file_, bucket_data.data(), bucket_data.size());
+				}
+
+				for (; i < probes.size() && (probes[i].first >> 48u) == bucket; ++i)
+				{
+					// Postings of the bucket are sorted by hash
+					std::size_t lo = 0u, hi = count;
+					while (lo < hi)
+					{
+						const std::size_t mid = (lo + hi) / 2u;
+						if (load_le<uint64_t>(bucket_data.data() + mid * POSTING_SIZE) < probes[i].first)
+							lo = mid + 1u;
+						else
+							hi = mid;
+					}
+
+					for (std::size_t k = lo; k < count; ++k)
+					{
+						const uint8_t* p = bucket_data.data() + k * POSTING_SIZE;
+						if (load_le<uint64_t>(p) != probes[i].first)
+							break;
+
+						const uint32_t image = load_le<uint32_t>(p + 8u);
+						const int64_t align = static_cast<int64_t>(load_le<uint32_t>(p + 12u)) - static_cast<int64_t>(probes[i].second);
+						++votes[std::make_pair(image, align)];
+					}
+				}
+			}
+
+			// Rate the candidates against the number of indexed windows covered by the binary
+			std::vector<fingerprint_match> matches;
+
+			for (const auto& [key, count] : votes)
+			{
+				const auto& [image, align] = key;
+
+				if (image >= images_.size() || images_[image].size < window)
+					continue;
+
+				// Offsets q of the binary that align with indexed windows (align + q in the image)
+				const int64_t last_window = static_cast<int64_t>(images_[image].size - window);
+				const int64_t q_end = std::min<int64_t>(static_cast<int64_t>(binary.size()) - static_cast<int64_t>(window), last_window - align);
+
+				int64_t q = std::max<int64_t>(0, -align);
+				const int64_t misalign = (align + q) % static_cast<int64_t>(stride);
+				if (misalign != 0)
+					q += static_cast<int64_t>(stride) - misalign;
+
+				std::size_t expected = 0u;
+				for (; q <= q_end; q += static_cast<int64_t>(stride))
+					expected += hashed[static_cast<std::size_t>(q)];
+
+				fingerprint_match match { image, align, count, expected };
+				if (expected > 0u && match.coverage() >= min_coverage)
+					matches.push_back(match);
+			}
+
+			std::sort(matches.begin(), matches.end(), [](const fingerprint_match& a, const fingerprint_match& b)
+			{
+				if (a.coverage() != b.coverage())
+					return a.coverage() > b.coverage();
+
+				return a.matched_windows > b.matched_windows;
+			});
+
+			return matches;
+		}
+	}
+}
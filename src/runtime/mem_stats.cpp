@@ -0,0 +1,426 @@
+/**
+ * @file
+ * @brief Memory footprint accounting and peak-RSS reporting.
+ */
+#include "unbit/runtime/mem_stats.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <utility>
+
+#if defined(__linux__)
+# include <sys/resource.h>
+#endif
+
+namespace unbit
+{
+	namespace runtime
+	{
+		namespace
+		{
+			/**
+			 * @brief Global accounting state.
+			 */
+			struct mem_state
+			{
+				/** @brief Currently tracked bytes per subsystem. */
+				std::array<std::atomic<uint64_t>, NUM_MEM_SUBSYSTEMS> current {};
+
+				/** @brief Peak tracked bytes per subsystem. */
+				std::array<std::atomic<uint64_t>, NUM_MEM_SUBSYSTEMS> peak {};
+
+				/** @brief Currently tracked bytes (all subsystems). */
+				std::atomic<uint64_t> total { 0u };
+
+				/** @brief Peak tracked bytes (all subsystems). */
+				std::atomic<uint64_t> peak_total { 0u };
+
+				/** @brief Peak tracked bytes (all subsystems) since the last phase boundary. */
+				std::atomic<uint64_t> phase_peak_total { 0u };
+
+				/** @brief Indicates if phase samples are recorded. */
+				std::atomic<bool> phases_enabled { false };
+
+				/** @brief Indicates if the peak RSS was reset at the last phase boundary (or never used). */
+				bool peak_rss_reset = true;
+
+				/** @brief Protects the phase samples (and the peak RSS reset indicator). */
+				std::mutex lock;
+
+				/** @brief Recorded phase samples. */
+				std::vector<mem_phase_sample> phases;
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Gets the global accounting state.
+			 */
+			static mem_state& state()
+			{
+				static mem_state instance;
+				return instance;
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Raises an atomic maximum to (at least) a given value.
+			 */
+			static void raise_peak(std::atomic<uint64_t>& peak, uint64_t value) noexcept
+			{
+				uint64_t prev = peak.load(std::memory_order_relaxed);
+
+				while (prev < value && !peak.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+				{
+					// Retry (prev was updated)
+				}
+			}
+
+#if defined(__linux__)
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Reads a memory size field (in kB) from @c /proc/self/status.
+			 */
+			static std::optional<uint64_t> read_proc_status_kb(const std::string& field)
+			{
+				std::ifstream stm("/proc/self/status");
+				std::string line;
+
+				while (std::getline(stm, line))
+				{
+					if (line.compare(0u, field.size(), field) == 0 && line.size() > field.size() && line[field.size()] == ':')
+					{
+						try
+						{
+							return static_cast<uint64_t>(std::stoull(line.substr(field.size() + 1u))) * 1024u;
+						}
+						catch (std::exception&)
+						{
+							return std::nullopt;
+						}
+					}
+				}
+
+				return std::nullopt;
+			}
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Resets the peak RSS (high-water mark) of the process to its current RSS.
+			 *
+			 * @return true if the kernel accepted the reset (Linux 4.0 and later).
+			 */
+			static bool reset_peak_rss()
+			{
+				std::ofstream stm("/proc/self/clear_refs");
+				if (!stm)
+					return false;
+
+				stm << "5" << std::flush;
+				return static_cast<bool>(stm);
+			}
+#endif
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Formats a byte count in MiB (or n/a) for the memory report.
+			 */
+			static void print_mib(std::ostream& os, std::optional<uint64_t> num_bytes, int width)
+			{
+				if (num_bytes)
+				{
+					os << std::setw(width) << (static_cast<double>(*num_bytes) / (1024.0 * 1024.0));
+				}
+				else
+				{
+					os << std::setw(width) << "n/a";
+				}
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		const char* mem_subsystem_name(mem_subsystem subsystem)
+		{
+			switch (subsystem)
+			{
+				case mem_subsystem::input_buffers: return "input buffers";
+				case mem_subsystem::frame_store:   return "frame store";
+				case mem_subsystem::mmi_maps:      return "mmi maps";
+				case mem_subsystem::packet_index:  return "packet index";
+				default:                           return "unknown";
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void mem_stats::track(mem_subsystem subsystem, std::size_t num_bytes) noexcept
+		{
+			if (num_bytes == 0u)
+				return;
+
+			auto& s = state();
+			const std::size_t index = static_cast<std::size_t>(subsystem);
+
+			const uint64_t current = s.current[index].fetch_add(num_bytes, std::memory_order_relaxed) + num_bytes;
+			raise_peak(s.peak[index], current);
+
+			const uint64_t total = s.total.fetch_add(num_bytes, std::memory_order_relaxed) + num_bytes;
+			raise_peak(s.peak_total, total);
+			raise_peak(s.phase_peak_total, total);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void mem_stats::untrack(mem_subsystem subsystem, std::size_t num_bytes) noexcept
+		{
+			if (num_bytes == 0u)
+				return;
+
+			auto& s = state();
+
+			s.current[static_cast<std::size_t>(subsystem)].fetch_sub(num_bytes, std::memory_order_relaxed);
+			s.total.fetch_sub(num_bytes, std::memory_order_relaxed);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		mem_usage mem_stats::usage(mem_subsystem subsystem) noexcept
+		{
+			auto& s = state();
+			const std::size_t index = static_cast<std::size_t>(subsystem);
+
+			return mem_usage { s.current[index].load(std::memory_order_relaxed), s.peak[index].load(std::memory_order_relaxed) };
+		}
+
+		//----------------------------------------------------------------------------------------------
+		mem_snapshot mem_stats::snapshot()
+		{
+			auto& s = state();
+			mem_snapshot result;
+
+			for (std::size_t i = 0u; i < NUM_MEM_SUBSYSTEMS; ++i)
+				result.subsystems[i] = usage(static_cast<mem_subsystem>(i));
+
+			result.total.current_bytes = s.total.load(std::memory_order_relaxed);
+			result.total.peak_bytes    = s.peak_total.load(std::memory_order_relaxed);
+			result.rss_bytes           = current_rss();
+			result.peak_rss_bytes      = peak_rss();
+
+			std::lock_guard<std::mutex> guard(s.lock);
+			result.phases = s.phases;
+
+			return result;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void mem_stats::enable_phases()
+		{
+			auto& s = state();
+
+			std::lock_guard<std::mutex> guard(s.lock);
+
+			if (s.phases_enabled.exchange(true, std::memory_order_relaxed))
+				return;
+
+			s.phase_peak_total.store(s.total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+#if defined(__linux__)
+			s.peak_rss_reset = reset_peak_rss();
+#else
+			s.peak_rss_reset = false;
+#endif
+		}
+
+		//----------------------------------------------------------------------------------------------
+		bool mem_stats::phases_enabled() noexcept
+		{
+			return state().phases_enabled.load(std::memory_order_relaxed);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		mem_phase_sample mem_stats::end_phase(const std::string& name)
+		{
+			auto& s = state();
+			mem_phase_sample sample;
+
+			sample.name = name;
+
+			// No sampling (and no reset of the RSS high-water mark) unless phases are recorded
+			if (!s.phases_enabled.load(std::memory_order_relaxed))
+				return sample;
+
+			for (std::size_t i = 0u; i < NUM_MEM_SUBSYSTEMS; ++i)
+				sample.tracked_bytes[i] = s.current[i].load(std::memory_order_relaxed);
+
+			sample.tracked_total      = s.total.load(std::memory_order_relaxed);
+			sample.peak_tracked_total = s.phase_peak_total.exchange(sample.tracked_total, std::memory_order_relaxed);
+			sample.rss_bytes          = current_rss();
+			sample.peak_rss_bytes     = peak_rss();
+
+			std::lock_guard<std::mutex> guard(s.lock);
+
+			// The high-water mark covers this phase only if it was reset at the previous boundary
+			sample.peak_rss_per_phase = s.peak_rss_reset;
+
+#if defined(__linux__)
+			s.peak_rss_reset = reset_peak_rss();
+#else
+			s.peak_rss_reset = false;
+#endif
+
+			s.phases.push_back(sample);
+			return sample;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void mem_stats::clear_phases()
+		{
+			auto& s = state();
+
+			std::lock_guard<std::mutex> guard(s.lock);
+			s.phases.clear();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::optional<uint64_t> mem_stats::current_rss()
+		{
+#if defined(__linux__)
+			return read_proc_status_kb("VmRSS");
+#else
+			return std::nullopt;
+#endif
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::optional<uint64_t> mem_stats::peak_rss()
+		{
+#if defined(__linux__)
+			if (auto hwm = read_proc_status_kb("VmHWM"))
+				return hwm;
+
+			// Fall back to getrusage (never reset by clear_refs)
+			struct rusage usage;
+			if (::getrusage(RUSAGE_SELF, &usage) == 0)
+				return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;
+
+			return std::nullopt;
+#else
+			return std::nullopt;
+#endif
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void mem_stats::report(std::ostream& os)
+		{
+			const auto snap = snapshot();
+
+			const auto old_flags = os.flags();
+			const auto old_precision = os.precision();
+
+			os << std::fixed << std::setprecision(1);
+
+			os << "memory report (MiB):" << std::endl;
+
+			if (!snap.phases.empty())
+			{
+				os << "  " << std::left << std::setw(24) << "phase" << std::right
+					<< std::setw(12) << "tracked"
+					<< std::setw(14) << "peak-tracked"
+					<< std::setw(10) << "rss"
+					<< std::setw(11) << "peak-rss"
+					<< std::endl;
+
+				bool have_cumulative_peak = false;
+
+				for (const auto& phase : snap.phases)
+				{
+					os << "  " << std::left << std::setw(24) << phase.name << std::right;
+					print_mib(os, phase.tracked_total, 12);
+					print_mib(os, phase.peak_tracked_total, 14);
+					print_mib(os, phase.rss_bytes, 10);
+					print_mib(os, phase.peak_rss_bytes, 10);
+					os << (phase.peak_rss_per_phase ? " " : "*") << std::endl;
+
+					have_cumulative_peak = have_cumulative_peak || !phase.peak_rss_per_phase;
+				}
+
+				if (have_cumulative_peak)
+					os << "  (*) peak rss since process start (high-water mark could not be reset)" << std::endl;
+
+				os << std::endl;
+			}
+
+			os << "  " << std::left << std::setw(24) << "subsystem" << std::right
+				<< std::setw(12) << "current"
+				<< std::setw(14) << "peak"
+				<< std::endl;
+
+			for (std::size_t i = 0u; i < NUM_MEM_SUBSYSTEMS; ++i)
+			{
+				os << "  " << std::left << std::setw(24) << mem_subsystem_name(static_cast<mem_subsystem>(i)) << std::right;
+				print_mib(os, snap.subsystems[i].current_bytes, 12);
+				print_mib(os, snap.subsystems[i].peak_bytes, 14);
+				os << std::endl;
+			}
+
+			os << "  " << std::left << std::setw(24) << "total (tracked)" << std::right;
+			print_mib(os, snap.total.current_bytes, 12);
+			print_mib(os, snap.total.peak_bytes, 14);
+			os << std::endl;
+
+			os << "  " << std::left << std::setw(24) << "process (rss)" << std::right;
+			print_mib(os, snap.rss_bytes, 12);
+			print_mib(os, snap.peak_rss_bytes, 14);
+			os << std::endl;
+
+			os.flags(old_flags);
+			os.precision(old_precision);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		mem_account::mem_account(mem_subsystem subsystem, std::size_t num_bytes) noexcept
+			: subsystem_(subsystem), num_bytes_(num_bytes)
+		{
+			mem_stats::track(subsystem_, num_bytes_);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		mem_account::mem_account(mem_account&& other) noexcept
+			: subsystem_(other.subsystem_), num_bytes_(std::exchange(other.num_bytes_, 0u))
+		{
+		}
+
+		//----------------------------------------------------------------------------------------------
+		mem_account& mem_account::operator=(mem_account&& other) noexcept
+		{
+			if (this != &other)
+			{
+				mem_stats::untrack(subsystem_, num_bytes_);
+
+				subsystem_ = other.subsystem_;
+				num_bytes_ = std::exchange(other.num_bytes_, 0u);
+			}
+
+			return *this;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		mem_account::~mem_account()
+		{
+			mem_stats::untrack(subsystem_, num_bytes_);
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void mem_account::resize(std::size_t num_bytes) noexcept
+		{
+			if (num_bytes > num_bytes_)
+			{
+				mem_stats::track(subsystem_, num_bytes - num_bytes_);
+			}
+			else
+			{
+				mem_stats::untrack(subsystem_, num_bytes_ - num_bytes);
+			}
+
+			num_bytes_ = num_bytes;
+		}
+	}
+}
@@ -0,0 +1,227 @@
+/**
+ * @file
+ * @brief SHA-256 message digest (content addressing of frames and files).
+ */
+#include "unbit/runtime/sha256.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace unbit
+{
+	namespace runtime
+	{
+		namespace
+		{
+			/**
+			 * @brief Initial hash value (FIPS 180-4, section 5.3.3).
+			 */
+			static constexpr std::array<uint32_t, 8u> INITIAL_STATE =
+			{
+				0x6A09E667u, 0xBB67AE85u, 0x3C6EF372u, 0xA54FF53Au,
+				0x510E527Fu, 0x9B05688Cu, 0x1F83D9ABu, 0x5BE0CD19u
+			};
+
+			/**
+			 * @brief Round constants (FIPS 180-4, section 4.2.2).
+			 */
+			static constexpr uint32_t K[64u] =
+			{
+				0x428A2F98u, 0x71374491u, 0xB5C0FBCFu, 0xE9B5DBA5u, 0x3956C25Bu, 0x59F111F1u, 0x923F82A4u, 0xAB1C5ED5u,
+				0xD807AA98u, 0x12835B01u, 0x243185BEu, 0x550C7DC3u, 0x72BE5D74u, 0x80DEB1FEu, 0x9BDC06A7u, 0xC19BF174u,
+				0xE49B69C1u, 0xEFBE4786u, 0x0FC19DC6u, 0x240CA1CCu, 0x2DE92C6Fu, 0x4A7484AAu, 0x5CB0A9DCu, 0x76F988DAu,
+				0x983E5152u, 0xA831C66Du, 0xB00327C8u, 0xBF597FC7u, 0xC6E00BF3u, 0xD5A79147u, 0x06CA6351u, 0x14292967u,
+				0x27B70A85u, 0x2E1B2138u, 0x4D2C6DFCu, 0x53380D13u, 0x650A7354u, 0x766A0ABBu, 0x81C2C92Eu, 0x92722C85u,
+				0xA2BFE8A1u, 0xA81A664Bu, 0xC24B8B70u, 0xC76C51A3u, 0xD192E819u, 0xD6990624u, 0xF40E3585u, 0x106AA070u,
+				0x19A4C116u, 0x1E376C08u, 0x2748774Cu, 0x34B0BCB5u, 0x391C0CB3u, 0x4ED8AA4Au, 0x5B9CCA4Fu, 0x682E6FF3u,
+				0x748F82EEu, 0x78A5636Fu, 0x84C87814u, 0x8CC70208u, 0x90BEFFFAu, 0xA4506CEBu, 0xBEF9A3F7u, 0xC67178F2u
+			};
+
+			//------------------------------------------------------------------------------------------
+			/**
+			 * @brief Loads a big-endian 32-bit word.
+			 */
+			static inline uint32_t load_be32(const uint8_t* p) noexcept
+			{
+				return (static_cast<uint32_t>(p[0u]) << 24u) | (static_cast<uint32_t>(p[1u]) << 16u) |
+					(static_cast<uint32_t>(p[2u]) << 8u) | static_cast<uint32_t>(p[3u]);
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		sha256::sha256() noexcept
+		{
+			reset();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void sha256::reset() noexcept
+		{
+			state_     = INITIAL_STATE;
+			block_len_ = 0u;
+			total_len_ = 0u;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void sha256::update(std::span<const uint8_t> data) noexcept
+		{
+			total_len_ += data.size();
+
+			// Complete a partial block
+			if (block_len_ > 0u)
+			{
+				const std::size_t n = std::min(data.size(), block_.size() - block_len_);
+				std::memcpy(block_.data() + block_len_, data.data(), n);
+
+				block_len_ += n;
+				data = data.subspan(n);
+
+				if (block_len_ < block_.size())
+					return;
+
+				compress(block_.data());
+				block_len_ = 0u;
+			}
+
+			// Full blocks (directly from the input)
+			while (data.size() >= block_.size())
+			{
+				compress(data.data());
+				data = data.subspan(block_.size());
+			}
+
+			// Remainder
+			std::memcpy(block_.data(), data.data(), data.size());
+			block_len_ = data.size();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void sha256::update_be(std::span<const uint32_t> words) noexcept
+		{
+			uint8_t buffer[256u];
+
+			while (!words.empty())
+			{
+				const std::size_t n = std::min<std::size_t>(words.size(), sizeof(buffer) / 4u);
+
+				for (std::size_t i = 0u; i < n; ++i)
+				{
+					buffer[4u * i + 0u] = static_cast<uint8_t>(words[i] >> 24u);
+					buffer[4u * i + 1u] = static_cast<uint8_t>(words[i] >> 16u);
+					buffer[4u * i + 2u] = static_cast<uint8_t>(words[i] >> 8u);
+					buffer[4u * i + 3u] = static_cast<uint8_t>(words[i]);
+				}
+
+				update(std::span<const uint8_t>(buffer, 4u * n));
+				words = words.subspan(n);
+			}
+		}
+
+		//----------------------------------------------------------------------------------------------
+		sha256::digest sha256::finish() noexcept
+		{
+			const uint64_t total_bits = total_len_ * 8u;
+
+			// Padding: 0x80, zeros, 64-bit message length (big-endian)
+			uint8_t pad[72u] = { 0x80u };
+			const std::size_t pad_len = (block_len_ < 56u) ? (56u - block_len_) : (120u - block_len_);
+
+			for (unsigned i = 0u; i < 8u; ++i)
+				pad[pad_len + i] = static_cast<uint8_t>(total_bits >> (56u - 8u * i));
+
+			update(std::span<const uint8_t>(pad, pad_len + 8u));
+
+			digest result;
+			for (std::size_t i = 0u; i < state_.size(); ++i)
+			{
+				result[4u * i + 0u] = static_cast<uint8_t>(state_[i] >> 24u);
+				result[4u * i + 1u] = static_cast<uint8_t>(state_[i] >> 16u);
+				result[4u * i + 2u] = static_cast<uint8_t>(state_[i] >> 8u);
+				result[4u * i + 3u] = static_cast<uint8_t>(state_[i]);
+			}
+
+			reset();
+			return result;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		sha256::digest sha256::hash(std::span<const uint8_t> data) noexcept
+		{
+			sha256 h;
+			h.update(data);
+			return h.finish();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		sha256::digest sha256::hash_be(std::span<const uint32_t> words) noexcept
+		{
+			sha256 h;
+			h.update_be(words);
+			return h.finish();
+		}
+
+		//----------------------------------------------------------------------------------------------
+		std::string sha256::to_hex(const digest& d)
+		{
+			static const char digits[] = "0123456789abcdef";
+			std::string result;
+			result.reserve(2u * d.size());
+
+			for (const uint8_t b : d)
+			{
+				result.push_back(digits[b >> 4u]);
+				result.push_back(digits[b & 0xFu]);
+			}
+
+			return result;
+		}
+
+		//----------------------------------------------------------------------------------------------
+		void sha256::compress(const uint8_t* block) noexcept
+		{
+			uint32_t w[64u];
+
+			for (unsigned i = 0u; i < 16u; ++i)
+				w[i] = load_be32(block + 4u * i);
+
+			for (unsigned i = 16u; i < 64u; ++i)
+			{
+				const uint32_t s0 = std::rotr(w[i - 15u], 7) ^ std::rotr(w[i - 15u], 18) ^ (w[i - 15u] >> 3u);
+				const uint32_t s1 = std::rotr(w[i - 2u], 17) ^ std::rotr(w[i - 2u], 19) ^ (w[i - 2u] >> 10u);
+				w[i] = w[i - 16u] + s0 + w[i - 7u] + s1;
+			}
+
+			uint32_t a = state_[0u], b = state_[1u], c = state_[2u], d = state_[3u];
+			uint32_t e = state_[4u], f = state_[5u], g = state_[6u], h = state_[7u];
+
+			for (unsigned i = 0u; i < 64u; ++i)
+			{
+				const uint32_t S1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+				const uint32_t ch = (e & f) ^ (~e & g);
+				const uint32_t t1 = h + S1 + ch + K[i] + w[i];
+				const uint32_t S0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+				const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+				const uint32_t t2 = S0 + maj;
+
+				h = g;
+				g = f;
+				f = e;
+				e = d + t1;
+				d = c;
+				c = b;
+				b = a;
+				a = t1 + t2;
+			}
+
+			state_[0u] += a;
+			state_[1u] += b;
+			state_[2u] += c;
+			state_[3u] += d;
+			state_[4u] += e;
+			state_[5u] += f;
+			state_[6u] += g;
+			state_[7u] += h;
+		}
+	}
+}
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @brief Proof-of-concept tool to dump LUT INIT values from a Xilinx FPGA bitstream (via logic location data).
+ */
+
+#include "unbit/fpga/old/xilinx/bitstream.hpp"
+#include "unbit/fpga/old/xilinx/fpga.hpp"
+#include "unbit/fpga/old/xilinx/logic_location.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using unbit::old::xilinx::bitstream;
+using unbit::old::xilinx::fpga;
+using unbit::old::xilinx::fpga_by_idcode;
+using unbit::old::xilinx::logic_location;
+using unbit::old::xilinx::lut_init_plan;
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		// Split options and positional arguments
+		unsigned slr = 0u;
+		std::vector<std::string> args;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg(argv[i]);
+
+			if (arg == "--slr" && (i + 1) < argc)
+			{
+				slr = static_cast<unsigned>(std::stoul(argv[++i]));
+			}
+			else
+			{
+				args.push_back(arg);
+			}
+		}
+
+		if (args.size() < 2u)
+		{
+			std::cerr << "usage: " << argv[0u] << " [--slr <n>] <bitstream> <logic-location-file> [<lut> ...]" << std::endl
+				  << std::endl
+				  << "Dumps the INIT values of the named LUTs (default: all LUTs listed in the logic location file) from a" << std::endl
+				  << "bitstream or readback file. LUTs are named <site>/<id> (e.g. SLICE_X12Y34/A), as listed by the Ram=" << std::endl
+				  << "and Rom= entries of the logic location file (write_bitstream -logic_location_file)." << std::endl
+				  << std::endl
+				  << "options:" << std::endl
+				  << "  --slr <n>  SLR of the frame data described by the logic location file (default: 0)" << std::endl
+				  << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const bitstream bs = bitstream::load_bitstream(args[0u], 0xFFFFFFFFu, true);
+		const fpga& fpga = fpga_by_idcode(bs.idcode());
+
+		const auto ll = logic_location::load(args[1u], slr);
+
+		// Select the LUTs (named, or all)
+		std::vector<size_t> luts;
+
+		if (args.size() > 2u)
+		{
+			for (size_t i = 2u; i < args.size(); ++i)
+				luts.push_back(ll.find_lut(args[i]));
+		}
+		else
+		{
+			luts.resize(ll.num_luts());
+			std::iota(luts.begin(), luts.end(), size_t(0u));
+		}
+
+		// Read all INIT values in one pass over the affected frames
+		const lut_init_plan plan(fpga, ll, luts);
+		const auto values = plan.read(bs);
+
+		for (size_t i = 0u; i < luts.size(); ++i)
+		{
+			std::cout << ll.lut(luts[i]).name << " 64'h" << std::hex << std::setfill('0') << std::setw(16) << values[i]
+					  << std::dec << std::setfill(' ');
+
+			if (plan.mask(i) != ~uint64_t(0u))
+			{
+				std::cout << " (partial, mask 64'h" << std::hex << std::setfill('0') << std::setw(16) << plan.mask(i)
+						  << std::dec << std::setfill(' ') << ")";
+			}
+
+			std::cout << std::endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,162 @@
+/**
+ * @file
+ * @brief Proof-of-concept tool to dump (ELF) symbols of a processor image from block RAMs in a Xilinx FPGA.
+ */
+
+#include "unbit/fpga/old/xilinx/bitstream.hpp"
+#include "unbit/fpga/old/xilinx/bram.hpp"
+#include "unbit/fpga/old/xilinx/mmi.hpp"
+#include "unbit/fpga/old/xilinx/fpga.hpp"
+
+#include "unbit/xml/xml.hpp"
+#include "unbit/ihex/elf.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using unbit::old::xilinx::bitstream;
+using unbit::old::xilinx::fpga;
+using unbit::old::xilinx::fpga_by_idcode;
+using unbit::old::xilinx::mmi::memory_map;
+
+using unbit::elf;
+using unbit::xml::xml_parser_guard;
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Tests if a symbol is fully covered by the regions of a memory map.
+ */
+static bool is_mapped(const memory_map& mmi, const elf::symbol& sym)
+{
+	for (size_t i = 0u; i < mmi.num_regions(); ++i)
+	{
+		const auto& rgn = mmi.region(i);
+
+		if (sym.address >= rgn.start_bit_addr() / 8u && sym.address + sym.size - 1u <= rgn.end_bit_addr() / 8u)
+			return true;
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Selects the symbols to be dumped.
+ */
+static std::vector<elf::symbol> select_symbols(const memory_map& mmi, const std::vector<elf::symbol>& symbols,
+											   const std::vector<std::string>& names)
+{
+	std::vector<elf::symbol> selected;
+
+	if (names.empty())
+	{
+		// All data objects in the memory map
+		for (const auto& sym : symbols)
+		{
+			if (sym.type == elf::symbol_type::object && sym.size > 0u && is_mapped(mmi, sym))
+				selected.push_back(sym);
+		}
+	}
+	else
+	{
+		// Named symbols (in command line order)
+		for (const auto& name : names)
+		{
+			const size_t num_selected = selected.size();
+
+			for (const auto& sym : symbols)
+			{
+				if (sym.name == name)
+					selected.push_back(sym);
+			}
+
+			if (selected.size() == num_selected)
+				throw std::invalid_argument("symbol '" + name + "' not found in elf file");
+		}
+	}
+
+	return selected;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	xml_parser_guard parser_guard;
+
+	try
+	{
+		// Split options and positional arguments
+		std::string reference;
+		std::vector<std::string> args;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg(argv[i]);
+
+			if (arg == "--raw" && (i + 1) < argc)
+			{
+				reference = argv[++i];
+			}
+			else
+			{
+				args.push_back(arg);
+			}
+		}
+
+		if (args.size() < 4u)
+		{
+			std::cerr << "usage: " << argv[0u] << " [--raw <reference-bitstream>] <bitstream> <mmi> <instance> <elf> [<symbol> ...]" << std::endl
+					  << std::endl
+					  << "Dumps the named symbols (default: all data objects in the memory map) of an elf file from the" << std::endl
+					  << "block RAMs of a bitstream or readback file. With --raw, the input is a raw readback data file" << std::endl
+					  << "(the reference bitstream provides the device geometry)." << std::endl
+					  << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const bitstream bs = reference.empty() ?
+			bitstream::load_bitstream(args[0u], 0xFFFFFFFFu, true) :
+			bitstream::load_raw(args[0u], bitstream::load_bitstream(reference, 0xFFFFFFFFu, true));
+
+		const fpga& fpga = fpga_by_idcode(bs.idcode());
+		const auto mmi = memory_map::load(args[1u], args[2u]);
+
+		const auto symbols = select_symbols(*mmi, elf::load_symbols(args[3u]),
+											std::vector<std::string>(args.begin() + 4u, args.end()));
+
+		// Read all symbols in one batch (grouped by block RAM)
+		std::vector<memory_map::byte_range> ranges;
+		ranges.reserve(symbols.size());
+
+		for (const auto& sym : symbols)
+		{
+			ranges.push_back(memory_map::byte_range { sym.address, static_cast<size_t>(sym.size) });
+		}
+
+		const auto values = mmi->read_ranges(fpga, bs, std::span<const memory_map::byte_range>(ranges));
+
+		for (size_t i = 0u; i < symbols.size(); ++i)
+		{
+			std::cout << std::hex << std::setfill('0') << std::setw(8) << symbols[i].address
+					  << std::dec << std::setfill(' ') << ' ' << std::setw(6) << symbols[i].size
+					  << ' ' << symbols[i].name << ':';
+
+			for (uint8_t value : values[i])
+			{
+				std::cout << ' ' << std::hex << std::setfill('0') << std::setw(2) << static_cast<unsigned>(value);
+			}
+
+			std::cout << std::dec << std::setfill(' ') << std::endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
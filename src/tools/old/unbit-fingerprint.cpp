@@ -0,0 +1,218 @@
+/**
+ * @file
+ * @brief Builds and queries a fingerprint index of the memory images of a bitstream corpus.
+ */
+
+#include "unbit/fpga/old/xilinx/bitstream.hpp"
+#include "unbit/fpga/old/xilinx/mmi.hpp"
+#include "unbit/fpga/old/xilinx/fpga.hpp"
+#include "unbit/runtime/executor.hpp"
+#include "unbit/runtime/fingerprint_index.hpp"
+
+#include "unbit/xml/xml.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using unbit::old::xilinx::bitstream;
+using unbit::old::xilinx::fpga;
+using unbit::old::xilinx::fpga_by_idcode;
+using unbit::old::xilinx::mmi::memory_map;
+using unbit::runtime::fingerprint_image;
+using unbit::runtime::fingerprint_index;
+using unbit::runtime::fingerprint_index_builder;
+using unbit::runtime::parallel_for;
+
+using unbit::xml::xml_parser_guard;
+
+namespace
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Entry of the corpus list.
+	 */
+	struct corpus_entry
+	{
+		std::string bitstream;
+		std::string mmi;
+		std::string instance;
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Reads the corpus list (one "<bitstream> <mmi> <instance>" triple per line, '#' starts a comment).
+	 */
+	std::vector<corpus_entry> load_corpus(const std::string& filename)
+	{
+		std::ifstream stm(filename);
+		if (!stm)
+			throw std::ios_base::failure("unable to open corpus list '" + filename + "'");
+
+		std::vector<corpus_entry> corpus;
+		std::string line;
+
+		for (std::size_t line_no = 1u; std::getline(stm, line); ++line_no)
+		{
+			line = line.substr(0u, line.find('#'));
+
+			std::istringstream fields(line);
+			corpus_entry entry;
+
+			if (!(fields >> entry.bitstream))
+				continue;
+
+			std::string extra;
+			if (!(fields >> entry.mmi >> entry.instance) || (fields >> extra))
+				throw std::invalid_argument(filename + ":" + std::to_string(line_no) + ": expected '<bitstream> <mmi> <instance>'");
+
+			corpus.push_back(std::move(entry));
+		}
+
+		return corpus;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads a binary file.
+	 */
+	std::vector<uint8_t> load_binary(const std::string& filename)
+	{
+		std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+		if (!stm)
+			throw std::ios_base::failure("unable to open binary file '" + filename + "'");
+
+		return std::vector<uint8_t>((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Builds the index over all memory regions of the corpus.
+	 */
+	int cmd_build(const std::string& index_name, const std::string& corpus_name)
+	{
+		const auto corpus = load_corpus(corpus_name);
+
+		// Parse each memory map only once (the XML parser is not used concurrently)
+		std::map<std::pair<std::string, std::string>, std::unique_ptr<memory_map>> maps;
+		for (const auto& entry : corpus)
+		{
+			auto& mmi = maps[std::make_pair(entry.mmi, entry.instance)];
+			if (!mmi)
+				mmi = memory_map::load(entry.mmi, entry.instance);
+		}
+
+		// Extract and hash the images in parallel (one bitstream per task, on the shared executor)
+		fingerprint_index_builder builder;
+
+		auto process = [&](std::size_t i)
+		{
+			const auto& entry = corpus[i];
+			const memory_map& mmi = *maps.at(std::make_pair(entry.mmi, entry.instance));
+
+			const bitstream bs = bitstream::load_bitstream(entry.bitstream, 0xFFFFFFFFu, true);
+			const fpga& fpga = fpga_by_idcode(bs.idcode());
+
+			for (std::size_t r = 0u; r < mmi.num_regions(); ++r)
+			{
+				const auto& rgn = mmi.region(r);
+				const auto data = mmi.read_region(fpga, bs, r);
+
+				builder.add(fingerprint_image { entry.bitstream, entry.instance, rgn.name(), rgn.start_bit_addr() / 8u, 0u }, data);
+			}
+		};
+
+		parallel_for(0u, corpus.size(), process);
+
+		builder.write(index_name);
+
+		std::cout << "indexed " << builder.num_images() << " images (" << builder.num_postings() << " windows) from "
+			<< corpus.size() << " bitstreams" << std::endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Finds the images containing a firmware binary.
+	 */
+	int cmd_query(const std::string& index_name, const std::string& binary_name, double min_coverage)
+	{
+		const fingerprint_index index(index_name);
+		const auto binary = load_binary(binary_name);
+
+		if (binary.size() < index.options().window + index.options().stride)
+		{
+			std::clog << "WARN: binary is shorter than " << (index.options().window + index.options().stride)
+				<< " bytes, matches may be missed" << std::endl;
+		}
+
+		const auto matches = index.query(binary, min_coverage);
+
+		for (const auto& m : matches)
+		{
+			const auto& image = index.images()[m.image];
+
+			std::cout << image.source << " " << image.instance << " " << image.region << " ";
+
+			const int64_t address = static_cast<int64_t>(image.base_address) + m.address;
+			if (address < 0)
+				std::cout << "-0x" << std::hex << std::setw(8) << std::setfill('0') << -address;
+			else
+				std::cout << "0x" << std::hex << std::setw(8) << std::setfill('0') << address;
+
+			std::cout << std::dec << std::setfill(' ') << " " << std::fixed << std::setprecision(3) << m.coverage()
+				<< " (" << m.matched_windows << "/" << m.expected_windows << ")" << std::endl;
+		}
+
+		return matches.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	void print_usage(const char* argv0)
+	{
+		std::cerr << "usage: " << argv0 << " build <index> <corpus-list>" << std::endl
+			<< "       " << argv0 << " query <index> <firmware.bin> [<min-coverage>]" << std::endl
+			<< std::endl
+			<< "The corpus list names one '<bitstream> <mmi> <instance>' triple per line. The build command extracts" << std::endl
+			<< "all memory regions of the listed instances and indexes their rolling window hashes; the query command" << std::endl
+			<< "reports the bitstreams (and load addresses) containing a firmware binary." << std::endl
+			<< std::endl
+			<< "The number of threads used by the build command can be set with the UNBIT_THREADS environment variable." << std::endl
+			<< std::endl;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	xml_parser_guard parser_guard;
+
+	try
+	{
+		const std::vector<std::string> args(argv + 1, argv + argc);
+
+		if (args.size() == 3u && args[0u] == "build")
+			return cmd_build(args[1u], args[2u]);
+
+		if ((args.size() == 3u || args.size() == 4u) && args[0u] == "query")
+			return cmd_query(args[1u], args[2u], (args.size() == 4u) ? std::stod(args[3u]) : 0.5);
+
+		print_usage(argv[0u]);
+		return EXIT_FAILURE;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,686 @@
+/**
+ * @file
+ * @brief Maintains a content-addressable (deduplicated) archive of bitstream builds.
+ */
+
+#include "unbit/fpga/old/xilinx/bitstream.hpp"
+#include "unbit/fpga/old/xilinx/fpga.hpp"
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/frame_archive.hpp"
+#include "unbit/fpga/xilinx/frame_sketch.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+#include "unbit/fpga/xilinx/frame_sync.hpp"
+#include "unbit/fpga/xilinx/readback_converter.hpp"
+#include "unbit/runtime/sha256.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <csignal>
+# include <netdb.h>
+# include <sys/socket.h>
+# include <sys/wait.h>
+# include <unistd.h>
+# define UNBIT_HAVE_SYNC 1
+#endif
+
+using unbit::old::xilinx::bitstream;
+using unbit::fpga::xilinx::bitstream_engine;
+using unbit::fpga::xilinx::frame_archive;
+using unbit::fpga::xilinx::frame_sketch;
+using unbit::fpga::xilinx::frame_store;
+using unbit::fpga::xilinx::frame_sync_client;
+using unbit::fpga::xilinx::frame_sync_server;
+using unbit::fpga::xilinx::readback_converter;
+using unbit::fpga::xilinx::readback_layout;
+using unbit::fpga::xilinx::sketch_index;
+using unbit::runtime::sha256;
+
+namespace
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Extracts the configuration words of bitstream data (native byte order, starting at the first sync word).
+	 */
+	std::vector<uint32_t> config_words(std::span<const uint8_t> data, const std::string& filename)
+	{
+		// Skip over leading data (e.g. the .bit file header) until we see the first sync word
+		uint32_t sync_w = 0u;
+		std::size_t pos = 0u;
+
+		while (pos < data.size() && sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			sync_w = (sync_w << 8u) | data[pos++];
+
+		if (sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			throw std::invalid_argument("no sync word found in bitstream file '" + filename + "'");
+
+		std::vector<uint32_t> words;
+		words.reserve((data.size() - pos) / 4u + 1u);
+
+		for (pos -= 4u; pos + 4u <= data.size(); pos += 4u)
+		{
+			words.push_back((static_cast<uint32_t>(data[pos]) << 24u) | (static_cast<uint32_t>(data[pos + 1u]) << 16u) |
+				(static_cast<uint32_t>(data[pos + 2u]) << 8u) | static_cast<uint32_t>(data[pos + 3u]));
+		}
+
+		return words;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads the configuration words of a bitstream file (native byte order, starting at the first sync word).
+	 */
+	std::vector<uint32_t> load_config_words(const std::string& filename)
+	{
+		std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+		if (!stm)
+			throw std::ios_base::failure("unable to open bitstream file '" + filename + "'");
+
+		const std::vector<uint8_t> data((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+		return config_words(data, filename);
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Finds the (first) IDCODE written by a configuration bitstream.
+	 */
+	uint32_t find_idcode(const std::vector<uint32_t>& words)
+	{
+		for (std::size_t i = 0u; i + 1u < words.size(); ++i)
+		{
+			// Type 1 write of one word to the IDCODE register
+			if (words[i] == 0x30018001u)
+				return words[i + 1u];
+		}
+
+		throw std::invalid_argument("no idcode found in bitstream");
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads the frames of a bitstream file.
+	 */
+	frame_store load_bitstream_frames(const std::string& filename)
+	{
+		const auto words = load_config_words(filename);
+		const auto& fpga = unbit::old::xilinx::fpga_by_idcode(find_idcode(words));
+		std::cout << "fpga: " << fpga.name() << std::endl;
+
+		return frame_store::load(words, fpga.frame_size() / 4u);
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads the frames of a raw readback file (or readback bitstream), using the layout of a reference bitstream.
+	 */
+	frame_store load_readback_frames(const std::string& reference_file, const std::string& readback_file, bool rbb_input)
+	{
+		const bitstream reference = bitstream::load_bitstream(reference_file, 0xFFFFFFFFu, true);
+
+		const auto& fpga = unbit::old::xilinx::fpga_by_idcode(reference.idcode());
+		std::cout << "fpga: " << fpga.name() << std::endl;
+
+		const std::size_t frame_words = fpga.frame_size() / 4u;
+
+		std::ifstream input(readback_file, std::ios_base::in | std::ios_base::binary);
+		if (!input)
+			throw std::ios_base::failure("unable to open readback file '" + readback_file + "'");
+
+		readback_converter converter(input, frame_words);
+
+		if (rbb_input)
+		{
+			// FDRO payload: pipeline words, padding frame, frame data
+			converter.scan_fdro((fpga.readback_offset() - fpga.frame_size()) / 4u);
+		}
+		else
+		{
+			// Raw readback: replicate the SLR layout of the reference bitstream (cf. bitstream::load_raw)
+			readback_layout layout;
+			layout.front_padding_words = fpga.front_padding() / 4u;
+			layout.back_padding_words  = fpga.back_padding() / 4u;
+
+			for (const auto& ref : reference.slrs())
+			{
+				if (ref.frame_data_size < fpga.front_padding())
+					throw std::invalid_argument("bad frame data size of reference bitstream");
+
+				auto& slr = layout.slrs.emplace_back();
+				slr.idcode     = ref.idcode;
+				slr.num_frames = (ref.frame_data_size - fpga.front_padding()) / fpga.frame_size();
+			}
+
+			converter.set_layout(layout);
+		}
+
+		// Convert to an (in-memory) bitstream, then load its frames
+		std::ostringstream converted(std::ios_base::out | std::ios_base::binary);
+		converter.convert(converted);
+
+		const std::string data = converted.str();
+		const auto words = config_words(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(data.data()), data.size()), readback_file);
+		return frame_store::load(words, frame_words);
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Gets the path of the sketch index of an archive.
+	 */
+	std::string sketch_index_path(const std::string& archive_dir)
+	{
+		return (std::filesystem::path(archive_dir) / "sketches.idx").string();
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Rebuilds the sketch index of an archive (from the manifests, no frame data is read).
+	 */
+	sketch_index build_sketch_index(const frame_archive& archive)
+	{
+		sketch_index index;
+
+		for (const auto& build : archive.builds())
+		{
+			frame_sketch sketch(index.size());
+			sketch.add(archive.manifest(build));
+			index.add(build, sketch);
+		}
+
+		return index;
+	}
+
+#if defined(UNBIT_HAVE_SYNC)
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Connection to a sync server (a child process, or a TCP connection).
+	 */
+	class sync_connection
+	{
+	private:
+		int in_fd_ = -1;
+		int out_fd_ = -1;
+		pid_t child_ = -1;
+
+	public:
+		sync_connection() =default;
+
+		~sync_connection()
+		{
+			if (out_fd_ >= 0 && out_fd_ != in_fd_)
+				::close(out_fd_);
+
+			if (in_fd_ >= 0)
+				::close(in_fd_);
+
+			if (child_ > 0)
+			{
+				int status;
+				while (::waitpid(child_, &status, 0) < 0 && errno == EINTR)
+					continue;
+			}
+		}
+
+		int in_fd() const noexcept
+		{
+			return in_fd_;
+		}
+
+		int out_fd() const noexcept
+		{
+			return out_fd_;
+		}
+
+		/**
+		 * @brief Runs a server command (through the shell), talking to its standard input and output.
+		 */
+		void exec(const std::string& command)
+		{
+			int to_child[2];
+			int from_child[2];
+
+			if (::pipe(to_child) != 0)
+				throw std::system_error(errno, std::generic_category(), "unable to create pipe");
+
+			if (::pipe(from_child) != 0)
+			{
+				const int err = errno;
+				::close(to_child[0u]);
+				::close(to_child[1u]);
+				throw std::system_error(err, std::generic_category(), "unable to create pipe");
+			}
+
+			child_ = ::fork();
+
+			if (child_ == 0)
+			{
+				::dup2(to_child[0u], STDIN_FILENO);
+				::dup2(from_child[1u], STDOUT_FILENO);
+				::close(to_child[0u]);
+				::close(to_child[1u]);
+				::close(from_child[0u]);
+				::close(from_child[1u]);
+
+				::execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+				::_exit(127);
+			}
+
+			const int err = errno;
+			::close(to_child[0u]);
+			::close(from_child[1u]);
+
+			out_fd_ = to_child[1u];
+			in_fd_ = from_child[0u];
+
+			if (child_ < 0)
+				throw std::system_error(err, std::generic_category(), "unable to start server command");
+		}
+
+		/**
+		 * @brief Connects to a TCP server ("host:port").
+		 */
+		void connect(const std::string& address)
+		{
+			const auto colon = address.rfind(':');
+			if (colon == std::string::npos)
+				throw std::invalid_argument("bad server address '" + address + "' (expected <host>:<port>)");
+
+			const std::string host = address.substr(0u, colon);
+			const std::string port = address.substr(colon + 1u);
+
+			struct addrinfo hints {};
+			hints.ai_family = AF_UNSPEC;
+			hints.ai_socktype = SOCK_STREAM;
+
+			struct addrinfo* result = nullptr;
+			const int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+			if (rc != 0)
+				throw std::runtime_error("unable to resolve '" + address + "': " + ::gai_strerror(rc));
+
+			int fd = -1;
+			for (auto* ai = result; ai && fd < 0; ai = ai->ai_next)
+			{
+				fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+				if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+				{
+					::close(fd);
+					fd = -1;
+				}
+			}
+
+			::freeaddrinfo(result);
+
+			if (fd < 0)
+				throw std::runtime_error("unable to connect to '" + address + "'");
+
+			in_fd_ = out_fd_ = fd;
+		}
+
+	private:
+		// Non-copyable
+		sync_connection(const sync_connection&) =delete;
+		sync_connection& operator=(const sync_connection&) =delete;
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Serves an archive on a TCP port (one client at a time).
+	 */
+	void serve_tcp(const frame_archive& archive, const std::string& port)
+	{
+		struct addrinfo hints {};
+		hints.ai_family = AF_INET6;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = AI_PASSIVE;
+
+		struct addrinfo* result = nullptr;
+		if (::getaddrinfo(nullptr, port.c_str(), &hints, &result) != 0)
+		{
+			hints.ai_family = AF_INET;
+			if (::getaddrinfo(nullptr, port.c_str(), &hints, &result) != 0)
+				throw std::invalid_argument("bad port '" + port + "'");
+		}
+
+		const int fd = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+		if (fd < 0)
+		{
+			const int err = errno;
+			::freeaddrinfo(result);
+			throw std::system_error(err, std::generic_category(), "unable to create socket");
+		}
+
+		const int enable = 1;
+		::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+		if (::bind(fd, result->ai_addr, result->ai_addrlen) != 0 || ::listen(fd, 4) != 0)
+		{
+			const int err = errno;
+			::freeaddrinfo(result);
+			::close(fd);
+			throw std::system_error(err, std::generic_category(), "unable to listen on port " + port);
+		}
+
+		::freeaddrinfo(result);
+		std::cerr << "serving on port " << port << std::endl;
+
+		for (;;)
+		{
+			const int client = ::accept(fd, nullptr, nullptr);
+			if (client < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				const int err = errno;
+				::close(fd);
+				throw std::system_error(err, std::generic_category(), "unable to accept connection");
+			}
+
+			try
+			{
+				frame_sync_server server(archive, client, client);
+				server.serve();
+			}
+			catch (std::exception& e)
+			{
+				std::cerr << "error: " << e.what() << std::endl;
+			}
+
+			::close(client);
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Opens the connection to a sync server ("--exec <command>" or "--connect <host>:<port>").
+	 */
+	void open_connection(sync_connection& connection, const std::string& mode, const std::string& target)
+	{
+		if (mode == "--exec")
+			connection.exec(target);
+		else
+			connection.connect(target);
+	}
+#endif
+
+	//-----------------------------------------------------------------------------------------------------------------
+	void print_usage(const char* argv0)
+	{
+		std::cerr << "usage: " << argv0 << " add <archive> <build> <bitstream>" << std::endl
+			  << "       " << argv0 << " extract <archive> <build> <result>" << std::endl
+			  << "       " << argv0 << " list <archive>" << std::endl
+			  << "       " << argv0 << " index <archive>" << std::endl
+			  << "       " << argv0 << " nearest <archive> <bitstream> [<k>]" << std::endl
+			  << "       " << argv0 << " nearest-readback [--rbb] <archive> <reference-bitstream> <readback-file> [<k>]" << std::endl
+			  << "       " << argv0 << " serve <archive> [--port <port>]" << std::endl
+			  << "       " << argv0 << " sync <archive> <build> [--base <build>] (--exec <command> | --connect <host>:<port>)" << std::endl
+			  << "       " << argv0 << " check <archive> <build> (--exec <command> | --connect <host>:<port>)" << std::endl
+			  << std::endl
+			  << "Maintains an archive of (uncompressed) bitstream builds. Each unique configuration frame is stored once" << std::endl
+			  << "(keyed by its SHA-256 digest); builds are stored as manifests referencing the frames, and are" << std::endl
+			  << "reconstructed on demand." << std::endl
+			  << std::endl
+			  << "The archive keeps a MinHash sketch of each build (updated by 'add', rebuilt by 'index'). The 'nearest'" << std::endl
+			  << "commands list the <k> (default: 5) archived builds most similar to a bitstream, or to readback data" << std::endl
+			  << "(raw readback with the layout of <reference-bitstream>, or a readback bitstream with --rbb)." << std::endl
+			  << std::endl
+			  << "Builds are synchronized between archives by walking per-SLR Merkle trees of the frame digests. 'serve'" << std::endl
+			  << "answers requests on its standard input and output (or on a TCP port); 'sync' fetches a build from a server" << std::endl
+			  << "started by a shell command (e.g. 'ssh host unbit-old-frame-archive serve /srv/archive') or listening on a" << std::endl
+			  << "TCP port. Only frames that differ from the local <base> build (and are missing in the local archive) are" << std::endl
+			  << "transferred. 'check' compares the Merkle tree roots of a local and a remote build." << std::endl << std::endl;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	void print_nearest(const std::string& archive_dir, const frame_store& frames, std::size_t k)
+	{
+		const auto path = sketch_index_path(archive_dir);
+		if (!std::filesystem::exists(path))
+			throw std::invalid_argument("archive '" + archive_dir + "' has no sketch index (run 'index' first)");
+
+		const sketch_index index = sketch_index::load(path);
+
+		frame_sketch sketch(index.size());
+		sketch.add(frames);
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto matches = index.nearest(sketch, k);
+		const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+		std::cout << std::fixed << std::setprecision(3);
+		for (const auto& match : matches)
+			std::cout << std::setw(8) << match.similarity << "  " << match.name << std::endl;
+
+		std::cout << std::endl << "searched " << index.num_entries() << " builds in " << elapsed.count() << " ms" << std::endl;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		const std::vector<std::string> args(argv + 1, argv + argc);
+
+		if (args.size() == 4u && args[0u] == "add")
+		{
+			frame_archive archive(args[1u]);
+
+			const frame_store frames = load_bitstream_frames(args[3u]);
+
+			std::size_t num_frames = 0u;
+			for (std::size_t k = 0u; k < frames.num_slrs(); ++k)
+				num_frames += frames.num_frames(k);
+
+			const std::size_t num_new = archive.add(args[2u], frames);
+			std::cout << "added build '" << args[2u] << "': " << num_frames << " frames, " << num_new << " new" << std::endl;
+
+			// Update the sketch index (rebuilt from scratch if it does not exist yet)
+			const auto index_path = sketch_index_path(args[1u]);
+			sketch_index index = std::filesystem::exists(index_path) ? sketch_index::load(index_path) : build_sketch_index(archive);
+
+			frame_sketch sketch(index.size());
+			sketch.add(frames);
+			index.add(args[2u], sketch);
+			index.save(index_path);
+		}
+		else if (args.size() == 4u && args[0u] == "extract")
+		{
+			const frame_archive archive(args[1u]);
+
+			std::cout << "reconstructing build '" << args[2u] << "' ..." << std::flush;
+			archive.reconstruct(args[2u], args[3u]);
+			std::cout << "done" << std::endl;
+		}
+		else if (args.size() == 2u && args[0u] == "list")
+		{
+			const frame_archive archive(args[1u]);
+
+			for (const auto& build : archive.builds())
+				std::cout << build << std::endl;
+
+			const auto stats = archive.stats();
+			const double mib = 1024.0 * 1024.0;
+
+			std::cout << std::endl << std::fixed << std::setprecision(1)
+				<< stats.num_builds << " builds, " << stats.num_frame_refs << " frames (" << stats.num_unique_frames << " unique)" << std::endl
+				<< "stored: " << (static_cast<double>(stats.pack_bytes + stats.metadata_bytes) / mib) << " MiB ("
+				<< (static_cast<double>(stats.metadata_bytes) / mib) << " MiB metadata), logical: "
+				<< (static_cast<double>(stats.logical_bytes) / mib) << " MiB" << std::endl;
+		}
+		else if (args.size() == 2u && args[0u] == "index")
+		{
+			const frame_archive archive(args[1u]);
+
+			const sketch_index index = build_sketch_index(archive);
+			index.save(sketch_index_path(args[1u]));
+
+			std::cout << "indexed " << index.num_entries() << " builds" << std::endl;
+		}
+		else if ((args.size() == 3u || args.size() == 4u) && args[0u] == "nearest")
+		{
+			const std::size_t k = (args.size() == 4u) ? std::stoul(args[3u]) : 5u;
+			print_nearest(args[1u], load_bitstream_frames(args[2u]), k);
+		}
+		else if (args.size() >= 4u && args[0u] == "nearest-readback")
+		{
+			const bool rbb_input = (args[1u] == "--rbb");
+			const std::size_t pos = rbb_input ? 2u : 1u;
+
+			if (args.size() != pos + 3u && args.size() != pos + 4u)
+			{
+				print_usage(argv[0u]);
+				return EXIT_FAILURE;
+			}
+
+			const std::size_t k = (args.size() == pos + 4u) ? std::stoul(args[pos + 3u]) : 5u;
+			print_nearest(args[pos], load_readback_frames(args[pos + 1u], args[pos + 2u], rbb_input), k);
+		}
+		else if ((args.size() == 2u || (args.size() == 4u && args[2u] == "--port")) && args[0u] == "serve")
+		{
+#if defined(UNBIT_HAVE_SYNC)
+			::signal(SIGPIPE, SIG_IGN);
+
+			const frame_archive archive(args[1u]);
+
+			if (args.size() == 4u)
+			{
+				serve_tcp(archive, args[3u]);
+			}
+			else
+			{
+				frame_sync_server server(archive, STDIN_FILENO, STDOUT_FILENO);
+				server.serve();
+			}
+#else
+			throw std::runtime_error("synchronization is not supported on this platform");
+#endif
+		}
+		else if (args.size() >= 5u && (args[0u] == "sync" || args[0u] == "check"))
+		{
+#if defined(UNBIT_HAVE_SYNC)
+			std::string base;
+			std::string mode;
+			std::string target;
+
+			for (std::size_t pos = 3u; pos < args.size(); pos += 2u)
+			{
+				if (pos + 1u < args.size() && args[pos] == "--base" && args[0u] == "sync")
+				{
+					base = args[pos + 1u];
+				}
+				else if (pos + 1u < args.size() && (args[pos] == "--exec" || args[pos] == "--connect"))
+				{
+					mode = args[pos];
+					target = args[pos + 1u];
+				}
+				else
+				{
+					mode.clear();
+					break;
+				}
+			}
+
+			if (mode.empty())
+			{
+				print_usage(argv[0u]);
+				return EXIT_FAILURE;
+			}
+
+			::signal(SIGPIPE, SIG_IGN);
+
+			frame_archive archive(args[1u]);
+			const std::string& build = args[2u];
+
+			sync_connection connection;
+			open_connection(connection, mode, target);
+
+			frame_sync_client client(connection.in_fd(), connection.out_fd());
+
+			if (args[0u] == "check")
+			{
+				const auto remote = client.info(build);
+				if (!remote)
+					throw std::invalid_argument("build '" + build + "' does not exist on the server");
+
+				if (!archive.contains(build))
+				{
+					std::cout << "build '" << build << "' is missing in the local archive" << std::endl;
+					return EXIT_FAILURE;
+				}
+
+				const auto trees = archive.merkle(build);
+				bool same = (trees.frame_words() == remote->frame_words && trees.num_slrs() == remote->slrs.size());
+
+				for (std::size_t k = 0u; k < remote->slrs.size(); ++k)
+				{
+					const bool slr_same = same && trees.slr(k).num_leaves() == remote->slrs[k].num_frames &&
+						trees.slr(k).root() == remote->slrs[k].root;
+
+					std::cout << "SLR(" << k << "): " << (slr_same ? "same" : "differs") << " (remote root "
+						<< sha256::to_hex(remote->slrs[k].root) << ")" << std::endl;
+
+					same = same && slr_same;
+				}
+
+				std::cout << "build '" << build << "' is " << (same ? "up to date" : "out of date") << std::endl;
+				return same ? EXIT_SUCCESS : EXIT_FAILURE;
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			const auto stats = client.sync(archive, build, base);
+			const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+			if (stats.up_to_date)
+			{
+				std::cout << "build '" << build << "' is up to date" << std::endl;
+			}
+			else
+			{
+				std::cout << "fetched build '" << build << "': " << stats.frames_received << " frames received, "
+					<< stats.frames_reused << " reused, " << stats.nodes_received << " tree nodes" << std::endl;
+
+				// Keep the sketch index (if any) up to date
+				const auto index_path = sketch_index_path(args[1u]);
+				if (std::filesystem::exists(index_path))
+				{
+					sketch_index index = sketch_index::load(index_path);
+
+					frame_sketch sketch(index.size());
+					sketch.add(archive.manifest(build));
+					index.add(build, sketch);
+					index.save(index_path);
+				}
+			}
+
+			std::cout << std::fixed << std::setprecision(1) << stats.round_trips << " round trips, "
+				<< stats.bytes_sent << " bytes sent, " << stats.bytes_received << " bytes received in "
+				<< elapsed.count() << " ms" << std::endl;
+#else
+			throw std::runtime_error("synchronization is not supported on this platform");
+#endif
+		}
+		else
+		{
+			print_usage(argv[0u]);
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
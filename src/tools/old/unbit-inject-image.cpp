@@ -1,28 +1,102 @@
 /**
  * @file
- * @brief Proof-of-concept tool to inject a (processor) image into block RAMs of a Xilinx FPGA.
+ * @brief Proof-of-concept tool to inject (processor) images into block RAMs of a Xilinx FPGA.
  */
 
 #include "unbit/fpga/old/xilinx/bitstream.hpp"
 #include "unbit/fpga/old/xilinx/bram.hpp"
 #include "unbit/fpga/old/xilinx/mmi.hpp"
 #include "unbit/fpga/old/xilinx/fpga.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
 
 #include "unbit/xml/xml.hpp"
 #include "unbit/ihex/ihex.hpp"
+#include "unbit/ihex/srec.hpp"
+#include "unbit/runtime/mem_stats.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using unbit::old::xilinx::bitstream;
 using unbit::old::xilinx::bram;
 using unbit::old::xilinx::bram_category;
 using unbit::old::xilinx::fpga;
 using unbit::old::xilinx::fpga_by_idcode;
+using unbit::old::xilinx::mmi::bram_write_plan;
 using unbit::old::xilinx::mmi::memory_map;
 using unbit::old::xilinx::mmi::memory_region;
+using unbit::fpga::xilinx::config_crc;
+using unbit::runtime::mem_stats;
 
 using unbit::xml::xml_parser_guard;
 
+//---------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Guesses the format of an image file from its extension.
+ */
+static std::string guess_image_format(const std::string& filename)
+{
+	const auto dot = filename.find_last_of('.');
+	if (dot == std::string::npos)
+		return "ihex";
+
+	std::string ext = filename.substr(dot + 1u);
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+
+	if (ext == "srec" || ext == "s19" || ext == "s28" || ext == "s37" || ext == "mot")
+		return "srec";
+	else if (ext == "bin")
+		return "bin";
+	else
+		return "ihex";
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Image file (and its format options) to be injected.
+ */
+struct image_file
+{
+	std::string filename;
+	std::string format;
+	bool has_base = false;
+	uint32_t base_address = 0u;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Loads an image file (Intel-Hex, S-record or raw binary).
+ */
+static unbit::memory_image load_image(const image_file& file)
+{
+	const std::string format = file.format.empty() ? guess_image_format(file.filename) : file.format;
+	const std::string& filename = file.filename;
+
+	if (format == "ihex")
+	{
+		return unbit::ihex::load_image(filename);
+	}
+	else if (format == "srec")
+	{
+		return unbit::srec::load_image(filename);
+	}
+	else if (format == "bin")
+	{
+		if (!file.has_base)
+			throw std::invalid_argument("raw binary images require a load address (--base)");
+
+		return unbit::raw_binary::load_image(filename, file.base_address);
+	}
+	else
+	{
+		throw std::invalid_argument("unsupported image format '" + format + "'");
+	}
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 int main(int argc, char *argv[])
 {
@@ -30,47 +104,150 @@ int main(int argc, char *argv[])
 
 	try
 	{
-		if (argc != 6u)
+		// Split options and positional arguments (--format and --base apply to the next image only)
+		bool mem_report = false;
+		image_file pending;
+		bool have_pending = false;
+		std::vector<std::string> args;
+		std::vector<image_file> images;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg(argv[i]);
+
+			if (arg == "--mem-report")
+			{
+				mem_report = true;
+				mem_stats::enable_phases();
+			}
+			else if (arg == "--format" && (i + 1) < argc)
+			{
+				pending.format = argv[++i];
+				have_pending = true;
+			}
+			else if (arg == "--base" && (i + 1) < argc)
+			{
+				pending.base_address = static_cast<uint32_t>(std::stoul(argv[++i], nullptr, 0));
+				pending.has_base = true;
+				have_pending = true;
+			}
+			else if (args.size() >= 4u && (args.size() % 2u) == 0u)
+			{
+				// Image of the preceding instance
+				pending.filename = arg;
+				images.push_back(pending);
+				args.push_back(arg);
+
+				pending = image_file();
+				have_pending = false;
+			}
+			else if (have_pending)
+			{
+				throw std::invalid_argument("--format and --base must directly precede an image file ('" + arg + "')");
+			}
+			else
+			{
+				args.push_back(arg);
+			}
+		}
+
+		if (have_pending)
+			throw std::invalid_argument("--format and --base must be followed by an image file");
+
+		if (args.size() < 5u || (args.size() % 2u) != 1u)
 		{
-			std::cerr << "usage: " << argv[0u] << " <result> <bitstream> <mmi> <instance> <ihex>" << std::endl
+			std::cerr << "usage: " << argv[0u] << " [--mem-report] "
+					  << "<result> <bitstream> <mmi> <instance> [--format ihex|srec|bin] [--base <address>] <image> "
+					  << "[<instance> [--format ...] [--base ...] <image> ...]" << std::endl
+					  << std::endl
+					  << "injects one image per processor instance (all instances are loaded from one parse of the" << std::endl
+					  << "mmi file, and all images are written in a single pass over the affected brams). crc checks" << std::endl
+					  << "of the result bitstream are updated if the crc checks of the input bitstream are valid." << std::endl
+					  << std::endl
+					  << "the image format defaults to the file extension (.srec/.s19/.s28/.s37/.mot: srec," << std::endl
+					  << ".bin: raw binary loaded at the --base address, otherwise: intel hex). --format and --base" << std::endl
+					  << "apply to the image that follows them." << std::endl
 					  << std::endl;
 			return EXIT_FAILURE;
 		}
 
-		bitstream bs = bitstream::load_bitstream(argv[2u], 0xFFFFFFFFu, true);
+		bitstream bs = bitstream::load_bitstream(args[1u], 0xFFFFFFFFu, true);
 		const fpga& fpga = fpga_by_idcode(bs.idcode());
-		const auto mmi = memory_map::load(argv[3u], argv[4u]);
+		mem_stats::end_phase("load bitstream");
+
+		// Only rewrite CRC checks that our CRC model reproduces on the unmodified input (anything else would
+		// silently "repair" checks that were meant to fail, or hide an unsupported bitstream layout)
+		bool update_crc = false;
+
+		if (!bs.is_readback())
+		{
+			const size_t num_mismatched = config_crc::verify_checks(bs.raw_data());
+			update_crc = (num_mismatched == 0u);
 
-		std::cout << "updating brams from intel hex image ..." << std::flush;
+			if (!update_crc)
+			{
+				std::cerr << "warning: " << num_mismatched << " crc check(s) of the input bitstream do not match; "
+						  << "crc checks are left unchanged" << std::endl
+						  << "warning: the result bitstream will likely fail to load (use unbit-strip-crc-checks)" << std::endl;
+			}
+
+			mem_stats::end_phase("verify crc");
+		}
+
+		const auto maps = memory_map::load_all(args[2u]);
+		mem_stats::end_phase("load mmi");
 
-		size_t total_load_size = 0u;
+		// Load the images (each in parallel), and merge their bytes into one block RAM write plan
+		bram_write_plan plan(fpga);
 
-		unbit::ihex::load(argv[5u], [&] (uint32_t address, const std::vector<uint8_t>& data)
+		for (size_t i = 3u, k = 0u; i < args.size(); i += 2u, ++k)
 		{
-			// Inject bytes into the working copy of the bitstream
-			for (size_t i = 0u; i < data.size(); ++i)
+			const auto map = std::find_if(maps.begin(), maps.end(), [&](const auto& m) { return m->name() == args[i]; });
+			if (map == maps.end())
+				throw std::invalid_argument("failed to locate processor instance '" + args[i] + "' in mmi file");
+
+			std::cout << "loading image for '" << args[i] << "' ..." << std::flush;
+
+			const auto image = load_image(images[k]);
+			size_t total_load_size = 0u;
+
+			for (const auto& seg : image.segments)
 			{
-				mmi->write_byte(bs, fpga, address + i, data[i]);
+				plan.add(**map, seg.address, seg.data);
+
+				// Account total number of bytes that have been loaded
+				total_load_size += seg.data.size();
 			}
 
-			// Account total number of bytes that have been loaded
-			total_load_size += data.size();
-		});
+			std::cout << total_load_size << " bytes" << std::endl;
+		}
+
+		mem_stats::end_phase("load images");
 
-		std::cout << total_load_size << " bytes loaded" << std::endl;
+		std::cout << "updating " << plan.num_brams() << " brams ..." << std::flush;
+		plan.apply(bs);
+		std::cout << "done" << std::endl;
+		mem_stats::end_phase("inject images");
 
-		// Need to fixup the CRC record (for now we simply kill the CRC command)
-		//
-		// HACK: We ought to do this properly ... for now the unbit-strip-crc-checks tool can
-		// be used to neutralize all CRC checks.
-		std::cout << "warning: crc checks in the result bitstream (if present) need to be fixed up." << std::endl
-			  << "warning: the unbit-strip-crc-checks tool can be used to strip all (sic!) crc" << std::endl
-			  << "warning: check commands from the result (and/or source) bitstream." << std::endl;
+		// Update the CRC checks (once, for all images)
+		if (update_crc)
+		{
+			const size_t num_checks = config_crc::update_checks(bs.raw_data());
+			std::cout << num_checks << " crc check(s) updated" << std::endl;
+			mem_stats::end_phase("update crc");
+		}
 
 		// And store the output
 		std::cout << "writing result bitstream ..." << std::flush;
-		bitstream::save(argv[1u], bs);
+		bitstream::save(args[0u], bs);
 		std::cout << "done" << std::endl;
+		mem_stats::end_phase("write result");
+
+		if (mem_report)
+		{
+			std::cout << std::endl;
+			mem_stats::report(std::cout);
+		}
 
 		return EXIT_SUCCESS;
 	}
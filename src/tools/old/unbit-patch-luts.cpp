@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @brief Proof-of-concept tool to patch LUT INIT values in a Xilinx FPGA bitstream (via logic location data).
+ */
+
+#include "unbit/fpga/old/xilinx/bitstream.hpp"
+#include "unbit/fpga/old/xilinx/fpga.hpp"
+#include "unbit/fpga/old/xilinx/logic_location.hpp"
+#include "unbit/runtime/mem_stats.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using unbit::old::xilinx::bitstream;
+using unbit::old::xilinx::fpga;
+using unbit::old::xilinx::fpga_by_idcode;
+using unbit::old::xilinx::logic_location;
+using unbit::old::xilinx::lut_init_plan;
+using unbit::runtime::mem_stats;
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Parses a LUT INIT value (hex, with optional 64'h or 0x prefix).
+ */
+static uint64_t parse_init(std::string text)
+{
+	if (text.starts_with("64'h") || text.starts_with("64'H"))
+		text.erase(0u, 4u);
+
+	size_t pos = 0u;
+	const uint64_t value = std::stoull(text, &pos, 16);
+
+	if (pos != text.size())
+		throw std::invalid_argument("malformed lut init value '" + text + "'");
+
+	return value;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		// Split options and positional arguments
+		bool mem_report = false;
+		unsigned slr = 0u;
+		std::vector<std::string> args;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg(argv[i]);
+
+			if (arg == "--mem-report")
+			{
+				mem_report = true;
+				mem_stats::enable_phases();
+			}
+			else if (arg == "--slr" && (i + 1) < argc)
+			{
+				slr = static_cast<unsigned>(std::stoul(argv[++i]));
+			}
+			else
+			{
+				args.push_back(arg);
+			}
+		}
+
+		if (args.size() < 4u)
+		{
+			std::cerr << "usage: " << argv[0u] << " [--slr <n>] [--mem-report] <result> <bitstream> <logic-location-file> <lut>=<init> ..." << std::endl
+				  << std::endl
+				  << "Patches the INIT values of LUTs (e.g. SLICE_X12Y34/A=64'h0123456789ABCDEF) in a bitstream. LUTs are named" << std::endl
+				  << "<site>/<id>, as listed by the Ram= and Rom= entries of the logic location file. All patches are applied" << std::endl
+				  << "in one pass over the affected frames. The result is written to <result> (note that this tool currently" << std::endl
+				  << "does not update CRC values)." << std::endl
+				  << std::endl
+				  << "options:" << std::endl
+				  << "  --slr <n>     SLR of the frame data described by the logic location file (default: 0)" << std::endl
+				  << "  --mem-report  print tracked memory and peak resident set size per processing phase" << std::endl
+				  << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		bitstream bs = bitstream::load_bitstream(args[1u]);
+		const fpga& fpga = fpga_by_idcode(bs.idcode());
+		mem_stats::end_phase("load bitstream");
+
+		const auto ll = logic_location::load(args[2u], slr);
+		mem_stats::end_phase("load logic location");
+
+		// Collect the patches
+		std::vector<size_t> luts;
+		std::vector<uint64_t> values;
+
+		for (size_t i = 3u; i < args.size(); ++i)
+		{
+			const auto eq = args[i].find('=');
+			if (eq == std::string::npos)
+				throw std::invalid_argument("malformed lut patch '" + args[i] + "' (expected <lut>=<init>)");
+
+			const size_t lut = ll.find_lut(args[i].substr(0u, eq));
+			if (ll.lut(lut).mask != ~uint64_t(0u))
+			{
+				std::cout << "warning: logic location file lists only some init bits of '" << ll.lut(lut).name
+						  << "' (other bits are not patched)" << std::endl;
+			}
+
+			luts.push_back(lut);
+			values.push_back(parse_init(args[i].substr(eq + 1u)));
+		}
+
+		// Patch all LUTs in one pass over the affected frames
+		const lut_init_plan plan(fpga, ll, luts);
+		plan.write(bs, values);
+
+		std::cout << luts.size() << " lut(s) patched in " << plan.num_frames() << " frame(s)" << std::endl;
+		mem_stats::end_phase("patch luts");
+
+		std::cout << "warning: crc checks in the result bitstream (if present) need to be fixed up." << std::endl
+			  << "warning: the unbit-strip-crc-checks tool can be used to strip all (sic!) crc" << std::endl
+			  << "warning: check commands from the result (and/or source) bitstream." << std::endl;
+
+		// And store the output
+		std::cout << "writing result bitstream ..." << std::flush;
+		bitstream::save(args[0u], bs);
+		std::cout << "done" << std::endl;
+		mem_stats::end_phase("write result");
+
+		if (mem_report)
+		{
+			std::cout << std::endl;
+			mem_stats::report(std::cout);
+		}
+
+		return EXIT_SUCCESS;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
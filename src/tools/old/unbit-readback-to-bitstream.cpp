@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Converts FPGA readback data into a configuration bitstream (streaming).
+ */
+
+#include "unbit/fpga/old/xilinx/bitstream.hpp"
+#include "unbit/fpga/old/xilinx/fpga.hpp"
+#include "unbit/fpga/xilinx/readback_converter.hpp"
+#include "unbit/runtime/mem_stats.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using unbit::old::xilinx::bitstream;
+using unbit::fpga::xilinx::readback_converter;
+using unbit::fpga::xilinx::readback_layout;
+using unbit::fpga::xilinx::serializer_options;
+using unbit::runtime::mem_stats;
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		// Split options and positional arguments
+		bool mem_report = false;
+		bool rbb_input = false;
+		serializer_options opts;
+		std::vector<std::string> args;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg(argv[i]);
+
+			if (arg == "--mem-report")
+			{
+				mem_report = true;
+				mem_stats::enable_phases();
+			}
+			else if (arg == "--rbb")
+			{
+				rbb_input = true;
+			}
+			else if (arg == "--no-crc")
+			{
+				opts.with_crc = false;
+			}
+			else
+			{
+				args.push_back(arg);
+			}
+		}
+
+		if (args.size() != 3u)
+		{
+			std::cerr << "usage: " << argv[0u] << " [--rbb] [--no-crc] [--mem-report] <result> <bitstream> <readback-file>" << std::endl
+				  << std::endl
+				  << "Converts FPGA readback data into a configuration bitstream. The readback data is either a raw" << std::endl
+				  << "readback file (read_back_hw_device -bin_file), with the layout inferred from the reference" << std::endl
+				  << "<bitstream>, or a readback bitstream with FDRO read packets (--rbb). Readback data and result are" << std::endl
+				  << "streamed (neither is loaded into memory as a whole)." << std::endl << std::endl
+				  << "options:" << std::endl
+				  << "  --rbb         the readback file is a readback bitstream (FDRO read packets)" << std::endl
+				  << "  --no-crc      do not emit crc checks in the result bitstream" << std::endl
+				  << "  --mem-report  print tracked memory and peak resident set size per processing phase" << std::endl
+				  << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// Load the reference bitstream (device geometry)
+		const bitstream reference = bitstream::load_bitstream(args[1u], 0xFFFFFFFFu, true);
+		mem_stats::end_phase("load reference");
+
+		const auto& fpga = unbit::old::xilinx::fpga_by_idcode(reference.idcode());
+		std::cout << "fpga: " << fpga.name() << std::endl;
+
+		const std::size_t frame_words = fpga.frame_size() / 4u;
+
+		std::ifstream input(args[2u], std::ios_base::in | std::ios_base::binary);
+		if (!input)
+			throw std::ios_base::failure("unable to open readback file '" + args[2u] + "'");
+
+		readback_converter converter(input, frame_words, opts);
+
+		// Index the readback data
+		if (rbb_input)
+		{
+			// FDRO payload: pipeline words, padding frame, frame data
+			converter.scan_fdro((fpga.readback_offset() - fpga.frame_size()) / 4u);
+		}
+		else
+		{
+			// Raw readback: replicate the SLR layout of the reference bitstream (cf. bitstream::load_raw)
+			readback_layout layout;
+			layout.front_padding_words = fpga.front_padding() / 4u;
+			layout.back_padding_words  = fpga.back_padding() / 4u;
+
+			for (const auto& ref : reference.slrs())
+			{
+				if (ref.frame_data_size < fpga.front_padding())
+					throw std::invalid_argument("bad frame data size of reference bitstream");
+
+				auto& slr = layout.slrs.emplace_back();
+				slr.idcode     = ref.idcode;
+				slr.num_frames = (ref.frame_data_size - fpga.front_padding()) / fpga.frame_size();
+			}
+
+			converter.set_layout(layout);
+		}
+
+		mem_stats::end_phase("index readback");
+
+		for (std::size_t i = 0u; i < converter.slrs().size(); ++i)
+		{
+			const auto& slr = converter.slrs()[i];
+
+			std::cout << "slr " << i << ": " << slr.num_frames << " frames at offset 0x"
+				<< std::hex << std::setw(8) << std::setfill('0') << slr.data_offset << std::dec << std::setfill(' ');
+
+			if (slr.idcode)
+				std::cout << " (idcode 0x" << std::hex << std::setw(8) << std::setfill('0') << *slr.idcode << std::dec << std::setfill(' ') << ")";
+
+			std::cout << std::endl;
+		}
+
+		// Stream the result bitstream
+		std::cout << "writing result bitstream ..." << std::flush;
+
+		std::ofstream output(args[0u], std::ios_base::out | std::ios_base::binary);
+		if (!output)
+			throw std::ios_base::failure("unable to open output file '" + args[0u] + "'");
+
+		converter.convert(output);
+		output.close();
+
+		std::cout << "done (" << converter.output_size() << " bytes, " << converter.num_fdri_frames() << " frames)" << std::endl;
+		mem_stats::end_phase("write result");
+
+		if (mem_report)
+		{
+			std::cout << std::endl;
+			mem_stats::report(std::cout);
+		}
+
+		return EXIT_SUCCESS;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
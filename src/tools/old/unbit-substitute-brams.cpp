@@ -6,40 +6,67 @@
 #include "unbit/fpga/old/xilinx/bitstream.hpp"
 #include "unbit/fpga/old/xilinx/bram.hpp"
 #include "unbit/fpga/old/xilinx/fpga.hpp"
+#include "unbit/runtime/mem_stats.hpp"
 
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <string>
+#include <vector>
 
 using unbit::old::xilinx::bitstream;
 using unbit::old::xilinx::bram;
 using unbit::old::xilinx::bram_category;
+using unbit::runtime::mem_stats;
 
 //---------------------------------------------------------------------------------------------------------------------
 int main(int argc, char *argv[])
 {
 	try
 	{
-		if (argc != 4)
+		// Split options and positional arguments
+		bool mem_report = false;
+		std::vector<std::string> args;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg(argv[i]);
+
+			if (arg == "--mem-report")
+			{
+				mem_report = true;
+				mem_stats::enable_phases();
+			}
+			else
+			{
+				args.push_back(arg);
+			}
+		}
+
+		if (args.size() != 3u)
 		{
-			std::cerr << "usage: " << argv[0u] << " <result> <bitstream> <readback-file>" << std::endl
+			std::cerr << "usage: " << argv[0u] << " [--mem-report] <result> <bitstream> <readback-file>" << std::endl
 				  << std::endl
 				  << "Substitutes initialization data of BRAM blocks in a given <bitstream> by BRAM content obtained" << std::endl
 				  << "obtained from FPGA readback (read_back_hw_device -bin_file). The resulting bitstream, with substituted"  << std::endl
 				  << "BRAMs is written to <result> and can be used to configure FPGAs (note that this tool currently does not" << std::endl
 				  << "update CRC values)" << std::endl << std::endl
+				  << "options:" << std::endl
+				  << "  --mem-report  print tracked memory and peak resident set size per processing phase" << std::endl
 				  << std::endl;
 			return EXIT_FAILURE;
 		}
 
 		// Load the bitstream to be updated
-		bitstream bs = bitstream::load_bitstream(argv[2u]);
-		
+		bitstream bs = bitstream::load_bitstream(args[1u]);
+		mem_stats::end_phase("load bitstream");
+
 		const auto& fpga = unbit::old::xilinx::fpga_by_idcode(bs.idcode());
 		std::cout << "fpga: " << fpga.name() << std::endl;
 
 		// Load the source RAMs (with inference of bitstream properties from the given bitstream)
-		const bitstream brams = bitstream::load_raw(argv[3u], bs);
+		const bitstream brams = bitstream::load_raw(args[2u], bs);
+		mem_stats::end_phase("load readback");
 
 		std::cout << "substituting brams " << std::flush;
 
@@ -58,6 +85,7 @@ int main(int argc, char *argv[])
 		}
 
 		std::cout << std::endl;
+		mem_stats::end_phase("substitute brams");
 
 		// Need to fixup the CRC record (for now we simply kill the CRC command)
 		//
@@ -69,8 +97,16 @@ int main(int argc, char *argv[])
 
 		// And store the output
 		std::cout << "writing result bitstream ..." << std::flush;
-		bitstream::save(argv[1u], bs);
+		bitstream::save(args[0u], bs);
 		std::cout << "done" << std::endl;
+		mem_stats::end_phase("write result");
+
+		if (mem_report)
+		{
+			std::cout << std::endl;
+			mem_stats::report(std::cout);
+		}
+
 		return EXIT_SUCCESS;
 	}
 	catch (std::exception& e)
@@ -0,0 +1,221 @@
+/**
+ * @file
+ * @brief Creates and applies frame-level delta patches between configuration bitstreams.
+ */
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/frame_delta.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+#include "unbit/runtime/sha256.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using unbit::fpga::xilinx::bitstream_engine;
+using unbit::fpga::xilinx::delta_options;
+using unbit::fpga::xilinx::frame_delta_decoder;
+using unbit::fpga::xilinx::frame_delta_encoder;
+using unbit::fpga::xilinx::frame_store;
+using unbit::runtime::sha256;
+
+namespace
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads the configuration words of a bitstream file (native byte order, starting at the first sync word).
+	 */
+	std::vector<uint32_t> load_config_words(const std::string& filename)
+	{
+		std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+		if (!stm)
+			throw std::ios_base::failure("unable to open bitstream file '" + filename + "'");
+
+		const std::vector<uint8_t> data((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+
+		// Skip over leading data (e.g. the .bit file header) until we see the first sync word
+		uint32_t sync_w = 0u;
+		std::size_t pos = 0u;
+
+		while (pos < data.size() && sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			sync_w = (sync_w << 8u) | data[pos++];
+
+		if (sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			throw std::invalid_argument("no sync word found in bitstream file '" + filename + "'");
+
+		std::vector<uint32_t> words;
+		words.reserve((data.size() - pos) / 4u + 1u);
+
+		for (pos -= 4u; pos + 4u <= data.size(); pos += 4u)
+		{
+			words.push_back((static_cast<uint32_t>(data[pos]) << 24u) | (static_cast<uint32_t>(data[pos + 1u]) << 16u) |
+				(static_cast<uint32_t>(data[pos + 2u]) << 8u) | static_cast<uint32_t>(data[pos + 3u]));
+		}
+
+		return words;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Opens an input file (binary mode).
+	 */
+	std::ifstream open_input(const std::string& filename)
+	{
+		std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+		if (!stm)
+			throw std::ios_base::failure("unable to open input file '" + filename + "'");
+
+		return stm;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Creates a delta between two bitstreams.
+	 */
+	int cmd_encode(std::size_t frame_words, bool xor_rle, const std::string& base_name, const std::string& target_name,
+		const std::string& delta_name)
+	{
+		const frame_store base = frame_store::load(load_config_words(base_name), frame_words);
+		const frame_store target = frame_store::load(load_config_words(target_name), frame_words);
+
+		frame_delta_encoder encoder(base, target, delta_options { .xor_rle = xor_rle });
+
+		std::ofstream stm(delta_name, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!stm)
+			throw std::ios_base::failure("unable to create delta file '" + delta_name + "'");
+
+		encoder.encode(stm);
+
+		std::cout << encoder.num_changed_frames() << " changed frames in " << encoder.num_records() << " records, "
+			<< encoder.size() << " bytes" << std::endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Applies a delta to a base bitstream.
+	 */
+	int cmd_apply(const std::string& delta_name, const std::string& base_name, const std::string& output_name)
+	{
+		auto delta = open_input(delta_name);
+		auto base = open_input(base_name);
+
+		frame_delta_decoder decoder(delta);
+
+		// Write to a temporary file, then rename it into place (the digests are checked at the end)
+		const std::filesystem::path path(output_name);
+		const std::filesystem::path tmp_path = path.string() + ".tmp";
+
+		try
+		{
+			std::ofstream output(tmp_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+			if (!output)
+				throw std::ios_base::failure("unable to create output file '" + tmp_path.string() + "'");
+
+			decoder.apply(base, output);
+		}
+		catch (...)
+		{
+			std::error_code ec;
+			std::filesystem::remove(tmp_path, ec);
+			throw;
+		}
+
+		std::filesystem::rename(tmp_path, path);
+		return EXIT_SUCCESS;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Prints the header of a delta.
+	 */
+	int cmd_info(const std::string& delta_name)
+	{
+		auto delta = open_input(delta_name);
+		frame_delta_decoder decoder(delta);
+
+		std::cout << "frame words:   " << decoder.frame_words() << std::endl
+			<< "base image:    " << sha256::to_hex(decoder.base_digest()) << std::endl
+			<< "target image:  " << sha256::to_hex(decoder.target_digest()) << std::endl;
+
+		for (std::size_t i = 0u; i < decoder.slrs().size(); ++i)
+		{
+			const auto& slr = decoder.slrs()[i];
+			std::cout << "SLR(" << i << "): " << slr.num_frames << " frames, " << slr.num_records << " records, "
+				<< (4u * slr.words) << " bytes" << std::endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	void print_usage(const char* argv0)
+	{
+		std::cerr << "usage: " << argv0 << " encode [--raw] --frame-words <n> <base> <target> <delta>" << std::endl
+			<< "       " << argv0 << " apply <delta> <base> <output>" << std::endl
+			<< "       " << argv0 << " info <delta>" << std::endl
+			<< std::endl
+			<< "Creates a frame-level delta between two (uncompressed) Xilinx 7-series or Virtex UltraScale+ bitstreams," << std::endl
+			<< "or applies a delta to the base bitstream (streaming, recomputing the CRC checks)." << std::endl
+			<< std::endl;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		const std::vector<std::string> args(argv + 1, argv + argc);
+
+		if (!args.empty() && args[0u] == "encode")
+		{
+			bool xor_rle = true;
+			std::size_t frame_words = 0u;
+			std::size_t pos = 1u;
+
+			for (; pos < args.size() && args[pos].starts_with("--"); ++pos)
+			{
+				if (args[pos] == "--raw")
+				{
+					xor_rle = false;
+				}
+				else if (args[pos] == "--frame-words" && pos + 1u < args.size())
+				{
+					frame_words = std::stoul(args[++pos]);
+				}
+				else
+				{
+					print_usage(argv[0u]);
+					return EXIT_FAILURE;
+				}
+			}
+
+			if (frame_words > 0u && pos + 3u == args.size())
+				return cmd_encode(frame_words, xor_rle, args[pos], args[pos + 1u], args[pos + 2u]);
+		}
+		else if (args.size() == 4u && args[0u] == "apply")
+		{
+			return cmd_apply(args[1u], args[2u], args[3u]);
+		}
+		else if (args.size() == 2u && args[0u] == "info")
+		{
+			return cmd_info(args[1u]);
+		}
+
+		print_usage(argv[0u]);
+		return EXIT_FAILURE;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
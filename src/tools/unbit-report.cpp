@@ -0,0 +1,270 @@
+/**
+ * @file
+ * @brief Single-pass bitstream report (packet statistics, CRC check, settings and frame digests).
+ */
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/config_context.hpp"
+#include "unbit/fpga/xilinx/config_crc.hpp"
+#include "unbit/fpga/xilinx/config_dispatcher.hpp"
+#include "unbit/runtime/sha256.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+using unbit::fpga::xilinx::bitstream_engine;
+using unbit::fpga::xilinx::config_context;
+using unbit::fpga::xilinx::config_crc;
+using unbit::fpga::xilinx::config_dispatcher;
+using unbit::fpga::xilinx::config_reg;
+using unbit::fpga::xilinx::config_reg_mask;
+using unbit::fpga::xilinx::config_visitor;
+using unbit::fpga::xilinx::visitor_filter;
+using unbit::runtime::sha256;
+
+namespace
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads the configuration words of a bitstream file (native byte order, starting at the first sync word).
+	 */
+	std::vector<uint32_t> load_config_words(const std::string& filename)
+	{
+		std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+		if (!stm)
+			throw std::ios_base::failure("unable to open bitstream file '" + filename + "'");
+
+		const std::vector<uint8_t> data((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+
+		// Skip over leading data (e.g. the .bit file header) until we see the first sync word
+		uint32_t sync_w = 0u;
+		std::size_t pos = 0u;
+
+		while (pos < data.size() && sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			sync_w = (sync_w << 8u) | data[pos++];
+
+		if (sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			throw std::invalid_argument("no sync word found in bitstream file '" + filename + "'");
+
+		std::vector<uint32_t> words;
+		words.reserve((data.size() - pos) / 4u + 1u);
+
+		for (pos -= 4u; pos + 4u <= data.size(); pos += 4u)
+		{
+			words.push_back((static_cast<uint32_t>(data[pos]) << 24u) | (static_cast<uint32_t>(data[pos + 1u]) << 16u) |
+				(static_cast<uint32_t>(data[pos + 2u]) << 8u) | static_cast<uint32_t>(data[pos + 3u]));
+		}
+
+		return words;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Counts the write packets (and payload words) of each register.
+	 */
+	class packet_stats final : public config_visitor
+	{
+	public:
+		struct counter
+		{
+			uint64_t packets = 0u;
+			uint64_t words   = 0u;
+		};
+
+		std::map<config_reg, counter> writes;
+
+		void on_write(const config_context& ctx, config_reg reg, word_span_type data) override
+		{
+			auto& c = writes[reg];
+			++c.packets;
+			c.words += data.size();
+		}
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Checks the CRC register writes against the CRC of the configuration data.
+	 */
+	class crc_check final : public config_visitor
+	{
+	public:
+		std::map<uint32_t, config_crc> crcs;
+		std::size_t num_passed = 0u;
+		std::size_t num_failed = 0u;
+
+		void on_slr_begin(const config_context& ctx) override
+		{
+			crcs[ctx.slr_index()].reset();
+		}
+
+		void on_write(const config_context& ctx, config_reg reg, word_span_type data) override
+		{
+			auto& crc = crcs[ctx.slr_index()];
+
+			if (reg == config_reg::CRC && !data.empty())
+			{
+				if (data[0u] == crc.value())
+				{
+					++num_passed;
+				}
+				else
+				{
+					++num_failed;
+					std::cout << "SLR(" << ctx.slr_index() << "): CRC mismatch (expected 0x" << std::hex << std::setw(8)
+						<< std::setfill('0') << crc.value() << ", found 0x" << std::setw(8) << data[0u] << ")"
+						<< std::dec << std::setfill(' ') << std::endl;
+				}
+			}
+
+			crc.process_write(reg, data);
+		}
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Digests the frame data of each SLR.
+	 */
+	class frame_digest final : public config_visitor
+	{
+	public:
+		struct slr_digest
+		{
+			sha256 hash;
+			std::size_t num_frames = 0u;
+		};
+
+		std::map<uint32_t, slr_digest> slrs;
+
+		void on_frame(const config_context& ctx, std::size_t frame_index, word_span_type frame) override
+		{
+			auto& slr = slrs[ctx.slr_index()];
+			slr.hash.update_be(frame);
+			++slr.num_frames;
+		}
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Reports the configuration settings of each SLR (from the shadow registers).
+	 */
+	class settings_probe final : public config_visitor
+	{
+	public:
+		void on_slr_end(const config_context& ctx) override
+		{
+			auto print_reg = [&](const char* name, std::optional<uint32_t> value)
+			{
+				std::cout << "  " << std::left << std::setw(18) << name << std::right;
+
+				if (value)
+					std::cout << "0x" << std::hex << std::setw(8) << std::setfill('0') << *value << std::dec << std::setfill(' ');
+				else
+					std::cout << "-";
+
+				std::cout << std::endl;
+			};
+
+			std::cout << "SLR(" << ctx.slr_index() << "):" << std::endl;
+			print_reg("IDCODE", ctx.idcode());
+			print_reg("CTL0", ctx.reg(config_reg::CTL0));
+			print_reg("CTL1", ctx.reg(config_reg::CTL1));
+			print_reg("COR0", ctx.reg(config_reg::COR0));
+			print_reg("COR1", ctx.reg(config_reg::COR1));
+			print_reg("WBSTAR", ctx.wbstar());
+			print_reg("TIMER", ctx.timer());
+
+			std::cout << std::boolalpha
+				<< "  readback disabled " << ctx.is_readback_disabled() << std::endl
+				<< "  encrypted         " << ctx.is_encrypted() << std::endl
+				<< "  compressed        " << ctx.is_compressed() << std::endl
+				<< "  started           " << ctx.is_started() << std::endl
+				<< std::noboolalpha;
+		}
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	void print_usage(const char* argv0)
+	{
+		std::cerr << "usage: " << argv0 << " [--frame-words <n>] <bitstream>" << std::endl
+			<< std::endl
+			<< "Reports the packet statistics, CRC checks, configuration settings and (if the frame size is given)" << std::endl
+			<< "the frame data digests of a Xilinx 7-series or Virtex UltraScale+ bitstream in a single pass." << std::endl
+			<< std::endl;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		const std::vector<std::string> args(argv + 1, argv + argc);
+
+		std::size_t frame_words = 0u;
+		std::size_t pos = 0u;
+
+		if (args.size() == 3u && args[0u] == "--frame-words")
+		{
+			frame_words = std::stoul(args[1u]);
+			pos = 2u;
+		}
+
+		if (pos + 1u != args.size())
+		{
+			print_usage(argv[0u]);
+			return EXIT_FAILURE;
+		}
+
+		const auto words = load_config_words(args[pos]);
+
+		packet_stats stats;
+		crc_check crc;
+		frame_digest digest;
+		settings_probe settings;
+
+		config_dispatcher dispatcher(frame_words);
+		dispatcher.add(settings, visitor_filter { .regs = 0u });
+		dispatcher.add(stats);
+		dispatcher.add(crc);
+
+		if (frame_words > 0u)
+			dispatcher.add(digest, visitor_filter { .regs = 0u, .frames = true });
+
+		dispatcher.set_stop_at_desync(true);
+
+		auto [n_parsed, success] = dispatcher.process(words);
+		if (!success)
+		{
+			std::clog << "ERR: parsing stopped early at word offset 0x" << std::hex << n_parsed << " of 0x" << words.size() << std::dec << std::endl;
+		}
+
+		std::cout << std::endl << "Register writes:" << std::endl;
+		for (const auto& [reg, c] : stats.writes)
+			std::cout << "  " << std::left << std::setw(8) << reg << std::right << std::setw(10) << c.packets << " packets" << std::setw(12) << c.words << " words" << std::endl;
+
+		std::cout << std::endl << "CRC checks: " << crc.num_passed << " passed, " << crc.num_failed << " failed" << std::endl;
+
+		if (frame_words > 0u)
+		{
+			std::cout << std::endl << "Frame digests:" << std::endl;
+			for (auto& [slr_index, slr] : digest.slrs)
+				std::cout << "  SLR(" << slr_index << "): " << slr.num_frames << " frames, sha256 " << sha256::to_hex(slr.hash.finish()) << std::endl;
+		}
+
+		return (success && crc.num_failed == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
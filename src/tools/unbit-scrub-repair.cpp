@@ -0,0 +1,290 @@
+/**
+ * @file
+ * @brief Generates scrub-repair partial bitstreams from readback data.
+ */
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/bitstream_serializer.hpp"
+#include "unbit/fpga/xilinx/frame_store.hpp"
+#include "unbit/fpga/xilinx/readback_converter.hpp"
+#include "unbit/fpga/xilinx/scrub_repair.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using unbit::fpga::xilinx::bitstream_engine;
+using unbit::fpga::xilinx::bitstream_serializer;
+using unbit::fpga::xilinx::frame_store;
+using unbit::fpga::xilinx::readback_converter;
+using unbit::fpga::xilinx::readback_layout;
+using unbit::fpga::xilinx::scrub_options;
+using unbit::fpga::xilinx::scrub_repair;
+
+namespace
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads the configuration words of a bitstream file (native byte order, starting at the first sync word).
+	 */
+	std::vector<uint32_t> load_config_words(const std::string& filename)
+	{
+		std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+		if (!stm)
+			throw std::ios_base::failure("unable to open bitstream file '" + filename + "'");
+
+		const std::vector<uint8_t> data((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+
+		// Skip over leading data (e.g. the .bit file header) until we see the first sync word
+		uint32_t sync_w = 0u;
+		std::size_t pos = 0u;
+
+		while (pos < data.size() && sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			sync_w = (sync_w << 8u) | data[pos++];
+
+		if (sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			throw std::invalid_argument("no sync word found in bitstream file '" + filename + "'");
+
+		std::vector<uint32_t> words;
+		words.reserve((data.size() - pos) / 4u + 1u);
+
+		for (pos -= 4u; pos + 4u <= data.size(); pos += 4u)
+		{
+			words.push_back((static_cast<uint32_t>(data[pos]) << 24u) | (static_cast<uint32_t>(data[pos + 1u]) << 16u) |
+				(static_cast<uint32_t>(data[pos + 2u]) << 8u) | static_cast<uint32_t>(data[pos + 3u]));
+		}
+
+		return words;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads a frame address map file.
+	 *
+	 * The file lists the frame address (hexadecimal) of each frame in linear frame order, with '-' marking row
+	 * padding frames. The keyword 'slr' starts the map of the next SLR; '#' starts a comment.
+	 */
+	std::vector<std::vector<uint32_t>> load_frame_addresses(const std::string& filename)
+	{
+		std::ifstream stm(filename);
+		if (!stm)
+			throw std::ios_base::failure("unable to open frame address map '" + filename + "'");
+
+		std::vector<std::vector<uint32_t>> result(1u);
+		std::string token;
+
+		while (stm >> token)
+		{
+			if (token.starts_with("#"))
+			{
+				std::getline(stm, token);
+			}
+			else if (token == "slr")
+			{
+				if (!result.back().empty())
+					result.emplace_back();
+			}
+			else if (token == "-")
+			{
+				result.back().push_back(bitstream_serializer::NO_FRAME_ADDRESS);
+			}
+			else
+			{
+				std::size_t end = 0u;
+				const unsigned long far = std::stoul(token, &end, 16);
+
+				if (end != token.size() || far > 0xFFFFFFFFul)
+					throw std::invalid_argument("bad frame address '" + token + "' in '" + filename + "'");
+
+				result.back().push_back(static_cast<uint32_t>(far));
+			}
+		}
+
+		return result;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	void print_usage(const char* argv0)
+	{
+		std::cerr << "usage: " << argv0 << " --frame-words <n> --far-map <file> [--mask <msk-file>] [--rbb <pipeline-words>]" << std::endl
+			<< "       " << std::string(std::char_traits<char>::length(argv0), ' ')
+			<< " [--padding <front-words>:<back-words>] [--max-upsets <n>] [--no-crc] <golden> <readback> <output>" << std::endl
+			<< std::endl
+			<< "Compares readback data against the frames of a golden (uncompressed) bitstream, ignoring the bits set in" << std::endl
+			<< "the mask file, and writes a partial bitstream that rewrites the upset frames only." << std::endl
+			<< std::endl
+			<< "The readback data is a raw readback file (with the given padding around the frame data of each SLR), or" << std::endl
+			<< "a readback bitstream with FDRO data (--rbb, with the number of pipeline words in front of the padding" << std::endl
+			<< "frame). The frame address map lists the FAR of each frame in hexadecimal ('-' for padding frames, 'slr'" << std::endl
+			<< "starts the next SLR). No output is written if no upsets are found." << std::endl
+			<< std::endl;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		const std::vector<std::string> args(argv + 1, argv + argc);
+
+		std::size_t frame_words = 0u;
+		std::string far_map;
+		std::string mask_name;
+		bool rbb_input = false;
+		std::size_t pipeline_words = 0u;
+		std::size_t front_padding = 0u;
+		std::size_t back_padding = 0u;
+		scrub_options opts;
+		std::size_t pos = 0u;
+
+		for (; pos < args.size() && args[pos].starts_with("--"); ++pos)
+		{
+			const bool has_value = (pos + 1u < args.size());
+
+			if (args[pos] == "--frame-words" && has_value)
+			{
+				frame_words = std::stoul(args[++pos]);
+			}
+			else if (args[pos] == "--far-map" && has_value)
+			{
+				far_map = args[++pos];
+			}
+			else if (args[pos] == "--mask" && has_value)
+			{
+				mask_name = args[++pos];
+			}
+			else if (args[pos] == "--rbb" && has_value)
+			{
+				rbb_input = true;
+				pipeline_words = std::stoul(args[++pos]);
+			}
+			else if (args[pos] == "--padding" && has_value && args[pos + 1u].find(':') != std::string::npos)
+			{
+				const std::string& value = args[++pos];
+				front_padding = std::stoul(value.substr(0u, value.find(':')));
+				back_padding = std::stoul(value.substr(value.find(':') + 1u));
+			}
+			else if (args[pos] == "--max-upsets" && has_value)
+			{
+				opts.max_upsets = std::stoul(args[++pos]);
+			}
+			else if (args[pos] == "--no-crc")
+			{
+				opts.with_crc = false;
+			}
+			else
+			{
+				print_usage(argv[0u]);
+				return EXIT_FAILURE;
+			}
+		}
+
+		if (frame_words == 0u || far_map.empty() || pos + 3u != args.size())
+		{
+			print_usage(argv[0u]);
+			return EXIT_FAILURE;
+		}
+
+		const std::string& golden_name = args[pos];
+		const std::string& readback_name = args[pos + 1u];
+		const std::string& output_name = args[pos + 2u];
+
+		// Golden image, mask and frame addresses (prepared once on the controller)
+		const frame_store golden = frame_store::load(load_config_words(golden_name), frame_words);
+		const auto addresses = load_frame_addresses(far_map);
+
+		if (addresses.size() != golden.num_slrs())
+			throw std::invalid_argument("frame address map does not match the number of slrs of the golden bitstream");
+
+		scrub_repair repair(golden, opts);
+
+		for (std::size_t k = 0u; k < addresses.size(); ++k)
+			repair.set_frame_addresses(k, addresses[k]);
+
+		frame_store mask;
+		if (!mask_name.empty())
+		{
+			mask = frame_store::load(load_config_words(mask_name), frame_words);
+			repair.set_mask(mask);
+		}
+
+		// Index and compare the readback data
+		const auto start = std::chrono::steady_clock::now();
+
+		std::ifstream readback(readback_name, std::ios_base::in | std::ios_base::binary);
+		if (!readback)
+			throw std::ios_base::failure("unable to open readback file '" + readback_name + "'");
+
+		readback_converter converter(readback, frame_words);
+
+		if (rbb_input)
+		{
+			converter.scan_fdro(pipeline_words);
+		}
+		else
+		{
+			readback_layout layout;
+			layout.front_padding_words = front_padding;
+			layout.back_padding_words = back_padding;
+
+			for (std::size_t k = 0u; k < golden.num_slrs(); ++k)
+			{
+				auto& slr = layout.slrs.emplace_back();
+				slr.idcode = golden.idcode(k).value_or(0u);
+				slr.num_frames = golden.num_frames(k);
+			}
+
+			converter.set_layout(layout);
+		}
+
+		repair.scan(readback, converter.slrs());
+
+		const auto compared = std::chrono::steady_clock::now();
+
+		for (const auto& upset : repair.upsets())
+		{
+			std::cout << "SLR(" << upset.slr << ") frame " << std::setw(6) << upset.frame << "  FAR 0x" << std::hex
+				<< std::setw(8) << std::setfill('0') << upset.frame_address << std::dec << std::setfill(' ') << "  "
+				<< upset.num_bits << " bit(s)" << std::endl;
+		}
+
+		if (repair.limit_reached())
+			std::cout << "upset limit reached" << std::endl;
+
+		if (repair.upsets().empty())
+		{
+			std::cout << "no upsets found" << std::endl;
+			return EXIT_SUCCESS;
+		}
+
+		std::ofstream output(output_name, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!output)
+			throw std::ios_base::failure("unable to create output file '" + output_name + "'");
+
+		repair.write(output);
+		output.close();
+
+		const auto written = std::chrono::steady_clock::now();
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< repair.upsets().size() << " upset frame(s), " << repair.num_fdri_frames() << " frame(s) rewritten, "
+			<< repair.output_size() << " bytes" << std::endl
+			<< "compare: " << std::chrono::duration<double, std::milli>(compared - start).count() << " ms, write: "
+			<< std::chrono::duration<double, std::milli>(written - compared).count() << " ms" << std::endl;
+
+		return EXIT_SUCCESS;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,215 @@
+/**
+ * @file
+ * @brief Converts configuration bitstreams into SVF programming sequences for generic JTAG programmers.
+ */
+#include "unbit/fpga/xilinx/bitstream_engine.hpp"
+#include "unbit/fpga/xilinx/svf_writer.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+using unbit::fpga::xilinx::bitstream_engine;
+using unbit::fpga::xilinx::svf_options;
+using unbit::fpga::xilinx::svf_writer;
+
+namespace
+{
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Loads a bitstream file (file byte order).
+	 */
+	std::vector<uint8_t> load_file(const std::string& filename)
+	{
+		std::ifstream stm(filename, std::ios_base::in | std::ios_base::binary);
+		if (!stm)
+			throw std::ios_base::failure("unable to open bitstream file '" + filename + "'");
+
+		return std::vector<uint8_t>((std::istreambuf_iterator<char>(stm)), std::istreambuf_iterator<char>());
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Locates the configuration data of a bitstream file.
+	 *
+	 * The configuration data starts with the dummy and bus width detection words in front of the first sync word
+	 * (any leading data, e.g. the .bit file header, is skipped).
+	 */
+	std::span<const uint8_t> find_config_data(const std::vector<uint8_t>& data, const std::string& filename)
+	{
+		uint32_t sync_w = 0u;
+		std::size_t pos = 0u;
+
+		while (pos < data.size() && sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			sync_w = (sync_w << 8u) | data[pos++];
+
+		if (sync_w != bitstream_engine::FPGA_SYNC_WORD_LE)
+			throw std::invalid_argument("no sync word found in bitstream file '" + filename + "'");
+
+		// Include the preceding dummy and bus width detection words
+		const auto word_at = [&](std::size_t offset)
+		{
+			return (static_cast<uint32_t>(data[offset]) << 24u) | (static_cast<uint32_t>(data[offset + 1u]) << 16u) |
+				(static_cast<uint32_t>(data[offset + 2u]) << 8u) | static_cast<uint32_t>(data[offset + 3u]);
+		};
+
+		std::size_t start = pos - 4u;
+
+		while (start >= 4u)
+		{
+			const uint32_t w = word_at(start - 4u);
+			if (w != 0xFFFFFFFFu && w != 0x000000BBu && w != 0x11220044u)
+				break;
+
+			start -= 4u;
+		}
+
+		return std::span<const uint8_t>(data).subspan(start);
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	/**
+	 * @brief Parses a hexadecimal 32-bit value.
+	 */
+	uint32_t parse_hex32(const std::string& text)
+	{
+		std::size_t end = 0u;
+		const unsigned long value = std::stoul(text, &end, 16);
+
+		if (end != text.size() || value > 0xFFFFFFFFul)
+			throw std::invalid_argument("bad hexadecimal value '" + text + "'");
+
+		return static_cast<uint32_t>(value);
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	void print_usage(const char* argv0)
+	{
+		std::cerr << "usage: " << argv0 << " [--slrs <n>] [--idcode <hex>] [--chunk <bytes>] [--chain <hir>:<tir>:<hdr>:<tdr>]" << std::endl
+			<< "       " << std::string(std::char_traits<char>::length(argv0), ' ')
+			<< " [--no-status-check] <bitstream> <result.svf>" << std::endl
+			<< std::endl
+			<< "Converts a configuration bitstream (.bit or .bin, uncompressed or compressed) into an SVF programming" << std::endl
+			<< "sequence (JPROGRAM, CFG_IN and JSTART) for 7-series and UltraScale(+) devices. The SVF text is streamed" << std::endl
+			<< "to the result file." << std::endl
+			<< std::endl
+			<< "options:" << std::endl
+			<< "  --slrs <n>           number of SLRs of the device (the 6-bit instruction is replicated per SLR)" << std::endl
+			<< "  --idcode <hex>       verify the IDCODE of the device before programming (revision is ignored)" << std::endl
+			<< "  --chunk <bytes>      split the configuration data into SDR shifts of at most <bytes> bytes" << std::endl
+			<< "  --chain <...>        IR and DR bits of the other devices in the chain before/after the target" << std::endl
+			<< "  --no-status-check    do not verify the INIT_COMPLETE and DONE status bits" << std::endl
+			<< std::endl;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	try
+	{
+		const std::vector<std::string> args(argv + 1, argv + argc);
+
+		svf_options opts;
+		std::size_t pos = 0u;
+
+		for (; pos < args.size() && args[pos].starts_with("--"); ++pos)
+		{
+			const std::string& opt = args[pos];
+			const bool has_value = (pos + 1u) < args.size();
+
+			if (opt == "--slrs" && has_value)
+			{
+				opts.num_slrs = std::stoul(args[++pos]);
+			}
+			else if (opt == "--idcode" && has_value)
+			{
+				opts.idcode = parse_hex32(args[++pos]);
+			}
+			else if (opt == "--chunk" && has_value)
+			{
+				opts.chunk_bytes = std::stoul(args[++pos]);
+			}
+			else if (opt == "--chain" && has_value)
+			{
+				const std::string& chain = args[++pos];
+				std::size_t values[4u] = { 0u, 0u, 0u, 0u };
+				std::size_t start = 0u;
+
+				for (std::size_t i = 0u; i < 4u; ++i)
+				{
+					const std::size_t sep = chain.find(':', start);
+					if ((i < 3u) == (sep == std::string::npos))
+						throw std::invalid_argument("bad chain position '" + chain + "' (expected <hir>:<tir>:<hdr>:<tdr>)");
+
+					values[i] = std::stoul(chain.substr(start, sep - start));
+					start = sep + 1u;
+				}
+
+				opts.header_ir_bits = values[0u];
+				opts.trailer_ir_bits = values[1u];
+				opts.header_dr_bits = values[2u];
+				opts.trailer_dr_bits = values[3u];
+			}
+			else if (opt == "--no-status-check")
+			{
+				opts.check_status = false;
+			}
+			else
+			{
+				print_usage(argv[0u]);
+				return EXIT_FAILURE;
+			}
+		}
+
+		if (pos + 2u != args.size())
+		{
+			print_usage(argv[0u]);
+			return EXIT_FAILURE;
+		}
+
+		const std::string& input_name = args[pos];
+		const std::string& output_name = args[pos + 1u];
+
+		const auto data = load_file(input_name);
+		const auto config = find_config_data(data, input_name);
+
+		const auto start = std::chrono::steady_clock::now();
+
+		std::ofstream output(output_name, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!output)
+			throw std::ios_base::failure("unable to create output file '" + output_name + "'");
+
+		svf_writer writer(output, opts);
+		writer.write_program(config);
+
+		output.close();
+		if (!output)
+			throw std::ios_base::failure("i/o error while writing output file '" + output_name + "'");
+
+		const auto written = std::chrono::steady_clock::now();
+		const double seconds = std::chrono::duration<double>(written - start).count();
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< config.size() << " bytes of configuration data, " << writer.num_shifts() << " shift(s), "
+			<< writer.text_size() << " bytes of svf text" << std::endl
+			<< "write: " << seconds * 1000.0 << " ms (" << (seconds > 0.0 ? writer.text_size() / seconds / 1e6 : 0.0)
+			<< " MB/s)" << std::endl;
+
+		return EXIT_SUCCESS;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << std::endl << "error: unhandled exception: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}